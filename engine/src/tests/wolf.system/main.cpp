@@ -0,0 +1,55 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : main.cpp
+	Description		 : Runs behavior tests of wolf.system
+	Comment          : Without arguments all tests run, otherwise only the tests whose names are passed
+*/
+
+#include "pch.h"
+#include <cstring>
+
+using namespace wolf;
+using namespace wolf::system;
+
+int main(int pArgc, char** pArgv)
+{
+	w_logger_config _log_config;
+	_log_config.app_name = L"wolf.system.tests";
+	_log_config.log_path = io::get_current_directoryW();
+	_log_config.log_to_std_out = false;
+	logger.initialize(_log_config);
+
+	size_t _ran = 0;
+	size_t _failed = 0;
+	for (auto& _test : test::get_tests())
+	{
+		if (pArgc > 1)
+		{
+			bool _selected = false;
+			for (int i = 1; i < pArgc && !_selected; ++i)
+			{
+				_selected = std::strcmp(pArgv[i], _test.name) == 0;
+			}
+			if (!_selected) continue;
+		}
+
+		const auto _failures = test::get_failures().load();
+		_test.func();
+		const bool _passed = test::get_failures().load() == _failures;
+		std::printf("[%s] %s\n", _passed ? "passed" : "failed", _test.name);
+		std::fflush(stdout);
+
+		_ran++;
+		if (!_passed)
+		{
+			_failed++;
+		}
+	}
+
+	std::printf("%zu of %zu tests passed\n", _ran - _failed, _ran);
+	logger.release();
+	//tests which were asked for but not found are failures as well
+	return (_failed || !_ran) ? 1 : 0;
+}
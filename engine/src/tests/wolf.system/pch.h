@@ -0,0 +1,20 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : pch.h
+	Description		 : Pre-Compiled header
+	Comment          :
+*/
+
+#if _MSC_VER > 1000
+#pragma once
+#endif
+
+#ifndef __PCH_H__
+#define __PCH_H__
+
+#include <w_system_pch.h>
+#include "w_test.h"
+
+#endif
@@ -0,0 +1,229 @@
+#include "pch.h"
+#include <w_archive.h>
+#include <w_vfs.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace wolf::system;
+
+static std::filesystem::path s_make_temp_directory(_In_z_ const char* pName)
+{
+	auto _path = std::filesystem::temp_directory_path() / pName;
+	std::error_code _error;
+	std::filesystem::remove_all(_path, _error);
+	std::filesystem::create_directories(_path, _error);
+	return _path;
+}
+
+static std::string s_read_file(_In_ const std::filesystem::path& pPath)
+{
+	std::ifstream _file(pPath, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(_file), std::istreambuf_iterator<char>());
+}
+
+static void s_write_file(_In_ const std::filesystem::path& pPath, _In_ const std::string& pContent)
+{
+	std::ofstream _file(pPath, std::ios::binary | std::ios::trunc);
+	_file.write(pContent.data(), pContent.size());
+}
+
+//an archive with a stored, a compressed and an aligned entry
+static W_RESULT s_save_archive(_In_ const std::filesystem::path& pPath, _Inout_ std::vector<std::pair<std::string, std::string>>& pEntries)
+{
+	std::mt19937 _random(23);
+	std::string _noise(10000, 0);
+	for (auto& _c : _noise) _c = static_cast<char>(_random());
+
+	pEntries.clear();
+	pEntries.emplace_back("textures/noise.bin", _noise);
+	pEntries.emplace_back("shaders/basic.glsl", std::string(20000, 'x') + "void main() {}");
+	pEntries.emplace_back("config.json", "{ \"name\": \"wolf\" }");
+
+	w_archive_writer _writer;
+	if (_writer.add(pEntries[0].first.c_str(), pEntries[0].second.data(), pEntries[0].second.size()) != W_PASSED ||
+		_writer.add(pEntries[1].first.c_str(), pEntries[1].second.data(), pEntries[1].second.size(), true) != W_PASSED ||
+		_writer.add(pEntries[2].first.c_str(), pEntries[2].second.data(), pEntries[2].second.size(), false, 4096) != W_PASSED)
+	{
+		return W_FAILED;
+	}
+	return _writer.save(pPath.string().c_str());
+}
+
+W_TEST(archive_save_open_find)
+{
+	const auto _dir = s_make_temp_directory("wolf_archive_tests_find");
+	const auto _path = _dir / "data.wpak";
+	std::vector<std::pair<std::string, std::string>> _entries;
+	W_REQUIRE(s_save_archive(_path, _entries) == W_PASSED);
+
+	w_archive _archive;
+	W_REQUIRE(_archive.open(_path.string().c_str()) == W_PASSED);
+	W_REQUIRE(_archive.get_entry_count() == _entries.size());
+
+	for (const auto& _pair : _entries)
+	{
+		const auto _entry = _archive.find(_pair.first.c_str());
+		W_REQUIRE(_entry != nullptr);
+		W_CHECK(_archive.get_entry_path(_entry) == _pair.first);
+		W_CHECK(_entry->offset % _entry->alignment == 0);
+
+		std::string _data(_entry->original_size, '\0');
+		W_REQUIRE(_archive.read(_entry, &_data[0], _data.size()) == W_PASSED);
+		W_CHECK(_data == _pair.second);
+		if (_entry->flags == W_ARCHIVE_ENTRY_STORED)
+		{
+			W_CHECK(std::string(_archive.get_data(_entry), _entry->size) == _pair.second);
+		}
+	}
+	W_CHECK(_archive.find("shaders/basic.glsl")->flags == W_ARCHIVE_ENTRY_LZ4);
+	W_CHECK(_archive.find("textures/noise.bin")->flags == W_ARCHIVE_ENTRY_STORED);
+	W_CHECK(_archive.find("config.json")->alignment == 4096);
+
+	//paths are normalized before lookup
+	W_CHECK(_archive.find("./textures\\noise.bin") == _archive.find("textures/noise.bin"));
+	W_CHECK(_archive.find("textures/missing.bin") == nullptr);
+
+	_archive.close();
+	std::error_code _error;
+	std::filesystem::remove_all(_dir, _error);
+}
+
+W_TEST(archive_rejects_duplicate_paths)
+{
+	const auto _dir = s_make_temp_directory("wolf_archive_tests_duplicate");
+	const auto _path = _dir / "data.wpak";
+	s_write_file(_path, "old");
+
+	const char _data[] = "data";
+	w_archive_writer _writer;
+	W_REQUIRE(_writer.add("a/b.txt", _data, sizeof(_data) - 1) == W_PASSED);
+	W_REQUIRE(_writer.add("./a\\b.txt", _data, sizeof(_data) - 1) == W_PASSED);
+	W_CHECK(_writer.save(_path.string().c_str()) == W_FAILED);
+
+	//existing archive is untouched and no temporary file is left behind
+	W_CHECK(s_read_file(_path) == "old");
+	W_CHECK(!std::filesystem::exists(_path.string() + ".tmp"));
+
+	std::error_code _error;
+	std::filesystem::remove_all(_dir, _error);
+}
+
+W_TEST(archive_rejects_corrupted_offsets)
+{
+	const auto _dir = s_make_temp_directory("wolf_archive_tests_corrupted");
+	const auto _path = _dir / "data.wpak";
+	std::vector<std::pair<std::string, std::string>> _entries;
+	W_REQUIRE(s_save_archive(_path, _entries) == W_PASSED);
+
+	const auto _content = s_read_file(_path);
+	W_REQUIRE(_content.size() > sizeof(w_archive_header));
+	w_archive_header _header;
+	std::memcpy(&_header, _content.data(), sizeof(_header));
+	W_REQUIRE(_header.entry_count == _entries.size());
+
+	const auto _corrupted = _dir / "corrupted.wpak";
+	const auto _open = [&](_In_ const std::string& pContent)
+	{
+		s_write_file(_corrupted, pContent);
+		w_archive _archive;
+		return _archive.open(_corrupted.string().c_str());
+	};
+
+	//an untouched copy opens
+	W_CHECK(_open(_content) == W_PASSED);
+
+	//truncated file
+	W_CHECK(_open(_content.substr(0, _content.size() - 1)) == W_FAILED);
+
+	//index beyond the end of file
+	{
+		auto _bad = _content;
+		auto _bad_header = _header;
+		_bad_header.index_offset = _header.file_size + 16;
+		std::memcpy(&_bad[0], &_bad_header, sizeof(_bad_header));
+		W_CHECK(_open(_bad) == W_FAILED);
+	}
+
+	//names beyond the end of file
+	{
+		auto _bad = _content;
+		auto _bad_header = _header;
+		_bad_header.names_size = _header.file_size;
+		std::memcpy(&_bad[0], &_bad_header, sizeof(_bad_header));
+		W_CHECK(_open(_bad) == W_FAILED);
+	}
+
+	//an entry whose data or name runs past the end of file
+	for (uint32_t i = 0; i < _header.entry_count; ++i)
+	{
+		const auto _entry_offset = static_cast<size_t>(_header.index_offset) + i * sizeof(w_archive_entry);
+		w_archive_entry _entry;
+		std::memcpy(&_entry, _content.data() + _entry_offset, sizeof(_entry));
+
+		auto _bad = _content;
+		auto _bad_entry = _entry;
+		_bad_entry.offset = _header.file_size;
+		std::memcpy(&_bad[_entry_offset], &_bad_entry, sizeof(_bad_entry));
+		W_CHECK(_open(_bad) == W_FAILED);
+
+		_bad_entry = _entry;
+		_bad_entry.size = _header.file_size - _entry.offset + 1;
+		std::memcpy(&_bad[_entry_offset], &_bad_entry, sizeof(_bad_entry));
+		W_CHECK(_open(_bad) == W_FAILED);
+
+		_bad_entry = _entry;
+		_bad_entry.name_size = static_cast<uint32_t>(_header.names_size) + 1;
+		std::memcpy(&_bad[_entry_offset], &_bad_entry, sizeof(_bad_entry));
+		W_CHECK(_open(_bad) == W_FAILED);
+	}
+
+	std::error_code _error;
+	std::filesystem::remove_all(_dir, _error);
+}
+
+W_TEST(archive_vfs_relative_and_absolute_mounts)
+{
+	const auto _dir = s_make_temp_directory("wolf_archive_tests_vfs");
+	const auto _absolute_path = (_dir / "absolute.wpak").string();
+	const auto _relative_path = (_dir / "relative.wpak").string();
+
+	const char _data[] = "data";
+	w_archive_writer _absolute;
+	W_REQUIRE(_absolute.add("a.txt", _data, sizeof(_data) - 1) == W_PASSED);
+	W_REQUIRE(_absolute.save(_absolute_path.c_str()) == W_PASSED);
+	w_archive_writer _relative;
+	W_REQUIRE(_relative.add("b.txt", _data, sizeof(_data) - 1) == W_PASSED);
+	W_REQUIRE(_relative.save(_relative_path.c_str()) == W_PASSED);
+
+	const auto _overlay = w_vfs::get_loose_files_overlay();
+	w_vfs::set_loose_files_overlay(false);
+
+	//an absolute mount point only matches absolute paths
+	W_REQUIRE(w_vfs::mount(_absolute_path.c_str(), "/wolf/content") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("/wolf/content/a.txt") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("\\wolf\\content\\a.txt") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("wolf/content/a.txt") == W_FAILED);
+	W_CHECK(w_vfs::get_is_packed("./wolf/content/a.txt") == W_FAILED);
+
+	//a relative mount point only matches relative paths
+	W_REQUIRE(w_vfs::mount(_relative_path.c_str(), "content") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("content/b.txt") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("./content/b.txt") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("/content/b.txt") == W_FAILED);
+	W_CHECK(w_vfs::unmount(_relative_path.c_str()) == W_PASSED);
+
+	//root of archive, empty for relative paths and "/" for absolute ones
+	W_REQUIRE(w_vfs::mount(_relative_path.c_str(), "") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("b.txt") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("/b.txt") == W_FAILED);
+	W_REQUIRE(w_vfs::mount(_relative_path.c_str(), "/") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("/b.txt") == W_PASSED);
+	W_CHECK(w_vfs::get_is_packed("b.txt") == W_FAILED);
+
+	w_vfs::unmount_all();
+	w_vfs::set_loose_files_overlay(_overlay);
+	std::error_code _error;
+	std::filesystem::remove_all(_dir, _error);
+}
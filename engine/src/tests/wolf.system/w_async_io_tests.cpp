@@ -0,0 +1,305 @@
+#include "pch.h"
+#include <w_async_io.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
+using namespace wolf::system;
+
+//random content, so a read from a wrong offset can not match
+static std::string s_make_file(_In_ const std::filesystem::path& pPath, _In_ const size_t& pSize)
+{
+	std::mt19937 _random(22);
+	std::string _content(pSize, '\0');
+	for (auto& _c : _content) _c = static_cast<char>(_random());
+
+	std::ofstream _file(pPath, std::ios::binary | std::ios::trunc);
+	_file.write(_content.data(), _content.size());
+	return _content;
+}
+
+//runs pTest on io_uring, which falls back to the thread pool where it is not available, and on the thread pool
+static void s_for_each_backend(_In_ const uint32_t& pQueueDepth, _In_ const std::function<void(w_async_io&)>& pTest)
+{
+	const bool _use_io_uring[] = { true, false };
+	for (auto _uring : _use_io_uring)
+	{
+		w_async_io_config _config;
+		_config.use_io_uring = _uring;
+		_config.queue_depth = pQueueDepth;
+		_config.worker_threads = 3;
+
+		w_async_io _io;
+		W_REQUIRE(_io.initialize(_config) == W_PASSED);
+		W_CHECK(_io.get_backend() != w_async_io_backend::NONE);
+		if (!_uring) W_CHECK(_io.get_backend() == w_async_io_backend::THREAD_POOL);
+		pTest(_io);
+		_io.release();
+	}
+}
+
+W_TEST(async_io_data_integrity)
+{
+	const auto _path = std::filesystem::temp_directory_path() / "wolf_async_io_tests_integrity.bin";
+	const auto _content = s_make_file(_path, 4 * 1024 * 1024);
+	const auto _path_string = _path.string();
+
+	const uint32_t _depths[] = { 1, 32 };
+	for (auto _depth : _depths)
+	{
+		s_for_each_backend(_depth, [&](w_async_io& pIO)
+			{
+				std::mt19937 _random(_depth);
+				std::vector<std::vector<char>> _buffers(300);
+				std::vector<w_io_request> _requests(_buffers.size());
+				std::atomic<size_t> _callbacks(0);
+				std::atomic<size_t> _max_in_flight(0);
+				for (size_t i = 0; i < _requests.size(); ++i)
+				{
+					auto& _request = _requests[i];
+					_request.path = _path_string;
+					_request.size = 1 + _random() % 65536;
+					_request.offset = _random() % (_content.size() - _request.size);
+					_request.priority = static_cast<w_io_priority>(i % 3);
+					_buffers[i].resize(_request.size);
+					_request.buffer = _buffers[i].data();
+					_request.on_completed = [&](const w_io_result&)
+					{
+						_callbacks++;
+						const auto _in_flight = pIO.get_in_flight();
+						auto _max = _max_in_flight.load();
+						while (_in_flight > _max && !_max_in_flight.compare_exchange_weak(_max, _in_flight));
+					};
+				}
+
+				const auto _copy = _requests;
+				std::atomic<bool> _batch_done(false);
+				auto _handle = pIO.submit(_requests, [&](const std::vector<w_io_result>& pResults)
+					{
+						_batch_done = pResults.size() == _copy.size();
+					});
+				W_REQUIRE(_handle.get() == W_PASSED);
+				W_CHECK(_batch_done);
+				W_CHECK(_callbacks == _copy.size());
+				W_CHECK(_max_in_flight <= _depth);
+
+				const auto& _results = _handle.get_results();
+				W_REQUIRE(_results.size() == _copy.size());
+				for (size_t i = 0; i < _copy.size(); ++i)
+				{
+					W_CHECK(_results[i].index == i);
+					W_CHECK(_results[i].bytes_read == _copy[i].size);
+					W_CHECK(std::memcmp(_buffers[i].data(), _content.data() + _copy[i].offset, _copy[i].size) == 0);
+				}
+			});
+	}
+
+	std::error_code _error;
+	std::filesystem::remove(_path, _error);
+}
+
+W_TEST(async_io_end_of_file)
+{
+	const auto _path = std::filesystem::temp_directory_path() / "wolf_async_io_tests_eof.bin";
+	const auto _content = s_make_file(_path, 100000);
+	const auto _path_string = _path.string();
+
+	s_for_each_backend(8, [&](w_async_io& pIO)
+		{
+			//a read across the end of file is short, reads at and past the end read nothing
+			std::vector<char> _buffer(4096, '\0');
+			auto _handle = pIO.read(_path_string.c_str(), _content.size() - 100, _buffer.data(), _buffer.size());
+			W_REQUIRE(_handle.get() == W_PASSED);
+			W_CHECK(_handle.get_results()[0].bytes_read == 100);
+			W_CHECK(std::memcmp(_buffer.data(), _content.data() + _content.size() - 100, 100) == 0);
+
+			_handle = pIO.read(_path_string.c_str(), _content.size(), _buffer.data(), _buffer.size());
+			W_REQUIRE(_handle.get() == W_PASSED);
+			W_CHECK(_handle.get_results()[0].bytes_read == 0);
+
+			_handle = pIO.read(_path_string.c_str(), _content.size() + 12345, _buffer.data(), _buffer.size());
+			W_REQUIRE(_handle.get() == W_PASSED);
+			W_CHECK(_handle.get_results()[0].bytes_read == 0);
+
+			//whole file in one read
+			std::vector<char> _all(_content.size() + 1, '\0');
+			_handle = pIO.read(_path_string.c_str(), 0, _all.data(), _all.size());
+			W_REQUIRE(_handle.get() == W_PASSED);
+			W_CHECK(_handle.get_results()[0].bytes_read == _content.size());
+			W_CHECK(std::memcmp(_all.data(), _content.data(), _content.size()) == 0);
+		});
+
+	std::error_code _error;
+	std::filesystem::remove(_path, _error);
+}
+
+W_TEST(async_io_invalid_requests)
+{
+	const auto _path = std::filesystem::temp_directory_path() / "wolf_async_io_tests_invalid.bin";
+	const auto _content = s_make_file(_path, 4096);
+	const auto _path_string = _path.string();
+	const auto _missing = (std::filesystem::temp_directory_path() / "wolf_async_io_tests_missing.bin").string();
+
+	s_for_each_backend(8, [&](w_async_io& pIO)
+		{
+			char _buffer[16];
+			std::vector<w_io_request> _requests(4);
+			//no path
+			_requests[0].buffer = _buffer;
+			_requests[0].size = sizeof(_buffer);
+			//no buffer
+			_requests[1].path = _path_string;
+			_requests[1].size = 5;
+			//missing file
+			_requests[2].path = _missing;
+			_requests[2].buffer = _buffer;
+			_requests[2].size = sizeof(_buffer);
+			//a valid request of the same batch still completes
+			char _valid[16];
+			_requests[3].path = _path_string;
+			_requests[3].buffer = _valid;
+			_requests[3].size = sizeof(_valid);
+
+			auto _handle = pIO.submit(_requests);
+			W_CHECK(_handle.get() == W_FAILED);
+			const auto& _results = _handle.get_results();
+			W_REQUIRE(_results.size() == 4);
+			W_CHECK(_results[0].status == W_INVALIDARG);
+			W_CHECK(_results[1].status == W_INVALIDARG);
+			W_CHECK(_results[2].status == W_FAILED && _results[2].error == ENOENT);
+			W_CHECK(_results[3].status == W_PASSED && _results[3].bytes_read == sizeof(_valid));
+			W_CHECK(std::memcmp(_valid, _content.data(), sizeof(_valid)) == 0);
+
+			//an empty batch passes at once
+			W_CHECK(pIO.submit({}).get() == W_PASSED);
+		});
+
+	//a service which is not initialized returns invalid handles
+	w_async_io _io;
+	char _buffer[16];
+	W_CHECK(!_io.read(_path_string.c_str(), 0, _buffer, sizeof(_buffer)).get_is_valid());
+
+	std::error_code _error;
+	std::filesystem::remove(_path, _error);
+}
+
+W_TEST(async_io_cancel)
+{
+	const auto _path = std::filesystem::temp_directory_path() / "wolf_async_io_tests_cancel.bin";
+	const size_t _block = 4096;
+	const size_t _count = 2000;
+	const auto _content = s_make_file(_path, _block * _count);
+	const auto _path_string = _path.string();
+
+	s_for_each_backend(1, [&](w_async_io& pIO)
+		{
+			std::vector<char> _buffer(_block * _count);
+			std::vector<w_io_request> _requests(_count);
+			std::atomic<bool> _cancel_called(false);
+			for (size_t i = 0; i < _count; ++i)
+			{
+				_requests[i].path = _path_string;
+				_requests[i].buffer = _buffer.data() + i * _block;
+				_requests[i].size = _block;
+				_requests[i].offset = i * _block;
+				//the first completion holds the only slot until the batch is cancelled
+				_requests[i].on_completed = [&](const w_io_result&)
+				{
+					while (!_cancel_called)
+					{
+						std::this_thread::yield();
+					}
+				};
+			}
+
+			auto _handle = pIO.submit(_requests);
+			_handle.cancel();
+			_cancel_called = true;
+			_handle.wait();
+			W_CHECK(_handle.get_is_completed());
+
+			size_t _cancelled = 0;
+			const auto& _results = _handle.get_results();
+			for (size_t i = 0; i < _count; ++i)
+			{
+				if (_results[i].status == W_PASSED)
+				{
+					W_CHECK(std::memcmp(_buffer.data() + i * _block, _content.data() + i * _block, _block) == 0);
+				}
+				else
+				{
+					W_CHECK(_results[i].error == ECANCELED);
+					_cancelled++;
+				}
+			}
+			W_CHECK(_cancelled >= _count - 1);
+			W_CHECK(_handle.get() == W_FAILED);
+
+			//cancelling a completed batch changes nothing
+			char _small[64];
+			auto _done = pIO.read(_path_string.c_str(), 0, _small, sizeof(_small));
+			W_REQUIRE(_done.get() == W_PASSED);
+			_done.cancel();
+			W_CHECK(_done.get() == W_PASSED);
+			W_CHECK(_done.get_results()[0].bytes_read == sizeof(_small));
+		});
+
+	std::error_code _error;
+	std::filesystem::remove(_path, _error);
+}
+
+W_TEST(async_io_release_in_flight)
+{
+	const auto _path = std::filesystem::temp_directory_path() / "wolf_async_io_tests_release.bin";
+	const size_t _block = 4096;
+	const size_t _count = 2000;
+	const auto _content = s_make_file(_path, _block * _count);
+	const auto _path_string = _path.string();
+
+	s_for_each_backend(4, [&](w_async_io& pIO)
+		{
+			std::vector<char> _buffer(_block * _count);
+			std::vector<w_io_request> _requests(_count);
+			std::atomic<size_t> _callbacks(0);
+			for (size_t i = 0; i < _count; ++i)
+			{
+				_requests[i].path = _path_string;
+				_requests[i].buffer = _buffer.data() + i * _block;
+				_requests[i].size = _block;
+				_requests[i].offset = i * _block;
+				_requests[i].on_completed = [&](const w_io_result&)
+				{
+					_callbacks++;
+				};
+			}
+
+			//release waits for reads in flight and completes the rest as cancelled
+			auto _handle = pIO.submit(_requests);
+			pIO.release();
+			W_CHECK(_handle.get_is_completed());
+			W_CHECK(_callbacks == _count);
+			W_CHECK(pIO.get_in_flight() == 0);
+			W_CHECK(pIO.get_queued() == 0);
+
+			const auto& _results = _handle.get_results();
+			for (size_t i = 0; i < _count; ++i)
+			{
+				if (_results[i].status == W_PASSED)
+				{
+					W_CHECK(std::memcmp(_buffer.data() + i * _block, _content.data() + i * _block, _block) == 0);
+				}
+				else
+				{
+					W_CHECK(_results[i].error == ECANCELED);
+				}
+			}
+
+			//a released service does not take new batches
+			W_CHECK(!pIO.submit(_requests).get_is_valid());
+		});
+
+	std::error_code _error;
+	std::filesystem::remove(_path, _error);
+}
@@ -0,0 +1,341 @@
+#include "pch.h"
+#include <w_compress.hpp>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+using namespace wolf::system;
+
+//text with runs and some noise, so every codec has something to find
+static std::string s_make_data(_In_ const size_t& pSize, _In_ const uint32_t& pSeed)
+{
+	std::mt19937 _random(pSeed);
+	std::string _data;
+	_data.reserve(pSize);
+	for (size_t i = 0; i < pSize; ++i)
+	{
+		_data.push_back(i % 7 == 0 ? static_cast<char>(_random()) : static_cast<char>('a' + (i / 13) % 26));
+	}
+	return _data;
+}
+
+static std::string s_read_frame(_In_ const std::string& pFrame, _Inout_ W_RESULT& pResult)
+{
+	std::stringstream _in(pFrame);
+	w_lz4_stream_reader _reader;
+	pResult = _reader.begin(_in);
+	std::string _out;
+	if (pResult != W_PASSED) return _out;
+
+	char _buffer[7777];
+	size_t _read = 0;
+	while ((_read = _reader.read(_buffer, sizeof(_buffer))) > 0)
+	{
+		_out.append(_buffer, _read);
+	}
+	pResult = _reader.end();
+	return _out;
+}
+
+W_TEST(compress_lz4_frame_streaming)
+{
+	const auto _src = s_make_data(3 * 1024 * 1024, 1);
+	std::mt19937 _random(2);
+
+	const w_compress_mode _modes[] = { w_compress_mode::W_DEFAULT, w_compress_mode::W_FAST };
+	for (auto _mode : _modes)
+	{
+		//writes of random sizes cross the block size of the frame
+		std::stringstream _out;
+		w_lz4_stream_writer _writer;
+		W_REQUIRE(_writer.begin(_out, _mode, 4) == W_PASSED);
+		size_t _offset = 0;
+		while (_offset < _src.size())
+		{
+			const auto _size = std::min<size_t>(_src.size() - _offset, 1 + _random() % 200000);
+			_writer.write(_src.data() + _offset, _size);
+			_offset += _size;
+		}
+		w_compress_result _info = {};
+		W_REQUIRE(_writer.end(&_info) == W_PASSED);
+
+		const auto _frame = _out.str();
+		W_CHECK(_info.size_in == _src.size());
+		W_CHECK(_info.size_out == _frame.size());
+		W_CHECK(_frame.size() < _src.size());
+		W_CHECK(w_compress::get_codec(_frame.data(), _frame.size()) == W_CODEC_LZ4_FRAME);
+
+		W_RESULT _result = W_FAILED;
+		W_CHECK(s_read_frame(_frame, _result) == _src);
+		W_CHECK(_result == W_PASSED);
+
+		//a whole frame through the generic decompress
+		w_compress_result _decompressed = {};
+		_decompressed.size_in = _frame.size();
+		W_REQUIRE(w_compress::decompress(_frame.data(), &_decompressed) == W_PASSED);
+		W_CHECK(_decompressed.size_out == _src.size());
+		W_CHECK(std::memcmp(_decompressed.data, _src.data(), _src.size()) == 0);
+		free(_decompressed.data);
+	}
+}
+
+W_TEST(compress_lz4_frame_rejects_damage)
+{
+	const auto _src = s_make_data(1024 * 1024, 3);
+	std::stringstream _out;
+	w_lz4_stream_writer _writer;
+	W_REQUIRE(_writer.begin(_out) == W_PASSED);
+	_writer.write(_src.data(), _src.size());
+	W_REQUIRE(_writer.end() == W_PASSED);
+	const auto _frame = _out.str();
+
+	//frames have checksums, a flipped byte or a missing tail is an error
+	auto _corrupted = _frame;
+	_corrupted[_corrupted.size() / 2] ^= 0x55;
+	W_RESULT _result = W_PASSED;
+	s_read_frame(_corrupted, _result);
+	W_CHECK(_result == W_FAILED);
+
+	_result = W_PASSED;
+	s_read_frame(_frame.substr(0, _frame.size() - 3), _result);
+	W_CHECK(_result == W_FAILED);
+
+	w_compress_result _decompressed = {};
+	_decompressed.size_in = _frame.size() - 3;
+	W_CHECK(w_compress::decompress(_frame.data(), &_decompressed) == W_FAILED);
+	W_CHECK(_decompressed.data == nullptr);
+
+	//an empty frame is valid
+	std::stringstream _empty;
+	w_lz4_stream_writer _empty_writer;
+	W_REQUIRE(_empty_writer.begin(_empty) == W_PASSED);
+	W_CHECK(_empty_writer.end() == W_PASSED);
+	_result = W_FAILED;
+	W_CHECK(s_read_frame(_empty.str(), _result).empty());
+	W_CHECK(_result == W_PASSED);
+}
+
+W_TEST(compress_lz4_parallel_blocks)
+{
+	//an incompressible tail is stored without compression
+	auto _src = s_make_data(9 * 1024 * 1024, 4);
+	std::mt19937 _random(5);
+	for (int i = 0; i < 100000; ++i)
+	{
+		_src.push_back(static_cast<char>(_random()));
+	}
+
+	const size_t _block_size = 1024 * 1024;
+	w_compress_result _compressed = {};
+	_compressed.size_in = _src.size();
+	W_REQUIRE(w_compress::compress_lz4_parallel(_src.data(), &_compressed, w_compress_mode::W_DEFAULT, 1, _block_size) == W_PASSED);
+	W_CHECK(_compressed.codec == W_CODEC_LZ4_PARALLEL);
+	W_CHECK(w_compress::get_codec(_compressed.data, _compressed.size_out) == W_CODEC_LZ4_PARALLEL);
+
+	std::vector<w_compress_block_info> _blocks;
+	size_t _total = 0;
+	W_REQUIRE(w_compress_parallel::get_blocks(_compressed.data, _compressed.size_out, _blocks, _total) == W_PASSED);
+	W_CHECK(_total == _src.size());
+	W_CHECK(_blocks.size() == (_src.size() + _block_size - 1) / _block_size);
+
+	//a block can be read without the others
+	std::vector<char> _block(_block_size);
+	W_CHECK(w_compress_parallel::decompress_block(_compressed.data, _compressed.size_out, 3, _block.data()) == W_PASSED);
+	W_CHECK(std::memcmp(_block.data(), _src.data() + 3 * _block_size, _blocks[3].size) == 0);
+
+	w_compress_result _decompressed = {};
+	_decompressed.size_in = _compressed.size_out;
+	W_REQUIRE(w_compress::decompress(_compressed.data, &_decompressed) == W_PASSED);
+	W_CHECK(_decompressed.size_out == _src.size());
+	W_CHECK(std::memcmp(_decompressed.data, _src.data(), _src.size()) == 0);
+	free(_decompressed.data);
+
+	//the checksum of a block catches damage, and a truncated index is rejected
+	_compressed.data[_compressed.size_out - 1000] ^= 1;
+	_decompressed = {};
+	_decompressed.size_in = _compressed.size_out;
+	W_CHECK(w_compress::decompress_lz4_parallel(_compressed.data, &_decompressed) == W_FAILED);
+	W_CHECK(_decompressed.data == nullptr);
+	W_CHECK(w_compress_parallel::get_blocks(_compressed.data, 40, _blocks, _total) == W_FAILED);
+	free(_compressed.data);
+
+	//input smaller than a block
+	w_compress_result _small = {};
+	_small.size_in = 10;
+	W_REQUIRE(w_compress::compress_lz4_parallel("0123456789", &_small, w_compress_mode::W_FAST, 8) == W_PASSED);
+	_decompressed = {};
+	_decompressed.size_in = _small.size_out;
+	W_REQUIRE(w_compress::decompress_lz4_parallel(_small.data, &_decompressed) == W_PASSED);
+	W_CHECK(_decompressed.size_out == 10);
+	W_CHECK(std::memcmp(_decompressed.data, "0123456789", 10) == 0);
+	free(_small.data);
+	free(_decompressed.data);
+}
+
+W_TEST(compress_lz4_hc_levels)
+{
+	const auto _src = s_make_data(512 * 1024, 6);
+
+	size_t _fast_size = 0;
+	w_compress_result _compressed = {};
+	_compressed.size_in = _src.size();
+	W_REQUIRE(w_compress::compress_lz4(_src.data(), &_compressed, w_compress_mode::W_FAST, 8) == W_PASSED);
+	_fast_size = _compressed.size_out;
+	free(_compressed.data);
+
+	const int _levels[] = { W_COMPRESS_HC_LEVEL_MIN, W_COMPRESS_HC_LEVEL_DEFAULT, W_COMPRESS_HC_LEVEL_MAX };
+	for (auto _level : _levels)
+	{
+		_compressed = {};
+		_compressed.size_in = _src.size();
+		W_REQUIRE(w_compress::compress_lz4(_src.data(), &_compressed, w_compress_mode::W_HIGH, _level) == W_PASSED);
+		W_CHECK(_compressed.size_out < _fast_size);
+
+		//single lz4 blocks have no header, so the codec and size must be given
+		w_compress_result _decompressed = {};
+		_decompressed.size_in = _compressed.size_out;
+		_decompressed.codec = _compressed.codec;
+		_decompressed.size_out = _src.size();
+		W_REQUIRE(w_compress::decompress(_compressed.data, &_decompressed) == W_PASSED);
+		W_CHECK(_decompressed.size_out == _src.size());
+		W_CHECK(std::memcmp(_decompressed.data, _src.data(), _src.size()) == 0);
+		free(_decompressed.data);
+		free(_compressed.data);
+	}
+
+	//frames and parallel blocks take hc levels as well
+	std::stringstream _out;
+	w_lz4_stream_writer _writer;
+	W_REQUIRE(_writer.begin(_out, w_compress_mode::W_HIGH, W_COMPRESS_HC_LEVEL_DEFAULT) == W_PASSED);
+	_writer.write(_src.data(), _src.size());
+	W_REQUIRE(_writer.end() == W_PASSED);
+	W_RESULT _result = W_FAILED;
+	W_CHECK(s_read_frame(_out.str(), _result) == _src);
+	W_CHECK(_result == W_PASSED);
+
+	_compressed = {};
+	_compressed.size_in = _src.size();
+	W_REQUIRE(w_compress_parallel::compress(_src.data(), &_compressed, w_compress_mode::W_HIGH, W_COMPRESS_HC_LEVEL_DEFAULT, 64 * 1024) == W_PASSED);
+	w_compress_result _decompressed = {};
+	_decompressed.size_in = _compressed.size_out;
+	W_REQUIRE(w_compress_parallel::decompress(_compressed.data, &_decompressed) == W_PASSED);
+	W_CHECK(_decompressed.size_out == _src.size());
+	W_CHECK(std::memcmp(_decompressed.data, _src.data(), _src.size()) == 0);
+	free(_decompressed.data);
+	free(_compressed.data);
+}
+
+W_TEST(compress_lz4_dictionary)
+{
+	//small records which share their keys, like many small assets of one kind
+	std::mt19937 _random(7);
+	std::vector<std::string> _samples;
+	for (int i = 0; i < 400; ++i)
+	{
+		_samples.push_back(
+			"{\"name\":\"mesh_" + std::to_string(_random() % 1000) +
+			"\",\"material\":\"standard_" + std::to_string(_random() % 8) +
+			"\",\"cast_shadow\":true,\"receive_shadow\":false,\"lod_distances\":[10,25,60],\"position\":[" +
+			std::to_string(_random() % 100) + "," + std::to_string(_random() % 100) + "," + std::to_string(_random() % 100) + "]}");
+	}
+	const std::vector<std::string> _train(_samples.begin(), _samples.begin() + 300);
+
+	std::string _dictionary;
+	W_REQUIRE(w_compress_dictionary::train(_train, _dictionary) == W_PASSED);
+	W_CHECK(!_dictionary.empty());
+	W_CHECK(_dictionary.size() <= W_COMPRESS_MAX_DICTIONARY_SIZE);
+
+	size_t _plain = 0;
+	size_t _with_dictionary = 0;
+	for (size_t i = 300; i < _samples.size(); ++i)
+	{
+		const auto& _sample = _samples[i];
+
+		w_compress_result _compressed = {};
+		_compressed.size_in = _sample.size();
+		W_REQUIRE(w_compress::compress_lz4(_sample.data(), &_compressed, w_compress_mode::W_HIGH, W_COMPRESS_HC_LEVEL_MAX) == W_PASSED);
+		_plain += _compressed.size_out;
+		free(_compressed.data);
+
+		const w_compress_mode _modes[] = { w_compress_mode::W_HIGH, w_compress_mode::W_FAST };
+		for (auto _mode : _modes)
+		{
+			_compressed = {};
+			_compressed.size_in = _sample.size();
+			W_REQUIRE(w_compress_dictionary::compress(_sample.data(), _dictionary, &_compressed, _mode) == W_PASSED);
+			if (_mode == w_compress_mode::W_HIGH)
+			{
+				_with_dictionary += _compressed.size_out;
+			}
+
+			w_compress_result _decompressed = {};
+			_decompressed.size_in = _compressed.size_out;
+			W_REQUIRE(w_compress_dictionary::decompress(_compressed.data, _dictionary, &_decompressed) == W_PASSED);
+			W_CHECK(_decompressed.size_out == _sample.size());
+			W_CHECK(std::memcmp(_decompressed.data, _sample.data(), _sample.size()) == 0);
+			free(_decompressed.data);
+
+			//another dictionary can not decode it
+			_decompressed = {};
+			_decompressed.size_in = _compressed.size_out;
+			W_CHECK(w_compress_dictionary::decompress(_compressed.data, "wrong", &_decompressed) == W_FAILED);
+			free(_compressed.data);
+		}
+	}
+	//the point of a dictionary is small inputs which can not find matches in themselves
+	W_CHECK(_with_dictionary < _plain / 2);
+
+	std::string _unused;
+	W_CHECK(w_compress_dictionary::train(std::vector<std::string>(1, _samples[0]), _unused) != W_PASSED);
+}
+
+W_TEST(compress_lzma_round_trip)
+{
+	auto _src = s_make_data(2 * 1024 * 1024 + 777, 8);
+	std::mt19937 _random(9);
+	for (int i = 0; i < 70000; ++i)
+	{
+		_src.push_back(static_cast<char>(_random()));
+	}
+
+	w_compress_result _compressed = {};
+	_compressed.size_in = _src.size();
+	W_REQUIRE(w_compress::compress_lzma(reinterpret_cast<const uint8_t*>(_src.data()), &_compressed, 3) == W_PASSED);
+	W_CHECK(_compressed.codec == W_CODEC_LZMA);
+	W_CHECK(_compressed.size_out < _src.size());
+
+	w_compress_result _decompressed = {};
+	_decompressed.size_in = _compressed.size_out;
+	_decompressed.codec = _compressed.codec;
+	W_REQUIRE(w_compress::decompress(_compressed.data, &_decompressed) == W_PASSED);
+	W_CHECK(_decompressed.size_out == _src.size());
+	W_CHECK(std::memcmp(_decompressed.data, _src.data(), _src.size()) == 0);
+	free(_decompressed.data);
+
+	//a truncated stream fails without output
+	_decompressed = {};
+	_decompressed.size_in = _compressed.size_out / 2;
+	W_CHECK(w_compress::decompress_lzma(reinterpret_cast<const uint8_t*>(_compressed.data), &_decompressed) == W_FAILED);
+	W_CHECK(_decompressed.data == nullptr);
+	free(_compressed.data);
+
+	//lzma blocks on the thread pool
+	_compressed = {};
+	_compressed.size_in = _src.size();
+	W_REQUIRE(w_compress::compress_lzma_parallel(_src.data(), &_compressed, 5, 1024 * 1024) == W_PASSED);
+	W_CHECK(w_compress::get_codec(_compressed.data, _compressed.size_out) == W_CODEC_LZMA_PARALLEL);
+
+	_decompressed = {};
+	_decompressed.size_in = _compressed.size_out;
+	W_REQUIRE(w_compress::decompress(_compressed.data, &_decompressed) == W_PASSED);
+	W_CHECK(_decompressed.codec == W_CODEC_LZMA_PARALLEL);
+	W_CHECK(_decompressed.size_out == _src.size());
+	W_CHECK(std::memcmp(_decompressed.data, _src.data(), _src.size()) == 0);
+	free(_decompressed.data);
+
+	_compressed.data[_compressed.size_out - 10000] ^= 1;
+	_decompressed = {};
+	_decompressed.size_in = _compressed.size_out;
+	W_CHECK(w_compress::decompress(_compressed.data, &_decompressed) == W_FAILED);
+	free(_compressed.data);
+}
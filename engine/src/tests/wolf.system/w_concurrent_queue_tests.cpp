@@ -0,0 +1,152 @@
+#include "pch.h"
+#include <w_concurrent_queue.h>
+#include <thread>
+
+using namespace wolf::system;
+
+W_TEST(bounded_concurrent_queue_full_and_empty)
+{
+	w_bounded_concurrent_queue<int> _queue(5);
+	W_REQUIRE(_queue.get_capacity() == 8);
+
+	int _item = 0;
+	W_CHECK(_queue.empty());
+	W_CHECK(!_queue.try_pop(_item));
+
+	for (int i = 0; i < 8; ++i)
+	{
+		W_CHECK(_queue.try_push(i));
+	}
+	W_CHECK(!_queue.try_push(8));
+	W_CHECK(_queue.get_size_approx() == 8);
+
+	//items come out in order and slots are reused after wrapping around
+	for (int _round = 0; _round < 3; ++_round)
+	{
+		int _items[8] = {};
+		W_CHECK(_queue.try_pop_bulk(_items, 8) == 8);
+		for (int i = 0; i < 8; ++i)
+		{
+			W_CHECK(_items[i] == _round * 8 + i);
+			_items[i] = (_round + 1) * 8 + i;
+		}
+		W_CHECK(_queue.try_push_bulk(_items, 8) == 8);
+	}
+	W_CHECK(_queue.try_push_bulk(&_item, 1) == 0);
+}
+
+W_TEST(bounded_concurrent_queue_mpmc)
+{
+	const uint64_t _producers = 4;
+	const uint64_t _consumers = 4;
+	const uint64_t _items_per_producer = 100000;
+
+	//a small queue keeps producers on the full path and consumers on the empty path
+	w_bounded_concurrent_queue<uint64_t> _queue(64);
+	std::vector<std::atomic<uint32_t>> _seen(_producers * _items_per_producer);
+	for (auto& _count : _seen)
+	{
+		_count.store(0);
+	}
+	std::atomic<uint64_t> _popped(0);
+
+	std::vector<std::thread> _threads;
+	for (uint64_t p = 0; p < _producers; ++p)
+	{
+		_threads.emplace_back([&, p]()
+			{
+				for (uint64_t i = 0; i < _items_per_producer; ++i)
+				{
+					const auto _item = (p << 32) | i;
+					while (!_queue.try_push(_item))
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+	}
+	for (uint64_t c = 0; c < _consumers; ++c)
+	{
+		_threads.emplace_back([&]()
+			{
+				//items of one producer reach a consumer in the order they were pushed
+				std::vector<int64_t> _last(_producers, -1);
+				const auto _total = _producers * _items_per_producer;
+				uint64_t _item = 0;
+				while (_popped.load() < _total)
+				{
+					if (!_queue.try_pop(_item))
+					{
+						std::this_thread::yield();
+						continue;
+					}
+
+					const auto _producer = _item >> 32;
+					const auto _index = static_cast<int64_t>(_item & 0xffffffff);
+					_popped++;
+					if (!W_CHECK(_producer < _producers)) continue;
+					W_CHECK(_index > _last[_producer]);
+					_last[_producer] = _index;
+					_seen[_producer * _items_per_producer + _index]++;
+				}
+			});
+	}
+	for (auto& _thread : _threads)
+	{
+		_thread.join();
+	}
+
+	W_CHECK(_popped.load() == _producers * _items_per_producer);
+	size_t _wrong = 0;
+	for (auto& _count : _seen)
+	{
+		if (_count.load() != 1) _wrong++;
+	}
+	W_CHECK(_wrong == 0);
+	W_CHECK(_queue.empty());
+}
+
+W_TEST(bounded_concurrent_queue_wait_pop)
+{
+	w_bounded_concurrent_queue<int> _queue(16);
+	const int _count = 20000;
+	std::atomic<int64_t> _sum(0);
+
+	std::vector<std::thread> _consumers;
+	for (int c = 0; c < 2; ++c)
+	{
+		_consumers.emplace_back([&]()
+			{
+				int _item = 0;
+				while (true)
+				{
+					//spin count of zero parks the thread at once
+					_queue.wait_pop(_item, 0);
+					if (_item < 0) return;
+					_sum += _item;
+				}
+			});
+	}
+
+	int64_t _expected = 0;
+	for (int i = 1; i <= _count; ++i)
+	{
+		while (!_queue.try_push(i))
+		{
+			std::this_thread::yield();
+		}
+		_expected += i;
+	}
+	for (int c = 0; c < 2; ++c)
+	{
+		while (!_queue.try_push(-1))
+		{
+			std::this_thread::yield();
+		}
+	}
+	for (auto& _thread : _consumers)
+	{
+		_thread.join();
+	}
+	W_CHECK(_sum.load() == _expected);
+}
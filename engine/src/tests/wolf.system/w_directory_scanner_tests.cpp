@@ -0,0 +1,185 @@
+#include "pch.h"
+#include <w_directory_scanner.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+using namespace wolf::system;
+
+static std::filesystem::path s_make_temp_directory(_In_z_ const char* pName)
+{
+	auto _path = std::filesystem::temp_directory_path() / pName;
+	std::error_code _error;
+	std::filesystem::remove_all(_path, _error);
+	std::filesystem::create_directories(_path, _error);
+	return _path;
+}
+
+//recently modified directories are listed again on every scan, so the tree is moved back in time
+static void s_set_age(_In_ const std::filesystem::path& pPath, _In_ const int& pDays)
+{
+	const auto _time = std::filesystem::file_time_type::clock::now() - std::chrono::hours(24 * pDays);
+	std::filesystem::last_write_time(pPath, _time);
+}
+
+//d0..d3 with e0..e1 each holding three files
+static size_t s_make_tree(_In_ const std::filesystem::path& pRoot)
+{
+	size_t _files = 0;
+	for (int d = 0; d < 4; ++d)
+	{
+		for (int e = 0; e < 2; ++e)
+		{
+			const auto _dir = pRoot / ("d" + std::to_string(d)) / ("e" + std::to_string(e));
+			std::filesystem::create_directories(_dir);
+			for (int f = 0; f < 3; ++f)
+			{
+				std::ofstream(_dir / ("f" + std::to_string(f) + ".txt")) << "abc";
+				_files++;
+			}
+		}
+	}
+	for (auto& _entry : std::filesystem::recursive_directory_iterator(pRoot))
+	{
+		s_set_age(_entry.path(), 400);
+	}
+	s_set_age(pRoot, 400);
+	return _files;
+}
+
+static bool s_has_entry(_In_ const std::vector<w_directory_entry>& pEntries, _In_ const std::string& pPath)
+{
+	for (const auto& _entry : pEntries)
+	{
+		if (_entry.path == pPath) return true;
+	}
+	return false;
+}
+
+//root, d0..d3 and their e0..e1
+static const size_t s_directories = 1 + 4 + 8;
+
+W_TEST(directory_scanner_cache_invalidation)
+{
+	const auto _root = s_make_temp_directory("wolf_directory_scanner_tests_cache");
+	const auto _files = s_make_tree(_root);
+	const auto _root_path = _root.string();
+
+	const uint32_t _workers[] = { 0, 4 };
+	for (auto _worker_threads : _workers)
+	{
+		w_directory_scanner_config _config;
+		_config.worker_threads = _worker_threads;
+		w_directory_scanner _scanner;
+		W_REQUIRE(_scanner.initialize(_config) == W_PASSED);
+
+		//cold scan lists every directory
+		std::vector<w_directory_entry> _entries;
+		W_REQUIRE(_scanner.scan(_root_path.c_str(), _entries) == W_PASSED);
+		W_CHECK(_entries.size() == _files);
+		W_CHECK(_scanner.get_listed_directories() == s_directories);
+		W_CHECK(_scanner.get_cached_directories() == 0);
+		for (size_t i = 1; i < _entries.size(); ++i)
+		{
+			W_CHECK(_entries[i - 1].path < _entries[i].path);
+		}
+
+		//warm scan takes everything from cache
+		_entries.clear();
+		W_REQUIRE(_scanner.scan(_root_path.c_str(), _entries) == W_PASSED);
+		W_CHECK(_entries.size() == _files);
+		W_CHECK(_scanner.get_listed_directories() == 0);
+		W_CHECK(_scanner.get_cached_directories() == s_directories);
+
+		//a new file changes modification time of its directory, only that directory is listed again
+		const auto _changed = _root / "d2" / "e1";
+		const auto _new_file = "new" + std::to_string(_worker_threads) + ".txt";
+		std::ofstream(_changed / _new_file) << "new";
+		s_set_age(_changed / _new_file, 300);
+		s_set_age(_changed, 300 - static_cast<int>(_worker_threads));
+
+		_entries.clear();
+		W_REQUIRE(_scanner.scan(_root_path.c_str(), _entries) == W_PASSED);
+		W_CHECK(_scanner.get_listed_directories() == 1);
+		W_CHECK(_scanner.get_cached_directories() == s_directories - 1);
+		W_CHECK(s_has_entry(_entries, "d2/e1/" + _new_file));
+		W_CHECK(_entries.size() == _files + 1);
+
+		//a removed file is gone from the next scan as well
+		std::filesystem::remove(_changed / _new_file);
+		s_set_age(_changed, 200 - static_cast<int>(_worker_threads));
+
+		_entries.clear();
+		W_REQUIRE(_scanner.scan(_root_path.c_str(), _entries) == W_PASSED);
+		W_CHECK(_scanner.get_listed_directories() == 1);
+		W_CHECK(!s_has_entry(_entries, "d2/e1/" + _new_file));
+		W_CHECK(_entries.size() == _files);
+
+		//clearing cache lists everything again
+		_scanner.clear_cache();
+		W_CHECK(_scanner.get_cache_size() == 0);
+		_entries.clear();
+		W_REQUIRE(_scanner.scan(_root_path.c_str(), _entries) == W_PASSED);
+		W_CHECK(_scanner.get_listed_directories() == s_directories);
+		_scanner.release();
+	}
+
+	std::error_code _error;
+	std::filesystem::remove_all(_root, _error);
+}
+
+W_TEST(directory_scanner_cache_file)
+{
+	const auto _dir = s_make_temp_directory("wolf_directory_scanner_tests_file");
+	const auto _root = _dir / "tree";
+	std::filesystem::create_directories(_root);
+	const auto _files = s_make_tree(_root);
+	const auto _root_path = _root.string();
+
+	w_directory_scanner_config _config;
+	_config.cache_path = (_dir / "scan.cache").string();
+
+	{
+		w_directory_scanner _scanner;
+		W_REQUIRE(_scanner.initialize(_config) == W_PASSED);
+		std::vector<w_directory_entry> _entries;
+		W_REQUIRE(_scanner.scan(_root_path.c_str(), _entries) == W_PASSED);
+		W_CHECK(_scanner.get_listed_directories() == s_directories);
+		_scanner.release();
+	}
+	W_REQUIRE(std::filesystem::exists(_config.cache_path));
+
+	//another scanner starts from the cache file
+	const auto _changed = _root / "d1";
+	std::ofstream(_changed / "new.txt") << "new";
+	s_set_age(_changed / "new.txt", 300);
+	s_set_age(_changed, 300);
+	{
+		w_directory_scanner _scanner;
+		W_REQUIRE(_scanner.initialize(_config) == W_PASSED);
+		W_CHECK(_scanner.get_cache_size() == s_directories);
+		std::vector<w_directory_entry> _entries;
+		W_REQUIRE(_scanner.scan(_root_path.c_str(), _entries) == W_PASSED);
+		W_CHECK(_scanner.get_listed_directories() == 1);
+		W_CHECK(_scanner.get_cached_directories() == s_directories - 1);
+		W_CHECK(s_has_entry(_entries, "d1/new.txt"));
+		W_CHECK(_entries.size() == _files + 1);
+		_scanner.release();
+	}
+
+	//a corrupted cache file is ignored
+	std::ofstream(_config.cache_path, std::ios::binary | std::ios::trunc) << "not a cache";
+	{
+		w_directory_scanner _scanner;
+		W_REQUIRE(_scanner.initialize(_config) == W_PASSED);
+		W_CHECK(_scanner.get_cache_size() == 0);
+		std::vector<w_directory_entry> _entries;
+		W_REQUIRE(_scanner.scan(_root_path.c_str(), _entries) == W_PASSED);
+		W_CHECK(_scanner.get_listed_directories() == s_directories);
+		W_CHECK(_entries.size() == _files + 1);
+		_scanner.release();
+	}
+
+	std::error_code _error;
+	std::filesystem::remove_all(_dir, _error);
+}
@@ -0,0 +1,158 @@
+#include "pch.h"
+#include <w_fiber_scheduler.h>
+#include <w_thread_pool.h>
+#include <thread>
+
+using namespace wolf::system;
+
+//each job adds pChildren jobs and waits for them, down to pDepth
+static void s_spawn(
+	_In_ w_fiber_scheduler& pScheduler,
+	_In_ const int& pDepth,
+	_In_ const size_t& pChildren,
+	_Inout_ std::atomic<size_t>& pLeaves)
+{
+	if (pDepth == 0)
+	{
+		pLeaves++;
+		return;
+	}
+
+	w_fiber_counter _counter;
+	for (size_t i = 0; i < pChildren; ++i)
+	{
+		pScheduler.add_job([&pScheduler, &pLeaves, pDepth, pChildren]()
+			{
+				s_spawn(pScheduler, pDepth - 1, pChildren, pLeaves);
+			}, &_counter);
+	}
+	pScheduler.wait_for_counter(&_counter);
+}
+
+static void s_run_parents(_In_ const size_t& pFibers, _In_ const size_t& pParents, _In_ const size_t& pChildren)
+{
+	w_thread_pool _pool;
+	_pool.allocate(4);
+	w_fiber_scheduler _scheduler;
+	W_REQUIRE(_scheduler.initialize(_pool, 0, pFibers) == W_PASSED);
+
+	std::atomic<size_t> _children(0);
+	w_fiber_counter _parents;
+	for (size_t i = 0; i < pParents; ++i)
+	{
+		_scheduler.add_job([&]()
+			{
+				w_fiber_counter _counter;
+				for (size_t j = 0; j < pChildren; ++j)
+				{
+					_scheduler.add_job([&]()
+						{
+							std::this_thread::yield();
+							_children++;
+						}, &_counter);
+				}
+				_scheduler.wait_for_counter(&_counter);
+			}, &_parents);
+	}
+	_scheduler.wait_for_counter(&_parents);
+	W_CHECK(_children == pParents * pChildren);
+	W_CHECK(_scheduler.release() == 0);
+}
+
+W_TEST(fiber_scheduler_suspend_resume)
+{
+	//one worker, so other jobs can only run if waiting jobs give it back
+	w_thread_pool _pool;
+	_pool.allocate(1);
+	w_fiber_scheduler _scheduler;
+	W_REQUIRE(_scheduler.initialize(_pool, 0, 16) == W_PASSED);
+	W_CHECK(!w_fiber_scheduler::get_is_in_fiber());
+
+	w_fiber_counter _gate;
+	_gate.increment();
+	std::atomic<int> _suspended(0);
+	std::atomic<int> _resumed(0);
+	std::atomic<int> _others(0);
+	std::atomic<bool> _in_fiber(true);
+
+	w_fiber_counter _done;
+	for (int i = 0; i < 2; ++i)
+	{
+		_scheduler.add_job([&]()
+			{
+				if (!w_fiber_scheduler::get_is_in_fiber()) _in_fiber = false;
+				_suspended++;
+				_scheduler.wait_for_counter(&_gate);
+				_resumed++;
+			}, &_done);
+	}
+	for (int i = 0; i < 10; ++i)
+	{
+		_scheduler.add_job([&]()
+			{
+				_others++;
+			}, &_done);
+	}
+
+	//both waiting jobs are suspended and the worker finishes the rest
+	while (_others < 10 || _suspended < 2)
+	{
+		std::this_thread::yield();
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	W_CHECK(_resumed == 0);
+	W_CHECK(_done.get_value() == 2);
+
+	_gate.decrement();
+	_scheduler.wait_for_counter(&_done);
+	W_CHECK(_resumed == 2);
+	W_CHECK(_in_fiber);
+	W_CHECK(_scheduler.release() == 0);
+}
+
+W_TEST(fiber_scheduler_nested_waits)
+{
+	w_thread_pool _pool;
+	_pool.allocate(4);
+	w_fiber_scheduler _scheduler;
+	W_REQUIRE(_scheduler.initialize(_pool, 0, 16) == W_PASSED);
+
+	//121 jobs in a tree of depth 4 on 16 fibers
+	std::atomic<size_t> _leaves(0);
+	w_fiber_counter _root;
+	_scheduler.add_job([&]()
+		{
+			s_spawn(_scheduler, 4, 3, _leaves);
+		}, &_root);
+	_scheduler.wait_for_counter(&_root);
+	W_CHECK(_leaves == 81);
+
+	//waiting for a value above zero resumes before all jobs finish
+	w_fiber_counter _counter;
+	w_fiber_counter _gate;
+	_gate.increment();
+	std::atomic<bool> _passed(false);
+	_scheduler.add_job([&]()
+		{
+			_scheduler.wait_for_counter(&_gate);
+		}, &_counter);
+	_scheduler.add_job([&]() {}, &_counter);
+	_scheduler.add_job([&]()
+		{
+			_scheduler.wait_for_counter(&_counter, 1);
+			_passed = true;
+			_gate.decrement();
+		});
+	_scheduler.wait_for_counter(&_counter);
+	W_CHECK(_passed);
+	W_CHECK(_scheduler.release() == 0);
+}
+
+W_TEST(fiber_scheduler_exhaustion)
+{
+	//more parents wait than there are fibers, their children have to run anyway
+	s_run_parents(32, 31, 4);
+	s_run_parents(32, 40, 4);
+	s_run_parents(4, 10, 4);
+	s_run_parents(1, 8, 3);
+}
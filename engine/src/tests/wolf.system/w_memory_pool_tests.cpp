@@ -0,0 +1,144 @@
+#include "pch.h"
+#include <w_memory_pool.h>
+#include <cstring>
+#include <thread>
+
+using namespace wolf::system;
+
+namespace
+{
+	struct w_particle
+	{
+		float   position[3];
+		float   velocity[3];
+		int     id;
+
+		w_particle(_In_ const int& pId) : id(pId) {}
+	};
+}
+
+W_TEST(memory_pool_cross_thread_free)
+{
+	w_fixed_memory_pool _pool;
+	W_REQUIRE(_pool.initialize(sizeof(w_particle), 16, 1024) == W_PASSED);
+
+	//blocks which are allocated on one thread are freed on another
+	const int _count = 100000;
+	std::vector<w_particle*> _particles(_count, nullptr);
+	std::thread _producer([&]()
+		{
+			for (int i = 0; i < _count; ++i)
+			{
+				_particles[i] = _pool.create<w_particle>(i);
+			}
+		});
+	_producer.join();
+
+	for (int i = 0; i < _count; ++i)
+	{
+		W_REQUIRE(_particles[i]);
+		W_CHECK(reinterpret_cast<uintptr_t>(_particles[i]) % 16 == 0);
+		W_CHECK(_particles[i]->id == i);
+	}
+	W_CHECK(_pool.get_statistics().used_blocks == _count);
+
+	std::thread _consumer([&]()
+		{
+			for (auto _particle : _particles)
+			{
+				_pool.destroy(_particle);
+			}
+		});
+	_consumer.join();
+
+	//caches of exited threads were returned to the shared list
+	const auto _statistics = _pool.get_statistics();
+	W_CHECK(_statistics.used_blocks == 0);
+	W_CHECK(_statistics.cached_free_blocks == 0);
+	W_CHECK(_statistics.shared_free_blocks == _statistics.slabs * _statistics.blocks_per_slab);
+	_pool.release();
+}
+
+W_TEST(memory_pool_concurrent_churn)
+{
+	w_fixed_memory_pool _pool;
+	W_REQUIRE(_pool.initialize(32, 16, 256) == W_PASSED);
+	const auto _block_size = _pool.get_block_size();
+
+	//each thread stamps its blocks, a block which is handed out twice gets the stamp of another thread
+	std::vector<std::thread> _threads;
+	for (int t = 0; t < 4; ++t)
+	{
+		_threads.emplace_back([&, t]()
+			{
+				std::vector<unsigned char*> _blocks;
+				for (int r = 0; r < 100000; ++r)
+				{
+					if (_blocks.size() < 500 && (r % 3))
+					{
+						auto _block = static_cast<unsigned char*>(_pool.allocate());
+						if (!W_CHECK(_block)) return;
+						std::memset(_block, t, _block_size);
+						_blocks.push_back(_block);
+					}
+					else if (!_blocks.empty())
+					{
+						auto _block = _blocks.back();
+						_blocks.pop_back();
+						for (size_t i = 0; i < _block_size; ++i)
+						{
+							if (_block[i] != t)
+							{
+								W_CHECK(_block[i] == t);
+								break;
+							}
+						}
+						_pool.free(_block);
+					}
+				}
+				for (auto _block : _blocks)
+				{
+					_pool.free(_block);
+				}
+			});
+	}
+	for (auto& _thread : _threads)
+	{
+		_thread.join();
+	}
+
+	W_CHECK(_pool.get_statistics().used_blocks == 0);
+	size_t _used = 0;
+	for (auto& _slab : _pool.get_slab_statistics())
+	{
+		_used += _slab.used_blocks;
+	}
+	W_CHECK(_used == 0);
+	_pool.release();
+}
+
+W_TEST(memory_pool_release_and_reuse)
+{
+	w_fixed_memory_pool _pool;
+	W_CHECK(_pool.allocate() == nullptr);
+	W_CHECK(_pool.initialize(0) == W_INVALIDARG);
+	W_CHECK(_pool.initialize(32, 24) == W_INVALIDARG);
+	W_REQUIRE(_pool.initialize(64) == W_PASSED);
+
+	auto _block = _pool.allocate();
+	W_CHECK(_block);
+	_pool.free(_block);
+	_pool.release();
+	W_CHECK(_pool.allocate() == nullptr);
+
+	//pools which come and go on one thread do not find caches of released pools
+	for (int i = 0; i < 10000; ++i)
+	{
+		w_fixed_memory_pool _temporary;
+		W_REQUIRE(_temporary.initialize(32) == W_PASSED);
+		auto _temporary_block = _temporary.allocate();
+		W_REQUIRE(_temporary_block);
+		_temporary.free(_temporary_block);
+		W_CHECK(_temporary.get_statistics().used_blocks == 0);
+	}
+}
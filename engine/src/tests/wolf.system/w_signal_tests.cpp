@@ -0,0 +1,128 @@
+#include "pch.h"
+#include <w_signal.h>
+#include <thread>
+
+using namespace wolf::system;
+
+namespace
+{
+	//counts live copies of a capture
+	struct w_counted
+	{
+		static std::atomic<int>     alive;
+		char                        pad[100];
+
+		w_counted() { alive++; }
+		w_counted(const w_counted&) { alive++; }
+		w_counted(w_counted&&) { alive++; }
+		~w_counted() { alive--; }
+	};
+	std::atomic<int> w_counted::alive(0);
+}
+
+W_TEST(inplace_function_large_capture)
+{
+	{
+		//capture does not fit in 48 bytes, so it lives on the heap
+		w_counted _counted;
+		double _big[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+		w_inplace_function<double()> _func([_counted, _big]()
+			{
+				return _big[9] + sizeof(_counted.pad);
+			});
+		W_CHECK(!_func.get_is_inline());
+		W_CHECK(_func() == 110);
+
+		auto _copy = _func;
+		W_CHECK(!_copy.get_is_inline());
+		W_CHECK(_copy() == 110);
+
+		auto _moved = std::move(_func);
+		W_CHECK(_moved() == 110);
+		W_CHECK(!_func);
+
+		_copy = _moved;
+		W_CHECK(_copy() == 110);
+
+		//small captures stay inline
+		int _value = 5;
+		w_inplace_function<int()> _small([_value]() { return _value; });
+		W_CHECK(_small.get_is_inline());
+		auto _small_moved = std::move(_small);
+		W_CHECK(_small_moved() == 5);
+	}
+	//copies, moves and destruction of both storages are balanced
+	W_CHECK(w_counted::alive.load() == 0);
+}
+
+W_TEST(signal_rise_while_connecting)
+{
+	w_signal<void(int)> _signal;
+	std::atomic<int64_t> _fixed_calls(0);
+	std::atomic<int64_t> _temporary_calls(0);
+	_signal += [&](int pValue) { _fixed_calls += pValue; };
+
+	const int _rises = 20000;
+	std::vector<std::thread> _threads;
+	for (int t = 0; t < 3; ++t)
+	{
+		_threads.emplace_back([&]()
+			{
+				for (int i = 0; i < _rises; ++i)
+				{
+					_signal(1);
+				}
+			});
+	}
+
+	//slots are added and removed while other threads rise the signal
+	for (int i = 0; i < 2000; ++i)
+	{
+		auto _connection = _signal.connect([&](int) { _temporary_calls++; });
+		W_CHECK(_signal.disconnect(_connection));
+	}
+	for (auto& _thread : _threads)
+	{
+		_thread.join();
+	}
+
+	W_CHECK(_fixed_calls.load() == 3 * _rises);
+	W_CHECK(_signal.get_slots_count() == 1);
+	W_CHECK(!_signal.disconnect(12345));
+}
+
+W_TEST(signal_queued_dispatch)
+{
+	w_signal_mailbox _mailbox;
+	std::vector<int> _received;
+
+	w_signal<int(int)> _signal;
+	auto _connection = _signal.connect_queued(_mailbox, [&](int pValue)
+		{
+			_received.push_back(pValue);
+			return pValue;
+		});
+
+	//emissions of another thread are kept in order until the owner dispatches them
+	std::thread _emitter([&]()
+		{
+			for (int i = 0; i < 1000; ++i)
+			{
+				_signal(i);
+			}
+		});
+	_emitter.join();
+
+	W_CHECK(_received.empty());
+	W_CHECK(_mailbox.get_pending_count() == 1000);
+	W_CHECK(_mailbox.dispatch() == 1000);
+	W_REQUIRE(_received.size() == 1000);
+	for (int i = 0; i < 1000; ++i)
+	{
+		W_CHECK(_received[i] == i);
+	}
+
+	W_CHECK(_signal.disconnect(_connection));
+	_signal(1);
+	W_CHECK(_mailbox.dispatch() == 0);
+}
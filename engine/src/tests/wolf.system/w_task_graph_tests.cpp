@@ -0,0 +1,129 @@
+#include "pch.h"
+#include <w_task_graph.h>
+#include <w_thread_pool.h>
+#include <random>
+#include <thread>
+
+using namespace wolf::system;
+
+static void s_check_order(_In_ const w_thread_pool_mode& pMode)
+{
+	w_thread_pool _pool;
+	_pool.allocate(4, pMode);
+
+	//edges only go from lower to higher indices, so the graph has no cycle
+	const size_t _nodes_count = 200;
+	std::mt19937 _random(7);
+	std::vector<std::vector<size_t>> _dependencies(_nodes_count);
+
+	std::atomic<uint64_t> _clock(0);
+	std::vector<std::atomic<uint64_t>> _started(_nodes_count);
+	std::vector<std::atomic<uint64_t>> _finished(_nodes_count);
+
+	w_task_graph _graph;
+	for (size_t i = 0; i < _nodes_count; ++i)
+	{
+		W_CHECK(_graph.add_node("node_" + std::to_string(i), [&, i]()
+			{
+				_started[i] = ++_clock;
+				std::this_thread::yield();
+				_finished[i] = ++_clock;
+			}) == i);
+	}
+	for (size_t i = 1; i < _nodes_count; ++i)
+	{
+		const auto _count = _random() % 4;
+		for (size_t j = 0; j < _count; ++j)
+		{
+			const auto _depends_on = _random() % i;
+			W_CHECK(_graph.add_dependency(i, _depends_on) == W_PASSED);
+			_dependencies[i].push_back(_depends_on);
+		}
+	}
+	W_REQUIRE(_graph.compile() == W_PASSED);
+	W_CHECK(_graph.get_nodes_count() == _nodes_count);
+
+	for (int _frame = 0; _frame < 20; ++_frame)
+	{
+		for (size_t i = 0; i < _nodes_count; ++i)
+		{
+			_started[i] = 0;
+			_finished[i] = 0;
+		}
+		W_REQUIRE(_graph.execute(_pool) == W_PASSED);
+
+		//all nodes ran once and each one started after all of its dependencies finished
+		for (size_t i = 0; i < _nodes_count; ++i)
+		{
+			W_REQUIRE(_finished[i] != 0);
+			for (auto _depends_on : _dependencies[i])
+			{
+				W_REQUIRE(_started[i] > _finished[_depends_on]);
+			}
+		}
+	}
+	_pool.release();
+}
+
+W_TEST(task_graph_dependency_order_work_stealing)
+{
+	s_check_order(w_thread_pool_mode::W_WORK_STEALING);
+}
+
+W_TEST(task_graph_dependency_order_pinned)
+{
+	s_check_order(w_thread_pool_mode::W_PINNED);
+}
+
+W_TEST(task_graph_rejects_cycles)
+{
+	w_task_graph _graph;
+	const auto _a = _graph.add_node("a", []() {});
+	const auto _b = _graph.add_node("b", []() {});
+	const auto _c = _graph.add_node("c", []() {});
+
+	W_CHECK(_graph.add_dependency(_a, _a) == W_INVALIDARG);
+	W_CHECK(_graph.add_dependency(_a, 3) == W_INVALIDARG);
+	W_CHECK(_graph.add_dependency(_b, _a) == W_PASSED);
+	W_CHECK(_graph.add_dependency(_c, _b) == W_PASSED);
+	W_CHECK(_graph.compile() == W_PASSED);
+
+	W_CHECK(_graph.add_dependency(_a, _c) == W_PASSED);
+	W_CHECK(_graph.compile() == W_FAILED);
+
+	w_thread_pool _pool;
+	_pool.allocate(2, w_thread_pool_mode::W_WORK_STEALING);
+	W_CHECK(_graph.execute(_pool) == W_FAILED);
+	_pool.release();
+}
+
+W_TEST(task_graph_critical_path)
+{
+	w_thread_pool _pool;
+	_pool.allocate(4, w_thread_pool_mode::W_WORK_STEALING);
+
+	auto _sleep = [](_In_ const int& pMilliSeconds)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(pMilliSeconds));
+	};
+
+	w_task_graph _graph;
+	const auto _cull = _graph.add_node("cull", [&]() { _sleep(5); });
+	const auto _long = _graph.add_node("long", [&]() { _sleep(40); });
+	const auto _short = _graph.add_node("short", [&]() { _sleep(1); });
+	const auto _submit = _graph.add_node("submit", [&]() { _sleep(1); });
+	_graph.add_dependency(_long, _cull);
+	_graph.add_dependency(_short, _cull);
+	_graph.add_dependency(_submit, _long);
+	_graph.add_dependency(_submit, _short);
+
+	W_REQUIRE(_graph.execute(_pool) == W_PASSED);
+
+	const auto& _path = _graph.get_critical_path();
+	W_REQUIRE(_path.size() == 3);
+	W_CHECK(_path[0] == _cull && _path[1] == _long && _path[2] == _submit);
+	W_CHECK(_graph.get_node_duration(_long) >= 0.04);
+	W_CHECK(_graph.get_critical_path_length() >= 0.046);
+	W_CHECK(_graph.get_last_execution_time() >= _graph.get_critical_path_length());
+	_pool.release();
+}
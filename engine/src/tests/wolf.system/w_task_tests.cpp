@@ -0,0 +1,208 @@
+#include "pch.h"
+#include <w_task.h>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace wolf::system;
+
+//a task which runs until pGate is set
+static w_task_handle s_gated_task(_In_ std::atomic<bool>& pStarted, _In_ std::atomic<bool>& pGate)
+{
+	return w_task::execute_async([&pStarted, &pGate]()
+		{
+			pStarted = true;
+			while (!pGate)
+			{
+				std::this_thread::yield();
+			}
+			return W_PASSED;
+		});
+}
+
+W_TEST(task_continuation_order)
+{
+	std::mutex _mutex;
+	std::vector<int> _order;
+	const auto _record = [&](int pStep)
+	{
+		std::lock_guard<std::mutex> _lock(_mutex);
+		_order.push_back(pStep);
+	};
+
+	//each continuation runs after its parent and gets the result of it
+	std::atomic<bool> _started(false);
+	std::atomic<bool> _gate(false);
+	auto _task = s_gated_task(_started, _gate);
+	auto _first = _task.then([&](W_RESULT pResult)
+		{
+			_record(1);
+			return pResult == W_PASSED ? W_INVALIDARG : W_PASSED;
+		});
+	auto _second = _first.then([&](W_RESULT pResult)
+		{
+			_record(2);
+			return pResult == W_INVALIDARG ? W_PASSED : W_FAILED;
+		});
+	auto _sibling = _task.then([&](W_RESULT pResult)
+		{
+			_record(3);
+			return pResult;
+		});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	W_CHECK(_first.get_status() == w_task_status::W_TASK_PENDING);
+	W_CHECK(_first.wait_for(0) == std::future_status::timeout);
+	_gate = true;
+
+	W_CHECK(_second.get() == W_PASSED);
+	W_CHECK(_first.get() == W_INVALIDARG);
+	W_CHECK(_sibling.get() == W_PASSED);
+	W_CHECK(_task.get_status() == w_task_status::W_TASK_COMPLETED);
+	{
+		std::lock_guard<std::mutex> _lock(_mutex);
+		W_REQUIRE(_order.size() == 3);
+		//1 runs before 2, the sibling may run anywhere after the parent
+		const auto _one = std::find(_order.begin(), _order.end(), 1);
+		const auto _two = std::find(_order.begin(), _order.end(), 2);
+		W_CHECK(_one < _two);
+	}
+
+	//continuations of a completed task are scheduled at once
+	auto _late = _task.then([](W_RESULT pResult)
+		{
+			return pResult == W_PASSED ? W_PASSED : W_FAILED;
+		});
+	W_CHECK(_late.get() == W_PASSED);
+
+	//results and callbacks of async and deferred tasks
+	std::atomic<int> _call_back(0);
+	auto _async = w_task::execute_async([]() { return W_INVALIDARG; }, [&](W_RESULT pResult)
+		{
+			_call_back = pResult == W_INVALIDARG ? 1 : -1;
+		});
+	W_CHECK(_async.get() == W_INVALIDARG);
+	W_CHECK(_call_back == 1);
+
+	std::atomic<bool> _ran(false);
+	auto _deferred = w_task::execute_deferred([&]()
+		{
+			_ran = true;
+			return W_PASSED;
+		});
+	W_CHECK(_deferred.wait_for(0) == std::future_status::deferred);
+	W_CHECK(!_ran);
+	W_CHECK(_deferred.get() == W_PASSED);
+	W_CHECK(_ran);
+}
+
+W_TEST(task_cancel)
+{
+	//before start, the work and continuations never run
+	std::atomic<bool> _ran(false);
+	auto _deferred = w_task::execute_deferred([&]()
+		{
+			_ran = true;
+			return W_PASSED;
+		});
+	auto _continuation = _deferred.then([&](W_RESULT)
+		{
+			_ran = true;
+			return W_PASSED;
+		});
+	W_CHECK(_deferred.cancel());
+	W_CHECK(_deferred.get_status() == w_task_status::W_TASK_CANCELLED);
+	W_CHECK(_deferred.get() == W_FAILED);
+	W_CHECK(_continuation.get() == W_FAILED);
+	W_CHECK(_continuation.get_status() == w_task_status::W_TASK_CANCELLED);
+	W_CHECK(!_ran);
+	W_CHECK(!_deferred.cancel());
+
+	//a continuation can be cancelled while its parent runs, the parent is not affected
+	std::atomic<bool> _started(false);
+	std::atomic<bool> _gate(false);
+	auto _task = s_gated_task(_started, _gate);
+	auto _cancelled = _task.then([&](W_RESULT)
+		{
+			_ran = true;
+			return W_PASSED;
+		});
+	auto _kept = _task.then([](W_RESULT pResult)
+		{
+			return pResult;
+		});
+	while (!_started)
+	{
+		std::this_thread::yield();
+	}
+
+	//after start, cancel fails and the task completes
+	W_CHECK(!_task.cancel());
+	W_CHECK(_task.get_status() == w_task_status::W_TASK_RUNNING);
+	W_CHECK(_cancelled.cancel());
+	_gate = true;
+
+	W_CHECK(_task.get() == W_PASSED);
+	W_CHECK(_task.get_status() == w_task_status::W_TASK_COMPLETED);
+	W_CHECK(_kept.get() == W_PASSED);
+	W_CHECK(_cancelled.get() == W_FAILED);
+	W_CHECK(!_ran);
+
+	//continuations of a cancelled task are cancelled when they are added
+	auto _after = _deferred.then([&](W_RESULT)
+		{
+			_ran = true;
+			return W_PASSED;
+		});
+	W_CHECK(_after.get_status() == w_task_status::W_TASK_CANCELLED);
+	W_CHECK(!_ran);
+
+	//an invalid handle
+	w_task_handle _invalid;
+	W_CHECK(!_invalid.get_is_valid());
+	W_CHECK(!_invalid.cancel());
+	W_CHECK(_invalid.get() == W_FAILED);
+	W_CHECK(!_invalid.then([](W_RESULT pResult) { return pResult; }).get_is_valid());
+}
+
+W_TEST(task_exception)
+{
+	//a task which throws completes with W_FAILED and its continuations still run
+	std::atomic<int> _call_back(0);
+	auto _task = w_task::execute_async([]() -> W_RESULT
+		{
+			throw std::runtime_error("task failed");
+		}, [&](W_RESULT pResult)
+		{
+			_call_back = pResult == W_FAILED ? 1 : -1;
+		});
+	auto _continuation = _task.then([](W_RESULT pResult)
+		{
+			return pResult == W_FAILED ? W_PASSED : W_FAILED;
+		});
+	W_CHECK(_task.get() == W_FAILED);
+	W_CHECK(_task.get_status() == w_task_status::W_TASK_COMPLETED);
+	W_CHECK(_call_back == 1);
+	W_CHECK(_continuation.get() == W_PASSED);
+
+	//a continuation which throws fails its own handle only
+	auto _throwing = _continuation.then([](W_RESULT) -> W_RESULT
+		{
+			throw 7;
+		});
+	auto _next = _throwing.then([](W_RESULT pResult)
+		{
+			return pResult == W_FAILED ? W_PASSED : W_FAILED;
+		});
+	W_CHECK(_throwing.get() == W_FAILED);
+	W_CHECK(_next.get() == W_PASSED);
+
+	//deferred tasks run on the waiting thread, the exception does not leave wait
+	auto _deferred = w_task::execute_deferred([]() -> W_RESULT
+		{
+			throw std::logic_error("deferred task failed");
+		});
+	W_CHECK(_deferred.get() == W_FAILED);
+	W_CHECK(_deferred.get_status() == w_task_status::W_TASK_COMPLETED);
+}
@@ -0,0 +1,67 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_test.h
+	Description		 : Minimal registry and checks for behavior tests of wolf.system
+	Comment          : A test is declared with W_TEST(name), main runs all of them or the one whose name is passed
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+namespace wolf::system::test
+{
+	typedef void(*w_test_func)();
+
+	struct w_test_case
+	{
+		const char*     name;
+		w_test_func     func;
+	};
+
+	inline std::vector<w_test_case>& get_tests()
+	{
+		static std::vector<w_test_case> s_tests;
+		return s_tests;
+	}
+
+	//failed checks of all tests, checks may run on worker threads
+	inline std::atomic<size_t>& get_failures()
+	{
+		static std::atomic<size_t> s_failures(0);
+		return s_failures;
+	}
+
+	inline bool check(_In_ const bool& pCondition, _In_z_ const char* pExpression, _In_z_ const char* pFile, _In_ const int& pLine)
+	{
+		if (pCondition) return true;
+
+		std::printf("%s(%d): check failed: %s\n", pFile, pLine, pExpression);
+		std::fflush(stdout);
+		get_failures()++;
+		return false;
+	}
+
+	struct w_test_registrar
+	{
+		w_test_registrar(_In_z_ const char* pName, _In_ w_test_func pFunc)
+		{
+			get_tests().push_back({ pName, pFunc });
+		}
+	};
+}
+
+#define W_TEST(NAME)																			\
+	static void NAME();																			\
+	static wolf::system::test::w_test_registrar s_register_##NAME(#NAME, &NAME);				\
+	static void NAME()
+
+//record a failure and continue
+#define W_CHECK(CONDITION) wolf::system::test::check(static_cast<bool>(CONDITION), #CONDITION, __FILE__, __LINE__)
+
+//record a failure and leave the test
+#define W_REQUIRE(CONDITION) if (!W_CHECK(CONDITION)) return
@@ -0,0 +1,155 @@
+#include "pch.h"
+#include <w_thread_pool.h>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace wolf::system;
+
+//each job adds pChildren jobs from its worker, down to pDepth
+static void s_fan_out(
+	_In_ w_thread_pool& pPool,
+	_In_ const int& pDepth,
+	_In_ const size_t& pChildren,
+	_Inout_ std::atomic<size_t>& pCount)
+{
+	pCount++;
+	if (pDepth == 0) return;
+
+	for (size_t i = 0; i < pChildren; ++i)
+	{
+		pPool.add_job([&pPool, &pCount, pDepth, pChildren]()
+			{
+				s_fan_out(pPool, pDepth - 1, pChildren, pCount);
+			});
+	}
+}
+
+W_TEST(thread_pool_work_stealing)
+{
+	w_thread_pool _pool;
+	_pool.allocate(4, w_thread_pool_mode::W_WORK_STEALING);
+	W_REQUIRE(_pool.get_pool_size() == 4);
+	W_CHECK(_pool.get_mode() == w_thread_pool_mode::W_WORK_STEALING);
+	W_CHECK(_pool.get_current_worker_index() == -1);
+
+	//all jobs go to the deque of the first worker, the others can only get them by stealing
+	const size_t _jobs_count = 64;
+	std::mutex _mutex;
+	std::vector<int> _workers;
+	std::vector<std::function<void()>> _jobs;
+	for (size_t i = 0; i < _jobs_count; ++i)
+	{
+		_jobs.push_back([&]()
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				std::lock_guard<std::mutex> _lock(_mutex);
+				_workers.push_back(_pool.get_current_worker_index());
+			});
+	}
+	_pool.add_jobs_for_thread(0, _jobs);
+	_pool.wait_all();
+
+	//-1 is the thread which waits and helps
+	W_REQUIRE(_workers.size() == _jobs_count);
+	std::set<int> _distinct(_workers.begin(), _workers.end());
+	for (auto _index : _distinct)
+	{
+		W_CHECK(_index >= -1 && _index < 4);
+	}
+	W_CHECK(_distinct.count(1) + _distinct.count(2) + _distinct.count(3) > 0);
+	_pool.release();
+}
+
+W_TEST(thread_pool_wait_all_helps)
+{
+	//the only worker is blocked until a job which the waiting thread has to run itself
+	w_thread_pool _pool;
+	_pool.allocate(1, w_thread_pool_mode::W_WORK_STEALING);
+
+	std::atomic<bool> _started(false);
+	std::atomic<bool> _unblock(false);
+	_pool.add_job([&]()
+		{
+			_started = true;
+			while (!_unblock)
+			{
+				std::this_thread::yield();
+			}
+		});
+	while (!_started)
+	{
+		std::this_thread::yield();
+	}
+
+	const auto _caller = std::this_thread::get_id();
+	std::atomic<size_t> _on_caller(0);
+	const size_t _jobs_count = 10;
+	for (size_t i = 0; i < _jobs_count; ++i)
+	{
+		_pool.add_job([&, i]()
+			{
+				if (std::this_thread::get_id() == _caller) _on_caller++;
+				if (i == _jobs_count - 1) _unblock = true;
+			});
+	}
+
+	_pool.wait_all();
+	W_CHECK(_on_caller == _jobs_count);
+	W_CHECK(_unblock);
+
+	//nothing is left to run
+	W_CHECK(!_pool.execute_one_job());
+	_pool.release();
+}
+
+W_TEST(thread_pool_submit_from_workers)
+{
+	const w_thread_pool_mode _modes[] = { w_thread_pool_mode::W_WORK_STEALING, w_thread_pool_mode::W_PINNED };
+	for (auto _mode : _modes)
+	{
+		w_thread_pool _pool;
+		_pool.allocate(4, _mode);
+
+		//1 + 4 + 16 + 64 + 256 + 1024 jobs, all but the first are added by workers
+		std::atomic<size_t> _count(0);
+		_pool.add_job([&]()
+			{
+				s_fan_out(_pool, 5, 4, _count);
+			});
+		if (_mode == w_thread_pool_mode::W_PINNED)
+		{
+			//pinned workers add jobs to each other, so wait until no more jobs are added
+			while (_count < 1365)
+			{
+				std::this_thread::yield();
+			}
+		}
+		_pool.wait_all();
+		W_CHECK(_count == 1365);
+		_pool.release();
+	}
+
+	//a job which waits for a submitted job runs other jobs meanwhile instead of blocking its worker
+	w_thread_pool _pool;
+	_pool.allocate(2, w_thread_pool_mode::W_WORK_STEALING);
+	std::vector<std::future<int>> _futures;
+	for (int i = 0; i < 8; ++i)
+	{
+		_futures.push_back(_pool.submit([&_pool, i]()
+			{
+				auto _inner = _pool.submit([i]()
+					{
+						return i * i;
+					});
+				_pool.wait(_inner);
+				return _inner.get() + 1;
+			}));
+	}
+	for (int i = 0; i < 8; ++i)
+	{
+		_pool.wait(_futures[i]);
+		W_CHECK(_futures[i].get() == i * i + 1);
+	}
+	_pool.release();
+}
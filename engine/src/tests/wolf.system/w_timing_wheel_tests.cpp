@@ -0,0 +1,156 @@
+#include "pch.h"
+#include <w_timing_wheel.h>
+#include <w_thread_pool.h>
+#include <random>
+
+using namespace wolf::system;
+
+W_TEST(timing_wheel_cascade)
+{
+	w_timing_wheel _wheel;
+	W_REQUIRE(_wheel.initialize(1) == W_PASSED);
+
+	//delays around the boundaries of each level, the last one starts on the coarsest level
+	const uint64_t _delays[] =
+	{
+		1, 2, 255, 256, 257, 511, 512, 513,
+		65535, 65536, 65537, 65536 + 256, (1ull << 24) + 5
+	};
+	const size_t _count = sizeof(_delays) / sizeof(_delays[0]);
+	std::vector<uint64_t> _fired(_count, 0);
+	for (size_t i = 0; i < _count; ++i)
+	{
+		W_CHECK(_wheel.schedule(_delays[i], [&, i]()
+			{
+				_fired[i] = _wheel.get_current_tick();
+			}) != 0);
+	}
+	W_CHECK(_wheel.get_active_timers_count() == _count);
+
+	//one tick at a time, so callbacks see the tick they expired on
+	while (_wheel.get_current_tick() < 70000)
+	{
+		_wheel.advance(1);
+	}
+	for (size_t i = 0; i + 1 < _count; ++i)
+	{
+		W_CHECK(_fired[i] == _delays[i]);
+	}
+	W_CHECK(_fired[_count - 1] == 0);
+
+	//jump close to the last timer, then step over it
+	_wheel.advance((1ull << 24) - _wheel.get_current_tick());
+	W_CHECK(_fired[_count - 1] == 0);
+	while (_wheel.get_current_tick() < (1ull << 24) + 10)
+	{
+		_wheel.advance(1);
+	}
+	W_CHECK(_fired[_count - 1] == _delays[_count - 1]);
+	W_CHECK(_wheel.get_active_timers_count() == 0);
+	_wheel.release();
+}
+
+W_TEST(timing_wheel_firing_order)
+{
+	w_timing_wheel _wheel;
+	W_REQUIRE(_wheel.initialize(1) == W_PASSED);
+
+	std::mt19937_64 _random(3);
+	const size_t _count = 5000;
+	std::vector<uint64_t> _delays(_count);
+	std::vector<size_t> _order;
+	_order.reserve(_count);
+	std::vector<w_timer_handle> _handles(_count);
+	for (size_t i = 0; i < _count; ++i)
+	{
+		_delays[i] = 1 + _random() % (1ull << 20);
+		_handles[i] = _wheel.schedule(_delays[i], [&, i]()
+			{
+				_order.push_back(i);
+			});
+	}
+
+	//cancelled timers never fire and can not be cancelled twice
+	size_t _cancelled = 0;
+	for (size_t i = 0; i < _count; i += 10)
+	{
+		W_CHECK(_wheel.cancel(_handles[i]));
+		W_CHECK(!_wheel.cancel(_handles[i]));
+		_cancelled++;
+	}
+
+	//a single advance collects callbacks tick by tick, so they run in order of expiry
+	W_CHECK(_wheel.advance(1ull << 21) == _count - _cancelled);
+	W_REQUIRE(_order.size() == _count - _cancelled);
+	for (size_t i = 0; i < _order.size(); ++i)
+	{
+		W_CHECK(_order[i] % 10 != 0);
+		if (i)
+		{
+			W_CHECK(_delays[_order[i - 1]] <= _delays[_order[i]]);
+		}
+	}
+	W_CHECK(!_wheel.cancel(_handles[1]));
+	_wheel.release();
+}
+
+W_TEST(timing_wheel_coarse_and_repeating)
+{
+	w_timing_wheel _wheel;
+	W_REQUIRE(_wheel.initialize(1) == W_PASSED);
+
+	//coarse timers are never early
+	std::vector<uint64_t> _fired(3, 0);
+	const uint64_t _delays[] = { 100, 1000, 100000 };
+	for (size_t i = 0; i < 3; ++i)
+	{
+		_wheel.schedule(_delays[i], [&, i]()
+			{
+				_fired[i] = _wheel.get_current_tick();
+			}, 0, w_timer_precision::W_TIMER_COARSE);
+	}
+
+	int _repeats = 0;
+	const auto _repeating = _wheel.schedule(10, [&]() { _repeats++; }, 300);
+	_wheel.advance(10);
+	W_CHECK(_repeats == 1);
+	for (int i = 0; i < 5; ++i)
+	{
+		_wheel.advance(300);
+	}
+	W_CHECK(_repeats == 6);
+	W_CHECK(_wheel.cancel(_repeating));
+	_wheel.advance(1000);
+	W_CHECK(_repeats == 6);
+
+	while (_wheel.get_current_tick() < 200000)
+	{
+		_wheel.advance(1);
+	}
+	for (size_t i = 0; i < 3; ++i)
+	{
+		W_CHECK(_fired[i] >= _delays[i]);
+	}
+	_wheel.release();
+}
+
+W_TEST(timing_wheel_thread_pool_dispatch)
+{
+	w_thread_pool _pool;
+	_pool.allocate(2, w_thread_pool_mode::W_WORK_STEALING);
+
+	w_timing_wheel _wheel;
+	W_REQUIRE(_wheel.initialize(1, &_pool) == W_PASSED);
+
+	std::atomic<int> _fired(0);
+	for (int i = 0; i < 1000; ++i)
+	{
+		_wheel.schedule(5 + i % 20, [&]() { _fired++; });
+	}
+	W_CHECK(_wheel.advance(30) == 1000);
+	_pool.wait_all();
+	W_CHECK(_fired.load() == 1000);
+
+	_wheel.release();
+	_pool.release();
+}
@@ -8,6 +8,7 @@
 #include <assimp/cimport.h>
 
 #include <amd/amd_tootle.h>
+#include <w_parallel.h>
 
 #ifdef __WIN32
 
@@ -20,6 +21,13 @@ static std::mutex        simplygon_mutex;
 
 #endif
 
+#ifdef W_CPIPELINE_HAS_PMR
+//when no memory resource is given, big vertex and index arrays come from w_large_allocator
+static wolf::system::w_large_memory_resource s_large_memory_resource;
+//and meshes are recorded with the mesh tag when memory tracking is enabled
+static wolf::system::w_tracked_memory_resource s_mesh_memory_resource(wolf::system::MEMORY_TAG_MESH, &s_large_memory_resource);
+#endif
+
 using namespace assimp;
 using namespace wolf;
 using namespace wolf::system;
@@ -48,6 +56,18 @@ static void _iterate_node(
 
 			_models.clear();
 			_scene->get_models_by_id(_mesh_index, _models);
+			if (_models.empty())
+			{
+				//meshes are moved into their first model, so LODs which are not in scene yet get instances too
+				for (auto _lod : pLODs)
+				{
+					if (_lod->get_id() == static_cast<int>(_mesh_index))
+					{
+						_models.push_back(_lod);
+						break;
+					}
+				}
+			}
 			if (_models.size())
 			{
 				//if we already created a model, so add an instnace for it
@@ -73,7 +93,12 @@ static void _iterate_node(
 				//could not find in models, we need to create a model
 				std::vector<w_cpipeline_mesh*> _meshes = { pModelMeshes[_mesh_index] };
 
+#ifdef W_CPIPELINE_HAS_PMR
+				auto _memory_resource = _scene->get_memory_resource();
+				auto _model = _memory_resource ? new w_cpipeline_model(_meshes, _memory_resource) : new w_cpipeline_model(_meshes);
+#else
 				auto _model = new w_cpipeline_model(_meshes);
+#endif
 				_model->set_name(_name);
 				_model->set_id(_mesh_index);
 				_model->set_transform(_transform);
@@ -85,7 +110,9 @@ static void _iterate_node(
 				}
 				else
 				{
-					_scene->add_model(_model);
+					//move, so meshes stay in the memory resource of scene
+					_scene->add_model(std::move(*_model));
+					delete _model;
 				}
 			}
 		}
@@ -254,6 +281,9 @@ w_cpipeline_scene* w_assimp::load(_In_z_ const std::wstring& pAssetPath,
 #ifdef __WIN32
                                   ,_In_ const bool& pGenerateLODUsingSimplygon
 #endif
+#ifdef W_CPIPELINE_HAS_PMR
+                                  ,_In_opt_ std::pmr::memory_resource* pMemoryResource
+#endif
 )
 {
 	Assimp::Importer _assimp_importer;
@@ -290,7 +320,16 @@ w_cpipeline_scene* w_assimp::load(_In_z_ const std::wstring& pAssetPath,
 		auto _root_name = std::string(_scene->mRootNode->mName.C_Str());
 
 		//create wolf scene
+#ifdef W_CPIPELINE_HAS_PMR
+        if (!pMemoryResource)
+        {
+            pMemoryResource = wolf::system::w_memory_tracker::get_is_enabled() ?
+                static_cast<std::pmr::memory_resource*>(&s_mesh_memory_resource) : &s_large_memory_resource;
+        }
+        auto _w_scene = new w_cpipeline_scene(pMemoryResource);
+#else
         auto _w_scene = new w_cpipeline_scene();
+#endif
         _w_scene->set_name(_scene_name);
 		_w_scene->set_root_name(_root_name);
 
@@ -360,64 +399,71 @@ w_cpipeline_scene* w_assimp::load(_In_z_ const std::wstring& pAssetPath,
 					glm::vec3 _max_vertex;
 
 					//copy assimp mesh information to wolf mesh information
+#ifdef W_CPIPELINE_HAS_PMR
+					//vertices and indices are built in the memory resource of scene, models take them over without a copy
+					auto _w_mesh = new w_cpipeline_mesh(_w_scene->get_memory_resource());
+#else
 					auto _w_mesh = new w_cpipeline_mesh();
-					for (size_t j = 0; j < _a_mesh->mNumVertices; ++j)
-					{
-						//create wolf vertex structure
-						w_vertex_struct _w_vertex;
-
-						//TODO: we need to support skinned model in next version
-
-						//modify vertices for right handed coordinate system
-						//if (_coordinate_system == w_coordinate_system::RIGHT_HANDED)
-						//{
-						//	if (_coordinate_system_up_vector.z == 1)
-						//	{
-						//		std::swap(_a_mesh->mVertices[j].z, _a_mesh->mVertices[j].y);
-						//		_a_mesh->mVertices[j].y *= -1;
-						//	}
-						//}
+#endif
 
-						//does not have any vertex
-						if (!_a_mesh->mVertices)
-						{
-							logger.error("{} doesn't have any vertex information", _scene_name);
-							break;
-						}
+					//TODO: we need to support skinned model in next version
 
-						auto _pos = _a_mesh->mVertices[j];
-						_w_vertex.position[0] = _pos.x;
-						_w_vertex.position[1] = _pos.y;
-						_w_vertex.position[2] = _pos.z;
+					//modify vertices for right handed coordinate system
+					//if (_coordinate_system == w_coordinate_system::RIGHT_HANDED)
+					//{
+					//	if (_coordinate_system_up_vector.z == 1)
+					//	{
+					//		std::swap(_a_mesh->mVertices[j].z, _a_mesh->mVertices[j].y);
+					//		_a_mesh->mVertices[j].y *= -1;
+					//	}
+					//}
 
-						if (_a_mesh->mNormals)
+					//does not have any vertex
+					if (!_a_mesh->mVertices)
+					{
+						logger.error("{} doesn't have any vertex information", _scene_name);
+					}
+					else
+					{
+						const bool _has_normals = _a_mesh->mNormals != nullptr;
+						const bool _has_uvs = _a_mesh->mTextureCoords && _a_mesh->mTextureCoords[0];
+						if (!_has_normals)
 						{
-							//get normal
-							auto _normal = _a_mesh->mNormals[j];
-							_w_vertex.normal[0] = _normal.x;
-							_w_vertex.normal[1] = _normal.y;
-							_w_vertex.normal[2] = _normal.z;
+							logger.warning("{} does have any vertex information", _scene_name);
 						}
-						else
+						if (!_has_uvs)
 						{
 							logger.warning("{} does have any vertex information", _scene_name);
 						}
 
-						//copy mesh
-						if (_a_mesh->mTextureCoords && _a_mesh->mTextureCoords[0])
+						//copy vertices in parallel, each index writes its own slot
+						_w_mesh->vertices.resize(_a_mesh->mNumVertices);
+						parallel_for(0, _a_mesh->mNumVertices, 1024, [&](size_t j)
 						{
-							//get uv
-							auto _uv = _a_mesh->mTextureCoords[0][j];
-							_w_vertex.uv[0] = _uv.x;
-							_w_vertex.uv[1] = _uv.y;
-						}
-						else
-						{
-							logger.warning("{} does have any vertex information", _scene_name);
-						}
+							auto& _w_vertex = _w_mesh->vertices[j];
+
+							auto _pos = _a_mesh->mVertices[j];
+							_w_vertex.position[0] = _pos.x;
+							_w_vertex.position[1] = _pos.y;
+							_w_vertex.position[2] = _pos.z;
+
+							if (_has_normals)
+							{
+								//get normal
+								auto _normal = _a_mesh->mNormals[j];
+								_w_vertex.normal[0] = _normal.x;
+								_w_vertex.normal[1] = _normal.y;
+								_w_vertex.normal[2] = _normal.z;
+							}
 
-						//add to vertices
-						_w_mesh->vertices.push_back(_w_vertex);
+							if (_has_uvs)
+							{
+								//get uv
+								auto _uv = _a_mesh->mTextureCoords[0][j];
+								_w_vertex.uv[0] = _uv.x;
+								_w_vertex.uv[1] = _uv.y;
+							}
+						});
 
 						//if (pOptimizeMeshUsingAMDTootle)
 						//{
@@ -428,15 +474,28 @@ w_cpipeline_scene* w_assimp::load(_In_z_ const std::wstring& pAssetPath,
 						//}
 
 						//check for minimum and maximum vertices for bounding boxes
-						_min_vertex.x = std::min(_w_vertex.position[0], _min_vertex.x);
-						_min_vertex.y = std::min(_w_vertex.position[1], _min_vertex.y);
-						_min_vertex.z = std::min(_w_vertex.position[2], _min_vertex.z);
-
-						_max_vertex.x = std::max(_w_vertex.position[0], _max_vertex.x);
-						_max_vertex.y = std::max(_w_vertex.position[1], _max_vertex.y);
-						_max_vertex.z = std::max(_w_vertex.position[2], _max_vertex.z);
+						typedef std::pair<glm::vec3, glm::vec3> w_min_max;
+						auto _bounds = parallel_reduce(0, _a_mesh->mNumVertices, 4096,
+							w_min_max(glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)),
+							[&](size_t pBegin, size_t pEnd, w_min_max pValue)
+						{
+							for (auto j = pBegin; j < pEnd; ++j)
+							{
+								auto& _pos = _a_mesh->mVertices[j];
+								pValue.first = glm::min(pValue.first, glm::vec3(_pos.x, _pos.y, _pos.z));
+								pValue.second = glm::max(pValue.second, glm::vec3(_pos.x, _pos.y, _pos.z));
+							}
+							return pValue;
+						},
+							[](const w_min_max& pA, const w_min_max& pB)
+						{
+							return w_min_max(glm::min(pA.first, pB.first), glm::max(pA.second, pB.second));
+						});
+						_min_vertex = glm::min(_min_vertex, _bounds.first);
+						_max_vertex = glm::max(_max_vertex, _bounds.second);
 
-						if (_a_mesh->mMaterialIndex >= 0 &&
+						if (_a_mesh->mNumVertices &&
+							_a_mesh->mMaterialIndex >= 0 &&
 							_a_mesh->mMaterialIndex < _texture_paths.size())
 						{
 							_w_mesh->textures_path = _texture_paths[_a_mesh->mMaterialIndex];
@@ -444,6 +503,7 @@ w_cpipeline_scene* w_assimp::load(_In_z_ const std::wstring& pAssetPath,
 					}
 
 					// generate indices
+					_w_mesh->indices.reserve(static_cast<size_t>(_a_mesh->mNumFaces) * 3);
 					for (size_t f = 0; f < _a_mesh->mNumFaces; ++f)
 					{
 						for (size_t k = 0; k < 3; ++k)
@@ -479,6 +539,13 @@ w_cpipeline_scene* w_assimp::load(_In_z_ const std::wstring& pAssetPath,
 			_model_meshes,
 			&_w_scene,
 			_LODs);
+
+		//models own the content of meshes now
+		for (auto _mesh : _model_meshes)
+		{
+			delete _mesh;
+		}
+		_model_meshes.clear();
         
 		//now we need assign LODs and CH to models, if model does not have LOD, we need to generate it with simpolygon (in Windows)
 		std::vector<w_cpipeline_model*> _models;
@@ -22,6 +22,10 @@ namespace assimp
                                                                        _In_ const bool& pOptimizeMeshUsingAMDTootle
 #ifdef __WIN32
                                                                        ,_In_ const bool& pGenerateLODUsingSimplygon
+#endif
+#ifdef W_CPIPELINE_HAS_PMR
+                                                                       //meshes are allocated from this memory resource, nullptr means the heap with big arrays from w_large_allocator
+                                                                       ,_In_opt_ std::pmr::memory_resource* pMemoryResource = nullptr
 #endif
                                                                        );
 	};
@@ -20,28 +20,13 @@ W_RESULT c_parser::parse_collada_from_file(
 {
 	auto _hr = W_PASSED;
 
-#if defined(__WIN32) || defined(__UWP)
-    auto _path = pFilePath;
-#else
-    auto _path = wolf::system::convert::wstring_to_string(pFilePath);
-#endif
-    
-	//open stream of xml 
-	std::ifstream _file(_path);
-	std::stringstream _string_stream;
-	_string_stream << _file.rdbuf();
-	_file.close();
-	std::string content(_string_stream.str());
-
 	sSkipChildrenOfThisNode = "NULL";
 
+	//collada is parsed in situ, nodes point into the buffer until the scene is created
 	using namespace rapidxml;
+	w_file_buffer _buffer;
 	xml_document<> _doc;
-	try
-	{
-		_doc.parse<0>(&content[0]);
-	}
-	catch (...)
+	if (w_xml::loadW(pFilePath.c_str(), _buffer, _doc) != W_PASSED)
 	{
 		_hr = W_FAILED;
         V(_hr, w_log_type::W_ERROR, L"Could not parse collada file on following path : {}. trace info: {}", pFilePath, L"::w_collada_parser");
@@ -18,6 +18,7 @@
 #include "simplygon/simplygon.h"
 #include <assimp/w_assimp.h>
 #include <w_compress.hpp>
+#include <w_vfs.h>
 
 namespace wolf::content_pipeline
 {
@@ -36,6 +37,10 @@ namespace wolf::content_pipeline
 
 #ifdef __WIN32
 			, _In_ const bool& pGenerateLODUsingSimplygon = true
+#endif
+#ifdef W_CPIPELINE_HAS_PMR
+			//meshes of scenes which are loaded by assimp are allocated from this memory resource, nullptr means the heap with big arrays from w_large_allocator
+			, _In_opt_ std::pmr::memory_resource* pMemoryResource = nullptr
 #endif
 		)
 		{
@@ -80,6 +85,9 @@ namespace wolf::content_pipeline
 						pOptimizeMeshUsingAMDTootle
 #ifdef __WIN32
 						, pGenerateLODUsingSimplygon
+#endif
+#ifdef W_CPIPELINE_HAS_PMR
+						, pMemoryResource
 #endif
 					);
 				}
@@ -99,7 +107,8 @@ namespace wolf::content_pipeline
 
 			std::string _str = _sbuffer.str();
 			pWolfScenePacked.size_in = _str.size();
-			auto _hr = w_compress::compress_lz4(_str.c_str(), &pWolfScenePacked);
+			//blocks are compressed on the thread pool
+			auto _hr = w_compress::compress_lz4_parallel(_str.c_str(), &pWolfScenePacked);
 			if (_hr != W_PASSED)
 			{
 				logger.error("error happened while compressing scenes");
@@ -126,54 +135,97 @@ namespace wolf::content_pipeline
 			auto _path = wolf::system::convert::wstring_to_string(pWolfSceneFilePath);
 #endif
 
-			w_compress_result _wolf_scene_packed;
-			if (save_wolf_scenes_to_memory(pScenePacks, _wolf_scene_packed) == W_PASSED)
+			std::ofstream _file(_path, std::ios::out | std::ios::binary);
+			if (!_file || _file.bad())
 			{
-				if (_wolf_scene_packed.data && _wolf_scene_packed.size_out)
-				{
-					std::ofstream _file(_path, std::ios::out | std::ios::binary);
-					if (!_file || _file.bad())
-					{
 #if defined(__WIN32) || defined(__UWP)
-						logger.error(L"Error on creating saving wolf scene file on following path: {}", _path);
+				logger.error(L"Error on creating saving wolf scene file on following path: {}", _path);
 #else
-						logger.error("Error on creating saving wolf scene file on following path: {}", _path);
+				logger.error("Error on creating saving wolf scene file on following path: {}", _path);
 #endif
-						_file.close();
-						return W_FAILED;
-					}
+				_file.close();
+				return W_FAILED;
+			}
 
-					for (size_t i = 0; i < _wolf_scene_packed.size_out; ++i)
-					{
-						_file << _wolf_scene_packed.data[i];
-					}
-					_file.flush();
-					_file.close();
+			//pack into an lz4 frame on the file, so neither packed nor compressed scenes are kept in memory
+			wolf::system::w_lz4_stream_writer _writer;
+			auto _hr = _writer.begin(_file);
+			if (_hr == W_PASSED)
+			{
+				msgpack::pack(_writer, pScenePacks);
+				_hr = _writer.end();
+			}
+			_file.flush();
+			_file.close();
+
+			if (_hr != W_PASSED)
+			{
+#if defined(__WIN32) || defined(__UWP)
+				logger.error(L"Error on saving wolf scene file on following path: {}", _path);
+#else
+				logger.error("Error on saving wolf scene file on following path: {}", _path);
+#endif
+			}
 
-					free(_wolf_scene_packed.data);
+			return _hr;
+		}
 
-					return W_PASSED;
-				}
-				else
-				{
-					logger.error(L"Could not create file with zero size on following path: {}", _path);
-				}
+		static W_RESULT load_wolf_scenes_from_memory(_In_z_ const std::string& pWolfScenePacked, _Inout_ std::vector<w_cpipeline_scene>& pScenePacks)
+		{
+			return _load_wolf_scenes(pWolfScenePacked.data(), pWolfScenePacked.size(), pScenePacks);
+		}
+
+		static W_RESULT load_wolf_scenes_from_file(_In_ std::vector<w_cpipeline_scene>& pScenePacks, _In_z_ std::wstring pWolfSceneFilePath)
+
+		{
+			//scenes are unpacked straight from pages of file or archive, nothing is copied before decompression
+			wolf::system::w_vfs_file _file;
+			if (_file.openW(pWolfSceneFilePath.c_str()) != W_PASSED || _file.get_size() == 0)
+			{
+#if defined(__WIN32) || defined(__UWP)
+				logger.error(L"Error on opening wolf scene file from following path: {}", pWolfSceneFilePath);
+#else
+				logger.error("Error on opening wolf scene file from following path: {}",
+					wolf::system::convert::wstring_to_string(pWolfSceneFilePath));
+#endif
+				return W_FAILED;
 			}
+			_file.advise(wolf::system::w_mapped_file_advice::SEQUENTIAL);
 
-			return W_FAILED;
+			return _load_wolf_scenes(_file.get_data(), _file.get_size(), pScenePacks);
 		}
 
-		static W_RESULT load_wolf_scenes_from_memory(_In_z_ std::string pWolfScenePacked, _Inout_ std::vector<w_cpipeline_scene>& pScenePacks)
+		static void release()
+		{
+#ifdef __WIN32
+			simplygon::release();
+#endif
+		}
+
+	private:
+		//frames of files or blocks of memory, which were packed by any version
+		static W_RESULT _load_wolf_scenes(_In_ const char* pData, _In_ const size_t& pSize, _Inout_ std::vector<w_cpipeline_scene>& pScenePacks)
 		{
 			using namespace wolf::system;
 
-			//decompress it, then unpack it
-			w_compress_result _decompress_result;
-			_decompress_result.size_in = pWolfScenePacked.size(); //1 for '\0'
-			auto _hr = w_compress::decompress_lz4(pWolfScenePacked.c_str(), &_decompress_result);
+			//scenes which are saved to file are lz4 frames
+			if (is_lz4_frame_c(pData, pSize))
+			{
+				w_compress_memory_reader _memory = { pData, pSize };
+				w_lz4_stream_reader _reader;
+				if (_reader.begin(w_compress_memory_reader::read, &_memory) != W_PASSED) return W_FAILED;
+				return _unpack_scenes(_reader, pScenePacks);
+			}
+
+			//decompress it, then unpack it. scenes which were packed in memory by older versions are single lz4 blocks
+			w_compress_result _decompress_result = {};
+			_decompress_result.size_in = pSize;
+			_decompress_result.codec = w_compress::get_codec(pData, pSize);
+			if (_decompress_result.codec == W_CODEC_UNKNOWN) _decompress_result.codec = W_CODEC_LZ4;
+			auto _hr = w_compress::decompress(pData, &_decompress_result);
 			if (_hr == W_RESULT::W_PASSED)
 			{
-				auto _msg = msgpack::unpack(_decompress_result.data, _decompress_result.size_out + 1);
+				auto _msg = msgpack::unpack(_decompress_result.data, _decompress_result.size_out);
 				_msg.get().convert(pScenePacks);
 			}
 			else
@@ -188,40 +240,31 @@ namespace wolf::content_pipeline
 			return _hr;
 		}
 
-		static W_RESULT load_wolf_scenes_from_file(_In_ std::vector<w_cpipeline_scene>& pScenePacks, _In_z_ std::wstring pWolfSceneFilePath)
-
+		static W_RESULT _unpack_scenes(_In_ wolf::system::w_lz4_stream_reader& pReader, _Inout_ std::vector<w_cpipeline_scene>& pScenePacks)
 		{
-#if defined(__WIN32) || defined(__UWP)
-			auto _path = pWolfSceneFilePath;
-#else
-			auto _path = wolf::system::convert::wstring_to_string(pWolfSceneFilePath);
-#endif
-			std::ifstream _file(_path, std::ios::in | std::ios::binary);
-			if (!_file || _file.bad())
+			msgpack::unpacker _unpacker;
+			msgpack::object_handle _handle;
+			bool _unpacked = false;
+			for (;;)
 			{
-#if defined(__WIN32) || defined(__UWP)
-				logger.error(L"Error on opening wolf scene file from following path: {}", _path);
-#else
-				logger.error("Error on opening wolf scene file from following path: {}", _path);
-#endif
-				_file.close();
-				return W_FAILED;
-			}
-			std::string _str((std::istreambuf_iterator<char>(_file)),
-				std::istreambuf_iterator<char>());
+				_unpacker.reserve_buffer(64 * 1024);
+				auto _size = pReader.read(_unpacker.buffer(), _unpacker.buffer_capacity());
+				if (!_size) break;
 
-			auto _hr = load_wolf_scenes_from_memory(_str, pScenePacks);
-
-			_file.close();
+				_unpacker.buffer_consumed(_size);
+				if (!_unpacked) _unpacked = _unpacker.next(_handle);
+			}
 
-			return _hr;
-		}
+			//the checksum of frame is verified when all of it was read
+			auto _hr = pReader.end();
+			if (_hr != W_PASSED || !_unpacked)
+			{
+				logger.error("error happened while decompressing scenes");
+				return W_FAILED;
+			}
 
-		static void release()
-		{
-#ifdef __WIN32
-			simplygon::release();
-#endif
+			_handle.get().convert(pScenePacks);
+			return W_PASSED;
 		}
 	};
 }
@@ -28,6 +28,44 @@ w_cpipeline_model::w_cpipeline_model(_In_ std::vector<w_cpipeline_mesh*>& pModel
     }
 }
 
+#ifdef W_CPIPELINE_HAS_PMR
+w_cpipeline_model::w_cpipeline_model(
+	_Inout_ std::vector<w_cpipeline_mesh*>& pModelMeshes,
+	_In_ std::pmr::memory_resource* pMemoryResource) :
+	_id(-1),
+	_meshes(pMemoryResource)
+{
+	//uses allocator construction moves meshes, buffers of meshes which were built in the same memory resource are taken over
+	this->_meshes.reserve(pModelMeshes.size());
+	for (auto _mesh : pModelMeshes)
+	{
+		this->_meshes.push_back(std::move(*_mesh));
+	}
+}
+#endif
+
+w_cpipeline_model::w_cpipeline_model(_Inout_ w_cpipeline_model&& pOther) noexcept :
+	_name(std::move(pOther._name)),
+	_id(pOther._id),
+	_instanced_geo_name(std::move(pOther._instanced_geo_name)),
+	_world(pOther._world),
+	_m_bind_pos(std::move(pOther._m_bind_pos)),
+	_v_bind_pos(std::move(pOther._v_bind_pos)),
+	_animation_time(pOther._animation_time),
+	_last_animation_time(pOther._last_animation_time),
+	_animation_containers(std::move(pOther._animation_containers)),
+	_frame_overlap(pOther._frame_overlap),
+	_overlapping(pOther._overlapping),
+	_overlapping_start_time(pOther._overlapping_start_time),
+	_transform(pOther._transform),
+	_instances_info(std::move(pOther._instances_info)),
+	_bounding_box(pOther._bounding_box),
+	_meshes(std::move(pOther._meshes)),
+	_bone_names(std::move(pOther._bone_names)),
+	_all_sub_meshes_use_same_texture(pOther._all_sub_meshes_use_same_texture)
+{
+}
+
 w_cpipeline_model::~w_cpipeline_model()
 {
 }
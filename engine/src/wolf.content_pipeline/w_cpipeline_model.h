@@ -11,9 +11,7 @@
 
 #include "w_cpipeline_export.h"
 
-#if __cplusplus <= 201402L
 #include <msgpack.hpp>
-#endif
 
 #include <map>
 #include <glm/matrix.hpp>
@@ -76,9 +74,7 @@ namespace wolf::content_pipeline
 		float	        scale[3];
 		glm::mat4x4     transform;
 
-#if __cplusplus <= 201402L
 		MSGPACK_DEFINE(position, rotation, scale);
-#endif
         
 #ifdef __PYTHON__
 
@@ -154,9 +150,7 @@ namespace wolf::content_pipeline
 
 		uint32_t        texture_sampler_index = 0;
 
-#if __cplusplus <= 201402L
 		MSGPACK_DEFINE(name, position, rotation, scale, texture_sampler_index);
-#endif
         
 #ifdef __PYTHON__
 		glm::w_vec3		py_get_position() { return glm::w_vec3(this->position[0], this->position[1], this->position[2]); }
@@ -174,15 +168,57 @@ namespace wolf::content_pipeline
 	{
 		std::string							name;
 		//posX, posY, posZ
-		std::vector<w_vertex_struct>		vertices;
-		std::vector<uint32_t>				indices;
+		w_vertex_vector						vertices;
+		w_index_vector						indices;
 		//c_material*						material;
 		//std::vector<c_effect*>			effects;
 		std::string							textures_path;
 		wolf::system::w_bounding_box		bounding_box;
 
-		std::vector<w_vertex_struct>		lod_1_vertices;
-		std::vector<uint32_t>				lod_1_indices;
+		w_vertex_vector						lod_1_vertices;
+		w_index_vector						lod_1_indices;
+
+#ifdef W_CPIPELINE_HAS_PMR
+		//vertices and indices are allocated from the memory resource, pmr containers of meshes pass their resource to each mesh
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+		w_cpipeline_mesh() = default;
+		explicit w_cpipeline_mesh(_In_ std::pmr::memory_resource* pMemoryResource) :
+			w_cpipeline_mesh(allocator_type(pMemoryResource))
+		{
+		}
+		explicit w_cpipeline_mesh(_In_ const allocator_type& pAllocator) :
+			vertices(pAllocator),
+			indices(pAllocator),
+			lod_1_vertices(pAllocator),
+			lod_1_indices(pAllocator)
+		{
+		}
+		w_cpipeline_mesh(_In_ const w_cpipeline_mesh& pOther) = default;
+		w_cpipeline_mesh(_In_ const w_cpipeline_mesh& pOther, _In_ const allocator_type& pAllocator) :
+			name(pOther.name),
+			vertices(pOther.vertices, pAllocator),
+			indices(pOther.indices, pAllocator),
+			textures_path(pOther.textures_path),
+			bounding_box(pOther.bounding_box),
+			lod_1_vertices(pOther.lod_1_vertices, pAllocator),
+			lod_1_indices(pOther.lod_1_indices, pAllocator)
+		{
+		}
+		w_cpipeline_mesh(_Inout_ w_cpipeline_mesh&& pOther) = default;
+		w_cpipeline_mesh(_Inout_ w_cpipeline_mesh&& pOther, _In_ const allocator_type& pAllocator) :
+			name(std::move(pOther.name)),
+			vertices(std::move(pOther.vertices), pAllocator),
+			indices(std::move(pOther.indices), pAllocator),
+			textures_path(std::move(pOther.textures_path)),
+			bounding_box(pOther.bounding_box),
+			lod_1_vertices(std::move(pOther.lod_1_vertices), pAllocator),
+			lod_1_indices(std::move(pOther.lod_1_indices), pAllocator)
+		{
+		}
+		w_cpipeline_mesh& operator=(_In_ const w_cpipeline_mesh& pOther) = default;
+		w_cpipeline_mesh& operator=(_Inout_ w_cpipeline_mesh&& pOther) = default;
+#endif
 
 		void release()
 		{
@@ -192,9 +228,7 @@ namespace wolf::content_pipeline
 			this->lod_1_indices.clear();
 		}
 
-#if __cplusplus <= 201402L
 		MSGPACK_DEFINE(vertices, indices, textures_path, bounding_box, lod_1_vertices, lod_1_indices);
-#endif
         
 #ifdef __PYTHON__
 
@@ -218,8 +252,20 @@ namespace wolf::content_pipeline
 	public:
 		WCP_EXP w_cpipeline_model();
 		WCP_EXP w_cpipeline_model(_In_ std::vector<w_cpipeline_mesh*>& pModelMeshes);
+#ifdef W_CPIPELINE_HAS_PMR
+		//move meshes to the memory resource, which must outlive this model. pModelMeshes are left empty
+		WCP_EXP w_cpipeline_model(
+			_Inout_ std::vector<w_cpipeline_mesh*>& pModelMeshes,
+			_In_ std::pmr::memory_resource* pMemoryResource);
+#endif
+		//moving keeps the meshes in their memory resource
+		WCP_EXP w_cpipeline_model(_Inout_ w_cpipeline_model&& pOther) noexcept;
+		w_cpipeline_model(_In_ const w_cpipeline_model& pOther) = default;
 		WCP_EXP virtual ~w_cpipeline_model();
 
+		w_cpipeline_model& operator=(_In_ const w_cpipeline_model& pOther) = default;
+		w_cpipeline_model& operator=(_Inout_ w_cpipeline_model&& pOther) = default;
+
 		WCP_EXP void add_instance(_In_ const w_instance_info& pValue);
 		WCP_EXP void add_lods(_In_ const std::vector<w_cpipeline_mesh*>& pLODs);
 		//WCP_EXP void add_convex_hulls(_In_ const std::vector<w_cpipeline_model*>& pCHs);
@@ -284,9 +330,7 @@ namespace wolf::content_pipeline
 //                _In_ const bool& pZUp,
 //                _In_ const bool& pInvertNormal);
 
-#if __cplusplus <= 201402L
 		MSGPACK_DEFINE(_name, _instanced_geo_name, _transform, _instances_info, _bounding_box, _meshes);
-#endif
 
 #ifdef __PYTHON__
 
@@ -387,7 +431,11 @@ namespace wolf::content_pipeline
 		std::vector<w_instance_info>							_instances_info;
 		wolf::system::w_bounding_box                            _bounding_box;
 
+#ifdef W_CPIPELINE_HAS_PMR
+		std::pmr::vector<w_cpipeline_mesh>						_meshes;
+#else
 		std::vector<w_cpipeline_mesh>							_meshes;
+#endif
 
 		//std::vector<collada::c_bone*>							_skeleton;
 		std::vector<std::string>								_bone_names;
@@ -5,9 +5,21 @@ using namespace std;
 using namespace wolf::system;
 using namespace wolf::content_pipeline;
 
+#ifdef W_CPIPELINE_HAS_PMR
+w_cpipeline_scene::w_cpipeline_scene() :
+	_memory_resource(nullptr)
+{
+}
+
+w_cpipeline_scene::w_cpipeline_scene(_In_opt_ std::pmr::memory_resource* pMemoryResource) :
+	_memory_resource(pMemoryResource)
+{
+}
+#else
 w_cpipeline_scene::w_cpipeline_scene()
 {
 }
+#endif
 
 w_cpipeline_scene::~w_cpipeline_scene()
 {
@@ -20,6 +32,11 @@ void w_cpipeline_scene::add_model(_In_ w_cpipeline_model* pModel)
     this->_models.push_back(*pModel);
 }
 
+void w_cpipeline_scene::add_model(_Inout_ w_cpipeline_model&& pModel)
+{
+    this->_models.push_back(std::move(pModel));
+}
+
 void w_cpipeline_scene::add_models(_In_ std::vector<w_cpipeline_model*>& pModel)
 {
     for (size_t i = 0; i < pModel.size(); ++i)
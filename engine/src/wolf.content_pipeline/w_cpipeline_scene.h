@@ -21,9 +21,14 @@ namespace wolf::content_pipeline
 	{
 	public:
 		WCP_EXP w_cpipeline_scene();
+#ifdef W_CPIPELINE_HAS_PMR
+		//meshes of models which are loaded for this scene are allocated from the memory resource
+		WCP_EXP explicit w_cpipeline_scene(_In_opt_ std::pmr::memory_resource* pMemoryResource);
+#endif
 		WCP_EXP virtual ~w_cpipeline_scene();
 
 		WCP_EXP void add_model(_In_ w_cpipeline_model* pModel);
+		WCP_EXP void add_model(_Inout_ w_cpipeline_model&& pModel);
 		WCP_EXP void add_models(_In_ std::vector<w_cpipeline_model*>& pModel);
 		WCP_EXP void add_boundary(_In_ wolf::system::w_bounding_sphere* pBoundary);
 		WCP_EXP void add_boundaries(_In_ std::vector<wolf::system::w_bounding_sphere*>& pBoundaries);
@@ -47,6 +52,10 @@ namespace wolf::content_pipeline
 
 		WCP_EXP const char* get_name() const { return this->_name.c_str(); }
 		WCP_EXP const char* get_root_name() const { return this->_root_name.c_str(); }
+#ifdef W_CPIPELINE_HAS_PMR
+		//nullptr means the default heap
+		WCP_EXP std::pmr::memory_resource* get_memory_resource() const { return this->_memory_resource; }
+#endif
 
 		/* WCP_EXP w_coordinate_system get_coordinate_system() const               { return static_cast<w_coordinate_system>(this->_coordinate_system); }
 		 WCP_EXP glm::vec3           get_coordinate_system_up_vector() const
@@ -65,9 +74,7 @@ namespace wolf::content_pipeline
 
 #pragma endregion
 
-#if __cplusplus <= 201402L
 		MSGPACK_DEFINE(_name, _cameras, _models, _boundaries);
-#endif
         
 #ifdef __PYTHON__
 		void py_add_model(_In_ w_cpipeline_model& pModel)
@@ -116,6 +123,9 @@ namespace wolf::content_pipeline
 		std::vector<w_camera>							_cameras;
 		std::vector<w_cpipeline_model>					_models;
 		std::vector<wolf::system::w_bounding_sphere>	_boundaries;
+#ifdef W_CPIPELINE_HAS_PMR
+		std::pmr::memory_resource*						_memory_resource;
+#endif
 
 		//just reperesent the coordinate system of 3D source format
 	   // bool                                            _coordinate_system;
@@ -10,10 +10,18 @@
 #ifndef __W_VERTEX_STRUCT_H__
 #define __W_VERTEX_STRUCT_H__
 
-#if __cplusplus <= 201402L
 #include <msgpack.hpp>
-#endif
 #include <vector>
+#include "w_memory_resource.h"
+
+//layout of meshes and scenes must not depend on the standard of translation units which include them,
+//so the pipeline and its users are C++17. Boost python helpers only convert std::vector, python builds do not use pmr
+#ifndef __PYTHON__
+#ifndef W_HAS_PMR
+#error "wolf.content_pipeline requires C++17 std::pmr"
+#endif
+#define W_CPIPELINE_HAS_PMR
+#endif
 
 namespace wolf
 {
@@ -31,9 +39,7 @@ namespace wolf
             float		    color[4];
             uint32_t	    vertex_index;
 
-#if __cplusplus <= 201402L
             MSGPACK_DEFINE(position, normal, uv, vertex_index);
-#endif
 
 #ifdef __PYTHON__
 			glm::w_vec3		py_get_position() { return glm::w_vec3(this->position[0], this->position[1], this->position[2]); }
@@ -74,6 +80,14 @@ namespace wolf
 
 #endif
 		};
+
+#ifdef W_CPIPELINE_HAS_PMR
+		typedef std::pmr::vector<w_vertex_struct>	w_vertex_vector;
+		typedef std::pmr::vector<uint32_t>			w_index_vector;
+#else
+		typedef std::vector<w_vertex_struct>		w_vertex_vector;
+		typedef std::vector<uint32_t>				w_index_vector;
+#endif
     }
 }
 
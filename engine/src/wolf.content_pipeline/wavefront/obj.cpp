@@ -12,8 +12,8 @@ using namespace wolf::content_pipeline;
 using namespace wolf::content_pipeline::wavefront;
 
 void obj::write(
-	_In_ std::vector<w_vertex_struct>& pVerticesData,
-	_In_ std::vector<uint32_t>& pIndicesData,
+	_In_ w_vertex_vector& pVerticesData,
+	_In_ w_index_vector& pIndicesData,
 	_In_z_ const std::string& pOutputFilePath)
 {
 	const std::string _trace_info = "w_wavefront_obj::write";
@@ -149,8 +149,8 @@ void obj::write(
 }
 
 W_RESULT obj::read(
-	_Inout_ std::vector<w_vertex_struct>& pVerticesData,
-	_Inout_ std::vector<uint32_t>& pIndicesData,
+	_Inout_ w_vertex_vector& pVerticesData,
+	_Inout_ w_index_vector& pIndicesData,
 	//_Inout_ std::vector<float>& pJustVertexPosition,
 	_In_z_ const std::string& pInputFilePath)
 {
@@ -27,13 +27,13 @@ namespace wolf
 			struct obj
 			{
 				static void write(
-					_In_ std::vector<w_vertex_struct>& pVerticesData,
-					_In_ std::vector<uint32_t>& pIndicesData,
+					_In_ w_vertex_vector& pVerticesData,
+					_In_ w_index_vector& pIndicesData,
 					_In_z_ const std::string& pOutputFilePath);
 
 				static W_RESULT read(
-					_Inout_ std::vector<w_vertex_struct>& pVerticesData,
-					_Inout_ std::vector<uint32_t>& pIndicesData,
+					_Inout_ w_vertex_vector& pVerticesData,
+					_Inout_ w_index_vector& pIndicesData,
 					//_Inout_ std::vector<float>& pJustVertexPosition,
 					_In_z_ const std::string& pInputFilePath);
 			};
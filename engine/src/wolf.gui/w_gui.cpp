@@ -45,25 +45,12 @@ HRESULT w_gui::load(const std::wstring& pGuiDesignPath, _In_ const UINT pParentW
 		return S_FALSE;
 	}
 
-	//first open the stream of xml file 
-	std::ifstream _file(_path);
-	std::stringstream _string_stream;
-	_string_stream << _file.rdbuf();
-	//close file
-	_file.close();
-	//read all stream into the content
-	std::string _content(_string_stream.str());
-	//clear string stream
-	_string_stream.clear();
-
+	//xml is parsed in situ, nodes point into the buffer until the end of loading
 	using namespace rapidxml;
+	wolf::system::w_file_buffer _buffer;
 	xml_document<> _doc;
 	bool _error = false;
-	try
-	{
-		_doc.parse<0>(&_content[0]);
-	}
-	catch (...)
+	if (wolf::system::w_xml::loadW(pGuiDesignPath.c_str(), _buffer, _doc) != W_PASSED)
 	{
 		_error = true;
 
@@ -6,6 +6,7 @@
 #include <w_thread.h>
 #include <w_std.h>
 #include <w_game_time.h>
+#include <w_large_allocator.h>
 
 #ifdef __WIN32
 
@@ -563,7 +564,8 @@ namespace wolf::framework
 				_frame_info.stride = 3;
 				_frame_info.width = _w;
 				_frame_info.height = _h;
-				_frame_info.pixels = (uint8_t*)malloc(_frame_info.width * _frame_info.height * _frame_info.stride * sizeof(uint8_t));
+				//whole frame is written each time, so map all pages up front
+				_frame_info.pixels = (uint8_t*)w_large_allocator::allocate(_frame_info.width * _frame_info.height * _frame_info.stride * sizeof(uint8_t), true);
 
 				int _line_size[1] = { (int)_frame_info.stride * (int)_w };
 
@@ -667,7 +669,7 @@ namespace wolf::framework
 				//free pixels
 				if (_frame_info.pixels)
 				{
-					free(_frame_info.pixels);
+					w_large_allocator::free(_frame_info.pixels);
 					_frame_info.pixels = nullptr;
 				}
 				//free dst picture
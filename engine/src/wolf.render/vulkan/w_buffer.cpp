@@ -2,6 +2,7 @@
 #include "w_buffer.h"
 #include <w_convert.h>
 #include <glm_extension.h>
+#include <w_memory_tracker.h>
 
 static std::mutex _mutex;
 
@@ -20,7 +21,9 @@ namespace wolf
 					_map_data(nullptr),
 					_memory_allocation(nullptr),
 					_mapped(false),
-					_allocated_from_pool(false)
+					_allocated_from_pool(false),
+					_used_memory_size(0),
+					_tracked_memory_size(0)
 				{
 				}
 
@@ -157,6 +160,9 @@ namespace wolf
 					}
 
 					this->_used_memory_size = pBufferSizeInBytes;
+					this->_tracked_memory_size = wolf::system::w_memory_tracker::track_allocation(
+						wolf::system::MEMORY_TAG_BUFFER,
+						static_cast<size_t>(this->_used_memory_size)) ? this->_used_memory_size : 0;
 					this->_descriptor_info.buffer = this->_buffer_handle.handle;
 					this->_descriptor_info.offset = 0;// this->_memory_allocation_info.offset;
 					this->_descriptor_info.range = this->_used_memory_size;//this->_memory_allocation_info.size;
@@ -369,6 +375,13 @@ namespace wolf
 						}
 					}
 
+					if (this->_tracked_memory_size)
+					{
+						wolf::system::w_memory_tracker::record_free(
+							wolf::system::MEMORY_TAG_BUFFER,
+							static_cast<size_t>(this->_tracked_memory_size));
+						this->_tracked_memory_size = 0;
+					}
 					this->_used_memory_size = 0;
 
 					return W_PASSED;
@@ -447,6 +460,8 @@ namespace wolf
 
 				uint32_t											_memory_property_flags;
 				VkDeviceSize										_used_memory_size;
+				//size which is recorded by w_memory_tracker
+				VkDeviceSize										_tracked_memory_size;
 			};
 		}
 	}
@@ -1,6 +1,7 @@
 #include "w_render_pch.h"
 #include "w_shader.h"
 #include <w_io.h>
+#include <w_vfs.h>
 #include <w_convert.h>
 #include <w_logger.h>
 
@@ -29,35 +30,35 @@ namespace wolf
 				{
 					this->_gDevice = pGDevice;
 
-					std::vector<unsigned char> _shader_binary_code;
-					int _file_state = 1;
+					//SPIR-V goes to driver straight from the mapped file or archive, entries and views are aligned to 4 bytes
+					system::w_vfs_file _shader_binary_code;
 #if defined(__WIN32) || defined(__UWP)
 					auto _path = pShaderBinaryPath;
-					system::io::read_binary_fileW(_path.c_str(), _shader_binary_code, _file_state);
+					if (system::io::get_is_fileW(_path.c_str()) == W_FAILED)
 #else
 					auto _path = wolf::system::convert::wstring_to_string(pShaderBinaryPath);
-					system::io::read_binary_file(_path.c_str(), _shader_binary_code, _file_state);
+					if (system::io::get_is_file(_path.c_str()) == W_FAILED)
 #endif
-					if (_file_state != 1)
 					{
-						if (_file_state == -1)
-						{
 #if defined(__WIN32) || defined(__UWP)
-							logger.error(L"Shader on following path: {} not exists.", _path);
+						logger.error(L"Shader on following path: {} not exists.", _path);
 #else
-							logger.error("Shader on following path: {} not exists.", _path);
+						logger.error("Shader on following path: {} not exists.", _path);
 #endif
-							return W_FAILED;
-						}
-						if (_file_state == -2)
-						{
+						return W_FAILED;
+					}
 #if defined(__WIN32) || defined(__UWP)
-							logger.error(L"Shader on following path: {} exists but could not open.", _path);
+					if (_shader_binary_code.openW(_path.c_str()) != W_PASSED || _shader_binary_code.get_size() == 0)
 #else
-							logger.error("Shader on following path: {} exists but could not open.", _path);
+					if (_shader_binary_code.open(_path.c_str()) != W_PASSED || _shader_binary_code.get_size() == 0)
 #endif
-							return W_FAILED;
-						}
+					{
+#if defined(__WIN32) || defined(__UWP)
+						logger.error(L"Shader on following path: {} exists but could not open.", _path);
+#else
+						logger.error("Shader on following path: {} exists but could not open.", _path);
+#endif
+						return W_FAILED;
 					}
 
 					VkShaderModule _shader_module = VK_NULL_HANDLE;
@@ -68,8 +69,8 @@ namespace wolf
 						VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,                    // VkStructureType                sType
 						nullptr,                                                        // const void                    *pNext
 						0,                                                              // VkShaderModuleCreateFlags      flags
-						_shader_binary_code.size(),                                     // size_t                         codeSize
-						reinterpret_cast<const uint32_t*>(&_shader_binary_code[0])      // const uint32_t                *pCode
+						_shader_binary_code.get_size(),                                 // size_t                         codeSize
+						reinterpret_cast<const uint32_t*>(_shader_binary_code.get_data())// const uint32_t                *pCode
 					};
 					auto _hr = vkCreateShaderModule(this->_gDevice->vk_device,
 						&_shader_module_create_info,
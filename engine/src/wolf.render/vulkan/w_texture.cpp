@@ -2,8 +2,10 @@
 #include "w_texture.h"
 #include <w_convert.h>
 #include <w_io.h>
+#include <w_vfs.h>
 #include "w_buffer.h"
 #include "w_command_buffers.h"
+#include <w_memory_tracker.h>
 #include <map>
 #include "w_framework/gli/gli.hpp"
 
@@ -33,7 +35,8 @@ namespace wolf
 				_image_type(w_image_type::_2D_TYPE),
 				_image_view_type(w_image_view_type::_2D),
 				_buffer_type(VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT),
-				_image_layout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+				_image_layout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+				_tracked_memory_size(0)
 			{
 				this->_image_view.attachment_desc.desc.format = VkFormat::VK_FORMAT_R8G8B8A8_UNORM;
 			}
@@ -151,6 +154,23 @@ namespace wolf
 				//lower it
 				std::transform(_ext.begin(), _ext.end(), _ext.begin(), ::tolower);
 
+#if !defined(__ANDROID__)
+				//decoders read from pages of file or archive, file is not copied into a buffer first
+				system::w_vfs_file _file;
+				if (_file.open(_g_path.c_str()) != W_PASSED || _file.get_size() == 0 || _file.get_size() > INT_MAX)
+				{
+					V(W_FAILED,
+						w_log_type::W_ERROR,
+						L"could not map the texture file: {} . graphics device: {}. trace info: {}",
+						_path,
+						wolf::system::convert::string_to_wstring(this->_gDevice->get_info()),
+						L"w_texture::load_texture_2D_from_file");
+
+					return W_FAILED;
+				}
+				_file.advise(system::w_mapped_file_advice::SEQUENTIAL);
+#endif
+
 				if (_ext == L".dds" || _ext == L".ktx")
 				{
 
@@ -170,7 +190,7 @@ namespace wolf
 */
 #else
 					//we re loading file with gli header
-					auto _gli_tex = gli::load(_g_path.c_str());
+					auto _gli_tex = gli::load(_file.get_data(), _file.get_size());
 #endif
 					if (_gli_tex.size())
 					{
@@ -190,7 +210,17 @@ namespace wolf
 
 					int __width, __height, __comp;
 
+#if defined(__ANDROID__)
 					_rgba = stbi_load(_g_path.c_str(), &__width, &__height, &__comp, STBI_rgb_alpha);
+#else
+					_rgba = stbi_load_from_memory(
+						reinterpret_cast<const stbi_uc*>(_file.get_data()),
+						static_cast<int>(_file.get_size()),
+						&__width,
+						&__height,
+						&__comp,
+						STBI_rgb_alpha);
+#endif
 
 					this->_image_view.width = __width;
 					this->_image_view.height = __height;
@@ -397,7 +427,7 @@ namespace wolf
 				//release the old one
 				if (this->_memory.handle)
 				{
-					vkFreeMemory(this->_gDevice->vk_device, this->_memory.handle, nullptr);
+					_free_memory();
 				}
 
 				VkMemoryRequirements _image_memory_requirements;
@@ -445,8 +475,26 @@ namespace wolf
 					return W_FAILED;
 				}
 
+				this->_tracked_memory_size = wolf::system::w_memory_tracker::track_allocation(
+					wolf::system::MEMORY_TAG_TEXTURE,
+					static_cast<size_t>(_image_memory_requirements.size)) ? _image_memory_requirements.size : 0;
+
 				return W_PASSED;
 			}
+
+			void _free_memory()
+			{
+				vkFreeMemory(this->_gDevice->vk_device, this->_memory.handle, nullptr);
+				this->_memory.handle = 0;
+
+				if (this->_tracked_memory_size)
+				{
+					wolf::system::w_memory_tracker::record_free(
+						wolf::system::MEMORY_TAG_TEXTURE,
+						static_cast<size_t>(this->_tracked_memory_size));
+					this->_tracked_memory_size = 0;
+				}
+			}
             
 			W_RESULT _create_image_view()
 			{
@@ -1573,10 +1621,7 @@ namespace wolf
                 //release memory
                 if( this->_memory.handle)
                 {
-                    vkFreeMemory(this->_gDevice->vk_device,
-                                 this->_memory.handle,
-                                 nullptr);
-                    this->_memory.handle = 0;
+                    _free_memory();
                 }
                 
                 if (this->_is_staging)
@@ -1713,6 +1758,8 @@ namespace wolf
 			VkImageLayout									_image_layout;
 			std::wstring									_texture_name;
 			bool											_just_initialized;
+			//size of _memory which is recorded by w_memory_tracker
+			VkDeviceSize									_tracked_memory_size;
         };
 		}
 	}
@@ -36,6 +36,8 @@ namespace pyWolf
             .def("set_fixed_time_step", &w_game_time::set_fixed_time_step, "set fixed time step value")
             .def("set_target_elapsed_ticks", &w_game_time::set_target_elapsed_ticks, "set target elapsed ticks value")
             .def("set_target_elapsed_seconds", &w_game_time::set_target_elapsed_seconds, "set target elapsed seconds value")
+            .def("get_frame_pacing", &w_game_time::get_frame_pacing, "get frame pacing value")
+            .def("set_frame_pacing", &w_game_time::set_frame_pacing, "set frame pacing value")
             ;
     }
 }
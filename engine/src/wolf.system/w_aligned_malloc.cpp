@@ -4,21 +4,24 @@
 /// \file
 ****************************************************************************************/
 // This is the implementation of address-aligned malloc and free using a linked list (inserting at front).
-// These functions are not thread-safe because there is an access to the addressList global variable.
-// Use a mutex when you access the global variable to make it thread-safe.
+// The addressList global variable is guarded by a mutex, so these functions are thread-safe.
 #include "w_system_pch.h"
+#include "w_memory_tracker.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <mutex>
 
 // a linked list node to store a coupled memory address of the original and aligned address.
 typedef struct llnode
 {
     void*          original;  // store the original starting address
     void*          aligned;   // store the aligned starting address
+    size_t         tracked;   // bytes which are recorded by w_memory_tracker, zero if tracking was disabled
     struct llnode* next;
 } node;
 
 static node* s_addressList = NULL;
+static std::mutex s_addressListMutex;
 static void PrintList();
 template <typename T>
 static T GetNextPowerOfTwo(T nValue);
@@ -83,6 +86,7 @@ void* aligned_malloc(size_t bytes, size_t alignment)
     // Store a coupled entry of address and aligned address into a linked list so we can free the memory with the correct
     //  address in aligned_free() function.  The new coupled entry is prepended into the linked list.  The next code makes sure
     //  that the linked list does not store multiple entry of the same memory address.
+    std::lock_guard<std::mutex> lock(s_addressListMutex);
     node* addressEntry;
 
     for (addressEntry = s_addressList;
@@ -100,6 +104,7 @@ void* aligned_malloc(size_t bytes, size_t alignment)
     addressEntry           = (node*) malloc(sizeof(node));
     addressEntry->original = originalAddress;
     addressEntry->aligned  = memory;
+    addressEntry->tracked  = wolf::system::w_memory_tracker::track_allocation(wolf::system::MEMORY_TAG_ALIGNED_MALLOC, totalSize) ? totalSize : 0;
     addressEntry->next     = s_addressList;
     s_addressList          = addressEntry;
 
@@ -143,6 +148,7 @@ void aligned_free(void* p)
         return;
     }
 
+    std::lock_guard<std::mutex> lock(s_addressListMutex);
     node* addressEntry;
     node* prevAddressEntry;
 
@@ -156,6 +162,11 @@ void aligned_free(void* p)
         {
             free(addressEntry->original);
 
+            if (addressEntry->tracked)
+            {
+                wolf::system::w_memory_tracker::record_free(wolf::system::MEMORY_TAG_ALIGNED_MALLOC, addressEntry->tracked);
+            }
+
             prevAddressEntry->next = addressEntry->next;
 
             // if we are deleting the head node, update the head node
@@ -9,32 +9,12 @@
 
 #pragma once
 
-#ifdef __WIN32
-
+#include "w_system_export.h"
 #include <cstdint>
+#include <cstddef>
 #include <new>
 #include <assert.h>
 
-namespace pointer_math
-{
-	void*       align_forward(void* pAddress, uint8_t pAlignment);
-	const void* align_forward(const void* pAddress, uint8_t pAlignment);
-
-	void*       align_backward(void* pAddress, uint8_t pAlignment);
-	const void* align_backward(const void* pAddress, uint8_t pAlignment);
-
-	uint8_t     align_forward_adjustment(const void* pAddress, uint8_t pAlignment);
-	uint8_t     align_forward_adjustment_with_header(const void* pAddress, uint8_t pAlignment, uint8_t pHeaderSize);
-
-	uint8_t     align_backward_adjustment(const void* pAddress, uint8_t pAlignment);
-
-	void*       add(void* pP, size_t pX);
-	const void* add(const void* pP, size_t pX);
-
-	void*       subtract(void* pP, size_t pX);
-	const void* subtract(const void* pP, size_t pX);
-}
-
 namespace wolf::system
 {
 	class w_allocator
@@ -93,12 +73,12 @@ namespace wolf::system
 	{
 		template <class T> T* allocate_new(w_allocator& pAllocator)
 		{
-			return new (pAllocator.allocate(sizeof(T), __alignof(T))) T;
+			return new (pAllocator.allocate(sizeof(T), alignof(T))) T;
 		}
 
 		template <class T> T* allocate_new(w_allocator& pAllocator, const T& pT)
 		{
-			return new (pAllocator.allocate(sizeof(T), __alignof(T))) T(pT);
+			return new (pAllocator.allocate(sizeof(T), alignof(T))) T(pT);
 		}
 
 		template<class T> void deallocate_delete(w_allocator& pAllocator, T& pObject)
@@ -109,19 +89,22 @@ namespace wolf::system
 
 		template<class T> T* allocate_array(w_allocator& pAllocator, size_t pLength)
 		{
-			ASSERT(pLength != 0);
+			assert(pLength != 0);
 
-			u8 headerSize = sizeof(size_t) / sizeof(T);
+			uint8_t _header_size = sizeof(size_t) / sizeof(T);
 
 			if (sizeof(size_t) % sizeof(T) > 0)
-				headerSize += 1;
+				_header_size += 1;
 
 			//Allocate extra space to store array length in the bytes before the array
-			T* p = ((T*)allocator.allocate(sizeof(T) * (length + headerSize), __alignof(T))) + headerSize;
+			auto _memory = (T*)pAllocator.allocate(sizeof(T) * (pLength + _header_size), alignof(T));
+			if (!_memory) return nullptr;
 
-			*(((size_t*)p) - 1) = length;
+			T* p = _memory + _header_size;
 
-			for (size_t i = 0; i < length; i++)
+			*(((size_t*)p) - 1) = pLength;
+
+			for (size_t i = 0; i < pLength; i++)
 				new (&p[i]) T;
 
 			return p;
@@ -129,20 +112,20 @@ namespace wolf::system
 
 		template<class T> void deallocate_array(w_allocator& pAllocator, T* pArray)
 		{
-			ASSERT(array != nullptr);
+			assert(pArray != nullptr);
 
-			size_t length = *(((size_t*)array) - 1);
+			size_t _length = *(((size_t*)pArray) - 1);
 
-			for (size_t i = 0; i < length; i++)
-				array[i].~T();
+			for (size_t i = 0; i < _length; i++)
+				pArray[i].~T();
 
 			//Calculate how much extra memory was allocated to store the length before the array
-			u8 headerSize = sizeof(size_t) / sizeof(T);
+			uint8_t _header_size = sizeof(size_t) / sizeof(T);
 
 			if (sizeof(size_t) % sizeof(T) > 0)
-				headerSize += 1;
+				_header_size += 1;
 
-			allocator.deallocate(array - headerSize);
+			pAllocator.deallocate(pArray - _header_size);
 		}
 	};
 
@@ -231,5 +214,3 @@ namespace wolf::system
 		}
 	};
 }
-
-#endif //__WIN32
\ No newline at end of file
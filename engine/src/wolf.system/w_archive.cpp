@@ -0,0 +1,522 @@
+#include "w_system_pch.h"
+#include "w_archive.h"
+#include "w_compress_data_type.h"
+#include "w_io.h"
+#include "w_directory_scanner.h"
+#include "lz4/lz4.h"
+#include "lz4/lz4hc.h"
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+
+using namespace wolf::system;
+
+//index is read in place, so it starts on this boundary
+#define W_ARCHIVE_INDEX_ALIGNMENT 8
+
+static_assert(sizeof(w_archive_header) == 48, "size of w_archive_header is a part of file format");
+static_assert(sizeof(w_archive_entry) == 48, "size of w_archive_entry is a part of file format");
+
+static std::string_view s_get_name(_In_ const char* pNames, _In_ const w_archive_entry& pEntry)
+{
+	return std::string_view(pNames + pEntry.name_offset, pEntry.name_size);
+}
+
+#pragma region w_archive
+
+w_archive::w_archive() :
+	_entries(nullptr),
+	_names(nullptr),
+	_entry_count(0)
+{
+}
+
+w_archive::~w_archive()
+{
+	close();
+}
+
+W_RESULT w_archive::open(_In_z_ const char* pPath)
+{
+	if (!pPath) return W_INVALIDARG;
+	close();
+
+	if (this->_file.open(pPath) != W_PASSED)
+	{
+		return W_FAILED;
+	}
+
+	const auto _data = this->_file.get_data();
+	const uint64_t _size = this->_file.get_size();
+	if (!_data || _size < sizeof(w_archive_header))
+	{
+		this->_file.close();
+		logger.error("archive {} is too small. trace info: w_archive::open", pPath);
+		return W_FAILED;
+	}
+
+	const auto _header = reinterpret_cast<const w_archive_header*>(_data);
+	if (_header->magic != W_ARCHIVE_MAGIC || _header->version != W_ARCHIVE_VERSION)
+	{
+		this->_file.close();
+		logger.error("{} is not an archive of version {}. trace info: w_archive::open", pPath, W_ARCHIVE_VERSION);
+		return W_FAILED;
+	}
+
+	//every offset is checked once here, lookups trust the index
+	const auto _index_size = static_cast<uint64_t>(_header->entry_count) * sizeof(w_archive_entry);
+	bool _is_valid = _header->file_size == _size &&
+		_header->index_offset % W_ARCHIVE_INDEX_ALIGNMENT == 0 &&
+		_header->index_offset <= _size && _index_size <= _size - _header->index_offset &&
+		_header->names_offset <= _size && _header->names_size <= _size - _header->names_offset;
+
+	const auto _entries = _is_valid ? reinterpret_cast<const w_archive_entry*>(_data + _header->index_offset) : nullptr;
+	for (uint32_t i = 0; _is_valid && i < _header->entry_count; ++i)
+	{
+		const auto& _entry = _entries[i];
+		_is_valid =
+			_entry.offset <= _size && _entry.size <= _size - _entry.offset &&
+			_entry.name_offset <= _header->names_size && _entry.name_size <= _header->names_size - _entry.name_offset &&
+			(i == 0 || _entries[i - 1].hash <= _entry.hash) &&
+			((_entry.flags == W_ARCHIVE_ENTRY_STORED && _entry.size == _entry.original_size) ||
+			(_entry.flags == W_ARCHIVE_ENTRY_LZ4 && _entry.size <= INT_MAX && _entry.original_size <= INT_MAX));
+	}
+	if (!_is_valid)
+	{
+		this->_file.close();
+		logger.error("archive {} is corrupted. trace info: w_archive::open", pPath);
+		return W_FAILED;
+	}
+
+	this->_path = pPath;
+	this->_entries = _entries;
+	this->_names = _data + _header->names_offset;
+	this->_entry_count = _header->entry_count;
+
+	//index is touched by every lookup
+	this->_file.advise(w_mapped_file_advice::WILL_NEED, static_cast<size_t>(_header->index_offset), static_cast<size_t>(_index_size));
+	return W_PASSED;
+}
+
+void w_archive::close()
+{
+	this->_file.close();
+	this->_path.clear();
+	this->_entries = nullptr;
+	this->_names = nullptr;
+	this->_entry_count = 0;
+}
+
+const w_archive_entry* w_archive::find(_In_z_ const char* pPath) const
+{
+	if (!pPath || !this->_entry_count) return nullptr;
+
+	const auto _path = normalize_path(pPath);
+	const auto _hash = get_hash(_path.c_str(), _path.size());
+
+	auto _end = this->_entries + this->_entry_count;
+	auto _iter = std::lower_bound(this->_entries, _end, _hash, [](const w_archive_entry& pEntry, const uint64_t& pHash)
+	{
+		return pEntry.hash < pHash;
+	});
+	for (; _iter != _end && _iter->hash == _hash; ++_iter)
+	{
+		if (s_get_name(this->_names, *_iter) == _path)
+		{
+			return _iter;
+		}
+	}
+	return nullptr;
+}
+
+const char* w_archive::get_data(_In_ const w_archive_entry* pEntry) const
+{
+	if (!pEntry || pEntry->flags != W_ARCHIVE_ENTRY_STORED || !this->_file.get_data()) return nullptr;
+	return this->_file.get_data() + pEntry->offset;
+}
+
+W_RESULT w_archive::read(_In_ const w_archive_entry* pEntry, _Inout_ char* pDestination, _In_ const size_t& pDestinationSize) const
+{
+	if (!pEntry || (!pDestination && pEntry->original_size) || pDestinationSize < pEntry->original_size) return W_INVALIDARG;
+	if (!pEntry->original_size) return W_PASSED;
+
+	const auto _src = this->_file.get_data() + pEntry->offset;
+	if (pEntry->flags == W_ARCHIVE_ENTRY_STORED)
+	{
+		std::memcpy(pDestination, _src, static_cast<size_t>(pEntry->size));
+		return W_PASSED;
+	}
+
+	const auto _size = LZ4_decompress_safe(
+		_src,
+		pDestination,
+		static_cast<int>(pEntry->size),
+		static_cast<int>(pEntry->original_size));
+	if (_size < 0 || static_cast<uint64_t>(_size) != pEntry->original_size)
+	{
+		logger.error("could not decompress {} of archive {}. trace info: w_archive::read", get_entry_path(pEntry), this->_path);
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
+
+W_RESULT w_archive::advise(_In_ const w_archive_entry* pEntry, _In_ const w_mapped_file_advice& pAdvice) const
+{
+	if (!pEntry) return W_INVALIDARG;
+	if (!pEntry->size) return W_PASSED;
+
+	//advise does not change the mapping, only hints for its pages
+	return const_cast<w_mapped_file&>(this->_file).advise(
+		pAdvice,
+		static_cast<size_t>(pEntry->offset),
+		static_cast<size_t>(pEntry->size));
+}
+
+std::string w_archive::normalize_path(_In_z_ const char* pPath)
+{
+	std::string _path;
+	if (!pPath) return _path;
+
+	const char* _component = pPath;
+	for (const char* _ptr = pPath; ; ++_ptr)
+	{
+		if (*_ptr != '/' && *_ptr != '\\' && *_ptr != '\0') continue;
+
+		const auto _length = static_cast<size_t>(_ptr - _component);
+		if (_length == 2 && _component[0] == '.' && _component[1] == '.')
+		{
+			//remove the last component
+			const auto _pos = _path.find_last_of('/');
+			_path.erase(_pos == std::string::npos ? 0 : _pos);
+		}
+		else if (_length && !(_length == 1 && _component[0] == '.'))
+		{
+			if (!_path.empty())
+			{
+				_path.push_back('/');
+			}
+			_path.append(_component, _length);
+		}
+
+		if (*_ptr == '\0') break;
+		_component = _ptr + 1;
+	}
+	return _path;
+}
+
+uint64_t w_archive::get_hash(_In_z_ const char* pNormalizedPath, _In_ const size_t& pLength)
+{
+	uint64_t _hash = 14695981039346656037ull;
+	for (size_t i = 0; i < pLength; ++i)
+	{
+		_hash ^= static_cast<uint8_t>(pNormalizedPath[i]);
+		_hash *= 1099511628211ull;
+	}
+	return _hash;
+}
+
+#pragma region Getters
+
+bool w_archive::get_is_open() const
+{
+	return this->_file.get_is_open();
+}
+
+uint32_t w_archive::get_entry_count() const
+{
+	return this->_entry_count;
+}
+
+const w_archive_entry* w_archive::get_entry(_In_ const uint32_t& pIndex) const
+{
+	if (pIndex >= this->_entry_count) return nullptr;
+	return &this->_entries[pIndex];
+}
+
+std::string w_archive::get_entry_path(_In_ const w_archive_entry* pEntry) const
+{
+	if (!pEntry || !this->_names) return "";
+	return std::string(s_get_name(this->_names, *pEntry));
+}
+
+const std::string& w_archive::get_path() const
+{
+	return this->_path;
+}
+
+#pragma endregion
+
+#pragma endregion
+
+#pragma region w_archive_writer
+
+static bool s_is_valid_alignment(_In_ const uint32_t& pAlignment)
+{
+	//0 means alignment of archive
+	return (pAlignment & (pAlignment - 1)) == 0;
+}
+
+w_archive_writer::w_archive_writer()
+{
+}
+
+w_archive_writer::~w_archive_writer()
+{
+	clear();
+}
+
+W_RESULT w_archive_writer::add(
+	_In_z_ const char* pPath,
+	_In_ const char* pData,
+	_In_ const size_t& pSize,
+	_In_ const bool& pCompress,
+	_In_ const uint32_t& pAlignment)
+{
+	if (!pPath || (!pData && pSize) || !s_is_valid_alignment(pAlignment)) return W_INVALIDARG;
+
+	w_pending_entry _entry;
+	_entry.path = w_archive::normalize_path(pPath);
+	if (_entry.path.empty()) return W_INVALIDARG;
+
+	if (pSize)
+	{
+		_entry.data.assign(pData, pData + pSize);
+	}
+	_entry.compress = pCompress;
+	_entry.alignment = pAlignment;
+	this->_entries.push_back(std::move(_entry));
+	return W_PASSED;
+}
+
+W_RESULT w_archive_writer::add_file(
+	_In_z_ const char* pPath,
+	_In_z_ const char* pFilePath,
+	_In_ const bool& pCompress,
+	_In_ const uint32_t& pAlignment)
+{
+	if (!pPath || !pFilePath || !s_is_valid_alignment(pAlignment)) return W_INVALIDARG;
+
+	w_pending_entry _entry;
+	_entry.path = w_archive::normalize_path(pPath);
+	if (_entry.path.empty()) return W_INVALIDARG;
+
+	_entry.file_path = pFilePath;
+	_entry.compress = pCompress;
+	_entry.alignment = pAlignment;
+	this->_entries.push_back(std::move(_entry));
+	return W_PASSED;
+}
+
+W_RESULT w_archive_writer::add_directory(
+	_In_z_ const char* pDirectory,
+	_In_z_ const char* pPrefix,
+	_In_ const std::function<bool(const std::string&)>& pCompress)
+{
+	if (!pDirectory || !pPrefix) return W_INVALIDARG;
+	if (io::get_is_directory(pDirectory) != W_PASSED)
+	{
+		logger.error("directory {} does not exist. trace info: w_archive_writer::add_directory", pDirectory);
+		return W_FAILED;
+	}
+
+	std::string _directory = pDirectory;
+	if (!_directory.empty() && _directory.back() != '/' && _directory.back() != '\\')
+	{
+		_directory.push_back('/');
+	}
+	const auto _prefix = w_archive::normalize_path(pPrefix);
+
+	//listings are not cached, archives are built from what is on disk now
+	w_directory_scanner_config _config;
+	_config.use_cache = false;
+
+	w_directory_scanner _scanner;
+	_scanner.initialize(_config);
+
+	//sorted paths keep archives of same content identical
+	std::vector<w_directory_entry> _files;
+	if (_scanner.scan(pDirectory, _files) != W_PASSED)
+	{
+		return W_FAILED;
+	}
+
+	for (auto& _file : _files)
+	{
+		const auto _path = _directory + _file.path;
+		const auto _relative = _prefix.empty() ? _file.path : _prefix + "/" + _file.path;
+		const auto _compress = pCompress ? pCompress(_relative) : false;
+		if (add_file(_relative.c_str(), _path.c_str(), _compress) != W_PASSED)
+		{
+			return W_FAILED;
+		}
+	}
+	return W_PASSED;
+}
+
+W_RESULT w_archive_writer::save(_In_z_ const char* pPath, _In_ const uint32_t& pAlignment)
+{
+	if (!pPath || !pAlignment || !s_is_valid_alignment(pAlignment)) return W_INVALIDARG;
+	if (this->_entries.size() > UINT32_MAX) return W_INVALIDARG;
+
+	//check paths before anything is written
+	std::vector<std::string_view> _paths;
+	_paths.reserve(this->_entries.size());
+	for (auto& _pending : this->_entries)
+	{
+		_paths.push_back(_pending.path);
+	}
+	std::sort(_paths.begin(), _paths.end());
+	const auto _duplicate = std::adjacent_find(_paths.begin(), _paths.end());
+	if (_duplicate != _paths.end())
+	{
+		logger.error("{} was added to archive {} more than once. trace info: w_archive_writer::save",
+			std::string(*_duplicate), pPath);
+		return W_FAILED;
+	}
+
+	//write to a temporary file and replace, so a failure does not leave a partial archive
+	const auto _temp_path = std::string(pPath) + ".tmp";
+	std::ofstream _stream(_temp_path, std::ios::binary | std::ios::trunc);
+	if (!_stream)
+	{
+		logger.error("could not create archive {}. trace info: w_archive_writer::save", _temp_path);
+		return W_FAILED;
+	}
+
+	const char _zeros[W_ARCHIVE_DEFAULT_ALIGNMENT * 256] = {};
+	uint64_t _offset = 0;
+	auto _write = [&](_In_ const char* pData, _In_ const uint64_t& pSize)
+	{
+		if (pSize)
+		{
+			_stream.write(pData, static_cast<std::streamsize>(pSize));
+		}
+		_offset += pSize;
+	};
+	auto _pad = [&](_In_ const uint64_t& pAlignment)
+	{
+		auto _padding = (pAlignment - _offset % pAlignment) % pAlignment;
+		while (_padding)
+		{
+			const auto _chunk = std::min<uint64_t>(_padding, sizeof(_zeros));
+			_write(_zeros, _chunk);
+			_padding -= _chunk;
+		}
+	};
+
+	w_archive_header _header = {};
+	_write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+
+	std::vector<w_archive_entry> _index;
+	_index.reserve(this->_entries.size());
+	std::string _names;
+	std::vector<char> _compressed;
+
+	for (auto& _pending : this->_entries)
+	{
+		w_mapped_file _file;
+		const char* _data = _pending.data.data();
+		size_t _size = _pending.data.size();
+		if (!_pending.file_path.empty())
+		{
+			if (_file.open(_pending.file_path.c_str()) != W_PASSED)
+			{
+				logger.error("could not read {} for archive {}. trace info: w_archive_writer::save", _pending.file_path, pPath);
+				_stream.close();
+				std::remove(_temp_path.c_str());
+				return W_FAILED;
+			}
+			_file.advise(w_mapped_file_advice::SEQUENTIAL);
+			_data = _file.get_data();
+			_size = _file.get_size();
+		}
+
+		w_archive_entry _entry = {};
+		_entry.hash = w_archive::get_hash(_pending.path.c_str(), _pending.path.size());
+		_entry.original_size = _size;
+		_entry.size = _size;
+		_entry.flags = W_ARCHIVE_ENTRY_STORED;
+		_entry.alignment = _pending.alignment ? _pending.alignment : pAlignment;
+		_entry.name_offset = static_cast<uint32_t>(_names.size());
+		_entry.name_size = static_cast<uint32_t>(_pending.path.size());
+		_names += _pending.path;
+
+		if (_pending.compress && _size && _size <= LZ4_MAX_INPUT_SIZE)
+		{
+			_compressed.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(_size))));
+			const auto _compressed_size = LZ4_compress_HC(
+				_data,
+				_compressed.data(),
+				static_cast<int>(_size),
+				static_cast<int>(_compressed.size()),
+				W_COMPRESS_HC_LEVEL_DEFAULT);
+			//keep it only if it saves enough to pay for decompression
+			if (_compressed_size > 0 && static_cast<size_t>(_compressed_size) < _size - _size / 8)
+			{
+				_data = _compressed.data();
+				_entry.size = static_cast<uint64_t>(_compressed_size);
+				_entry.flags = W_ARCHIVE_ENTRY_LZ4;
+			}
+		}
+
+		_pad(_entry.alignment);
+		_entry.offset = _offset;
+		_write(_data, _entry.size);
+		_index.push_back(_entry);
+	}
+
+	std::sort(_index.begin(), _index.end(), [&_names](const w_archive_entry& pLeft, const w_archive_entry& pRight)
+	{
+		if (pLeft.hash != pRight.hash) return pLeft.hash < pRight.hash;
+		return s_get_name(_names.data(), pLeft) < s_get_name(_names.data(), pRight);
+	});
+
+	_pad(W_ARCHIVE_INDEX_ALIGNMENT);
+	_header.index_offset = _offset;
+	_write(reinterpret_cast<const char*>(_index.data()), _index.size() * sizeof(w_archive_entry));
+	_header.names_offset = _offset;
+	_header.names_size = _names.size();
+	_write(_names.data(), _names.size());
+
+	_header.magic = W_ARCHIVE_MAGIC;
+	_header.version = W_ARCHIVE_VERSION;
+	_header.entry_count = static_cast<uint32_t>(_index.size());
+	_header.alignment = pAlignment;
+	_header.file_size = _offset;
+	_stream.seekp(0);
+	_stream.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+	_stream.close();
+
+	if (!_stream)
+	{
+		logger.error("could not write archive {}. trace info: w_archive_writer::save", _temp_path);
+		std::remove(_temp_path.c_str());
+		return W_FAILED;
+	}
+#if defined(__WIN32) || defined(_MSC_VER)
+	std::remove(pPath);
+#endif
+	if (std::rename(_temp_path.c_str(), pPath) != 0)
+	{
+		logger.error("could not replace archive {}. trace info: w_archive_writer::save", pPath);
+		std::remove(_temp_path.c_str());
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
+
+void w_archive_writer::clear()
+{
+	this->_entries.clear();
+}
+
+#pragma region Getters
+
+size_t w_archive_writer::get_entry_count() const
+{
+	return this->_entries.size();
+}
+
+#pragma endregion
+
+#pragma endregion
@@ -0,0 +1,161 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_archive.h
+	Description		 : Packed content archive, entries are found by a sorted index of hashed paths and read from a mapped file
+	Comment          : Layout is header, aligned entries, index and names. Index and names are used in place from the mapping.
+					   Paths are relative to root of archive with '/' separators, each entry may be compressed with lz4 hc.
+					   Fields are little endian
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include "w_mapped_file.h"
+#include <functional>
+
+//"WPAK"
+#define W_ARCHIVE_MAGIC					0x4B415057
+#define W_ARCHIVE_VERSION				1
+#define W_ARCHIVE_DEFAULT_ALIGNMENT		16
+
+namespace wolf::system
+{
+	enum w_archive_entry_flag
+	{
+		W_ARCHIVE_ENTRY_STORED = 0,
+		//lz4 block of original_size bytes
+		W_ARCHIVE_ENTRY_LZ4 = 1
+	};
+
+	struct w_archive_header
+	{
+		uint32_t	magic;
+		uint32_t	version;
+		uint32_t	entry_count;
+		uint32_t	alignment;
+		uint64_t	index_offset;
+		uint64_t	names_offset;
+		uint64_t	names_size;
+		uint64_t	file_size;
+	};
+
+	//entries of index are sorted by hash and then by path
+	struct w_archive_entry
+	{
+		uint64_t	hash;
+		uint64_t	offset;
+		//stored bytes
+		uint64_t	size;
+		uint64_t	original_size;
+		uint32_t	name_offset;
+		uint32_t	name_size;
+		uint32_t	flags;
+		uint32_t	alignment;
+	};
+
+	class w_archive
+	{
+	public:
+		WSYS_EXP w_archive();
+		WSYS_EXP ~w_archive();
+
+		WSYS_EXP W_RESULT open(_In_z_ const char* pPath);
+		WSYS_EXP void close();
+
+		//find an entry by its path inside archive, returns nullptr if it does not exist
+		WSYS_EXP const w_archive_entry* find(_In_z_ const char* pPath) const;
+
+		//pages of a stored entry in place, nullptr for compressed entries
+		WSYS_EXP const char* get_data(_In_ const w_archive_entry* pEntry) const;
+		//copy or decompress entry to pDestination, which has original_size bytes
+		WSYS_EXP W_RESULT read(_In_ const w_archive_entry* pEntry, _Inout_ char* pDestination, _In_ const size_t& pDestinationSize) const;
+		//hint for the pages of an entry
+		WSYS_EXP W_RESULT advise(_In_ const w_archive_entry* pEntry, _In_ const w_mapped_file_advice& pAdvice) const;
+
+		//convert separators to '/' and remove "." components and separators from begining
+		WSYS_EXP static std::string normalize_path(_In_z_ const char* pPath);
+		//fnv-1a of normalized path
+		WSYS_EXP static uint64_t get_hash(_In_z_ const char* pNormalizedPath, _In_ const size_t& pLength);
+
+#pragma region Getters
+		WSYS_EXP bool get_is_open() const;
+		WSYS_EXP uint32_t get_entry_count() const;
+		//entries in order of index
+		WSYS_EXP const w_archive_entry* get_entry(_In_ const uint32_t& pIndex) const;
+		WSYS_EXP std::string get_entry_path(_In_ const w_archive_entry* pEntry) const;
+		WSYS_EXP const std::string& get_path() const;
+#pragma endregion
+
+	private:
+		//Prevent copying
+		w_archive(w_archive const&);
+		w_archive& operator= (w_archive const&);
+
+		w_mapped_file                   _file;
+		std::string                     _path;
+		const w_archive_entry*          _entries;
+		const char*                     _names;
+		uint32_t                        _entry_count;
+	};
+
+	class w_archive_writer
+	{
+	public:
+		WSYS_EXP w_archive_writer();
+		WSYS_EXP ~w_archive_writer();
+
+		/*
+			add an entry from memory, pData is copied. Compressed entries are stored as they are,
+			if compression does not save an eighth of size. pAlignment 0 means alignment of archive
+		*/
+		WSYS_EXP W_RESULT add(
+			_In_z_ const char* pPath,
+			_In_ const char* pData,
+			_In_ const size_t& pSize,
+			_In_ const bool& pCompress = false,
+			_In_ const uint32_t& pAlignment = 0);
+
+		//add an entry which is read from pFilePath on save
+		WSYS_EXP W_RESULT add_file(
+			_In_z_ const char* pPath,
+			_In_z_ const char* pFilePath,
+			_In_ const bool& pCompress = false,
+			_In_ const uint32_t& pAlignment = 0);
+
+		/*
+			add all files of directory and its sub directories, paths are relative to pDirectory and start with pPrefix.
+			pCompress decides for each relative path, nullptr means no compression
+		*/
+		WSYS_EXP W_RESULT add_directory(
+			_In_z_ const char* pDirectory,
+			_In_z_ const char* pPrefix = "",
+			_In_ const std::function<bool(const std::string&)>& pCompress = nullptr);
+
+		//write archive, entries are written in order of adding them
+		WSYS_EXP W_RESULT save(_In_z_ const char* pPath, _In_ const uint32_t& pAlignment = W_ARCHIVE_DEFAULT_ALIGNMENT);
+
+		WSYS_EXP void clear();
+
+#pragma region Getters
+		WSYS_EXP size_t get_entry_count() const;
+#pragma endregion
+
+	private:
+		//Prevent copying
+		w_archive_writer(w_archive_writer const&);
+		w_archive_writer& operator= (w_archive_writer const&);
+
+		struct w_pending_entry
+		{
+			std::string         path;
+			std::vector<char>   data;
+			std::string         file_path;
+			bool                compress;
+			uint32_t            alignment;
+		};
+		std::vector<w_pending_entry>    _entries;
+	};
+}
@@ -0,0 +1,968 @@
+#include "w_system_pch.h"
+#include "w_async_io.h"
+#include "w_thread_pool.h"
+#include "w_convert.h"
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+
+#if !defined(__WIN32) && !defined(_MSC_VER)
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#if defined(__linux) && !defined(__ANDROID)
+#include <linux/io_uring.h>
+//IORING_OP_READ was added with this feature in 5.6
+#if defined(IORING_FEAT_RW_CUR_POS)
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#define W_ASYNC_IO_URING
+#endif
+#endif
+
+//reads are split to chunks of this size, io_uring and ReadFile take 32 bit lengths
+#define W_ASYNC_IO_MAX_CHUNK (1u << 30)
+
+namespace wolf::system
+{
+#if defined(__WIN32) || defined(_MSC_VER)
+	typedef HANDLE w_io_file;
+	static const w_io_file s_invalid_io_file = INVALID_HANDLE_VALUE;
+#else
+	typedef int w_io_file;
+	static const w_io_file s_invalid_io_file = -1;
+#endif
+
+	struct w_io_file_entry
+	{
+		w_io_file   file;
+		int         error;
+	};
+
+	struct w_io_batch_state
+	{
+		std::vector<w_io_request>                               requests;
+		std::vector<w_io_result>                                results;
+		std::function<void(const std::vector<w_io_result>&)>   on_completed;
+		//files of batch which are opened by submit for io_uring or by I/O threads, guarded by mutex
+		std::unordered_map<std::string, w_io_file_entry>        files;
+		std::atomic<size_t>                                     remaining{ 0 };
+		std::atomic<bool>                                       cancelled{ false };
+		std::mutex                                              mutex;
+		std::condition_variable                                 cv;
+		bool                                                    completed = false;
+		W_RESULT                                                status = W_PASSED;
+	};
+
+	struct w_io_op
+	{
+		std::shared_ptr<w_io_batch_state>   batch;
+		size_t                              index;
+		//bytes which were read so far, reads continue after short reads
+		size_t                              done;
+	};
+
+	class w_async_io_pimp
+	{
+	public:
+		w_async_io_pimp() :
+			_backend(w_async_io_backend::NONE),
+			_queue_depth(0),
+			_in_flight(0),
+			_queued(0),
+			_is_released(false)
+#ifdef W_ASYNC_IO_URING
+			, _ring(-1),
+			_event(-1),
+			_event_value(0),
+			_sq_entries(0),
+			_to_submit(0),
+			_sq_ring(nullptr),
+			_sq_ring_size(0),
+			_cq_ring(nullptr),
+			_cq_ring_size(0),
+			_sqes(nullptr),
+			_sqes_size(0)
+#endif
+		{
+		}
+
+		~w_async_io_pimp()
+		{
+			release();
+		}
+
+		W_RESULT initialize(_In_ const w_async_io_config& pConfig)
+		{
+			if (this->_backend != w_async_io_backend::NONE) return W_FAILED;
+
+			this->_queue_depth = std::max(pConfig.queue_depth, 1u);
+			this->_is_released = false;
+
+#ifdef W_ASYNC_IO_URING
+			if (pConfig.use_io_uring && _uring_setup() == W_PASSED)
+			{
+				this->_backend = w_async_io_backend::IO_URING;
+				this->_thread = std::thread(&w_async_io_pimp::_uring_loop, this);
+				return W_PASSED;
+			}
+#endif
+			const auto _workers = std::min(std::max(pConfig.worker_threads, 1u), this->_queue_depth);
+			this->_pool.allocate(_workers, w_thread_pool_mode::W_WORK_STEALING);
+			this->_backend = w_async_io_backend::THREAD_POOL;
+			return W_PASSED;
+		}
+
+		w_io_batch_handle submit(
+			_In_ std::vector<w_io_request>& pRequests,
+			_In_ const std::function<void(const std::vector<w_io_result>&)>& pOnCompleted)
+		{
+			w_io_batch_handle _handle;
+
+			auto _state = std::make_shared<w_io_batch_state>();
+			_state->requests = std::move(pRequests);
+			_state->on_completed = pOnCompleted;
+			_state->results.resize(_state->requests.size());
+			for (size_t i = 0; i < _state->results.size(); ++i)
+			{
+				_state->results[i].index = i;
+			}
+			_state->remaining.store(_state->requests.size());
+
+#ifdef W_ASYNC_IO_URING
+			//open is blocking, so files are opened here instead of on the io_uring thread
+			if (this->_backend == w_async_io_backend::IO_URING)
+			{
+				int _error = 0;
+				for (const auto& _request : _state->requests)
+				{
+					if (_request.path.empty()) continue;
+					_get_file(_state, _request.path, _error);
+				}
+			}
+#endif
+
+			std::vector<w_io_op*> _invalids;
+			size_t _valids = 0;
+			{
+				std::lock_guard<std::mutex> _lock(this->_mutex);
+				if (this->_backend == w_async_io_backend::NONE || this->_is_released)
+				{
+					logger.error("async io service is not initialized. trace info: w_async_io::submit");
+					_close_files(_state);
+					return _handle;
+				}
+				for (size_t i = 0; i < _state->requests.size(); ++i)
+				{
+					auto _op = new w_io_op{ _state, i, 0 };
+					const auto& _request = _state->requests[i];
+					if (_request.path.empty() || (!_request.buffer && _request.size))
+					{
+						_invalids.push_back(_op);
+						continue;
+					}
+					this->_queues[_get_queue_index(_request.priority)].push_back(_op);
+					_valids++;
+				}
+				this->_queued += _valids;
+			}
+			_handle._state = _state;
+
+			for (auto _op : _invalids)
+			{
+				_complete(_op, W_INVALIDARG, EINVAL);
+			}
+			if (_state->requests.empty())
+			{
+				_finish(_state);
+			}
+			if (_valids)
+			{
+				_wake(_valids);
+			}
+			return _handle;
+		}
+
+		void release()
+		{
+			{
+				std::lock_guard<std::mutex> _lock(this->_mutex);
+				if (this->_backend == w_async_io_backend::NONE || this->_is_released) return;
+				this->_is_released = true;
+			}
+
+#ifdef W_ASYNC_IO_URING
+			if (this->_backend == w_async_io_backend::IO_URING)
+			{
+				//the loop cancels queued requests and exits after reads in flight
+				_wake(1);
+				if (this->_thread.joinable())
+				{
+					this->_thread.join();
+				}
+				_uring_release();
+			}
+#endif
+			if (this->_backend == w_async_io_backend::THREAD_POOL)
+			{
+				_cancel_queued();
+				this->_pool.release();
+			}
+			this->_backend = w_async_io_backend::NONE;
+		}
+
+#pragma region Getters
+		w_async_io_backend get_backend() const
+		{
+			return this->_backend;
+		}
+
+		uint32_t get_queue_depth() const
+		{
+			return this->_queue_depth;
+		}
+
+		size_t get_in_flight() const
+		{
+			return this->_in_flight.load();
+		}
+
+		size_t get_queued()
+		{
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+			return this->_queued;
+		}
+#pragma endregion
+
+	private:
+		static size_t _get_queue_index(_In_ const w_io_priority& pPriority)
+		{
+			//the first queue is served first
+			switch (pPriority)
+			{
+			case w_io_priority::HIGH:
+				return 0;
+			case w_io_priority::LOW:
+				return 2;
+			default:
+				return 1;
+			}
+		}
+
+		//must be called while _mutex is locked
+		bool _pop(_Inout_ w_io_op*& pOp)
+		{
+			for (auto& _queue : this->_queues)
+			{
+				if (!_queue.empty())
+				{
+					pOp = _queue.front();
+					_queue.pop_front();
+					this->_queued--;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void _wake(_In_ const size_t& pCount)
+		{
+#ifdef W_ASYNC_IO_URING
+			if (this->_backend == w_async_io_backend::IO_URING)
+			{
+				uint64_t _value = 1;
+				if (write(this->_event, &_value, sizeof(_value)) < 0)
+				{
+					logger.error("could not wake io_uring thread. trace info: w_async_io::_wake");
+				}
+				return;
+			}
+#endif
+			//each job reads the request with highest priority at the time it runs
+			for (size_t i = 0; i < pCount; ++i)
+			{
+				this->_pool.add_job([this]()
+				{
+					_pool_read_one();
+				});
+			}
+		}
+
+		void _cancel_queued()
+		{
+			std::vector<w_io_op*> _ops;
+			{
+				std::lock_guard<std::mutex> _lock(this->_mutex);
+				w_io_op* _op = nullptr;
+				while (_pop(_op))
+				{
+					_ops.push_back(_op);
+				}
+			}
+			for (auto _op : _ops)
+			{
+				_complete(_op, W_FAILED, ECANCELED);
+			}
+		}
+
+		w_io_file _get_file(_In_ const std::shared_ptr<w_io_batch_state>& pBatch, _In_ const std::string& pPath, _Inout_ int& pError)
+		{
+			std::lock_guard<std::mutex> _lock(pBatch->mutex);
+
+			auto _iter = pBatch->files.find(pPath);
+			if (_iter != pBatch->files.end())
+			{
+				pError = _iter->second.error;
+				return _iter->second.file;
+			}
+
+			w_io_file_entry _entry = { s_invalid_io_file, 0 };
+#if defined(__WIN32) || defined(_MSC_VER)
+			_entry.file = CreateFileW(
+				convert::from_utf8(pPath).c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL,
+				nullptr);
+			if (_entry.file == s_invalid_io_file)
+			{
+				_entry.error = static_cast<int>(GetLastError());
+			}
+#else
+			_entry.file = open(pPath.c_str(), O_RDONLY | O_CLOEXEC);
+			if (_entry.file == s_invalid_io_file)
+			{
+				_entry.error = errno;
+			}
+#endif
+			pBatch->files[pPath] = _entry;
+			pError = _entry.error;
+			return _entry.file;
+		}
+
+		void _complete(_In_ w_io_op* pOp, _In_ const W_RESULT& pStatus, _In_ const int& pError)
+		{
+			auto _batch = std::move(pOp->batch);
+			auto& _result = _batch->results[pOp->index];
+			_result.status = pStatus;
+			_result.bytes_read = pOp->done;
+			_result.error = pError;
+
+			const auto& _callback = _batch->requests[pOp->index].on_completed;
+			delete pOp;
+
+			if (_callback)
+			{
+				_callback(_result);
+			}
+			if (_batch->remaining.fetch_sub(1) == 1)
+			{
+				_finish(_batch);
+			}
+		}
+
+		void _close_files(_In_ const std::shared_ptr<w_io_batch_state>& pBatch)
+		{
+			for (auto& _iter : pBatch->files)
+			{
+				if (_iter.second.file == s_invalid_io_file) continue;
+#if defined(__WIN32) || defined(_MSC_VER)
+				CloseHandle(_iter.second.file);
+#else
+				close(_iter.second.file);
+#endif
+			}
+			pBatch->files.clear();
+		}
+
+		void _finish(_In_ const std::shared_ptr<w_io_batch_state>& pBatch)
+		{
+			_close_files(pBatch);
+
+			W_RESULT _status = W_PASSED;
+			for (auto& _result : pBatch->results)
+			{
+				if (_result.status != W_PASSED)
+				{
+					_status = W_FAILED;
+					break;
+				}
+			}
+			pBatch->status = _status;
+
+			if (pBatch->on_completed)
+			{
+				pBatch->on_completed(pBatch->results);
+			}
+
+			{
+				std::lock_guard<std::mutex> _lock(pBatch->mutex);
+				pBatch->completed = true;
+			}
+			pBatch->cv.notify_all();
+		}
+
+#pragma region thread pool
+		void _pool_read_one()
+		{
+			w_io_op* _op = nullptr;
+			{
+				std::lock_guard<std::mutex> _lock(this->_mutex);
+				if (!_pop(_op)) return;
+			}
+			if (_op->batch->cancelled.load())
+			{
+				_complete(_op, W_FAILED, ECANCELED);
+				return;
+			}
+
+			this->_in_flight++;
+
+			const auto& _request = _op->batch->requests[_op->index];
+			int _error = 0;
+			auto _file = _get_file(_op->batch, _request.path, _error);
+			while (_file != s_invalid_io_file && _op->done < _request.size)
+			{
+				const auto _offset = _request.offset + _op->done;
+				const auto _chunk = std::min(_request.size - _op->done, static_cast<size_t>(W_ASYNC_IO_MAX_CHUNK));
+#if defined(__WIN32) || defined(_MSC_VER)
+				OVERLAPPED _overlapped = {};
+				_overlapped.Offset = static_cast<DWORD>(_offset);
+				_overlapped.OffsetHigh = static_cast<DWORD>(_offset >> 32);
+				DWORD _read = 0;
+				if (!ReadFile(_file, _request.buffer + _op->done, static_cast<DWORD>(_chunk), &_read, &_overlapped))
+				{
+					const auto _last_error = GetLastError();
+					if (_last_error != ERROR_HANDLE_EOF)
+					{
+						_error = static_cast<int>(_last_error);
+					}
+					break;
+				}
+#else
+				const auto _read = pread(_file, _request.buffer + _op->done, _chunk, static_cast<off_t>(_offset));
+				if (_read < 0)
+				{
+					if (errno == EINTR) continue;
+					_error = errno;
+					break;
+				}
+#endif
+				//end of file
+				if (_read == 0) break;
+				_op->done += static_cast<size_t>(_read);
+			}
+
+			this->_in_flight--;
+			_complete(_op, _error ? W_FAILED : W_PASSED, _error);
+		}
+#pragma endregion
+
+#ifdef W_ASYNC_IO_URING
+#pragma region io_uring
+		W_RESULT _uring_setup()
+		{
+			io_uring_params _params;
+			std::memset(&_params, 0, sizeof(_params));
+
+			//one more entry for the read of eventfd which wakes the loop
+			this->_ring = static_cast<int>(syscall(__NR_io_uring_setup, this->_queue_depth + 1, &_params));
+			if (this->_ring < 0)
+			{
+				logger.warning("io_uring is not available, errno {}. falling back to thread pool. trace info: w_async_io::initialize", errno);
+				this->_ring = -1;
+				return W_FAILED;
+			}
+
+			//IORING_OP_READ needs 5.6, probing needs it too
+			const size_t _probe_size = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+			auto _probe = static_cast<io_uring_probe*>(calloc(1, _probe_size));
+			bool _has_read = false;
+			if (_probe)
+			{
+				if (syscall(__NR_io_uring_register, this->_ring, IORING_REGISTER_PROBE, _probe, 256) >= 0)
+				{
+					_has_read = _probe->last_op >= IORING_OP_READ &&
+						(_probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+				}
+				free(_probe);
+			}
+			if (!_has_read)
+			{
+				logger.warning("io_uring does not support read operation. falling back to thread pool. trace info: w_async_io::initialize");
+				_uring_release();
+				return W_FAILED;
+			}
+
+			this->_sq_entries = _params.sq_entries;
+			this->_sq_ring_size = _params.sq_off.array + _params.sq_entries * sizeof(uint32_t);
+			this->_cq_ring_size = _params.cq_off.cqes + _params.cq_entries * sizeof(io_uring_cqe);
+			const bool _single_mmap = (_params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (_single_mmap)
+			{
+				this->_sq_ring_size = this->_cq_ring_size = std::max(this->_sq_ring_size, this->_cq_ring_size);
+			}
+
+			this->_sq_ring = mmap(nullptr, this->_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->_ring, IORING_OFF_SQ_RING);
+			if (this->_sq_ring == MAP_FAILED)
+			{
+				this->_sq_ring = nullptr;
+				logger.error("could not map submission queue of io_uring. trace info: w_async_io::initialize");
+				_uring_release();
+				return W_FAILED;
+			}
+			if (_single_mmap)
+			{
+				this->_cq_ring = this->_sq_ring;
+			}
+			else
+			{
+				this->_cq_ring = mmap(nullptr, this->_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->_ring, IORING_OFF_CQ_RING);
+				if (this->_cq_ring == MAP_FAILED)
+				{
+					this->_cq_ring = nullptr;
+					logger.error("could not map completion queue of io_uring. trace info: w_async_io::initialize");
+					_uring_release();
+					return W_FAILED;
+				}
+			}
+
+			this->_sqes_size = _params.sq_entries * sizeof(io_uring_sqe);
+			auto _sqes = mmap(nullptr, this->_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->_ring, IORING_OFF_SQES);
+			if (_sqes == MAP_FAILED)
+			{
+				logger.error("could not map submission entries of io_uring. trace info: w_async_io::initialize");
+				_uring_release();
+				return W_FAILED;
+			}
+			this->_sqes = static_cast<io_uring_sqe*>(_sqes);
+
+			auto _sq = static_cast<char*>(this->_sq_ring);
+			this->_sq_head = reinterpret_cast<unsigned*>(_sq + _params.sq_off.head);
+			this->_sq_tail = reinterpret_cast<unsigned*>(_sq + _params.sq_off.tail);
+			this->_sq_mask = *reinterpret_cast<unsigned*>(_sq + _params.sq_off.ring_mask);
+			this->_sq_array = reinterpret_cast<unsigned*>(_sq + _params.sq_off.array);
+
+			auto _cq = static_cast<char*>(this->_cq_ring);
+			this->_cq_head = reinterpret_cast<unsigned*>(_cq + _params.cq_off.head);
+			this->_cq_tail = reinterpret_cast<unsigned*>(_cq + _params.cq_off.tail);
+			this->_cq_mask = *reinterpret_cast<unsigned*>(_cq + _params.cq_off.ring_mask);
+			this->_cqes = reinterpret_cast<io_uring_cqe*>(_cq + _params.cq_off.cqes);
+
+			this->_event = eventfd(0, EFD_CLOEXEC);
+			if (this->_event < 0)
+			{
+				this->_event = -1;
+				logger.error("could not create eventfd for io_uring. trace info: w_async_io::initialize");
+				_uring_release();
+				return W_FAILED;
+			}
+
+			return W_PASSED;
+		}
+
+		void _uring_release()
+		{
+			if (this->_sqes)
+			{
+				munmap(this->_sqes, this->_sqes_size);
+				this->_sqes = nullptr;
+			}
+			if (this->_cq_ring && this->_cq_ring != this->_sq_ring)
+			{
+				munmap(this->_cq_ring, this->_cq_ring_size);
+			}
+			this->_cq_ring = nullptr;
+			if (this->_sq_ring)
+			{
+				munmap(this->_sq_ring, this->_sq_ring_size);
+				this->_sq_ring = nullptr;
+			}
+			//closing ring cancels the pending read of eventfd, so close it first
+			if (this->_ring >= 0)
+			{
+				close(this->_ring);
+				this->_ring = -1;
+			}
+			if (this->_event >= 0)
+			{
+				close(this->_event);
+				this->_event = -1;
+			}
+		}
+
+		//reads in flight never exceed the queue depth, so submission queue can not be full
+		void _uring_prepare_read(_In_ const int& pFile, _In_ void* pBuffer, _In_ const uint32_t& pSize, _In_ const uint64_t& pOffset, _In_ const uint64_t& pUserData)
+		{
+			const auto _tail = *this->_sq_tail;
+			const auto _index = _tail & this->_sq_mask;
+
+			auto _sqe = &this->_sqes[_index];
+			std::memset(_sqe, 0, sizeof(io_uring_sqe));
+			_sqe->opcode = IORING_OP_READ;
+			_sqe->fd = pFile;
+			_sqe->addr = reinterpret_cast<uint64_t>(pBuffer);
+			_sqe->len = pSize;
+			_sqe->off = pOffset;
+			_sqe->user_data = pUserData;
+
+			this->_sq_array[_index] = _index;
+			__atomic_store_n(this->_sq_tail, _tail + 1, __ATOMIC_RELEASE);
+			this->_to_submit++;
+		}
+
+		void _uring_prepare_wake()
+		{
+			//user data 0 marks the read of eventfd
+			_uring_prepare_read(this->_event, &this->_event_value, sizeof(this->_event_value), 0, 0);
+		}
+
+		//returns false if the request was completed without reading
+		bool _uring_issue(_In_ w_io_op* pOp)
+		{
+			const auto& _request = pOp->batch->requests[pOp->index];
+			if (pOp->done >= _request.size)
+			{
+				_complete(pOp, W_PASSED, 0);
+				return false;
+			}
+
+			int _error = 0;
+			auto _file = _get_file(pOp->batch, _request.path, _error);
+			if (_file == s_invalid_io_file)
+			{
+				_complete(pOp, W_FAILED, _error);
+				return false;
+			}
+
+			const auto _chunk = std::min(_request.size - pOp->done, static_cast<size_t>(W_ASYNC_IO_MAX_CHUNK));
+			_uring_prepare_read(
+				_file,
+				_request.buffer + pOp->done,
+				static_cast<uint32_t>(_chunk),
+				_request.offset + pOp->done,
+				reinterpret_cast<uint64_t>(pOp));
+			return true;
+		}
+
+		void _uring_loop()
+		{
+			std::vector<w_io_op*> _ops;
+			std::vector<w_io_op*> _cancelled;
+
+			_uring_prepare_wake();
+			for (;;)
+			{
+				bool _is_released;
+				{
+					std::lock_guard<std::mutex> _lock(this->_mutex);
+					_is_released = this->_is_released;
+					w_io_op* _op = nullptr;
+					while (!_is_released && this->_in_flight.load() + _ops.size() < this->_queue_depth && _pop(_op))
+					{
+						if (_op->batch->cancelled.load())
+						{
+							_cancelled.push_back(_op);
+						}
+						else
+						{
+							_ops.push_back(_op);
+						}
+					}
+				}
+
+				for (auto _op : _cancelled)
+				{
+					_complete(_op, W_FAILED, ECANCELED);
+				}
+				_cancelled.clear();
+
+				if (_is_released)
+				{
+					_cancel_queued();
+					//the read of eventfd is cancelled by closing the ring
+					if (this->_in_flight.load() == 0) break;
+				}
+
+				for (auto _op : _ops)
+				{
+					//count it first, callbacks of completed requests may check it
+					this->_in_flight++;
+					if (!_uring_issue(_op))
+					{
+						this->_in_flight--;
+					}
+				}
+				_ops.clear();
+
+				//submit new reads and wait for at least one completion, a write to eventfd wakes us up
+				const auto _submitted = syscall(__NR_io_uring_enter, this->_ring, this->_to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+				if (_submitted < 0)
+				{
+					if (errno != EINTR && errno != EBUSY && errno != EAGAIN)
+					{
+						logger.error("io_uring_enter failed with errno {}. trace info: w_async_io::_uring_loop", errno);
+					}
+				}
+				else
+				{
+					this->_to_submit -= static_cast<unsigned>(_submitted);
+				}
+
+				_uring_reap();
+			}
+		}
+
+		void _uring_reap()
+		{
+			auto _head = *this->_cq_head;
+			const auto _tail = __atomic_load_n(this->_cq_tail, __ATOMIC_ACQUIRE);
+
+			std::vector<std::pair<uint64_t, int>> _completions;
+			for (; _head != _tail; ++_head)
+			{
+				const auto& _cqe = this->_cqes[_head & this->_cq_mask];
+				_completions.push_back(std::make_pair(static_cast<uint64_t>(_cqe.user_data), _cqe.res));
+			}
+			//release slots before callbacks run
+			__atomic_store_n(this->_cq_head, _head, __ATOMIC_RELEASE);
+
+			for (auto& _completion : _completions)
+			{
+				if (_completion.first == 0)
+				{
+					_uring_prepare_wake();
+					continue;
+				}
+
+				auto _op = reinterpret_cast<w_io_op*>(_completion.first);
+				const auto _res = _completion.second;
+				if (_res < 0)
+				{
+					if (_res == -EAGAIN || _res == -EINTR)
+					{
+						if (!_uring_issue(_op))
+						{
+							this->_in_flight--;
+						}
+						continue;
+					}
+					this->_in_flight--;
+					_complete(_op, W_FAILED, -_res);
+				}
+				else if (_res == 0)
+				{
+					//end of file
+					this->_in_flight--;
+					_complete(_op, W_PASSED, 0);
+				}
+				else
+				{
+					//short reads continue from where they stopped
+					_op->done += static_cast<size_t>(_res);
+					if (!_uring_issue(_op))
+					{
+						this->_in_flight--;
+					}
+				}
+			}
+		}
+#pragma endregion
+#endif
+
+		w_async_io_backend                  _backend;
+		uint32_t                            _queue_depth;
+		std::atomic<size_t>                 _in_flight;
+		size_t                              _queued;
+		bool                                _is_released;
+		std::mutex                          _mutex;
+		//high, normal and low priorities
+		std::deque<w_io_op*>                _queues[3];
+
+		w_thread_pool                       _pool;
+
+#ifdef W_ASYNC_IO_URING
+		std::thread                         _thread;
+		int                                 _ring;
+		int                                 _event;
+		uint64_t                            _event_value;
+		unsigned                            _sq_entries;
+		unsigned                            _to_submit;
+		void*                               _sq_ring;
+		size_t                              _sq_ring_size;
+		void*                               _cq_ring;
+		size_t                              _cq_ring_size;
+		io_uring_sqe*                       _sqes;
+		size_t                              _sqes_size;
+		unsigned*                           _sq_head;
+		unsigned*                           _sq_tail;
+		unsigned                            _sq_mask;
+		unsigned*                           _sq_array;
+		unsigned*                           _cq_head;
+		unsigned*                           _cq_tail;
+		unsigned                            _cq_mask;
+		io_uring_cqe*                       _cqes;
+#endif
+	};
+}
+
+using namespace wolf::system;
+
+#pragma region w_io_batch_handle
+
+w_io_batch_handle::w_io_batch_handle()
+{
+}
+
+void w_io_batch_handle::wait() const
+{
+	if (!this->_state) return;
+
+	std::unique_lock<std::mutex> _lock(this->_state->mutex);
+	this->_state->cv.wait(_lock, [this]() { return this->_state->completed; });
+}
+
+std::future_status w_io_batch_handle::wait_for(_In_ const long long pMilliSeconds) const
+{
+	if (!this->_state) return std::future_status::ready;
+
+	std::unique_lock<std::mutex> _lock(this->_state->mutex);
+	return this->_state->cv.wait_for(
+		_lock,
+		std::chrono::milliseconds(pMilliSeconds),
+		[this]() { return this->_state->completed; }) ? std::future_status::ready : std::future_status::timeout;
+}
+
+W_RESULT w_io_batch_handle::get() const
+{
+	if (!this->_state) return W_FAILED;
+
+	wait();
+	return this->_state->status;
+}
+
+void w_io_batch_handle::cancel() const
+{
+	if (!this->_state) return;
+	this->_state->cancelled.store(true);
+}
+
+const std::vector<w_io_result>& w_io_batch_handle::get_results() const
+{
+	static const std::vector<w_io_result> s_empty;
+	if (!this->_state) return s_empty;
+
+	wait();
+	return this->_state->results;
+}
+
+bool w_io_batch_handle::get_is_completed() const
+{
+	if (!this->_state) return false;
+
+	std::lock_guard<std::mutex> _lock(this->_state->mutex);
+	return this->_state->completed;
+}
+
+bool w_io_batch_handle::get_is_valid() const
+{
+	return this->_state != nullptr;
+}
+
+#pragma endregion
+
+w_async_io::w_async_io() : _pimp(new w_async_io_pimp())
+{
+}
+
+w_async_io::~w_async_io()
+{
+	release();
+	SAFE_DELETE(this->_pimp);
+}
+
+W_RESULT w_async_io::initialize(_In_ const w_async_io_config& pConfig)
+{
+	if (!this->_pimp) return W_FAILED;
+	return this->_pimp->initialize(pConfig);
+}
+
+w_io_batch_handle w_async_io::submit(
+	_In_ std::vector<w_io_request> pRequests,
+	_In_ const std::function<void(const std::vector<w_io_result>&)>& pOnCompleted)
+{
+	if (!this->_pimp) return w_io_batch_handle();
+	return this->_pimp->submit(pRequests, pOnCompleted);
+}
+
+w_io_batch_handle w_async_io::read(
+	_In_z_ const char* pPath,
+	_In_ const uint64_t& pOffset,
+	_In_ char* pBuffer,
+	_In_ const size_t& pSize,
+	_In_ const w_io_priority& pPriority,
+	_In_ const std::function<void(const w_io_result&)>& pOnCompleted)
+{
+	std::vector<w_io_request> _requests(1);
+	auto& _request = _requests[0];
+	_request.path = pPath ? pPath : "";
+	_request.offset = pOffset;
+	_request.buffer = pBuffer;
+	_request.size = pSize;
+	_request.priority = pPriority;
+	_request.on_completed = pOnCompleted;
+	return submit(std::move(_requests));
+}
+
+void w_async_io::release()
+{
+	if (!this->_pimp) return;
+	this->_pimp->release();
+}
+
+#pragma region Getters
+
+w_async_io_backend w_async_io::get_backend() const
+{
+	if (!this->_pimp) return w_async_io_backend::NONE;
+	return this->_pimp->get_backend();
+}
+
+uint32_t w_async_io::get_queue_depth() const
+{
+	if (!this->_pimp) return 0;
+	return this->_pimp->get_queue_depth();
+}
+
+size_t w_async_io::get_in_flight() const
+{
+	if (!this->_pimp) return 0;
+	return this->_pimp->get_in_flight();
+}
+
+size_t w_async_io::get_queued() const
+{
+	if (!this->_pimp) return 0;
+	return this->_pimp->get_queued();
+}
+
+w_async_io& w_async_io::get_shared()
+{
+	static w_async_io s_io;
+	static std::once_flag s_once;
+	std::call_once(s_once, []()
+	{
+		s_io.initialize();
+	});
+	return s_io;
+}
+
+#pragma endregion
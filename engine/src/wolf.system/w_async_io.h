@@ -0,0 +1,151 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_async_io.h
+	Description		 : Asynchronous batched file reads into caller provided buffers
+	Comment          : On linux reads are submitted to io_uring by one I/O thread, when io_uring is not available
+					   (kernels older than 5.6, seccomp) and on other platforms a pool of workers reads with pread/ReadFile.
+					   At most queue_depth reads are in flight, higher priorities are issued first.
+					   Callbacks run on an I/O thread, they may submit new batches but must not block
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include <future>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace wolf::system
+{
+	enum class w_io_priority
+	{
+		//streaming which can wait
+		LOW = 0,
+		NORMAL,
+		//data which is needed for the current frame
+		HIGH
+	};
+
+	struct w_io_result
+	{
+		//W_PASSED when the read completed, bytes_read is less than requested at the end of file
+		W_RESULT		status = W_FAILED;
+		size_t			bytes_read = 0;
+		//errno, or GetLastError on windows
+		int				error = 0;
+		//index of request inside its batch
+		size_t			index = 0;
+	};
+
+	struct w_io_request
+	{
+		//files are opened once per batch and shared by its requests
+		std::string		path;
+		uint64_t		offset = 0;
+		//must stay valid until the request completes
+		char*			buffer = nullptr;
+		size_t			size = 0;
+		w_io_priority	priority = w_io_priority::NORMAL;
+		//may be nullptr
+		std::function<void(const w_io_result&)> on_completed;
+	};
+
+	struct w_async_io_config
+	{
+		//maximum number of reads in flight
+		uint32_t		queue_depth = 64;
+		//workers of thread pool backend, it is clamped to queue_depth
+		uint32_t		worker_threads = 4;
+		//set false to force thread pool backend on linux
+		bool			use_io_uring = true;
+	};
+
+	enum class w_async_io_backend
+	{
+		NONE,
+		IO_URING,
+		THREAD_POOL
+	};
+
+	struct w_io_batch_state;
+
+	//a handle to a batch which was submitted to w_async_io
+	class w_io_batch_handle
+	{
+		friend class w_async_io;
+		friend class w_async_io_pimp;
+	public:
+		WSYS_EXP w_io_batch_handle();
+
+		//wait for all requests of batch
+		WSYS_EXP void wait() const;
+		WSYS_EXP std::future_status wait_for(_In_ const long long pMilliSeconds) const;
+		//wait and return W_PASSED if all requests of batch passed
+		WSYS_EXP W_RESULT get() const;
+		//requests which are not issued yet complete with W_FAILED and ECANCELED
+		WSYS_EXP void cancel() const;
+
+#pragma region Getters
+		//wait and get results in order of requests
+		WSYS_EXP const std::vector<w_io_result>& get_results() const;
+		WSYS_EXP bool get_is_completed() const;
+		WSYS_EXP bool get_is_valid() const;
+#pragma endregion
+
+	private:
+		std::shared_ptr<w_io_batch_state> _state;
+	};
+
+	class w_async_io_pimp;
+	class w_async_io
+	{
+	public:
+		WSYS_EXP w_async_io();
+		WSYS_EXP ~w_async_io();
+
+		WSYS_EXP W_RESULT initialize(_In_ const w_async_io_config& pConfig = w_async_io_config());
+
+		/*
+			submit a batch of reads, pOnCompleted is called after the callbacks of all requests.
+			With io_uring files of the batch are opened by the calling thread.
+			Returns an invalid handle if service is not initialized
+		*/
+		WSYS_EXP w_io_batch_handle submit(
+			_In_ std::vector<w_io_request> pRequests,
+			_In_ const std::function<void(const std::vector<w_io_result>&)>& pOnCompleted = nullptr);
+
+		//submit a batch of one request
+		WSYS_EXP w_io_batch_handle read(
+			_In_z_ const char* pPath,
+			_In_ const uint64_t& pOffset,
+			_In_ char* pBuffer,
+			_In_ const size_t& pSize,
+			_In_ const w_io_priority& pPriority = w_io_priority::NORMAL,
+			_In_ const std::function<void(const w_io_result&)>& pOnCompleted = nullptr);
+
+		//cancel queued requests and wait for reads in flight, it is called by destructor
+		WSYS_EXP void release();
+
+#pragma region Getters
+		WSYS_EXP w_async_io_backend get_backend() const;
+		WSYS_EXP uint32_t get_queue_depth() const;
+		//number of reads which are issued and not completed
+		WSYS_EXP size_t get_in_flight() const;
+		//number of requests which wait for a free slot
+		WSYS_EXP size_t get_queued() const;
+		//the service which is shared by loaders, it is initialized with default config on first use
+		WSYS_EXP static w_async_io& get_shared();
+#pragma endregion
+
+	private:
+		//Prevent copying
+		w_async_io(w_async_io const&);
+		w_async_io& operator= (w_async_io const&);
+
+		w_async_io_pimp*		_pimp;
+	};
+}
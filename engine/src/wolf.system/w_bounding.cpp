@@ -1,5 +1,6 @@
 #include "w_system_pch.h"
 #include "w_bounding.h"
+#include "w_parallel.h"
 #include <glm/glm.hpp>
 
 using namespace wolf::system;
@@ -417,4 +418,27 @@ bool w_bounding_frustum::intersects(_In_ const w_bounding_sphere& pBoundingSpher
 	return intersects(w_bounding_box::create_from_bounding_sphere(pBoundingSphere));
 }
 
+size_t w_bounding_frustum::intersects(
+	_In_ const w_bounding_box* pBoxes,
+	_In_ const size_t& pCount,
+	_Inout_ bool* pResults)
+{
+	if (!pBoxes || !pResults || !pCount) return 0;
+
+	return parallel_reduce(0, pCount, 256, (size_t)0,
+		[&](size_t pBegin, size_t pEnd, size_t pVisibles)
+	{
+		for (auto i = pBegin; i < pEnd; ++i)
+		{
+			pResults[i] = intersects(pBoxes[i]);
+			if (pResults[i]) pVisibles++;
+		}
+		return pVisibles;
+	},
+		[](size_t pA, size_t pB)
+	{
+		return pA + pB;
+	});
+}
+
 #pragma endregion
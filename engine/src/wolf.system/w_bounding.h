@@ -13,9 +13,7 @@
 #include <array>
 #include "glm_extension.h"
 
-#if __cplusplus <= 201402L
 #include "msgpack.hpp"
-#endif
 
 #include "python_exporter/w_boost_python_helper.h"
 
@@ -49,9 +47,7 @@ namespace wolf::system
 		WSYS_EXP void get_corners(_Inout_ std::array<glm::vec3, 8> & pCorners);
 		WSYS_EXP glm::vec3 get_center() const;
         
-#if __cplusplus <= 201402L
 		MSGPACK_DEFINE(min, max, position, rotation);
-#endif
         
 #ifdef __PYTHON__
 
@@ -114,9 +110,7 @@ namespace wolf::system
 		WSYS_EXP bool intersects(_In_ const w_bounding_box& pBox);
 		WSYS_EXP w_containment_type contains(_In_ const glm::vec3& pPoit);
 
-#if __cplusplus <= 201402L
 		MSGPACK_DEFINE(center, radius);
-#endif
         
 #ifdef __PYTHON__
 		//center
@@ -138,10 +132,10 @@ namespace wolf::system
 		WSYS_EXP bool intersects(_In_ const glm::vec3& pPoint);
 		WSYS_EXP bool intersects(_In_ const w_bounding_sphere& pSphere);
 		WSYS_EXP bool intersects(_In_ const w_bounding_box& pBox);
+		//test pCount boxes in parallel and write result of each box to pResults, returns number of visible boxes
+		WSYS_EXP size_t intersects(_In_ const w_bounding_box* pBoxes, _In_ const size_t& pCount, _Inout_ bool* pResults);
 
-#if __cplusplus <= 201402L
 		MSGPACK_DEFINE(_planes);
-#endif
         
 #ifdef __PYTHON__
 		boost::python::list py_get_plans()
@@ -3,35 +3,56 @@
 	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
 	Website			 : https://WolfEngine.App
 	Name			 : w_compress.hpp
-	Description		 : compress stream based on https://github.com/lz4/lz4
-	Comment          :
+	Description		 : compress stream based on https://github.com/lz4/lz4 and https://www.7-zip.org/sdk.html
+	Comment          : compress_lz4 and decompress_lz4 work on whole buffers,
+					   w_lz4_stream_writer and w_lz4_stream_reader work on lz4 frames with bounded memory.
+					   decompress picks the codec from pDecompressInfo->codec or from the header of buffer
 */
 
 #pragma once
 
 #include "w_compress_lz4.h"
+#include "w_compress_parallel.h"
+#include "w_compress_dictionary.h"
+#include "w_compress_lzma.h"
 #include "w_system_export.h"
 #include "w_logger.h"
-
-#ifdef __WIN32
-#include "w_compress_lzma.h"
-#endif
+#include <istream>
+#include <ostream>
 
 namespace wolf::system
 {
+	//w_compress_read_fn on a buffer in memory, pass it as user data of read
+	struct w_compress_memory_reader
+	{
+		const char*     data;
+		size_t          size;
+
+		static size_t read(void* pUserData, char* pData, size_t pSize)
+		{
+			auto _memory = static_cast<w_compress_memory_reader*>(pUserData);
+			auto _size = pSize < _memory->size ? pSize : _memory->size;
+			std::memcpy(pData, _memory->data, _size);
+			_memory->data += _size;
+			_memory->size -= _size;
+			return _size;
+		}
+	};
+
 	struct w_compress
 	{
+		//pAcceleration is the acceleration of W_FAST or the level of W_HIGH (W_COMPRESS_HC_LEVEL_MIN to W_COMPRESS_HC_LEVEL_MAX)
 		static W_RESULT compress_lz4(
 			_In_		const char* pSrcBuffer,
 			_Inout_		w_compress_result* pCompressResult,
 			_In_		w_compress_mode pMode = w_compress_mode::W_DEFAULT,
-			_In_		int pAcceleration = 1.0)
+			_In_		int pAcceleration = 1)
 		{
 			if (!pCompressResult || !pSrcBuffer) return W_RESULT::W_INVALIDARG;
 
 			W_RESULT _result = W_PASSED;
 
-			auto _err_log = (char*)malloc(256 * sizeof(char));
+			auto _err_log = (char*)malloc(W_COMPRESS_ERROR_LOG_SIZE * sizeof(char));
 			if (compress_buffer_c(
 				pSrcBuffer,
 				pMode,
@@ -55,7 +76,7 @@ namespace wolf::system
 
 			W_RESULT _result = W_PASSED;
 
-			auto _err_log = (char*)malloc(256 * sizeof(char));
+			auto _err_log = (char*)malloc(W_COMPRESS_ERROR_LOG_SIZE * sizeof(char));
 			if (decompress_buffer_c(
 				pCompressedBuffer,
 				pDecompressInfo,
@@ -69,10 +90,29 @@ namespace wolf::system
 			return _result;
 		}
 
-#ifdef __WIN32
+		//compress independent blocks on the thread pool, see w_compress_parallel
+		static W_RESULT compress_lz4_parallel(
+			_In_		const char* pSrcBuffer,
+			_Inout_		w_compress_result* pCompressResult,
+			_In_		w_compress_mode pMode = w_compress_mode::W_DEFAULT,
+			_In_		int pAcceleration = 1,
+			_In_		size_t pBlockSize = W_COMPRESS_PARALLEL_DEFAULT_BLOCK_SIZE)
+		{
+			return w_compress_parallel::compress(pSrcBuffer, pCompressResult, pMode, pAcceleration, pBlockSize);
+		}
+
+		static W_RESULT decompress_lz4_parallel(
+			_In_	const char* pCompressedBuffer,
+			_Inout_	w_compress_result* pDecompressInfo)
+		{
+			return w_compress_parallel::decompress(pCompressedBuffer, pDecompressInfo);
+		}
+
+		//pLevel is from W_COMPRESS_LZMA_LEVEL_MIN to W_COMPRESS_LZMA_LEVEL_MAX
 		static W_RESULT compress_lzma(
 			_In_ const uint8_t* pSrcBuffer,
-			_Inout_ w_compress_result* pCompressResult)
+			_Inout_ w_compress_result* pCompressResult,
+			_In_ int pLevel = W_COMPRESS_LZMA_LEVEL_DEFAULT)
 		{
 			if (!pCompressResult || !pSrcBuffer) return W_RESULT::W_INVALIDARG;
 
@@ -80,8 +120,10 @@ namespace wolf::system
 
 			if (w_compress_lzma::compress(
 				pSrcBuffer,
-				pCompressResult))
+				pCompressResult,
+				pLevel))
 			{
+				logger.error("could not compress. trace info: w_compress::compress_lzma");
 				_result = W_FAILED;
 			}
 
@@ -100,42 +142,340 @@ namespace wolf::system
 				pCompressedBuffer,
 				pDecompressInfo))
 			{
+				logger.error("could not decompress. trace info: w_compress::decompress_lzma");
 				_result = W_FAILED;
 			}
 
 			return _result;
 		}
-#endif
 
-		/*static w_compress_result compress_file(_In_ FILE* pFileStreamIn, _Inout_ FILE* pCompressedFileOut)
+		//multi threaded lzma, blocks are compressed on the thread pool, see w_compress_parallel
+		static W_RESULT compress_lzma_parallel(
+			_In_		const char* pSrcBuffer,
+			_Inout_		w_compress_result* pCompressResult,
+			_In_		int pLevel = W_COMPRESS_LZMA_LEVEL_DEFAULT,
+			_In_		size_t pBlockSize = W_COMPRESS_PARALLEL_LZMA_BLOCK_SIZE)
+		{
+			return w_compress_parallel::compress_lzma(pSrcBuffer, pCompressResult, pLevel, pBlockSize);
+		}
+
+		/*
+			returns codec of buffers which have a header, which are lz4 frames and blocks of w_compress_parallel.
+			Single lz4 blocks, lzma and dictionary buffers return W_CODEC_UNKNOWN, keep codec of w_compress_result for them
+		*/
+		static w_compress_codec get_codec(
+			_In_ const char* pBuffer,
+			_In_ const size_t& pSize)
+		{
+			if (!pBuffer) return W_CODEC_UNKNOWN;
+			if (is_lz4_frame_c(pBuffer, pSize)) return W_CODEC_LZ4_FRAME;
+			return w_compress_parallel::get_codec(pBuffer, pSize);
+		}
+
+		//decompress with codec of pDecompressInfo, or with codec from header of pCompressedBuffer if it is W_CODEC_UNKNOWN
+		static W_RESULT decompress(
+			_In_	const char* pCompressedBuffer,
+			_Inout_	w_compress_result* pDecompressInfo)
 		{
-			auto _err_log = (char*)malloc(256 * sizeof(char));
-			auto _result = compress_file_c(pFileStreamIn, pCompressedFileOut, _err_log);
-			if (_result.error)
+			if (!pDecompressInfo || !pCompressedBuffer) return W_RESULT::W_INVALIDARG;
+
+			auto _codec = pDecompressInfo->codec;
+			if (_codec == W_CODEC_UNKNOWN) _codec = get_codec(pCompressedBuffer, pDecompressInfo->size_in);
+
+			switch (_codec)
+			{
+			case W_CODEC_LZ4:
+				return decompress_lz4(pCompressedBuffer, pDecompressInfo);
+			case W_CODEC_LZ4_FRAME:
+				return _decompress_lz4_frame(pCompressedBuffer, pDecompressInfo);
+			case W_CODEC_LZ4_PARALLEL:
+			case W_CODEC_LZMA_PARALLEL:
+				return w_compress_parallel::decompress(pCompressedBuffer, pDecompressInfo);
+			case W_CODEC_LZMA:
+				return decompress_lzma(reinterpret_cast<const uint8_t*>(pCompressedBuffer), pDecompressInfo);
+			case W_CODEC_LZ4_DICTIONARY:
+				logger.error("dictionary is needed, use w_compress_dictionary. trace info: w_compress::decompress");
+				return W_INVALIDARG;
+			default:
+				logger.error("unknown codec. trace info: w_compress::decompress");
+				return W_INVALIDARG;
+			}
+		}
+
+		//compress pFileStreamIn to an lz4 frame on pCompressedFileOut in chunks, files are not closed
+		static W_RESULT compress_lz4_file(
+			_In_		FILE* pFileStreamIn,
+			_In_		FILE* pCompressedFileOut,
+			_Inout_		w_compress_result* pCompressResult = nullptr,
+			_In_		w_compress_mode pMode = w_compress_mode::W_DEFAULT,
+			_In_		int pAcceleration = 1)
+		{
+			if (!pFileStreamIn || !pCompressedFileOut) return W_RESULT::W_INVALIDARG;
+
+			W_RESULT _result = W_PASSED;
+
+			auto _err_log = (char*)malloc(W_COMPRESS_ERROR_LOG_SIZE * sizeof(char));
+			if (compress_file_c(
+				pFileStreamIn,
+				pCompressedFileOut,
+				pMode,
+				pAcceleration,
+				pCompressResult,
+				_err_log))
 			{
 				logger.error(_err_log);
+				_result = W_FAILED;
 			}
 			free(_err_log);
 
-			if (pFileStreamIn) fclose(pFileStreamIn);
-			if (pCompressedFileOut) fclose(pCompressedFileOut);
-
 			return _result;
 		}
-		static w_compress_result decompress_file(_In_ FILE* pCompressedFileIn, _Inout_ FILE* pFileStreamOut)
+
+		static W_RESULT decompress_lz4_file(
+			_In_		FILE* pCompressedFileIn,
+			_In_		FILE* pFileStreamOut,
+			_Inout_		w_compress_result* pDecompressInfo = nullptr)
 		{
-			auto _err_log = (char*)malloc(256 * sizeof(char));
-			auto _result = decompress_file_c(pCompressedFileIn, pFileStreamOut, _err_log);
-			if (_result.error)
+			if (!pCompressedFileIn || !pFileStreamOut) return W_RESULT::W_INVALIDARG;
+
+			W_RESULT _result = W_PASSED;
+
+			auto _err_log = (char*)malloc(W_COMPRESS_ERROR_LOG_SIZE * sizeof(char));
+			if (decompress_file_c(
+				pCompressedFileIn,
+				pFileStreamOut,
+				pDecompressInfo,
+				_err_log))
 			{
 				logger.error(_err_log);
+				_result = W_FAILED;
 			}
 			free(_err_log);
 
-			if (pCompressedFileIn) fclose(pCompressedFileIn);
-			if (pFileStreamOut) fclose(pFileStreamOut);
-
 			return _result;
-		}*/
+		}
+
+	private:
+		//decompress a whole lz4 frame, the output grows while frame is read
+		static W_RESULT _decompress_lz4_frame(
+			_In_	const char* pCompressedBuffer,
+			_Inout_	w_compress_result* pDecompressInfo)
+		{
+			pDecompressInfo->data = nullptr;
+			pDecompressInfo->size_out = 0;
+
+			char _err_log[W_COMPRESS_ERROR_LOG_SIZE];
+			w_compress_memory_reader _memory = { pCompressedBuffer, pDecompressInfo->size_in };
+			auto _stream = decompress_stream_begin_c(w_compress_memory_reader::read, &_memory, _err_log);
+			if (!_stream)
+			{
+				logger.error(_err_log);
+				return W_FAILED;
+			}
+
+			size_t _capacity = pDecompressInfo->size_in * 2 < 64 * 1024 ? 64 * 1024 : pDecompressInfo->size_in * 2;
+			size_t _size = 0;
+			char* _data = nullptr;
+			bool _failed = false;
+			for (;;)
+			{
+				if (!_data || _size == _capacity)
+				{
+					if (_data) _capacity *= 2;
+					auto _grown = static_cast<char*>(realloc(_data, _capacity));
+					if (!_grown)
+					{
+						logger.error("allocating memory for decompressed buffer. trace info: w_compress::_decompress_lz4_frame");
+						_failed = true;
+						break;
+					}
+					_data = _grown;
+				}
+
+				size_t _read_size = 0;
+				if (decompress_stream_read_c(_stream, _data + _size, _capacity - _size, &_read_size, _err_log))
+				{
+					logger.error(_err_log);
+					_failed = true;
+					break;
+				}
+				if (_read_size == 0) break;
+				_size += _read_size;
+			}
+
+			w_compress_result _info = {};
+			_failed = decompress_stream_end_c(_stream, &_info) != 0 || _failed;
+			if (_failed)
+			{
+				free(_data);
+				return W_FAILED;
+			}
+
+			pDecompressInfo->data = _data;
+			pDecompressInfo->size_out = _size;
+			pDecompressInfo->codec = W_CODEC_LZ4_FRAME;
+			return W_PASSED;
+		}
+	};
+
+	/*
+		compresses everything which is written to it into an lz4 frame on a std::ostream or a write function.
+		It has write(const char*, size_t), so msgpack::pack can write to it directly
+	*/
+	class w_lz4_stream_writer
+	{
+	public:
+		w_lz4_stream_writer()
+		{
+		}
+
+		~w_lz4_stream_writer()
+		{
+			end();
+		}
+
+		W_RESULT begin(
+			_In_ std::ostream& pStream,
+			_In_ w_compress_mode pMode = w_compress_mode::W_DEFAULT,
+			_In_ int pAcceleration = 1)
+		{
+			return begin(_ostream_write, &pStream, pMode, pAcceleration);
+		}
+
+		W_RESULT begin(
+			_In_ w_compress_write_fn pWrite,
+			_In_ void* pUserData,
+			_In_ w_compress_mode pMode = w_compress_mode::W_DEFAULT,
+			_In_ int pAcceleration = 1)
+		{
+			if (this->_stream) return W_FAILED;
+
+			char _err_log[W_COMPRESS_ERROR_LOG_SIZE];
+			this->_stream = compress_stream_begin_c(pMode, pAcceleration, pWrite, pUserData, _err_log);
+			if (!this->_stream)
+			{
+				logger.error(_err_log);
+				return W_FAILED;
+			}
+			this->_failed = false;
+			return W_PASSED;
+		}
+
+		//errors are kept until end
+		void write(_In_ const char* pData, _In_ size_t pSize)
+		{
+			if (!this->_stream || this->_failed) return;
+
+			char _err_log[W_COMPRESS_ERROR_LOG_SIZE];
+			if (compress_stream_write_c(this->_stream, pData, pSize, _err_log))
+			{
+				logger.error(_err_log);
+				this->_failed = true;
+			}
+		}
+
+		//finish the frame, sizes are stored in pCompressResult
+		W_RESULT end(_Inout_ w_compress_result* pCompressResult = nullptr)
+		{
+			if (!this->_stream) return W_FAILED;
+
+			char _err_log[W_COMPRESS_ERROR_LOG_SIZE];
+			auto _failed = compress_stream_end_c(this->_stream, pCompressResult, _err_log) != 0;
+			if (_failed && !this->_failed) logger.error(_err_log);
+			this->_stream = nullptr;
+
+			return _failed || this->_failed ? W_FAILED : W_PASSED;
+		}
+
+	private:
+		//Prevent copying
+		w_lz4_stream_writer(w_lz4_stream_writer const&);
+		w_lz4_stream_writer& operator= (w_lz4_stream_writer const&);
+
+		static size_t _ostream_write(void* pUserData, const char* pData, size_t pSize)
+		{
+			auto _stream = static_cast<std::ostream*>(pUserData);
+			_stream->write(pData, pSize);
+			return _stream->good() ? pSize : 0;
+		}
+
+		w_lz4_compress_stream*      _stream = nullptr;
+		bool                        _failed = false;
+	};
+
+	//reads an lz4 frame from a std::istream or a read function in chunks, only the current chunk is kept in memory
+	class w_lz4_stream_reader
+	{
+	public:
+		w_lz4_stream_reader()
+		{
+		}
+
+		~w_lz4_stream_reader()
+		{
+			end();
+		}
+
+		W_RESULT begin(_In_ std::istream& pStream)
+		{
+			return begin(_istream_read, &pStream);
+		}
+
+		W_RESULT begin(_In_ w_compress_read_fn pRead, _In_ void* pUserData)
+		{
+			if (this->_stream) return W_FAILED;
+
+			char _err_log[W_COMPRESS_ERROR_LOG_SIZE];
+			this->_stream = decompress_stream_begin_c(pRead, pUserData, _err_log);
+			if (!this->_stream)
+			{
+				logger.error(_err_log);
+				return W_FAILED;
+			}
+			this->_failed = false;
+			return W_PASSED;
+		}
+
+		//returns number of decompressed bytes, 0 at the end of frame or on error
+		size_t read(_Inout_ char* pData, _In_ size_t pSize)
+		{
+			if (!this->_stream || this->_failed) return 0;
+
+			size_t _read_size = 0;
+			char _err_log[W_COMPRESS_ERROR_LOG_SIZE];
+			if (decompress_stream_read_c(this->_stream, pData, pSize, &_read_size, _err_log))
+			{
+				logger.error(_err_log);
+				this->_failed = true;
+				return 0;
+			}
+			return _read_size;
+		}
+
+		//fails if frame was corrupted or not read completely
+		W_RESULT end(_Inout_ w_compress_result* pDecompressInfo = nullptr)
+		{
+			if (!this->_stream) return W_FAILED;
+
+			auto _failed = decompress_stream_end_c(this->_stream, pDecompressInfo) != 0;
+			this->_stream = nullptr;
+
+			return _failed || this->_failed ? W_FAILED : W_PASSED;
+		}
+
+	private:
+		//Prevent copying
+		w_lz4_stream_reader(w_lz4_stream_reader const&);
+		w_lz4_stream_reader& operator= (w_lz4_stream_reader const&);
+
+		static size_t _istream_read(void* pUserData, char* pData, size_t pSize)
+		{
+			auto _stream = static_cast<std::istream*>(pUserData);
+			_stream->read(pData, pSize);
+			return static_cast<size_t>(_stream->gcount());
+		}
+
+		w_lz4_decompress_stream*    _stream = nullptr;
+		bool                        _failed = false;
 	};
 }
@@ -14,13 +14,62 @@
 typedef enum
 {
 	W_DEFAULT,
-	W_FAST
+	//acceleration trades ratio for speed
+	W_FAST,
+	//lz4hc for offline packing, better ratio with the same speed of decompression, acceleration is the level
+	W_HIGH
 }
 w_compress_mode;
 
+//levels of W_HIGH, levels from 10 use the optimal parser which is much slower
+#define W_COMPRESS_HC_LEVEL_MIN			3
+#define W_COMPRESS_HC_LEVEL_DEFAULT		9
+#define W_COMPRESS_HC_LEVEL_MAX			12
+
+//levels under W_COMPRESS_HC_LEVEL_MIN (e.g. the default acceleration of 1) mean the default level
+static inline int w_compress_hc_level(int pLevel)
+{
+	if (pLevel < W_COMPRESS_HC_LEVEL_MIN) return W_COMPRESS_HC_LEVEL_DEFAULT;
+	return pLevel > W_COMPRESS_HC_LEVEL_MAX ? W_COMPRESS_HC_LEVEL_MAX : pLevel;
+}
+
+//levels of lzma, from 7 the dictionary is 32MB or more for each encoder
+#define W_COMPRESS_LZMA_LEVEL_MIN		0
+#define W_COMPRESS_LZMA_LEVEL_DEFAULT	5
+#define W_COMPRESS_LZMA_LEVEL_MAX		9
+
+//codec which produced a compressed buffer, stored values must never change
+typedef enum
+{
+	W_CODEC_UNKNOWN = 0,
+	//single lz4 block of compress_buffer_c
+	W_CODEC_LZ4 = 1,
+	//lz4 frame of streams and files
+	W_CODEC_LZ4_FRAME = 2,
+	//lz4 block with the header of compress_buffer_with_dictionary_c
+	W_CODEC_LZ4_DICTIONARY = 3,
+	//lz4 blocks of w_compress_parallel
+	W_CODEC_LZ4_PARALLEL = 4,
+	//lzma with 13 bytes header of .lzma files
+	W_CODEC_LZMA = 5,
+	//lzma blocks of w_compress_parallel
+	W_CODEC_LZMA_PARALLEL = 6
+}
+w_compress_codec;
+
 typedef struct
 {
 	size_t				size_in;
 	size_t				size_out;
 	char*				data;
+	//set by compress and decompress functions
+	w_compress_codec	codec;
 } w_compress_result;
+
+//size of error logs which are passed to compress functions
+#define W_COMPRESS_ERROR_LOG_SIZE 256
+
+//writes pSize bytes to the destination of stream, returns number of bytes written, anything less than pSize is an error
+typedef size_t(*w_compress_write_fn)(void* pUserData, const char* pData, size_t pSize);
+//reads up to pSize bytes from the source of stream, returns number of bytes read, 0 means end of source
+typedef size_t(*w_compress_read_fn)(void* pUserData, char* pData, size_t pSize);
@@ -0,0 +1,192 @@
+#include "w_system_pch.h"
+#include "w_compress_dictionary.h"
+#include "w_compress_lz4.h"
+#include <queue>
+
+using namespace wolf::system;
+
+//length of sequences which are counted
+static const size_t s_gram_size = 8;
+//length of segments which are copied into dictionary, candidates start every quarter of it
+static const size_t s_segment_size = 256;
+static const size_t s_table_bits = 20;
+
+namespace
+{
+	struct w_segment
+	{
+		uint64_t    score;
+		uint32_t    sample;
+		uint32_t    offset;
+		uint32_t    size;
+
+		bool operator<(const w_segment& pOther) const
+		{
+			return this->score < pOther.score;
+		}
+	};
+
+	uint32_t _hash(const char* pData)
+	{
+		uint64_t _value;
+		std::memcpy(&_value, pData, sizeof(_value));
+		return static_cast<uint32_t>((_value * 0x9E3779B97F4A7C15ull) >> (64 - s_table_bits));
+	}
+
+	//sum of frequencies of distinct sequences of segment, sequences which only one sample has do not count
+	uint64_t _segment_score(
+		const char* pData,
+		size_t pSize,
+		const std::vector<uint32_t>& pFrequencies,
+		std::vector<uint32_t>& pStamps,
+		uint32_t pStamp)
+	{
+		uint64_t _score = 0;
+		for (size_t i = 0; i + s_gram_size <= pSize; ++i)
+		{
+			auto _h = _hash(pData + i);
+			if (pStamps[_h] == pStamp) continue;
+			pStamps[_h] = pStamp;
+			if (pFrequencies[_h] > 1) _score += pFrequencies[_h] - 1;
+		}
+		return _score;
+	}
+}
+
+W_RESULT w_compress_dictionary::train(
+	_In_ const std::vector<std::string>& pSamples,
+	_Inout_ std::string& pDictionary,
+	_In_ const size_t& pDictionarySize)
+{
+	pDictionary.clear();
+
+	const auto _capacity = std::min(pDictionarySize, W_COMPRESS_MAX_DICTIONARY_SIZE);
+	if (pSamples.size() < 2 || _capacity == 0)
+	{
+		logger.error("at least two samples and a dictionary size are needed. trace info: w_compress_dictionary::train");
+		return W_INVALIDARG;
+	}
+
+	//count in how many samples each sequence appears
+	std::vector<uint32_t> _frequencies(size_t(1) << s_table_bits, 0);
+	std::vector<uint32_t> _stamps(size_t(1) << s_table_bits, UINT32_MAX);
+	for (size_t s = 0; s < pSamples.size(); ++s)
+	{
+		const auto& _sample = pSamples[s];
+		for (size_t i = 0; i + s_gram_size <= _sample.size(); ++i)
+		{
+			auto _h = _hash(_sample.data() + i);
+			if (_stamps[_h] == s) continue;
+			_stamps[_h] = static_cast<uint32_t>(s);
+			_frequencies[_h]++;
+		}
+	}
+
+	//score overlapping candidate segments of all samples
+	uint32_t _stamp = 0;
+	std::fill(_stamps.begin(), _stamps.end(), UINT32_MAX);
+	std::priority_queue<w_segment> _candidates;
+	for (size_t s = 0; s < pSamples.size(); ++s)
+	{
+		const auto& _sample = pSamples[s];
+		if (_sample.size() < s_gram_size) continue;
+
+		for (size_t _offset = 0; _offset < _sample.size(); _offset += s_segment_size / 4)
+		{
+			auto _size = std::min(s_segment_size, _sample.size() - _offset);
+			if (_size < s_gram_size) break;
+
+			auto _score = _segment_score(_sample.data() + _offset, _size, _frequencies, _stamps, _stamp++);
+			if (_score) _candidates.push({ _score, static_cast<uint32_t>(s), static_cast<uint32_t>(_offset), static_cast<uint32_t>(_size) });
+			if (_offset + _size == _sample.size()) break;
+		}
+	}
+
+	//greedy with lazy updates, sequences of a chosen segment no longer count for others
+	std::vector<w_segment> _chosen;
+	size_t _used = 0;
+	while (!_candidates.empty() && _used < _capacity)
+	{
+		auto _segment = _candidates.top();
+		_candidates.pop();
+
+		const auto _data = pSamples[_segment.sample].data() + _segment.offset;
+		_segment.score = _segment_score(_data, _segment.size, _frequencies, _stamps, _stamp++);
+		if (_segment.score == 0) continue;
+		if (!_candidates.empty() && _segment.score < _candidates.top().score)
+		{
+			_candidates.push(_segment);
+			continue;
+		}
+
+		_segment.size = static_cast<uint32_t>(std::min<size_t>(_segment.size, _capacity - _used));
+		_chosen.push_back(_segment);
+		_used += _segment.size;
+
+		for (size_t i = 0; i + s_gram_size <= _segment.size; ++i)
+		{
+			_frequencies[_hash(_data + i)] = 0;
+		}
+	}
+
+	if (_chosen.empty())
+	{
+		logger.error("samples do not share any data. trace info: w_compress_dictionary::train");
+		return W_FAILED;
+	}
+
+	//the best segments go to the end, which is closest to the data
+	pDictionary.reserve(_used);
+	for (auto _iter = _chosen.rbegin(); _iter != _chosen.rend(); ++_iter)
+	{
+		pDictionary.append(pSamples[_iter->sample].data() + _iter->offset, _iter->size);
+	}
+
+	return W_PASSED;
+}
+
+W_RESULT w_compress_dictionary::compress(
+	_In_ const char* pSrcBuffer,
+	_In_ const std::string& pDictionary,
+	_Inout_ w_compress_result* pCompressInfo,
+	_In_ w_compress_mode pMode,
+	_In_ int pAcceleration)
+{
+	if (!pSrcBuffer || !pCompressInfo) return W_INVALIDARG;
+
+	char _err_log[W_COMPRESS_ERROR_LOG_SIZE] = {};
+	if (compress_buffer_with_dictionary_c(
+		pSrcBuffer,
+		pMode,
+		pAcceleration,
+		pDictionary.data(),
+		pDictionary.size(),
+		pCompressInfo,
+		_err_log))
+	{
+		logger.error(_err_log);
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
+
+W_RESULT w_compress_dictionary::decompress(
+	_In_ const char* pCompressedBuffer,
+	_In_ const std::string& pDictionary,
+	_Inout_ w_compress_result* pDecompressInfo)
+{
+	if (!pCompressedBuffer || !pDecompressInfo) return W_INVALIDARG;
+
+	char _err_log[W_COMPRESS_ERROR_LOG_SIZE] = {};
+	if (decompress_buffer_with_dictionary_c(
+		pCompressedBuffer,
+		pDictionary.data(),
+		pDictionary.size(),
+		pDecompressInfo,
+		_err_log))
+	{
+		logger.error(_err_log);
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
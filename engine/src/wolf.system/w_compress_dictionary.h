@@ -0,0 +1,45 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_compress_dictionary.h
+	Description		 : Shared lz4 dictionaries for many small files (gui xml, shaders, materials)
+	Comment          : Training picks segments of samples which share most 8 byte sequences with other samples,
+					   similar to the cover algorithm of zstd. The same dictionary must be given to compress and decompress
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_compress_data_type.h"
+#include "w_std.h"
+#include <string>
+#include <vector>
+
+namespace wolf::system
+{
+	//lz4 only refers to the last 64KB of a dictionary
+	static const size_t W_COMPRESS_MAX_DICTIONARY_SIZE = 64 * 1024;
+
+	struct w_compress_dictionary
+	{
+		//train a dictionary of up to pDictionarySize bytes from pSamples, at least two samples are needed
+		WSYS_EXP static W_RESULT train(
+			_In_ const std::vector<std::string>& pSamples,
+			_Inout_ std::string& pDictionary,
+			_In_ const size_t& pDictionarySize = W_COMPRESS_MAX_DICTIONARY_SIZE);
+
+		//data of pCompressInfo must be released with free
+		WSYS_EXP static W_RESULT compress(
+			_In_ const char* pSrcBuffer,
+			_In_ const std::string& pDictionary,
+			_Inout_ w_compress_result* pCompressInfo,
+			_In_ w_compress_mode pMode = w_compress_mode::W_HIGH,
+			_In_ int pAcceleration = W_COMPRESS_HC_LEVEL_DEFAULT);
+
+		WSYS_EXP static W_RESULT decompress(
+			_In_ const char* pCompressedBuffer,
+			_In_ const std::string& pDictionary,
+			_Inout_ w_compress_result* pDecompressInfo);
+	};
+}
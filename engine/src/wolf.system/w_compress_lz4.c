@@ -3,8 +3,39 @@
 #include <stdlib.h>
 #include <string.h>
 #include "lz4/lz4.h"
+#include "lz4/lz4frame.h"
+#include "lz4/lz4hc.h"
+#include "lz4/xxhash.h"
 
-#define IN_CHUNK_SIZE  (16 * 1024)
+//size of blocks of lz4 frames and chunks of file streams
+#define IN_CHUNK_SIZE  (64 * 1024)
+
+struct w_lz4_compress_stream
+{
+	LZ4F_cctx*				context;
+	LZ4F_preferences_t		preferences;
+	w_compress_write_fn		write;
+	void*					user_data;
+	char*					out_buffer;
+	size_t					out_capacity;
+	size_t					size_in;
+	size_t					size_out;
+	int						failed;
+};
+
+struct w_lz4_decompress_stream
+{
+	LZ4F_dctx*				context;
+	w_compress_read_fn		read;
+	void*					user_data;
+	char*					in_buffer;
+	size_t					in_size;
+	size_t					in_position;
+	size_t					size_in;
+	size_t					size_out;
+	int						finished;
+	int						failed;
+};
 
 int compress_buffer_c(
 	/*_In_*/	const char* pSrcBuffer,
@@ -22,13 +53,22 @@ int compress_buffer_c(
 	{
 		snprintf(
 			pErrorLog,
-			strlen(pErrorLog),
+			W_COMPRESS_ERROR_LOG_SIZE,
 			"allocating memory for compressed buffer. trace_info: w_compress::compress_buffer_c");
 		return 1;
 	}
 
 	int _compressed_buffer_size = -1;
-	if (pMode == W_FAST)
+	if (pMode == W_HIGH)
+	{
+		_compressed_buffer_size = LZ4_compress_HC(
+			pSrcBuffer,
+			pCompressInfo->data,
+			(int)pCompressInfo->size_in,
+			_max_dst_size,
+			w_compress_hc_level(pAcceleration));
+	}
+	else if (pMode == W_FAST)
 	{
 		_compressed_buffer_size = LZ4_compress_fast_force(
 			pSrcBuffer, 
@@ -50,12 +90,13 @@ int compress_buffer_c(
 	{
 		//realloc compress_data to free up memory
 		pCompressInfo->size_out = (size_t)_compressed_buffer_size;
+		pCompressInfo->codec = W_CODEC_LZ4;
 		pCompressInfo->data = (char*)realloc(pCompressInfo->data, pCompressInfo->size_out);
 		if (!pCompressInfo->data)
 		{
 			snprintf(
 				pErrorLog,
-				strlen(pErrorLog),
+				W_COMPRESS_ERROR_LOG_SIZE,
 				"could not fit memory of compressed buffer. trace_info: w_compress::compress_buffer_c");
 			return 1;
 		}
@@ -65,7 +106,7 @@ int compress_buffer_c(
 	{
 		snprintf(
 			pErrorLog,
-			strlen(pErrorLog),
+			W_COMPRESS_ERROR_LOG_SIZE,
 			"could not compress. trace_info: w_compress::compress_buffer_c");
 		return 1;
 	}
@@ -85,7 +126,7 @@ int decompress_buffer_c(
 	{
 		snprintf(
 			pErrorLog,
-			strlen(pErrorLog),
+			W_COMPRESS_ERROR_LOG_SIZE,
 			"error on allocate buffer for decompressed buffer. trace_info: w_compress::decompress_buffer_c");
 		return 1;
 	}
@@ -112,7 +153,7 @@ int decompress_buffer_c(
 			{
 				snprintf(
 					pErrorLog,
-					strlen(pErrorLog),
+					W_COMPRESS_ERROR_LOG_SIZE,
 					"could not re-allocate memory of de-compressed buffer. trace_info: w_compress::compress_buffer_c");
 				break;
 			}
@@ -125,7 +166,7 @@ int decompress_buffer_c(
 	{
 		snprintf(
 			pErrorLog,
-			strlen(pErrorLog),
+			W_COMPRESS_ERROR_LOG_SIZE,
 			"decompress size must be greater than zero. trace_info: w_compress::decompress_buffer_c");
 		free(pDecompressInfo->data);
 		pDecompressInfo->data = NULL;
@@ -135,15 +176,651 @@ int decompress_buffer_c(
 	else
 	{
 		pDecompressInfo->size_out = _decompressed_size;
+		pDecompressInfo->codec = W_CODEC_LZ4;
 		pDecompressInfo->data = (char*)realloc(pDecompressInfo->data, pDecompressInfo->size_out);
 		if (!pDecompressInfo->data)
 		{
 			snprintf(
 				pErrorLog,
-				strlen(pErrorLog),
+				W_COMPRESS_ERROR_LOG_SIZE,
 				"could not fit memory for de-compressed buffer. trace_info: w_compress::compress_buffer_c");
 			return 1;
 		}
 	}
 	return 0;
 }
+
+static int _write_out(
+	w_lz4_compress_stream* pStream,
+	size_t pSize,
+	char* pErrorLog)
+{
+	if (pSize == 0) return 0;
+	if (pStream->write(pStream->user_data, pStream->out_buffer, pSize) != pSize)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"could not write compressed data. trace_info: w_compress::compress_stream_c");
+		pStream->failed = 1;
+		return 1;
+	}
+	pStream->size_out += pSize;
+	return 0;
+}
+
+static void _release_compress_stream(w_lz4_compress_stream* pStream)
+{
+	if (!pStream) return;
+	if (pStream->context) LZ4F_freeCompressionContext(pStream->context);
+	free(pStream->out_buffer);
+	free(pStream);
+}
+
+w_lz4_compress_stream* compress_stream_begin_c(
+	/*_In_*/	w_compress_mode pMode,
+	/*_In_*/	int pAcceleration,
+	/*_In_*/	w_compress_write_fn pWrite,
+	/*_In_*/	void* pUserData,
+	/*_Inout_*/ char* pErrorLog)
+{
+	if (!pWrite) return NULL;
+
+	w_lz4_compress_stream* _stream = (w_lz4_compress_stream*)calloc(1, sizeof(w_lz4_compress_stream));
+	if (!_stream)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"allocating memory for compress stream. trace_info: w_compress::compress_stream_begin_c");
+		return NULL;
+	}
+	_stream->write = pWrite;
+	_stream->user_data = pUserData;
+
+	//linked blocks of 64KB, size of content is unknown, so it is not stored in header
+	_stream->preferences.frameInfo.blockSizeID = LZ4F_max64KB;
+	_stream->preferences.frameInfo.blockMode = LZ4F_blockLinked;
+	_stream->preferences.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+	//negative levels trigger fast acceleration of lz4, levels from 3 use lz4hc
+	if (pMode == W_HIGH)
+	{
+		_stream->preferences.compressionLevel = w_compress_hc_level(pAcceleration);
+	}
+	else
+	{
+		_stream->preferences.compressionLevel = pMode == W_FAST ? -(pAcceleration > 1 ? pAcceleration : 1) : 0;
+	}
+
+	size_t _result = LZ4F_createCompressionContext(&_stream->context, LZ4F_VERSION);
+	if (LZ4F_isError(_result))
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"could not create compression context: %s. trace_info: w_compress::compress_stream_begin_c",
+			LZ4F_getErrorName(_result));
+		_release_compress_stream(_stream);
+		return NULL;
+	}
+
+	//bound of one block covers header and end of frame too
+	_stream->out_capacity = LZ4F_compressBound(IN_CHUNK_SIZE, &_stream->preferences);
+	if (_stream->out_capacity < LZ4F_HEADER_SIZE_MAX) _stream->out_capacity = LZ4F_HEADER_SIZE_MAX;
+	_stream->out_buffer = (char*)malloc(_stream->out_capacity);
+	if (!_stream->out_buffer)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"allocating memory for compress stream. trace_info: w_compress::compress_stream_begin_c");
+		_release_compress_stream(_stream);
+		return NULL;
+	}
+
+	_result = LZ4F_compressBegin(
+		_stream->context,
+		_stream->out_buffer,
+		_stream->out_capacity,
+		&_stream->preferences);
+	if (LZ4F_isError(_result))
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"could not begin frame: %s. trace_info: w_compress::compress_stream_begin_c",
+			LZ4F_getErrorName(_result));
+		_release_compress_stream(_stream);
+		return NULL;
+	}
+	if (_write_out(_stream, _result, pErrorLog))
+	{
+		_release_compress_stream(_stream);
+		return NULL;
+	}
+
+	return _stream;
+}
+
+int compress_stream_write_c(
+	/*_In_*/	w_lz4_compress_stream* pStream,
+	/*_In_*/	const char* pSrcBuffer,
+	/*_In_*/	size_t pSize,
+	/*_Inout_*/ char* pErrorLog)
+{
+	if (!pStream || pStream->failed) return 1;
+	if (!pSrcBuffer || pSize == 0) return 0;
+
+	//feed one block at a time, so the output buffer always fits
+	while (pSize)
+	{
+		size_t _chunk = pSize < IN_CHUNK_SIZE ? pSize : IN_CHUNK_SIZE;
+		size_t _result = LZ4F_compressUpdate(
+			pStream->context,
+			pStream->out_buffer,
+			pStream->out_capacity,
+			pSrcBuffer,
+			_chunk,
+			NULL);
+		if (LZ4F_isError(_result))
+		{
+			snprintf(
+				pErrorLog,
+				W_COMPRESS_ERROR_LOG_SIZE,
+				"could not compress: %s. trace_info: w_compress::compress_stream_write_c",
+				LZ4F_getErrorName(_result));
+			pStream->failed = 1;
+			return 1;
+		}
+		if (_write_out(pStream, _result, pErrorLog)) return 1;
+
+		pStream->size_in += _chunk;
+		pSrcBuffer += _chunk;
+		pSize -= _chunk;
+	}
+	return 0;
+}
+
+int compress_stream_end_c(
+	/*_In_*/	w_lz4_compress_stream* pStream,
+	/*_Inout_*/	w_compress_result* pCompressInfo,
+	/*_Inout_*/ char* pErrorLog)
+{
+	if (!pStream) return 1;
+
+	int _failed = pStream->failed;
+	if (!_failed)
+	{
+		size_t _result = LZ4F_compressEnd(
+			pStream->context,
+			pStream->out_buffer,
+			pStream->out_capacity,
+			NULL);
+		if (LZ4F_isError(_result))
+		{
+			snprintf(
+				pErrorLog,
+				W_COMPRESS_ERROR_LOG_SIZE,
+				"could not end frame: %s. trace_info: w_compress::compress_stream_end_c",
+				LZ4F_getErrorName(_result));
+			_failed = 1;
+		}
+		else
+		{
+			_failed = _write_out(pStream, _result, pErrorLog);
+		}
+	}
+
+	if (pCompressInfo)
+	{
+		pCompressInfo->size_in = pStream->size_in;
+		pCompressInfo->size_out = pStream->size_out;
+		pCompressInfo->data = NULL;
+		pCompressInfo->codec = W_CODEC_LZ4_FRAME;
+	}
+	_release_compress_stream(pStream);
+
+	return _failed;
+}
+
+static void _release_decompress_stream(w_lz4_decompress_stream* pStream)
+{
+	if (!pStream) return;
+	if (pStream->context) LZ4F_freeDecompressionContext(pStream->context);
+	free(pStream->in_buffer);
+	free(pStream);
+}
+
+w_lz4_decompress_stream* decompress_stream_begin_c(
+	/*_In_*/	w_compress_read_fn pRead,
+	/*_In_*/	void* pUserData,
+	/*_Inout_*/ char* pErrorLog)
+{
+	if (!pRead) return NULL;
+
+	w_lz4_decompress_stream* _stream = (w_lz4_decompress_stream*)calloc(1, sizeof(w_lz4_decompress_stream));
+	if (!_stream)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"allocating memory for decompress stream. trace_info: w_compress::decompress_stream_begin_c");
+		return NULL;
+	}
+	_stream->read = pRead;
+	_stream->user_data = pUserData;
+
+	size_t _result = LZ4F_createDecompressionContext(&_stream->context, LZ4F_VERSION);
+	if (LZ4F_isError(_result))
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"could not create decompression context: %s. trace_info: w_compress::decompress_stream_begin_c",
+			LZ4F_getErrorName(_result));
+		_release_decompress_stream(_stream);
+		return NULL;
+	}
+
+	_stream->in_buffer = (char*)malloc(IN_CHUNK_SIZE);
+	if (!_stream->in_buffer)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"allocating memory for decompress stream. trace_info: w_compress::decompress_stream_begin_c");
+		_release_decompress_stream(_stream);
+		return NULL;
+	}
+
+	return _stream;
+}
+
+int decompress_stream_read_c(
+	/*_In_*/	w_lz4_decompress_stream* pStream,
+	/*_Inout_*/	char* pDstBuffer,
+	/*_In_*/	size_t pCapacity,
+	/*_Inout_*/	size_t* pReadSize,
+	/*_Inout_*/ char* pErrorLog)
+{
+	if (pReadSize) *pReadSize = 0;
+	if (!pStream || !pDstBuffer || !pReadSize || pStream->failed) return 1;
+
+	size_t _produced = 0;
+	while (_produced < pCapacity && !pStream->finished)
+	{
+		if (pStream->in_position == pStream->in_size)
+		{
+			pStream->in_size = pStream->read(pStream->user_data, pStream->in_buffer, IN_CHUNK_SIZE);
+			pStream->in_position = 0;
+			if (pStream->in_size == 0)
+			{
+				snprintf(
+					pErrorLog,
+					W_COMPRESS_ERROR_LOG_SIZE,
+					"compressed data ended before end of frame. trace_info: w_compress::decompress_stream_read_c");
+				pStream->failed = 1;
+				return 1;
+			}
+			pStream->size_in += pStream->in_size;
+		}
+
+		size_t _dst_size = pCapacity - _produced;
+		size_t _src_size = pStream->in_size - pStream->in_position;
+		size_t _result = LZ4F_decompress(
+			pStream->context,
+			pDstBuffer + _produced,
+			&_dst_size,
+			pStream->in_buffer + pStream->in_position,
+			&_src_size,
+			NULL);
+		if (LZ4F_isError(_result))
+		{
+			//a wrong checksum of content is reported here too
+			snprintf(
+				pErrorLog,
+				W_COMPRESS_ERROR_LOG_SIZE,
+				"could not decompress: %s. trace_info: w_compress::decompress_stream_read_c",
+				LZ4F_getErrorName(_result));
+			pStream->failed = 1;
+			return 1;
+		}
+
+		pStream->in_position += _src_size;
+		_produced += _dst_size;
+		//0 means the frame is fully decoded and verified
+		if (_result == 0) pStream->finished = 1;
+	}
+
+	pStream->size_out += _produced;
+	*pReadSize = _produced;
+	return 0;
+}
+
+int decompress_stream_end_c(
+	/*_In_*/	w_lz4_decompress_stream* pStream,
+	/*_Inout_*/	w_compress_result* pDecompressInfo)
+{
+	if (!pStream) return 1;
+
+	//bytes after the frame were read from source, but they are not part of it
+	int _failed = pStream->failed || !pStream->finished;
+	if (pDecompressInfo)
+	{
+		pDecompressInfo->size_in = pStream->size_in - (pStream->in_size - pStream->in_position);
+		pDecompressInfo->size_out = pStream->size_out;
+		pDecompressInfo->data = NULL;
+		pDecompressInfo->codec = W_CODEC_LZ4_FRAME;
+	}
+	_release_decompress_stream(pStream);
+
+	return _failed;
+}
+
+static size_t _file_write(void* pUserData, const char* pData, size_t pSize)
+{
+	return fwrite(pData, 1, pSize, (FILE*)pUserData);
+}
+
+static size_t _file_read(void* pUserData, char* pData, size_t pSize)
+{
+	return fread(pData, 1, pSize, (FILE*)pUserData);
+}
+
+int compress_file_c(
+	/*_In_*/	FILE* pFileStreamIn,
+	/*_In_*/	FILE* pCompressedFileOut,
+	/*_In_*/	w_compress_mode pMode,
+	/*_In_*/	int pAcceleration,
+	/*_Inout_*/	w_compress_result* pCompressInfo,
+	/*_Inout_*/ char* pErrorLog)
+{
+	if (!pFileStreamIn || !pCompressedFileOut) return 1;
+
+	char* _chunk = (char*)malloc(IN_CHUNK_SIZE);
+	if (!_chunk)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"allocating memory for file chunk. trace_info: w_compress::compress_file_c");
+		return 1;
+	}
+
+	w_lz4_compress_stream* _stream = compress_stream_begin_c(pMode, pAcceleration, _file_write, pCompressedFileOut, pErrorLog);
+	if (!_stream)
+	{
+		free(_chunk);
+		return 1;
+	}
+
+	int _failed = 0;
+	size_t _size;
+	while (!_failed && (_size = fread(_chunk, 1, IN_CHUNK_SIZE, pFileStreamIn)) > 0)
+	{
+		_failed = compress_stream_write_c(_stream, _chunk, _size, pErrorLog);
+	}
+	if (!_failed && ferror(pFileStreamIn))
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"could not read from file. trace_info: w_compress::compress_file_c");
+		_failed = 1;
+	}
+	free(_chunk);
+
+	//stream must be released even if it failed
+	if (compress_stream_end_c(_stream, pCompressInfo, pErrorLog))
+	{
+		_failed = 1;
+	}
+	return _failed;
+}
+
+int decompress_file_c(
+	/*_In_*/	FILE* pCompressedFileIn,
+	/*_In_*/	FILE* pFileStreamOut,
+	/*_Inout_*/	w_compress_result* pDecompressInfo,
+	/*_Inout_*/ char* pErrorLog)
+{
+	if (!pCompressedFileIn || !pFileStreamOut) return 1;
+
+	char* _chunk = (char*)malloc(IN_CHUNK_SIZE);
+	if (!_chunk)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"allocating memory for file chunk. trace_info: w_compress::decompress_file_c");
+		return 1;
+	}
+
+	w_lz4_decompress_stream* _stream = decompress_stream_begin_c(_file_read, pCompressedFileIn, pErrorLog);
+	if (!_stream)
+	{
+		free(_chunk);
+		return 1;
+	}
+
+	int _failed = 0;
+	size_t _size = 0;
+	do
+	{
+		_failed = decompress_stream_read_c(_stream, _chunk, IN_CHUNK_SIZE, &_size, pErrorLog);
+		if (!_failed && _size && fwrite(_chunk, 1, _size, pFileStreamOut) != _size)
+		{
+			snprintf(
+				pErrorLog,
+				W_COMPRESS_ERROR_LOG_SIZE,
+				"could not write to file. trace_info: w_compress::decompress_file_c");
+			_failed = 1;
+		}
+	} while (!_failed && _size);
+	free(_chunk);
+
+	if (decompress_stream_end_c(_stream, pDecompressInfo) && !_failed)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"compressed file ended before end of frame. trace_info: w_compress::decompress_file_c");
+		_failed = 1;
+	}
+	return _failed;
+}
+
+//decompressed size and id of dictionary
+#define DICTIONARY_HEADER_SIZE 8
+//lz4 only refers to the last 64KB
+#define MAX_DICTIONARY_SIZE (64 * 1024)
+
+static void _write_u32_le(char* pDst, unsigned int pValue)
+{
+	int i;
+	for (i = 0; i < 4; ++i) pDst[i] = (char)((pValue >> (8 * i)) & 0xFF);
+}
+
+static unsigned int _read_u32_le(const char* pSrc)
+{
+	unsigned int _value = 0;
+	int i;
+	for (i = 0; i < 4; ++i) _value |= (unsigned int)(unsigned char)pSrc[i] << (8 * i);
+	return _value;
+}
+
+static void _dictionary_tail(const char** pDictionary, size_t* pDictionarySize)
+{
+	if (*pDictionarySize > MAX_DICTIONARY_SIZE)
+	{
+		*pDictionary += *pDictionarySize - MAX_DICTIONARY_SIZE;
+		*pDictionarySize = MAX_DICTIONARY_SIZE;
+	}
+}
+
+int compress_buffer_with_dictionary_c(
+	/*_In_*/	const char* pSrcBuffer,
+	/*_In_*/	w_compress_mode pMode,
+	/*_In_*/	int pAcceleration,
+	/*_In_*/	const char* pDictionary,
+	/*_In_*/	size_t pDictionarySize,
+	/*_Inout_*/	w_compress_result* pCompressInfo,
+	/*_Inout_*/ char* pErrorLog)
+{
+	if (!pCompressInfo || !pSrcBuffer || pCompressInfo->size_in == 0 || pCompressInfo->size_in > LZ4_MAX_INPUT_SIZE) return 1;
+	if (!pDictionary)
+	{
+		pDictionary = "";
+		pDictionarySize = 0;
+	}
+	_dictionary_tail(&pDictionary, &pDictionarySize);
+
+	const int _max_dst_size = LZ4_compressBound((int)pCompressInfo->size_in);
+	pCompressInfo->data = (char*)malloc(DICTIONARY_HEADER_SIZE + _max_dst_size);
+	if (!pCompressInfo->data)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"allocating memory for compressed buffer. trace_info: w_compress::compress_buffer_with_dictionary_c");
+		return 1;
+	}
+
+	int _compressed_buffer_size = -1;
+	char* _dst = pCompressInfo->data + DICTIONARY_HEADER_SIZE;
+	if (pMode == W_HIGH)
+	{
+		LZ4_streamHC_t* _stream = LZ4_createStreamHC();
+		if (_stream)
+		{
+			LZ4_resetStreamHC(_stream, w_compress_hc_level(pAcceleration));
+			LZ4_loadDictHC(_stream, pDictionary, (int)pDictionarySize);
+			_compressed_buffer_size = LZ4_compress_HC_continue(
+				_stream,
+				pSrcBuffer,
+				_dst,
+				(int)pCompressInfo->size_in,
+				_max_dst_size);
+			LZ4_freeStreamHC(_stream);
+		}
+	}
+	else
+	{
+		LZ4_stream_t* _stream = LZ4_createStream();
+		if (_stream)
+		{
+			LZ4_loadDict(_stream, pDictionary, (int)pDictionarySize);
+			_compressed_buffer_size = LZ4_compress_fast_continue(
+				_stream,
+				pSrcBuffer,
+				_dst,
+				(int)pCompressInfo->size_in,
+				_max_dst_size,
+				pMode == W_FAST && pAcceleration > 1 ? pAcceleration : 1);
+			LZ4_freeStream(_stream);
+		}
+	}
+
+	if (_compressed_buffer_size <= 0)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"could not compress. trace_info: w_compress::compress_buffer_with_dictionary_c");
+		free(pCompressInfo->data);
+		pCompressInfo->data = NULL;
+		pCompressInfo->size_out = 0;
+		return 1;
+	}
+
+	_write_u32_le(pCompressInfo->data, (unsigned int)pCompressInfo->size_in);
+	_write_u32_le(pCompressInfo->data + 4, XXH32(pDictionary, pDictionarySize, 0));
+	pCompressInfo->size_out = DICTIONARY_HEADER_SIZE + (size_t)_compressed_buffer_size;
+	pCompressInfo->codec = W_CODEC_LZ4_DICTIONARY;
+
+	//realloc compress_data to free up memory, the larger block is still valid if it fails
+	char* _shrunk = (char*)realloc(pCompressInfo->data, pCompressInfo->size_out);
+	if (_shrunk) pCompressInfo->data = _shrunk;
+	return 0;
+}
+
+int decompress_buffer_with_dictionary_c(
+	/*_In_*/	const char* pCompressedBuffer,
+	/*_In_*/	const char* pDictionary,
+	/*_In_*/	size_t pDictionarySize,
+	/*_Inout_*/	w_compress_result* pDecompressInfo,
+	/*_Inout_*/ char* pErrorLog)
+{
+	if (!pCompressedBuffer || !pDecompressInfo || pDecompressInfo->size_in <= DICTIONARY_HEADER_SIZE) return 1;
+	if (!pDictionary)
+	{
+		pDictionary = "";
+		pDictionarySize = 0;
+	}
+	_dictionary_tail(&pDictionary, &pDictionarySize);
+
+	pDecompressInfo->data = NULL;
+	pDecompressInfo->size_out = 0;
+
+	unsigned int _size = _read_u32_le(pCompressedBuffer);
+	if (_read_u32_le(pCompressedBuffer + 4) != XXH32(pDictionary, pDictionarySize, 0))
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"buffer was compressed with another dictionary. trace_info: w_compress::decompress_buffer_with_dictionary_c");
+		return 1;
+	}
+	if (_size == 0 || _size > LZ4_MAX_INPUT_SIZE)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"wrong decompressed size. trace_info: w_compress::decompress_buffer_with_dictionary_c");
+		return 1;
+	}
+
+	pDecompressInfo->data = (char*)malloc(_size);
+	if (!pDecompressInfo->data)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"error on allocate buffer for decompressed buffer. trace_info: w_compress::decompress_buffer_with_dictionary_c");
+		return 1;
+	}
+
+	int _decompressed_size = LZ4_decompress_safe_usingDict(
+		pCompressedBuffer + DICTIONARY_HEADER_SIZE,
+		pDecompressInfo->data,
+		(int)(pDecompressInfo->size_in - DICTIONARY_HEADER_SIZE),
+		(int)_size,
+		pDictionary,
+		(int)pDictionarySize);
+	if (_decompressed_size != (int)_size)
+	{
+		snprintf(
+			pErrorLog,
+			W_COMPRESS_ERROR_LOG_SIZE,
+			"could not decompress. trace_info: w_compress::decompress_buffer_with_dictionary_c");
+		free(pDecompressInfo->data);
+		pDecompressInfo->data = NULL;
+		return 1;
+	}
+
+	pDecompressInfo->size_out = _size;
+	pDecompressInfo->codec = W_CODEC_LZ4_DICTIONARY;
+	return 0;
+}
+
+int is_lz4_frame_c(
+	/*_In_*/	const char* pBuffer,
+	/*_In_*/	size_t pSize)
+{
+	//magic number 0x184D2204 in little endian
+	if (!pBuffer || pSize < 4) return 0;
+	return (unsigned char)pBuffer[0] == 0x04 &&
+		(unsigned char)pBuffer[1] == 0x22 &&
+		(unsigned char)pBuffer[2] == 0x4D &&
+		(unsigned char)pBuffer[3] == 0x18;
+}
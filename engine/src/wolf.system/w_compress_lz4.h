@@ -4,7 +4,7 @@
 	Website			 : https://WolfEngine.App
 	Name			 : w_compress_lz4.h
 	Description		 : compress stream based on https://github.com/lz4/lz4
-	Comment          :
+	Comment          : compress_buffer_c and decompress_buffer_c work on raw lz4 blocks, streams and files use lz4 frame format
 */
 
 #pragma once
@@ -29,8 +29,91 @@ extern "C" {
 		/*_Inout_*/	w_compress_result* pDecompressInfo,
 		/*_Inout_*/ char* pErrorLog);
 
-	/*WSYS_EXP w_compress_result compress_file_c(FILE* pFileStreamIn, FILE* pCompressedFileOut, _Inout_ char* pErrorLog);
-	WSYS_EXP w_compress_result decompress_file_c(FILE* pCompressedFileIn, FILE* pFileStreamOut, _Inout_ char* pErrorLog);*/
+	/*
+		streaming api writes a single lz4 frame with content checksum, input size is not needed up front.
+		data is compressed in blocks of 64KB, so working memory does not depend on size of data
+	*/
+	typedef struct w_lz4_compress_stream w_lz4_compress_stream;
+	typedef struct w_lz4_decompress_stream w_lz4_decompress_stream;
+
+	//writes header of frame with pWrite, returns NULL on failure
+	WSYS_EXP w_lz4_compress_stream* compress_stream_begin_c(
+		/*_In_*/	w_compress_mode pMode,
+		/*_In_*/	int pAcceleration,
+		/*_In_*/	w_compress_write_fn pWrite,
+		/*_In_*/	void* pUserData,
+		/*_Inout_*/ char* pErrorLog);
+
+	WSYS_EXP int compress_stream_write_c(
+		/*_In_*/	w_lz4_compress_stream* pStream,
+		/*_In_*/	const char* pSrcBuffer,
+		/*_In_*/	size_t pSize,
+		/*_Inout_*/ char* pErrorLog);
+
+	//writes end of frame and releases pStream, size_in and size_out of pCompressInfo (optional) are filled, data is NULL
+	WSYS_EXP int compress_stream_end_c(
+		/*_In_*/	w_lz4_compress_stream* pStream,
+		/*_Inout_*/	w_compress_result* pCompressInfo,
+		/*_Inout_*/ char* pErrorLog);
+
+	//returns NULL on failure
+	WSYS_EXP w_lz4_decompress_stream* decompress_stream_begin_c(
+		/*_In_*/	w_compress_read_fn pRead,
+		/*_In_*/	void* pUserData,
+		/*_Inout_*/ char* pErrorLog);
+
+	//fills pDstBuffer as much as possible, pReadSize is 0 at end of frame. checksum of content is verified at the end
+	WSYS_EXP int decompress_stream_read_c(
+		/*_In_*/	w_lz4_decompress_stream* pStream,
+		/*_Inout_*/	char* pDstBuffer,
+		/*_In_*/	size_t pCapacity,
+		/*_Inout_*/	size_t* pReadSize,
+		/*_Inout_*/ char* pErrorLog);
+
+	//releases pStream, size_in and size_out of pDecompressInfo (optional) are filled, data is NULL
+	WSYS_EXP int decompress_stream_end_c(
+		/*_In_*/	w_lz4_decompress_stream* pStream,
+		/*_Inout_*/	w_compress_result* pDecompressInfo);
+
+	//compresses pFileStreamIn to an lz4 frame on pCompressedFileOut, files are not closed
+	WSYS_EXP int compress_file_c(
+		/*_In_*/	FILE* pFileStreamIn,
+		/*_In_*/	FILE* pCompressedFileOut,
+		/*_In_*/	w_compress_mode pMode,
+		/*_In_*/	int pAcceleration,
+		/*_Inout_*/	w_compress_result* pCompressInfo,
+		/*_Inout_*/ char* pErrorLog);
+
+	WSYS_EXP int decompress_file_c(
+		/*_In_*/	FILE* pCompressedFileIn,
+		/*_In_*/	FILE* pFileStreamOut,
+		/*_Inout_*/	w_compress_result* pDecompressInfo,
+		/*_Inout_*/ char* pErrorLog);
+
+	/*
+		compress small buffers against a shared dictionary (see w_compress_dictionary), only the last 64KB of pDictionary is used.
+		The compressed buffer starts with decompressed size and id of dictionary, so a wrong dictionary is detected
+	*/
+	WSYS_EXP int compress_buffer_with_dictionary_c(
+		/*_In_*/	const char* pSrcBuffer,
+		/*_In_*/	w_compress_mode pMode,
+		/*_In_*/	int pAcceleration,
+		/*_In_*/	const char* pDictionary,
+		/*_In_*/	size_t pDictionarySize,
+		/*_Inout_*/	w_compress_result* pCompressInfo,
+		/*_Inout_*/ char* pErrorLog);
+
+	WSYS_EXP int decompress_buffer_with_dictionary_c(
+		/*_In_*/	const char* pCompressedBuffer,
+		/*_In_*/	const char* pDictionary,
+		/*_In_*/	size_t pDictionarySize,
+		/*_Inout_*/	w_compress_result* pDecompressInfo,
+		/*_Inout_*/ char* pErrorLog);
+
+	//returns 1 if pBuffer starts with magic number of lz4 frame, buffers of compress_buffer_c do not
+	WSYS_EXP int is_lz4_frame_c(
+		/*_In_*/	const char* pBuffer,
+		/*_In_*/	size_t pSize);
 
 #if defined (__cplusplus)
 }
@@ -1,77 +1,125 @@
 #include "w_system_pch.h"
 #include "w_compress_lzma.h"
+#include "lzma/LzmaEnc.h"
+#include "lzma/LzmaDec.h"
 
 using namespace wolf::system;
 
-int w_compress_lzma::compress(const uint8_t* pSourceBuffer, w_compress_result* pCompressInfo)
+//5 bytes of properties + 8 bytes of decompressed size
+static const size_t s_header_size = LZMA_PROPS_SIZE + 8;
+//larger sizes in header are treated as corrupted data
+static const UInt64 s_max_size = 256 * 1024 * 1024;
+
+static void* _lzma_alloc(ISzAllocPtr, size_t size)
+{
+	return new (std::nothrow) uint8_t[size];
+}
+static void _lzma_free(ISzAllocPtr, void *addr)
 {
-	// set up properties
+	if (!addr) return;
+
+	delete[] reinterpret_cast<uint8_t *>(addr);
+}
+
+static ISzAlloc _alloc_funcs = { _lzma_alloc, _lzma_free };
+
+static int _encode(
+	const uint8_t* pSrc,
+	size_t pSrcSize,
+	uint8_t* pDst,
+	size_t& pDstSize,
+	uint8_t* pProps,
+	int pLevel)
+{
+	// set up properties, dictionary is never larger than data
 	CLzmaEncProps _props;
 	LzmaEncProps_Init(&_props);
+	_props.level = pLevel < W_COMPRESS_LZMA_LEVEL_MIN ? W_COMPRESS_LZMA_LEVEL_MIN :
+		pLevel > W_COMPRESS_LZMA_LEVEL_MAX ? W_COMPRESS_LZMA_LEVEL_MAX : pLevel;
+	_props.reduceSize = pSrcSize;
 
-	if (pCompressInfo->size_in >= (1 << 20))
-	{
-		_props.dictSize = 1 << 20; //1mb dictionary
-	}
-	else
-	{
-		_props.dictSize = pCompressInfo->size_in; //smaller dictionary = faster!
-	}
-	_props.fb = 40;
-
-	// prepare space for the encoded properties
-	SizeT _props_size = 5;
-	unsigned char _props_encoded[5];
-
-	// allocate some space for the compression output
-	// this is way more than necessary in most cases...
-	// but better safe than sorry
-	//   (a smarter implementation would use a growing buffer,
-	//    but this requires a bunch of fuckery that is out of
-	///   scope for this simple example)
-	SizeT _output_size_64 = pCompressInfo->size_in * 2.0f;
-	if (_output_size_64 < 1024)
-	{
-		_output_size_64 = 1024;
-	}
-
-	auto _compress_mem = (uint8_t*)malloc(_output_size_64 * sizeof(uint8_t));
-	int _lzma_status = LzmaEncode(
-		_compress_mem,
-		&_output_size_64,
-		pSourceBuffer,
-		pCompressInfo->size_in,
+	SizeT _props_size = LZMA_PROPS_SIZE;
+	SizeT _dst_size = pDstSize;
+	auto _status = LzmaEncode(
+		pDst,
+		&_dst_size,
+		pSrc,
+		pSrcSize,
 		&_props,
-		_props_encoded,
+		pProps,
 		&_props_size,
 		0,
 		NULL,
 		&_alloc_funcs,
 		&_alloc_funcs);
 
-	pCompressInfo->size_out = _output_size_64 + 13;
-	if (_lzma_status == SZ_OK)
+	pDstSize = _dst_size;
+	return _status == SZ_OK ? 0 : 1;
+}
+
+static int _decode(
+	const uint8_t* pSrc,
+	size_t pSrcSize,
+	const uint8_t* pProps,
+	uint8_t* pDst,
+	size_t pDstSize)
+{
+	ELzmaStatus _lzma_status;
+	SizeT _proc_out_size = pDstSize, _proc_in_size = pSrcSize;
+	auto _status = LzmaDecode(
+		pDst,
+		&_proc_out_size,
+		pSrc,
+		&_proc_in_size,
+		pProps,
+		LZMA_PROPS_SIZE,
+		LZMA_FINISH_END,
+		&_lzma_status,
+		&_alloc_funcs);
+
+	return _status == SZ_OK && _proc_out_size == pDstSize ? 0 : 1;
+}
+
+size_t w_compress_lzma::get_block_bound(size_t pSize)
+{
+	//same bound as LzmaLib of sdk
+	return LZMA_PROPS_SIZE + pSize + pSize / 3 + 128;
+}
+
+int w_compress_lzma::compress(const uint8_t* pSourceBuffer, w_compress_result* pCompressInfo, int pLevel)
+{
+	pCompressInfo->size_out = 0;
+
+	// compress right after the header, so data is not copied again
+	auto _capacity = get_block_bound(pCompressInfo->size_in) - LZMA_PROPS_SIZE;
+	auto _data = (char*)malloc(s_header_size + _capacity);
+	if (!_data) return 1;
+
+	size_t _size = _capacity;
+	if (_encode(pSourceBuffer, pCompressInfo->size_in, (uint8_t*)_data + s_header_size, _size, (uint8_t*)_data, pLevel))
 	{
-		// tricky: we have to generate the LZMA header
-		// 5 bytes properties + 8 byte uncompressed size
-		pCompressInfo->data = (char*)malloc((_output_size_64 + 13) * sizeof(char));
-		
-		memcpy(pCompressInfo->data, _props_encoded, 5);
-		for (int i = 0; i < 8; i++)
-		{
-			pCompressInfo->data[5 + i] = (pCompressInfo->size_in >> (i * 8)) & 0xFF;
-		}
-		memcpy(pCompressInfo->data + 13, _compress_mem, _output_size_64);
-
-		return 0;
+		free(_data);
+		return 1;
 	}
-	return 1;
+
+	for (int i = 0; i < 8; i++)
+	{
+		_data[LZMA_PROPS_SIZE + i] = (char)((static_cast<UInt64>(pCompressInfo->size_in) >> (i * 8)) & 0xFF);
+	}
+
+	pCompressInfo->size_out = s_header_size + _size;
+	pCompressInfo->codec = W_CODEC_LZMA;
+	//shrinking never fails on common allocators, keep the larger block if it does
+	auto _shrunk = (char*)realloc(_data, pCompressInfo->size_out);
+	pCompressInfo->data = _shrunk ? _shrunk : _data;
+
+	return 0;
 }
 
 int w_compress_lzma::decompress(const uint8_t* pCompressedBuffer, w_compress_result* pDeCompressInfo)
 {
 	pDeCompressInfo->size_out = 0;
-	if (pDeCompressInfo->size_in < 13)
+	if (pDeCompressInfo->size_in < s_header_size)
 	{
 		return 1; // invalid header!
 	}
@@ -80,32 +128,52 @@ int w_compress_lzma::decompress(const uint8_t* pCompressedBuffer, w_compress_res
 	UInt64 _size_from_header = 0;
 	for (int i = 0; i < 8; i++)
 	{
-		_size_from_header |= (pCompressedBuffer[5 + i] << (i * 8));
+		_size_from_header |= static_cast<UInt64>(pCompressedBuffer[LZMA_PROPS_SIZE + i]) << (i * 8);
 	}
+	if (_size_from_header > s_max_size) return 1;
+
+	// one more byte for null terminator of text data
+	auto _data = (char*)malloc(static_cast<size_t>(_size_from_header) + 1);
+	if (!_data) return 1;
 
-	if (_size_from_header <= (256 * 1024 * 1024))
+	if (_decode(
+		pCompressedBuffer + s_header_size,
+		pDeCompressInfo->size_in - s_header_size,
+		pCompressedBuffer,
+		(uint8_t*)_data,
+		static_cast<size_t>(_size_from_header)))
 	{
-		pDeCompressInfo->data = (char*)malloc(_size_from_header);
-
-		ELzmaStatus _lzma_status;
-		SizeT _proc_out_size = _size_from_header, _proc_in_size = pDeCompressInfo->size_in - 13;
-		int status = LzmaDecode(
-			(uint8_t*)pDeCompressInfo->data,
-			&_proc_out_size,
-			&pCompressedBuffer[13],
-			&_proc_in_size,
-			pCompressedBuffer,
-			5,
-			LZMA_FINISH_END,
-			&_lzma_status,
-			&_alloc_funcs);
-
-		if (status == SZ_OK && _proc_out_size == _size_from_header)
-		{
-			pDeCompressInfo->data[_proc_out_size] = '\0';
-			pDeCompressInfo->size_out = _proc_out_size;
-			return 0;
-		}
+		free(_data);
+		return 1;
 	}
-	return 1;
-}
\ No newline at end of file
+
+	_data[_size_from_header] = '\0';
+	pDeCompressInfo->data = _data;
+	pDeCompressInfo->size_out = static_cast<size_t>(_size_from_header);
+	pDeCompressInfo->codec = W_CODEC_LZMA;
+	return 0;
+}
+
+size_t w_compress_lzma::compress_block(
+	const uint8_t* pSrc,
+	size_t pSrcSize,
+	uint8_t* pDst,
+	size_t pDstCapacity,
+	int pLevel)
+{
+	if (pDstCapacity <= LZMA_PROPS_SIZE) return 0;
+
+	size_t _size = pDstCapacity - LZMA_PROPS_SIZE;
+	if (_encode(pSrc, pSrcSize, pDst + LZMA_PROPS_SIZE, _size, pDst, pLevel)) return 0;
+	return LZMA_PROPS_SIZE + _size;
+}
+
+int w_compress_lzma::decompress_block(
+	const uint8_t* pSrc,
+	size_t pSrcSize,
+	uint8_t* pDst,
+	size_t pDstSize)
+{
+	if (pSrcSize < LZMA_PROPS_SIZE) return 1;
+	return _decode(pSrc + LZMA_PROPS_SIZE, pSrcSize - LZMA_PROPS_SIZE, pSrc, pDst, pDstSize);
+}
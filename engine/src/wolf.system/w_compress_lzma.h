@@ -4,7 +4,8 @@
 	Website			 : https://WolfEngine.App
 	Name			 : w_compress_lzma.h
 	Description		 : compress stream based on https://www.7-zip.org/sdk.html
-	Comment          :
+	Comment          : compress and decompress use the header of .lzma files, 5 bytes of properties and 8 bytes of size.
+					   Blocks only have the properties, w_compress_parallel keeps their sizes
 */
 
 #if _MSC_VER > 1000
@@ -18,30 +19,32 @@
 #include "w_compress_data_type.h"
 #include "w_std.h"
 
-#ifdef __WIN32
-#include "lzma/LzmaEnc.h"
-#include "lzma/LzmaDec.h"
-#endif
-
-static void* _lzma_alloc(ISzAllocPtr, size_t size)
-{
-	return new uint8_t[size];
-}
-static void _lzma_free(ISzAllocPtr, void *addr)
-{
-	if (!addr) return;
-
-	delete[] reinterpret_cast<uint8_t *>(addr);
-}
-
-static ISzAlloc _alloc_funcs = { _lzma_alloc, _lzma_free };
-
 namespace wolf::system
 {
 	struct w_compress_lzma
 	{
-		WSYS_EXP static int compress(const uint8_t* pSourceBuffer, w_compress_result* pCompressInfo);
+		//data of pCompressInfo must be released with free, pLevel is from W_COMPRESS_LZMA_LEVEL_MIN to W_COMPRESS_LZMA_LEVEL_MAX
+		WSYS_EXP static int compress(
+			const uint8_t* pSourceBuffer,
+			w_compress_result* pCompressInfo,
+			int pLevel = W_COMPRESS_LZMA_LEVEL_DEFAULT);
 		WSYS_EXP static int decompress(const uint8_t* pCompressedBuffer, w_compress_result* pDeCompressInfo);
+
+		//size of pDst which is enough for a block of pSize bytes
+		WSYS_EXP static size_t get_block_bound(size_t pSize);
+		//returns compressed size of block, 0 if it does not fit in pDstCapacity
+		WSYS_EXP static size_t compress_block(
+			const uint8_t* pSrc,
+			size_t pSrcSize,
+			uint8_t* pDst,
+			size_t pDstCapacity,
+			int pLevel);
+		//pDstSize must be the exact size of decompressed block
+		WSYS_EXP static int decompress_block(
+			const uint8_t* pSrc,
+			size_t pSrcSize,
+			uint8_t* pDst,
+			size_t pDstSize);
 	};
 }
 
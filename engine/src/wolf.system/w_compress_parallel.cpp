@@ -0,0 +1,423 @@
+#include "w_system_pch.h"
+#include "w_compress_parallel.h"
+#include "w_compress_lzma.h"
+#include "w_parallel.h"
+#include "lz4/lz4.h"
+#include "lz4/lz4hc.h"
+#include "lz4/xxhash.h"
+#include <atomic>
+
+using namespace wolf::system;
+
+static const char s_magic[4] = { 'W', 'L', 'Z', 'P' };
+static const uint32_t s_version = 2;
+//magic, version, codec, block size, block count and decompressed size. version 1 has no codec and is always lz4
+static const size_t s_header_size = 28;
+static const size_t s_header_size_v1 = 24;
+//offset, compressed size, size and checksum
+static const size_t s_index_entry_size = 20;
+static const size_t s_min_block_size = 64 * 1024;
+static const size_t s_max_block_size = 1024 * 1024 * 1024;
+
+static void _write_u32(char* pDst, uint32_t pValue)
+{
+	for (int i = 0; i < 4; ++i) pDst[i] = static_cast<char>((pValue >> (8 * i)) & 0xFF);
+}
+
+static void _write_u64(char* pDst, uint64_t pValue)
+{
+	for (int i = 0; i < 8; ++i) pDst[i] = static_cast<char>((pValue >> (8 * i)) & 0xFF);
+}
+
+static uint32_t _read_u32(const char* pSrc)
+{
+	uint32_t _value = 0;
+	for (int i = 0; i < 4; ++i) _value |= static_cast<uint32_t>(static_cast<uint8_t>(pSrc[i])) << (8 * i);
+	return _value;
+}
+
+static uint64_t _read_u64(const char* pSrc)
+{
+	uint64_t _value = 0;
+	for (int i = 0; i < 8; ++i) _value |= static_cast<uint64_t>(static_cast<uint8_t>(pSrc[i])) << (8 * i);
+	return _value;
+}
+
+static W_RESULT _decompress_block(
+	const char* pData,
+	const w_compress_block_info& pBlock,
+	w_compress_codec pCodec,
+	char* pDst)
+{
+	auto _src = pData + pBlock.offset;
+	if (pBlock.compressed_size == pBlock.size)
+	{
+		std::memcpy(pDst, _src, pBlock.size);
+	}
+	else if (pCodec == W_CODEC_LZMA_PARALLEL)
+	{
+		if (w_compress_lzma::decompress_block(
+			reinterpret_cast<const uint8_t*>(_src),
+			pBlock.compressed_size,
+			reinterpret_cast<uint8_t*>(pDst),
+			pBlock.size)) return W_FAILED;
+	}
+	else
+	{
+		auto _size = LZ4_decompress_safe(
+			_src,
+			pDst,
+			static_cast<int>(pBlock.compressed_size),
+			static_cast<int>(pBlock.size));
+		if (_size != static_cast<int>(pBlock.size)) return W_FAILED;
+	}
+	return XXH32(pDst, pBlock.size, 0) == pBlock.checksum ? W_PASSED : W_FAILED;
+}
+
+//pLevel is the acceleration of lz4 or the level of lzma
+static W_RESULT _compress(
+	const char* pSrcBuffer,
+	w_compress_result* pCompressInfo,
+	w_compress_codec pCodec,
+	w_compress_mode pMode,
+	int pLevel,
+	size_t pBlockSize,
+	w_thread_pool* pThreadPool)
+{
+	if (!pSrcBuffer || !pCompressInfo || pCompressInfo->size_in == 0) return W_INVALIDARG;
+
+	pCompressInfo->data = nullptr;
+	pCompressInfo->size_out = 0;
+
+	if (pBlockSize < s_min_block_size) pBlockSize = s_min_block_size;
+	if (pBlockSize > s_max_block_size) pBlockSize = s_max_block_size;
+
+	const auto _size = pCompressInfo->size_in;
+	const auto _block_count = (_size + pBlockSize - 1) / pBlockSize;
+	if (_block_count > UINT32_MAX)
+	{
+		wolf::logger.error("too many blocks, use a larger block size. trace info: w_compress_parallel::_compress");
+		return W_INVALIDARG;
+	}
+
+	//each block is compressed into its own slot first, then slots are packed together
+	const auto _bound = pCodec == W_CODEC_LZMA_PARALLEL ?
+		w_compress_lzma::get_block_bound(pBlockSize) :
+		static_cast<size_t>(LZ4_compressBound(static_cast<int>(pBlockSize)));
+	const auto _data_offset = s_header_size + _block_count * s_index_entry_size;
+	auto _out = static_cast<char*>(malloc(_data_offset + _block_count * _bound));
+	if (!_out)
+	{
+		wolf::logger.error("allocating memory for compressed buffer. trace info: w_compress_parallel::_compress");
+		return W_OUTOFMEMORY;
+	}
+
+	std::vector<w_compress_block_info> _blocks(_block_count);
+	auto& _pool = pThreadPool ? *pThreadPool : w_task::get_shared_thread_pool();
+	parallel_for(_pool, 0, _block_count, 1, [&](size_t i)
+	{
+		auto _src = pSrcBuffer + i * pBlockSize;
+		auto _src_size = static_cast<int>(std::min(pBlockSize, _size - i * pBlockSize));
+		auto _dst = _out + _data_offset + i * _bound;
+
+		int _compressed_size;
+		if (pCodec == W_CODEC_LZMA_PARALLEL)
+		{
+			_compressed_size = static_cast<int>(w_compress_lzma::compress_block(
+				reinterpret_cast<const uint8_t*>(_src),
+				_src_size,
+				reinterpret_cast<uint8_t*>(_dst),
+				_bound,
+				pLevel));
+		}
+		else if (pMode == w_compress_mode::W_HIGH)
+		{
+			_compressed_size = LZ4_compress_HC(_src, _dst, _src_size, static_cast<int>(_bound), w_compress_hc_level(pLevel));
+		}
+		else if (pMode == w_compress_mode::W_FAST)
+		{
+			_compressed_size = LZ4_compress_fast(_src, _dst, _src_size, static_cast<int>(_bound), pLevel);
+		}
+		else
+		{
+			_compressed_size = LZ4_compress_default(_src, _dst, _src_size, static_cast<int>(_bound));
+		}
+
+		//blocks which do not shrink are stored as they are
+		if (_compressed_size <= 0 || _compressed_size >= _src_size)
+		{
+			std::memcpy(_dst, _src, _src_size);
+			_compressed_size = _src_size;
+		}
+
+		auto& _block = _blocks[i];
+		_block.compressed_size = static_cast<uint32_t>(_compressed_size);
+		_block.size = static_cast<uint32_t>(_src_size);
+		_block.checksum = XXH32(_src, _src_size, 0);
+	});
+
+	//pack slots in order, a block never moves past its own slot
+	uint64_t _offset = 0;
+	for (size_t i = 0; i < _block_count; ++i)
+	{
+		auto& _block = _blocks[i];
+		std::memmove(_out + _data_offset + _offset, _out + _data_offset + i * _bound, _block.compressed_size);
+		_block.offset = _offset;
+		_offset += _block.compressed_size;
+	}
+
+	std::memcpy(_out, s_magic, sizeof(s_magic));
+	_write_u32(_out + 4, s_version);
+	_write_u32(_out + 8, static_cast<uint32_t>(pCodec));
+	_write_u32(_out + 12, static_cast<uint32_t>(pBlockSize));
+	_write_u32(_out + 16, static_cast<uint32_t>(_block_count));
+	_write_u64(_out + 20, _size);
+	for (size_t i = 0; i < _block_count; ++i)
+	{
+		auto _entry = _out + s_header_size + i * s_index_entry_size;
+		_write_u64(_entry, _blocks[i].offset);
+		_write_u32(_entry + 8, _blocks[i].compressed_size);
+		_write_u32(_entry + 12, _blocks[i].size);
+		_write_u32(_entry + 16, _blocks[i].checksum);
+	}
+
+	pCompressInfo->size_out = _data_offset + static_cast<size_t>(_offset);
+	pCompressInfo->codec = pCodec;
+	//shrinking never fails on common allocators, keep the larger block if it does
+	auto _shrunk = static_cast<char*>(realloc(_out, pCompressInfo->size_out));
+	pCompressInfo->data = _shrunk ? _shrunk : _out;
+
+	return W_PASSED;
+}
+
+//parse header and index, pData is set to the first block
+static W_RESULT _read_blocks(
+	const char* pCompressedBuffer,
+	size_t pCompressedSize,
+	std::vector<w_compress_block_info>& pBlocks,
+	size_t& pSize,
+	w_compress_codec& pCodec,
+	const char*& pData)
+{
+	pBlocks.clear();
+	pSize = 0;
+	pCodec = W_CODEC_UNKNOWN;
+	pData = nullptr;
+
+	if (!w_compress_parallel::get_is_parallel(pCompressedBuffer, pCompressedSize))
+	{
+		wolf::logger.error("buffer was not compressed with w_compress_parallel. trace info: w_compress_parallel::_read_blocks");
+		return W_INVALIDARG;
+	}
+
+	//fields of version 1 start right after the version
+	size_t _header_size;
+	auto _fields = pCompressedBuffer + 8;
+	const auto _version = _read_u32(pCompressedBuffer + 4);
+	if (_version == 1)
+	{
+		_header_size = s_header_size_v1;
+		pCodec = W_CODEC_LZ4_PARALLEL;
+	}
+	else if (_version == s_version && pCompressedSize >= s_header_size)
+	{
+		_header_size = s_header_size;
+		pCodec = static_cast<w_compress_codec>(_read_u32(_fields));
+		_fields += 4;
+		if (pCodec != W_CODEC_LZ4_PARALLEL && pCodec != W_CODEC_LZMA_PARALLEL)
+		{
+			wolf::logger.error("unsupported codec. trace info: w_compress_parallel::_read_blocks");
+			return W_FAILED;
+		}
+	}
+	else
+	{
+		wolf::logger.error("unsupported version. trace info: w_compress_parallel::_read_blocks");
+		return W_FAILED;
+	}
+
+	const auto _block_size = _read_u32(_fields);
+	const size_t _block_count = _read_u32(_fields + 4);
+	const auto _size = _read_u64(_fields + 8);
+
+	//every field is checked against size of buffer, so broken headers can not read out of it
+	if ((pCompressedSize - _header_size) / s_index_entry_size < _block_count)
+	{
+		wolf::logger.error("index of blocks is truncated. trace info: w_compress_parallel::_read_blocks");
+		return W_FAILED;
+	}
+	const auto _data_size = pCompressedSize - _header_size - _block_count * s_index_entry_size;
+
+	pBlocks.resize(_block_count);
+	uint64_t _total = 0;
+	for (size_t i = 0; i < _block_count; ++i)
+	{
+		auto _entry = pCompressedBuffer + _header_size + i * s_index_entry_size;
+		auto& _block = pBlocks[i];
+		_block.offset = _read_u64(_entry);
+		_block.compressed_size = _read_u32(_entry + 8);
+		_block.size = _read_u32(_entry + 12);
+		_block.checksum = _read_u32(_entry + 16);
+
+		if (_block.size > _block_size ||
+			_block.compressed_size > _block.size ||
+			_block.offset > _data_size ||
+			_block.compressed_size > _data_size - _block.offset)
+		{
+			pBlocks.clear();
+			wolf::logger.error("index of blocks is corrupted. trace info: w_compress_parallel::_read_blocks");
+			return W_FAILED;
+		}
+		_total += _block.size;
+	}
+
+	if (_total != _size || _size > SIZE_MAX)
+	{
+		pBlocks.clear();
+		wolf::logger.error("size of blocks does not match the header. trace info: w_compress_parallel::_read_blocks");
+		return W_FAILED;
+	}
+
+	pSize = static_cast<size_t>(_size);
+	pData = pCompressedBuffer + _header_size + _block_count * s_index_entry_size;
+	return W_PASSED;
+}
+
+W_RESULT w_compress_parallel::compress(
+	_In_ const char* pSrcBuffer,
+	_Inout_ w_compress_result* pCompressInfo,
+	_In_ w_compress_mode pMode,
+	_In_ int pAcceleration,
+	_In_ size_t pBlockSize,
+	_In_opt_ w_thread_pool* pThreadPool)
+{
+	return _compress(pSrcBuffer, pCompressInfo, W_CODEC_LZ4_PARALLEL, pMode, pAcceleration, pBlockSize, pThreadPool);
+}
+
+W_RESULT w_compress_parallel::compress_lzma(
+	_In_ const char* pSrcBuffer,
+	_Inout_ w_compress_result* pCompressInfo,
+	_In_ int pLevel,
+	_In_ size_t pBlockSize,
+	_In_opt_ w_thread_pool* pThreadPool)
+{
+	return _compress(pSrcBuffer, pCompressInfo, W_CODEC_LZMA_PARALLEL, w_compress_mode::W_DEFAULT, pLevel, pBlockSize, pThreadPool);
+}
+
+W_RESULT w_compress_parallel::decompress(
+	_In_ const char* pCompressedBuffer,
+	_Inout_ w_compress_result* pDecompressInfo,
+	_In_opt_ w_thread_pool* pThreadPool)
+{
+	if (!pCompressedBuffer || !pDecompressInfo) return W_INVALIDARG;
+
+	pDecompressInfo->data = nullptr;
+	pDecompressInfo->size_out = 0;
+
+	std::vector<w_compress_block_info> _blocks;
+	size_t _size = 0;
+	w_compress_codec _codec;
+	const char* _data;
+	auto _hr = _read_blocks(pCompressedBuffer, pDecompressInfo->size_in, _blocks, _size, _codec, _data);
+	if (_hr != W_PASSED) return _hr;
+
+	//malloc of zero bytes may return nullptr
+	auto _out = static_cast<char*>(malloc(_size ? _size : 1));
+	if (!_out)
+	{
+		logger.error("allocating memory for decompressed buffer. trace info: w_compress_parallel::decompress");
+		return W_OUTOFMEMORY;
+	}
+
+	//offset of each block in decompressed data
+	std::vector<size_t> _offsets(_blocks.size());
+	size_t _offset = 0;
+	for (size_t i = 0; i < _blocks.size(); ++i)
+	{
+		_offsets[i] = _offset;
+		_offset += _blocks[i].size;
+	}
+
+	std::atomic<bool> _failed(false);
+	auto& _pool = pThreadPool ? *pThreadPool : w_task::get_shared_thread_pool();
+	parallel_for(_pool, 0, _blocks.size(), 1, [&](size_t i)
+	{
+		if (_decompress_block(_data, _blocks[i], _codec, _out + _offsets[i]) != W_PASSED)
+		{
+			_failed.store(true, std::memory_order_relaxed);
+		}
+	});
+
+	if (_failed.load())
+	{
+		free(_out);
+		logger.error("corrupted block or wrong checksum. trace info: w_compress_parallel::decompress");
+		return W_FAILED;
+	}
+
+	pDecompressInfo->data = _out;
+	pDecompressInfo->size_out = _size;
+	pDecompressInfo->codec = _codec;
+	return W_PASSED;
+}
+
+W_RESULT w_compress_parallel::decompress_block(
+	_In_ const char* pCompressedBuffer,
+	_In_ const size_t& pCompressedSize,
+	_In_ const size_t& pBlockIndex,
+	_Inout_ char* pDstBuffer)
+{
+	if (!pCompressedBuffer || !pDstBuffer) return W_INVALIDARG;
+
+	std::vector<w_compress_block_info> _blocks;
+	size_t _size = 0;
+	w_compress_codec _codec;
+	const char* _data;
+	auto _hr = _read_blocks(pCompressedBuffer, pCompressedSize, _blocks, _size, _codec, _data);
+	if (_hr != W_PASSED) return _hr;
+
+	if (pBlockIndex >= _blocks.size())
+	{
+		logger.error("block index is out of range. trace info: w_compress_parallel::decompress_block");
+		return W_INVALIDARG;
+	}
+
+	if (_decompress_block(_data, _blocks[pBlockIndex], _codec, pDstBuffer) != W_PASSED)
+	{
+		logger.error("corrupted block or wrong checksum. trace info: w_compress_parallel::decompress_block");
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
+
+W_RESULT w_compress_parallel::get_blocks(
+	_In_ const char* pCompressedBuffer,
+	_In_ const size_t& pCompressedSize,
+	_Inout_ std::vector<w_compress_block_info>& pBlocks,
+	_Inout_ size_t& pSize)
+{
+	w_compress_codec _codec;
+	const char* _data;
+	return _read_blocks(pCompressedBuffer, pCompressedSize, pBlocks, pSize, _codec, _data);
+}
+
+w_compress_codec w_compress_parallel::get_codec(
+	_In_ const char* pBuffer,
+	_In_ const size_t& pSize)
+{
+	if (!get_is_parallel(pBuffer, pSize)) return W_CODEC_UNKNOWN;
+
+	const auto _version = _read_u32(pBuffer + 4);
+	if (_version == 1) return W_CODEC_LZ4_PARALLEL;
+	if (_version != s_version || pSize < s_header_size) return W_CODEC_UNKNOWN;
+
+	const auto _codec = static_cast<w_compress_codec>(_read_u32(pBuffer + 8));
+	return _codec == W_CODEC_LZ4_PARALLEL || _codec == W_CODEC_LZMA_PARALLEL ? _codec : W_CODEC_UNKNOWN;
+}
+
+bool w_compress_parallel::get_is_parallel(
+	_In_ const char* pBuffer,
+	_In_ const size_t& pSize)
+{
+	return pBuffer && pSize >= s_header_size_v1 && std::memcmp(pBuffer, s_magic, sizeof(s_magic)) == 0;
+}
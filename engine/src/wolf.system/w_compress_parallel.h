@@ -0,0 +1,90 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_compress_parallel.h
+	Description		 : lz4 or lzma compression of independent blocks on w_thread_pool
+	Comment          : Layout is header, index of blocks and then compressed blocks, all integers are little endian.
+					   Each block has its own xxh32 checksum, so a single block can be decompressed and verified
+					   without touching the rest of data. Header of version 2 keeps the codec of blocks
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_compress_data_type.h"
+#include "w_std.h"
+#include <vector>
+
+namespace wolf::system
+{
+	class w_thread_pool;
+
+	static const size_t W_COMPRESS_PARALLEL_DEFAULT_BLOCK_SIZE = 2 * 1024 * 1024;
+	//each lzma encoder needs about 12 times of block size
+	static const size_t W_COMPRESS_PARALLEL_LZMA_BLOCK_SIZE = 4 * 1024 * 1024;
+
+	struct w_compress_block_info
+	{
+		//offset of compressed block from start of data
+		uint64_t        offset = 0;
+		//equals size if block was stored without compression
+		uint32_t        compressed_size = 0;
+		uint32_t        size = 0;
+		//xxh32 of decompressed block
+		uint32_t        checksum = 0;
+	};
+
+	struct w_compress_parallel
+	{
+		/*
+			compress pCompressInfo->size_in bytes of pSrcBuffer in blocks of pBlockSize (64KB up to 1GB),
+			data of pCompressInfo must be released with free. pThreadPool nullptr means the shared thread pool
+		*/
+		WSYS_EXP static W_RESULT compress(
+			_In_ const char* pSrcBuffer,
+			_Inout_ w_compress_result* pCompressInfo,
+			_In_ w_compress_mode pMode = w_compress_mode::W_DEFAULT,
+			_In_ int pAcceleration = 1,
+			_In_ size_t pBlockSize = W_COMPRESS_PARALLEL_DEFAULT_BLOCK_SIZE,
+			_In_opt_ w_thread_pool* pThreadPool = nullptr);
+
+		//same as compress with lzma blocks, much slower than lz4 but smaller, pLevel is from W_COMPRESS_LZMA_LEVEL_MIN to W_COMPRESS_LZMA_LEVEL_MAX
+		WSYS_EXP static W_RESULT compress_lzma(
+			_In_ const char* pSrcBuffer,
+			_Inout_ w_compress_result* pCompressInfo,
+			_In_ int pLevel = W_COMPRESS_LZMA_LEVEL_DEFAULT,
+			_In_ size_t pBlockSize = W_COMPRESS_PARALLEL_LZMA_BLOCK_SIZE,
+			_In_opt_ w_thread_pool* pThreadPool = nullptr);
+
+		//decompress all blocks of pCompressedBuffer, which has pDecompressInfo->size_in bytes
+		WSYS_EXP static W_RESULT decompress(
+			_In_ const char* pCompressedBuffer,
+			_Inout_ w_compress_result* pDecompressInfo,
+			_In_opt_ w_thread_pool* pThreadPool = nullptr);
+
+		//decompress one block into pDstBuffer, which must have room for size of block
+		WSYS_EXP static W_RESULT decompress_block(
+			_In_ const char* pCompressedBuffer,
+			_In_ const size_t& pCompressedSize,
+			_In_ const size_t& pBlockIndex,
+			_Inout_ char* pDstBuffer);
+
+		//read the block index, pSize is the total decompressed size
+		WSYS_EXP static W_RESULT get_blocks(
+			_In_ const char* pCompressedBuffer,
+			_In_ const size_t& pCompressedSize,
+			_Inout_ std::vector<w_compress_block_info>& pBlocks,
+			_Inout_ size_t& pSize);
+
+		//returns W_CODEC_LZ4_PARALLEL or W_CODEC_LZMA_PARALLEL, W_CODEC_UNKNOWN if pBuffer was not compressed by w_compress_parallel
+		WSYS_EXP static w_compress_codec get_codec(
+			_In_ const char* pBuffer,
+			_In_ const size_t& pSize);
+
+		//returns true if pBuffer starts with header of w_compress_parallel
+		WSYS_EXP static bool get_is_parallel(
+			_In_ const char* pBuffer,
+			_In_ const size_t& pSize);
+	};
+}
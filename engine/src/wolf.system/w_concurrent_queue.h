@@ -4,7 +4,8 @@
 	Website			 : https://WolfEngine.App
 	Name			 : w_concurrent_queue.h
 	Description		 : A cross platform concurrent queue, in windows inherited from Concurrency::concurrent_queue
-	Comment          :
+	Comment          : w_bounded_concurrent_queue is a lock free bounded multi producer/multi consumer ring buffer
+					   based on sequence numbered slots of Dmitry Vyukov's bounded MPMC queue
 */
 
 #pragma once
@@ -15,13 +16,18 @@
 
 #elif defined(__APPLE__) || defined(__linux)
 
-#include <thread>
 #include <queue>
-#include <mutex>
-#include <condition_variable>
 
 #endif
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "w_std.h"
+
 namespace wolf::system
 {
 #if defined(__WIN32) || defined(__UWP)
@@ -36,9 +42,10 @@ namespace wolf::system
 	public:
 		void clear()
 		{
+			std::queue<_Ty> _empty;
 			std::unique_lock<std::mutex> _lock(this->_mutex);
 			{
-				this->_queue.clear();
+				std::swap(this->_queue, _empty);
 			}
 		}
 		bool empty()
@@ -64,28 +71,27 @@ namespace wolf::system
 			this->_cv.notify_one();
 		}
 
+		//pop an item if available, it never blocks when the queue is empty
 		bool try_pop(_Ty& pItem)
 		{
-			bool _result = true;
 			std::unique_lock<std::mutex> _lock(this->_mutex);
-			{
-				while (this->_queue.empty())
-				{
-					this->_cv.wait(_lock);
-				}
-				if (this->_queue.size())
-				{
-					pItem = this->_queue.front();
-					this->_queue.pop();
-				}
-				else
-				{
-					_result = false;
-				}
-			}
-			_lock.unlock();
+			if (this->_queue.empty()) return false;
 
-			return _result;
+			pItem = std::move(this->_queue.front());
+			this->_queue.pop();
+			return true;
+		}
+
+		//wait until an item is available and pop it
+		void wait_pop(_Ty& pItem)
+		{
+			std::unique_lock<std::mutex> _lock(this->_mutex);
+			this->_cv.wait(_lock, [this]()
+				{
+					return !this->_queue.empty();
+				});
+			pItem = std::move(this->_queue.front());
+			this->_queue.pop();
 		}
 
 		_Ty unsafe_begin() const
@@ -116,8 +122,199 @@ namespace wolf::system
 
 	private:
 		std::queue<_Ty>             _queue;
-		std::mutex                  _mutex;
+		mutable std::mutex          _mutex;
 		std::condition_variable     _cv;
 	};
 #endif
+
+	template<typename _Ty>
+	class w_bounded_concurrent_queue
+	{
+	public:
+		//capacity will be rounded up to the next power of two
+		w_bounded_concurrent_queue(_In_ const size_t& pCapacity) :
+			_enqueue_pos(0),
+			_dequeue_pos(0),
+			_waiters(0)
+		{
+			size_t _capacity = 2;
+			while (_capacity < pCapacity)
+			{
+				_capacity <<= 1;
+			}
+			this->_mask = _capacity - 1;
+
+			this->_slots.reset(new w_slot[_capacity]);
+			for (size_t i = 0; i < _capacity; ++i)
+			{
+				this->_slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		//push an item, returns false if the queue is full
+		bool try_push(_In_ const _Ty& pItem)
+		{
+			if (!_push(pItem)) return false;
+			_notify();
+			return true;
+		}
+
+		//push items in order until the queue becomes full, returns number of pushed items
+		size_t try_push_bulk(_In_ const _Ty* pItems, _In_ const size_t& pCount)
+		{
+			size_t _pushed = 0;
+			while (_pushed < pCount && _push(pItems[_pushed]))
+			{
+				_pushed++;
+			}
+			if (_pushed) _notify();
+			return _pushed;
+		}
+
+		//pop an item if available, it never blocks
+		bool try_pop(_Inout_ _Ty& pItem)
+		{
+			auto _pos = this->_dequeue_pos.load(std::memory_order_relaxed);
+			w_slot* _slot;
+			while (true)
+			{
+				_slot = &this->_slots[_pos & this->_mask];
+				auto _seq = _slot->sequence.load(std::memory_order_acquire);
+				auto _dif = static_cast<intptr_t>(_seq) - static_cast<intptr_t>(_pos + 1);
+				if (_dif == 0)
+				{
+					if (this->_dequeue_pos.compare_exchange_weak(_pos, _pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (_dif < 0)
+				{
+					//queue is empty
+					return false;
+				}
+				else
+				{
+					_pos = this->_dequeue_pos.load(std::memory_order_relaxed);
+				}
+			}
+			pItem = std::move(_slot->data);
+			_slot->sequence.store(_pos + this->_mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		//pop up to pMaxCount items, returns number of popped items
+		size_t try_pop_bulk(_Inout_ _Ty* pItems, _In_ const size_t& pMaxCount)
+		{
+			size_t _popped = 0;
+			while (_popped < pMaxCount && try_pop(pItems[_popped]))
+			{
+				_popped++;
+			}
+			return _popped;
+		}
+
+		//wait until an item is available, spins for pSpinCount tries before parking the thread
+		void wait_pop(_Inout_ _Ty& pItem, _In_ const size_t& pSpinCount = 256)
+		{
+			for (size_t i = 0; i < pSpinCount; ++i)
+			{
+				if (try_pop(pItem)) return;
+				std::this_thread::yield();
+			}
+
+			std::unique_lock<std::mutex> _lock(this->_mutex);
+			this->_waiters.fetch_add(1);
+			while (!try_pop(pItem))
+			{
+				this->_cv.wait(_lock);
+			}
+			this->_waiters.fetch_sub(1);
+		}
+
+		bool empty() const
+		{
+			return get_size_approx() == 0;
+		}
+
+#pragma region Getters
+
+		size_t get_capacity() const
+		{
+			return this->_mask + 1;
+		}
+
+		//number of items, it might be outdated as soon as it returns
+		size_t get_size_approx() const
+		{
+			auto _dequeue = this->_dequeue_pos.load(std::memory_order_relaxed);
+			auto _enqueue = this->_enqueue_pos.load(std::memory_order_relaxed);
+			return _enqueue > _dequeue ? _enqueue - _dequeue : 0;
+		}
+
+#pragma endregion
+
+	private:
+		//prevent copying
+		w_bounded_concurrent_queue(w_bounded_concurrent_queue const&);
+		w_bounded_concurrent_queue& operator= (w_bounded_concurrent_queue const&);
+
+		bool _push(_In_ const _Ty& pItem)
+		{
+			auto _pos = this->_enqueue_pos.load(std::memory_order_relaxed);
+			w_slot* _slot;
+			while (true)
+			{
+				_slot = &this->_slots[_pos & this->_mask];
+				auto _seq = _slot->sequence.load(std::memory_order_acquire);
+				auto _dif = static_cast<intptr_t>(_seq) - static_cast<intptr_t>(_pos);
+				if (_dif == 0)
+				{
+					if (this->_enqueue_pos.compare_exchange_weak(_pos, _pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (_dif < 0)
+				{
+					//queue is full
+					return false;
+				}
+				else
+				{
+					_pos = this->_enqueue_pos.load(std::memory_order_relaxed);
+				}
+			}
+			_slot->data = pItem;
+			_slot->sequence.store(_pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		void _notify()
+		{
+			//waiters check the queue while holding the mutex, so locking here avoids lost wake ups
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (this->_waiters.load() > 0)
+			{
+				{
+					std::lock_guard<std::mutex> _lock(this->_mutex);
+				}
+				this->_cv.notify_all();
+			}
+		}
+
+		struct w_slot
+		{
+			std::atomic<size_t>     sequence;
+			_Ty                     data;
+		};
+
+		//keep producers and consumers on different cache lines
+		static const size_t W_CACHE_LINE_SIZE = 64;
+
+		std::unique_ptr<w_slot[]>   _slots;
+		size_t                      _mask;
+		char                        _pad0[W_CACHE_LINE_SIZE];
+		std::atomic<size_t>         _enqueue_pos;
+		char                        _pad1[W_CACHE_LINE_SIZE];
+		std::atomic<size_t>         _dequeue_pos;
+		char                        _pad2[W_CACHE_LINE_SIZE];
+		std::atomic<size_t>         _waiters;
+		std::mutex                  _mutex;
+		std::condition_variable     _cv;
+	};
 }
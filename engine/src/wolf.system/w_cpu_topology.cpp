@@ -0,0 +1,478 @@
+#include "w_system_pch.h"
+#include "w_cpu_topology.h"
+#include <thread>
+#include <mutex>
+#include <map>
+#include <algorithm>
+
+#if defined(__WIN32) || defined(__UWP)
+#include <memory>
+#elif defined(__linux)
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#else
+#include <sys/mman.h>
+#endif
+
+using namespace wolf::system;
+
+struct w_cpu_topology_info
+{
+	std::vector<w_logical_processor>    processors;
+	size_t                              cores = 0;
+	size_t                              l3_groups = 0;
+	size_t                              numa_nodes = 0;
+};
+
+static void _fallback_topology(_Inout_ w_cpu_topology_info& pInfo)
+{
+	auto _count = std::thread::hardware_concurrency();
+	if (!_count)
+	{
+		_count = 1;
+	}
+
+	pInfo.processors.resize(_count);
+	for (uint32_t i = 0; i < _count; ++i)
+	{
+		pInfo.processors[i].id = i;
+		pInfo.processors[i].core = i;
+		pInfo.processors[i].group_index = static_cast<uint16_t>(i);
+	}
+	pInfo.cores = _count;
+	pInfo.l3_groups = 1;
+	pInfo.numa_nodes = 1;
+}
+
+#if defined(__WIN32) || defined(__UWP)
+
+static W_RESULT _read_topology(_Inout_ w_cpu_topology_info& pInfo)
+{
+	DWORD _size = 0;
+	GetLogicalProcessorInformationEx(RelationAll, nullptr, &_size);
+	if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) return W_FAILED;
+
+	std::unique_ptr<uint8_t[]> _buffer(new uint8_t[_size]);
+	if (!GetLogicalProcessorInformationEx(RelationAll, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)_buffer.get(), &_size)) return W_FAILED;
+
+	//global index of first processor of each group
+	const auto _groups = GetActiveProcessorGroupCount();
+	std::vector<uint32_t> _offsets(_groups + 1, 0);
+	for (WORD i = 0; i < _groups; ++i)
+	{
+		_offsets[i + 1] = _offsets[i] + GetActiveProcessorCount(i);
+	}
+	pInfo.processors.resize(_offsets[_groups]);
+	for (WORD g = 0; g < _groups; ++g)
+	{
+		for (auto i = _offsets[g]; i < _offsets[g + 1]; ++i)
+		{
+			pInfo.processors[i].id = i;
+			pInfo.processors[i].group = g;
+			pInfo.processors[i].group_index = static_cast<uint16_t>(i - _offsets[g]);
+		}
+	}
+
+	auto _for_each_processor = [&](_In_ const GROUP_AFFINITY& pMask, _In_ const std::function<void(w_logical_processor&)>& pFunc)
+	{
+		if (pMask.Group >= _groups) return;
+		for (uint32_t _bit = 0; _bit < sizeof(KAFFINITY) * 8; ++_bit)
+		{
+			if (!(pMask.Mask & ((KAFFINITY)1 << _bit))) continue;
+			auto _index = _offsets[pMask.Group] + _bit;
+			if (_index < _offsets[pMask.Group + 1])
+			{
+				pFunc(pInfo.processors[_index]);
+			}
+		}
+	};
+
+	uint32_t _packages = 0;
+	for (DWORD _offset = 0; _offset < _size;)
+	{
+		auto _item = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(_buffer.get() + _offset);
+		switch (_item->Relationship)
+		{
+		case RelationProcessorCore:
+		{
+			const auto _core = static_cast<uint32_t>(pInfo.cores++);
+			uint32_t _smt_index = 0;
+			for (WORD i = 0; i < _item->Processor.GroupCount; ++i)
+			{
+				_for_each_processor(_item->Processor.GroupMask[i], [&](w_logical_processor& pProcessor)
+					{
+						pProcessor.core = _core;
+						pProcessor.smt_index = _smt_index++;
+					});
+			}
+			break;
+		}
+		case RelationProcessorPackage:
+		{
+			const auto _package = _packages++;
+			for (WORD i = 0; i < _item->Processor.GroupCount; ++i)
+			{
+				_for_each_processor(_item->Processor.GroupMask[i], [&](w_logical_processor& pProcessor)
+					{
+						pProcessor.package = _package;
+					});
+			}
+			break;
+		}
+		case RelationCache:
+			if (_item->Cache.Level == 3)
+			{
+				const auto _l3_group = static_cast<uint32_t>(pInfo.l3_groups++);
+				_for_each_processor(_item->Cache.GroupMask, [&](w_logical_processor& pProcessor)
+					{
+						pProcessor.l3_group = _l3_group;
+					});
+			}
+			break;
+		case RelationNumaNode:
+		{
+			pInfo.numa_nodes++;
+			const auto _node = _item->NumaNode.NodeNumber;
+			_for_each_processor(_item->NumaNode.GroupMask, [&](w_logical_processor& pProcessor)
+				{
+					pProcessor.numa_node = _node;
+				});
+			break;
+		}
+		default:
+			break;
+		}
+		_offset += _item->Size;
+	}
+
+	if (!pInfo.l3_groups)
+	{
+		//no L3 reported, treat each package as a group
+		for (auto& _processor : pInfo.processors)
+		{
+			_processor.l3_group = _processor.package;
+		}
+		pInfo.l3_groups = _packages ? _packages : 1;
+	}
+	if (!pInfo.numa_nodes)
+	{
+		pInfo.numa_nodes = 1;
+	}
+
+	return pInfo.processors.empty() || !pInfo.cores ? W_FAILED : W_PASSED;
+}
+
+#elif defined(__linux)
+
+static bool _read_line(_In_z_ const std::string& pPath, _Inout_ std::string& pLine)
+{
+	std::ifstream _file(pPath);
+	if (!_file) return false;
+	return static_cast<bool>(std::getline(_file, pLine));
+}
+
+static bool _read_int(_In_z_ const std::string& pPath, _Inout_ int& pValue)
+{
+	std::string _line;
+	if (!_read_line(pPath, _line) || _line.empty()) return false;
+	pValue = std::atoi(_line.c_str());
+	return true;
+}
+
+//parse lists such as "0-3,8,10-11"
+static std::vector<uint32_t> _parse_cpu_list(_In_z_ const std::string& pList)
+{
+	std::vector<uint32_t> _cpus;
+	std::stringstream _stream(pList);
+	std::string _range;
+	while (std::getline(_stream, _range, ','))
+	{
+		if (_range.empty()) continue;
+		auto _dash = _range.find('-');
+		auto _first = static_cast<uint32_t>(std::atoi(_range.c_str()));
+		auto _last = _dash == std::string::npos ? _first : static_cast<uint32_t>(std::atoi(_range.c_str() + _dash + 1));
+		for (auto i = _first; i <= _last; ++i)
+		{
+			_cpus.push_back(i);
+		}
+	}
+	return _cpus;
+}
+
+static W_RESULT _read_topology(_Inout_ w_cpu_topology_info& pInfo)
+{
+	const std::string _cpu_root = "/sys/devices/system/cpu/";
+
+	std::string _online;
+	if (!_read_line(_cpu_root + "online", _online)) return W_FAILED;
+
+	auto _cpus = _parse_cpu_list(_online);
+	if (_cpus.empty()) return W_FAILED;
+
+	std::map<std::pair<int, int>, uint32_t> _cores;
+	std::map<uint32_t, uint32_t> _l3_groups;
+	std::map<int, uint32_t> _packages;
+
+	for (auto& _cpu : _cpus)
+	{
+		const auto _path = _cpu_root + "cpu" + std::to_string(_cpu) + "/";
+
+		w_logical_processor _processor;
+		_processor.id = _cpu;
+		_processor.group_index = static_cast<uint16_t>(_cpu);
+
+		int _package_id = 0, _core_id = static_cast<int>(_cpu);
+		_read_int(_path + "topology/physical_package_id", _package_id);
+		_read_int(_path + "topology/core_id", _core_id);
+
+		auto _package = _packages.emplace(_package_id, static_cast<uint32_t>(_packages.size())).first->second;
+		auto _core = _cores.emplace(std::make_pair(_package_id, _core_id), static_cast<uint32_t>(_cores.size())).first->second;
+		_processor.package = _package;
+		_processor.core = _core;
+
+		//the group of a shared L3 is named by its first processor
+		_processor.l3_group = UINT32_MAX;
+		for (int _index = 0; _index < 16; ++_index)
+		{
+			const auto _cache = _path + "cache/index" + std::to_string(_index) + "/";
+			int _level = 0;
+			if (!_read_int(_cache + "level", _level)) break;
+			if (_level != 3) continue;
+
+			std::string _shared;
+			if (_read_line(_cache + "shared_cpu_list", _shared))
+			{
+				auto _siblings = _parse_cpu_list(_shared);
+				if (!_siblings.empty())
+				{
+					_processor.l3_group = _l3_groups.emplace(_siblings.front(), static_cast<uint32_t>(_l3_groups.size())).first->second;
+				}
+			}
+			break;
+		}
+		if (_processor.l3_group == UINT32_MAX)
+		{
+			_processor.l3_group = _l3_groups.emplace(UINT32_MAX - _package, static_cast<uint32_t>(_l3_groups.size())).first->second;
+		}
+
+		pInfo.processors.push_back(_processor);
+	}
+
+	//SMT index follows order of processors inside each core
+	std::vector<uint32_t> _smt_counts(_cores.size(), 0);
+	for (auto& _processor : pInfo.processors)
+	{
+		_processor.smt_index = _smt_counts[_processor.core]++;
+	}
+
+	//NUMA nodes
+	std::vector<uint32_t> _nodes;
+	if (auto _dir = opendir("/sys/devices/system/node"))
+	{
+		while (auto _entry = readdir(_dir))
+		{
+			if (std::strncmp(_entry->d_name, "node", 4) != 0) continue;
+			auto _digits = _entry->d_name + 4;
+			if (*_digits < '0' || *_digits > '9') continue;
+
+			const auto _node = static_cast<uint32_t>(std::atoi(_digits));
+			std::string _list;
+			if (!_read_line(std::string("/sys/devices/system/node/") + _entry->d_name + "/cpulist", _list)) continue;
+
+			_nodes.push_back(_node);
+			for (auto& _cpu : _parse_cpu_list(_list))
+			{
+				for (auto& _processor : pInfo.processors)
+				{
+					if (_processor.id == _cpu)
+					{
+						_processor.numa_node = _node;
+						break;
+					}
+				}
+			}
+		}
+		closedir(_dir);
+	}
+
+	pInfo.cores = _cores.size();
+	pInfo.l3_groups = _l3_groups.size();
+	pInfo.numa_nodes = _nodes.empty() ? 1 : _nodes.size();
+
+	return W_PASSED;
+}
+
+#else
+
+static W_RESULT _read_topology(_Inout_ w_cpu_topology_info& pInfo)
+{
+	return W_FAILED;
+}
+
+#endif
+
+static const w_cpu_topology_info& _get_topology()
+{
+	static w_cpu_topology_info _info;
+	static std::once_flag _once;
+	std::call_once(_once, []()
+		{
+			if (_read_topology(_info) != W_PASSED)
+			{
+				_info = w_cpu_topology_info();
+				_fallback_topology(_info);
+			}
+		});
+	return _info;
+}
+
+const std::vector<w_logical_processor>& w_cpu_topology::get_logical_processors()
+{
+	return _get_topology().processors;
+}
+
+const w_logical_processor* w_cpu_topology::get_logical_processor(_In_ const uint32_t& pLogicalProcessor)
+{
+	auto& _processors = _get_topology().processors;
+	for (auto& _processor : _processors)
+	{
+		if (_processor.id == pLogicalProcessor) return &_processor;
+	}
+	return nullptr;
+}
+
+size_t w_cpu_topology::get_number_of_physical_cores()
+{
+	return _get_topology().cores;
+}
+
+size_t w_cpu_topology::get_number_of_l3_groups()
+{
+	return _get_topology().l3_groups;
+}
+
+size_t w_cpu_topology::get_number_of_numa_nodes()
+{
+	return _get_topology().numa_nodes;
+}
+
+std::vector<uint32_t> w_cpu_topology::get_worker_processors(
+	_In_ const size_t& pCount,
+	_In_ const std::vector<uint32_t>& pExcluded)
+{
+	std::vector<uint32_t> _result;
+	if (!pCount) return _result;
+
+	auto& _info = _get_topology();
+
+	//cores of excluded processors
+	std::vector<bool> _excluded_cores(_info.cores, false);
+	for (auto& _id : pExcluded)
+	{
+		auto _processor = get_logical_processor(_id);
+		if (_processor)
+		{
+			_excluded_cores[_processor->core] = true;
+		}
+	}
+
+	//order by SMT index, then interleave NUMA nodes so workers spread over sockets
+	std::vector<const w_logical_processor*> _candidates;
+	for (auto& _processor : _info.processors)
+	{
+		if (!_excluded_cores[_processor.core])
+		{
+			_candidates.push_back(&_processor);
+		}
+	}
+	if (_candidates.empty())
+	{
+		for (auto& _processor : _info.processors)
+		{
+			_candidates.push_back(&_processor);
+		}
+	}
+
+	std::map<uint32_t, uint32_t> _ranks;
+	std::vector<std::pair<std::pair<uint32_t, uint32_t>, const w_logical_processor*>> _ordered;
+	for (auto& _processor : _candidates)
+	{
+		auto _rank = _ranks[_processor->numa_node * 1024 + _processor->smt_index]++;
+		_ordered.push_back({ { _processor->smt_index, _rank }, _processor });
+	}
+	std::stable_sort(_ordered.begin(), _ordered.end(), [](const auto& pA, const auto& pB)
+		{
+			return pA.first < pB.first;
+		});
+
+	//more workers than processors share processors round robin
+	for (size_t i = 0; i < pCount; ++i)
+	{
+		_result.push_back(_ordered[i % _ordered.size()].second->id);
+	}
+	return _result;
+}
+
+uint32_t w_cpu_topology::get_current_numa_node()
+{
+#if defined(__WIN32) || defined(__UWP)
+	PROCESSOR_NUMBER _processor_number;
+	GetCurrentProcessorNumberEx(&_processor_number);
+	USHORT _node = 0;
+	if (!GetNumaProcessorNodeEx(&_processor_number, &_node)) return 0;
+	return _node;
+#elif defined(__linux) && defined(SYS_getcpu)
+	unsigned int _cpu = 0, _node = 0;
+	if (syscall(SYS_getcpu, &_cpu, &_node, nullptr) != 0) return 0;
+	return _node;
+#else
+	return 0;
+#endif
+}
+
+void* w_cpu_topology::numa_allocate(_In_ const size_t& pSize, _In_ const uint32_t& pNumaNode)
+{
+	if (!pSize) return nullptr;
+
+#if defined(__WIN32) || defined(__UWP)
+	return VirtualAllocExNuma(GetCurrentProcess(), nullptr, pSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, pNumaNode);
+#else
+	auto _memory = mmap(nullptr, pSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (_memory == MAP_FAILED) return nullptr;
+
+#if defined(__linux) && defined(SYS_mbind)
+	if (get_number_of_numa_nodes() > 1)
+	{
+		//MPOL_PREFERRED, pages fall back to other nodes when this one is full
+		const int _mpol_preferred = 1;
+		const size_t _bits = sizeof(unsigned long) * 8;
+		std::vector<unsigned long> _mask(pNumaNode / _bits + 1, 0);
+		_mask[pNumaNode / _bits] = 1UL << (pNumaNode % _bits);
+		if (syscall(SYS_mbind, _memory, pSize, _mpol_preferred, _mask.data(), _mask.size() * _bits + 1, 0) != 0)
+		{
+			logger.warning("could not bind memory to numa node {}. trace info: w_cpu_topology::numa_allocate", pNumaNode);
+		}
+	}
+#else
+	(void)pNumaNode;
+#endif
+
+	return _memory;
+#endif
+}
+
+void w_cpu_topology::numa_free(_In_ void* pMemory, _In_ const size_t& pSize)
+{
+	if (!pMemory) return;
+
+#if defined(__WIN32) || defined(__UWP)
+	(void)pSize;
+	VirtualFree(pMemory, 0, MEM_RELEASE);
+#else
+	munmap(pMemory, pSize);
+#endif
+}
@@ -0,0 +1,62 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_cpu_topology.h
+	Description		 : Discover physical cores, SMT siblings, L3 groups and NUMA nodes of the machine
+	Comment          : Topology is read once from /sys on Linux and GetLogicalProcessorInformationEx on Windows,
+					   other platforms report each logical processor as a core of a single node
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include <vector>
+
+namespace wolf::system
+{
+	struct w_logical_processor
+	{
+		//index of logical processor which is used for affinity
+		uint32_t    id = 0;
+		//index of physical core
+		uint32_t    core = 0;
+		//0 for the first hardware thread of the core, SMT siblings have greater values
+		uint32_t    smt_index = 0;
+		uint32_t    package = 0;
+		//index of group of processors which share the same L3 cache
+		uint32_t    l3_group = 0;
+		//number of NUMA node as reported by OS
+		uint32_t    numa_node = 0;
+		//processor group and index inside the group on Windows
+		uint16_t    group = 0;
+		uint16_t    group_index = 0;
+	};
+
+	class w_cpu_topology
+	{
+	public:
+		WSYS_EXP static const std::vector<w_logical_processor>& get_logical_processors();
+		//returns nullptr if pLogicalProcessor does not exist
+		WSYS_EXP static const w_logical_processor* get_logical_processor(_In_ const uint32_t& pLogicalProcessor);
+		WSYS_EXP static size_t get_number_of_physical_cores();
+		WSYS_EXP static size_t get_number_of_l3_groups();
+		WSYS_EXP static size_t get_number_of_numa_nodes();
+
+		/*
+			choose processors for pCount worker threads.
+			First hardware thread of each physical core is used first, spread over NUMA nodes, then SMT siblings.
+			Cores of pExcluded processors (e.g. render thread) are skipped unless there is nothing else left
+		*/
+		WSYS_EXP static std::vector<uint32_t> get_worker_processors(
+			_In_ const size_t& pCount,
+			_In_ const std::vector<uint32_t>& pExcluded = std::vector<uint32_t>());
+
+		//NUMA node of the processor which runs the calling thread
+		WSYS_EXP static uint32_t get_current_numa_node();
+		//allocate pages preferably on pNumaNode, free it with numa_free
+		WSYS_EXP static void* numa_allocate(_In_ const size_t& pSize, _In_ const uint32_t& pNumaNode);
+		WSYS_EXP static void numa_free(_In_ void* pMemory, _In_ const size_t& pSize);
+	};
+}
@@ -0,0 +1,910 @@
+#include "w_system_pch.h"
+#include "w_directory_scanner.h"
+#include "w_thread_pool.h"
+#include "w_convert.h"
+#include <mutex>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#if !defined(__WIN32) && !defined(_MSC_VER)
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux) && !defined(__ANDROID)
+#include <sys/syscall.h>
+#define W_DIRECTORY_SCANNER_GETDENTS
+#endif
+
+#if defined(__APPLE__)
+#define W_STAT_MTIME(pStat) (pStat).st_mtimespec
+#else
+#define W_STAT_MTIME(pStat) (pStat).st_mtim
+#endif
+
+//"WDSC"
+#define W_DIRECTORY_CACHE_MAGIC			0x43534457
+#define W_DIRECTORY_CACHE_VERSION		1
+//directories which were modified this close to a scan are listed again by next scan,
+//a modification in the same tick of file system clock would be missed otherwise
+#define W_DIRECTORY_CACHE_RACY_WINDOW	(2ll * 1000000000ll)
+#define W_DIRECTORY_SCANNER_BUFFER_SIZE	(64 * 1024)
+
+namespace wolf::system
+{
+	struct w_directory_child
+	{
+		std::string					name;
+		uint64_t					size = 0;
+		int64_t						modified_time = 0;
+		w_directory_entry_type		type = w_directory_entry_type::FILE;
+	};
+
+	struct w_directory_listing
+	{
+		//modification time of directory when it was listed
+		int64_t							modified_time = 0;
+		//false if directory was modified in racy window of its scan
+		bool							is_trusted = false;
+		std::vector<w_directory_child>	children;
+	};
+
+	struct w_scanned_directory
+	{
+		std::string									relative;
+		std::string									absolute;
+		std::shared_ptr<const w_directory_listing>	listing;
+		//children which are directories and passed the filter
+		std::vector<size_t>							directories;
+		bool										is_cached = false;
+	};
+
+	struct w_scan_state
+	{
+		std::string							root;
+		const w_directory_scan_filter*		filter = nullptr;
+		int64_t								start_time = 0;
+		std::mutex							mutex;
+		std::vector<w_scanned_directory>	directories;
+		//sub directories which wait for the thread which scans, when there are no workers
+		std::vector<std::string>			pending;
+	};
+
+	static bool s_is_dot(_In_z_ const char* pName)
+	{
+		return pName[0] == '.' && (pName[1] == '\0' || (pName[1] == '.' && pName[2] == '\0'));
+	}
+
+	static bool s_is_hidden(_In_ const std::string& pName)
+	{
+		return !pName.empty() && pName[0] == '.';
+	}
+
+	static std::string s_join(_In_ const std::string& pParent, _In_ const std::string& pName)
+	{
+		return pParent.empty() ? pName : pParent + "/" + pName;
+	}
+
+#if defined(__WIN32) || defined(_MSC_VER)
+
+	//100 nanoseconds since 1601 to nanoseconds since unix epoch
+	static int64_t s_to_time(_In_ const FILETIME& pTime)
+	{
+		const auto _ticks = (static_cast<int64_t>(pTime.dwHighDateTime) << 32) | pTime.dwLowDateTime;
+		return (_ticks - 116444736000000000ll) * 100;
+	}
+
+	static void s_set_child(
+		_In_ const DWORD& pAttributes,
+		_In_ const DWORD& pSizeHigh,
+		_In_ const DWORD& pSizeLow,
+		_In_ const FILETIME& pTime,
+		_Inout_ w_directory_child& pChild)
+	{
+		if (pAttributes & FILE_ATTRIBUTE_REPARSE_POINT)
+		{
+			pChild.type = w_directory_entry_type::OTHER;
+		}
+		else if (pAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			pChild.type = w_directory_entry_type::DIRECTORY;
+		}
+		else
+		{
+			pChild.type = w_directory_entry_type::FILE;
+		}
+		pChild.size = pChild.type == w_directory_entry_type::FILE ?
+			(static_cast<uint64_t>(pSizeHigh) << 32) | pSizeLow : 0;
+		pChild.modified_time = s_to_time(pTime);
+	}
+
+	static bool s_get_attributes(_In_ const std::string& pPath, _Out_ WIN32_FILE_ATTRIBUTE_DATA& pData)
+	{
+		const auto _path = wolf::system::convert::from_utf8(pPath);
+		return GetFileAttributesExW(_path.c_str(), GetFileExInfoStandard, &pData) != 0;
+	}
+
+	static bool s_get_full_path(_In_z_ const char* pPath, _Out_ std::string& pFullPath)
+	{
+		const auto _path = wolf::system::convert::from_utf8(pPath);
+		const auto _size = GetFullPathNameW(_path.c_str(), 0, NULL, NULL);
+		if (_size == 0) return false;
+
+		std::wstring _full(_size, L'\0');
+		const auto _length = GetFullPathNameW(_path.c_str(), _size, &_full[0], NULL);
+		if (_length == 0 || _length >= _size) return false;
+		_full.resize(_length);
+
+		pFullPath = wolf::system::convert::to_utf8(_full);
+		std::replace(pFullPath.begin(), pFullPath.end(), '\\', '/');
+		return true;
+	}
+
+	static bool s_get_directory_time(_In_ const std::string& pPath, _Out_ int64_t& pTime)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA _data;
+		if (!s_get_attributes(pPath, _data) || !(_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) return false;
+		pTime = s_to_time(_data.ftLastWriteTime);
+		return true;
+	}
+
+	static bool s_stat_child(_In_ const std::string& pDirectory, _Inout_ w_directory_child& pChild)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA _data;
+		if (!s_get_attributes(pDirectory + "/" + pChild.name, _data)) return false;
+		s_set_child(_data.dwFileAttributes, _data.nFileSizeHigh, _data.nFileSizeLow, _data.ftLastWriteTime, pChild);
+		return true;
+	}
+
+	static W_RESULT s_list_directory(
+		_In_ const std::string& pPath,
+		_Inout_ std::vector<char>& pBuffer,
+		_Inout_ w_directory_listing& pListing)
+	{
+		(void)pBuffer;
+
+		//time is taken before reading, so changes while listing are seen by next scan
+		if (!s_get_directory_time(pPath, pListing.modified_time)) return W_FAILED;
+
+		const auto _pattern = wolf::system::convert::from_utf8(pPath) + L"\\*";
+		WIN32_FIND_DATAW _data;
+		auto _find = FindFirstFileExW(
+			_pattern.c_str(),
+			FindExInfoBasic,
+			&_data,
+			FindExSearchNameMatch,
+			NULL,
+			FIND_FIRST_EX_LARGE_FETCH);
+		if (_find == INVALID_HANDLE_VALUE)
+		{
+			return GetLastError() == ERROR_FILE_NOT_FOUND ? W_PASSED : W_FAILED;
+		}
+
+		do
+		{
+			auto _name = wolf::system::convert::to_utf8(_data.cFileName);
+			if (s_is_dot(_name.c_str())) continue;
+
+			w_directory_child _child;
+			_child.name = std::move(_name);
+			s_set_child(_data.dwFileAttributes, _data.nFileSizeHigh, _data.nFileSizeLow, _data.ftLastWriteTime, _child);
+			pListing.children.push_back(std::move(_child));
+		} while (FindNextFileW(_find, &_data));
+
+		const auto _error = GetLastError();
+		FindClose(_find);
+		return _error == ERROR_NO_MORE_FILES ? W_PASSED : W_FAILED;
+	}
+
+#else
+
+	static int64_t s_to_time(_In_ const struct timespec& pTime)
+	{
+		return static_cast<int64_t>(pTime.tv_sec) * 1000000000ll + pTime.tv_nsec;
+	}
+
+	static void s_set_child(_In_ const struct stat& pStat, _Inout_ w_directory_child& pChild)
+	{
+		if (S_ISREG(pStat.st_mode))
+		{
+			pChild.type = w_directory_entry_type::FILE;
+			pChild.size = static_cast<uint64_t>(pStat.st_size);
+		}
+		else
+		{
+			pChild.type = S_ISDIR(pStat.st_mode) ? w_directory_entry_type::DIRECTORY : w_directory_entry_type::OTHER;
+			pChild.size = 0;
+		}
+		pChild.modified_time = s_to_time(W_STAT_MTIME(pStat));
+	}
+
+	static bool s_get_full_path(_In_z_ const char* pPath, _Out_ std::string& pFullPath)
+	{
+		char _path[PATH_MAX];
+		if (!realpath(pPath, _path)) return false;
+		pFullPath = _path;
+		return true;
+	}
+
+	static bool s_get_directory_time(_In_ const std::string& pPath, _Out_ int64_t& pTime)
+	{
+		struct stat _stat;
+		if (stat(pPath.c_str(), &_stat) != 0 || !S_ISDIR(_stat.st_mode)) return false;
+		pTime = s_to_time(W_STAT_MTIME(_stat));
+		return true;
+	}
+
+	static bool s_stat_child(_In_ const std::string& pDirectory, _Inout_ w_directory_child& pChild)
+	{
+		struct stat _stat;
+		const auto _path = pDirectory + "/" + pChild.name;
+		if (lstat(_path.c_str(), &_stat) != 0) return false;
+		s_set_child(_stat, pChild);
+		return true;
+	}
+
+	//symbolic links are not followed
+	static void s_stat_child_at(_In_ const int& pDirectory, _Inout_ w_directory_child& pChild)
+	{
+		struct stat _stat;
+		if (fstatat(pDirectory, pChild.name.c_str(), &_stat, AT_SYMLINK_NOFOLLOW) == 0)
+		{
+			s_set_child(_stat, pChild);
+		}
+		else
+		{
+			//it was removed after it was listed
+			pChild.type = w_directory_entry_type::OTHER;
+		}
+	}
+
+#ifdef W_DIRECTORY_SCANNER_GETDENTS
+
+	struct w_linux_dirent64
+	{
+		uint64_t		d_ino;
+		int64_t			d_off;
+		unsigned short	d_reclen;
+		unsigned char	d_type;
+		char			d_name[1];
+	};
+
+	static W_RESULT s_list_directory(
+		_In_ const std::string& pPath,
+		_Inout_ std::vector<char>& pBuffer,
+		_Inout_ w_directory_listing& pListing)
+	{
+		const int _fd = open(pPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (_fd < 0) return W_FAILED;
+
+		//time is taken before reading, so changes while listing are seen by next scan
+		struct stat _stat;
+		if (fstat(_fd, &_stat) != 0)
+		{
+			close(_fd);
+			return W_FAILED;
+		}
+		pListing.modified_time = s_to_time(W_STAT_MTIME(_stat));
+
+		if (pBuffer.size() < W_DIRECTORY_SCANNER_BUFFER_SIZE)
+		{
+			pBuffer.resize(W_DIRECTORY_SCANNER_BUFFER_SIZE);
+		}
+
+		W_RESULT _hr = W_PASSED;
+		for (;;)
+		{
+			//each call returns as many entries as fit in buffer
+			const auto _read = syscall(SYS_getdents64, _fd, pBuffer.data(), pBuffer.size());
+			if (_read < 0)
+			{
+				if (errno == EINTR) continue;
+				_hr = W_FAILED;
+				break;
+			}
+			if (_read == 0) break;
+
+			for (long _offset = 0; _offset < _read;)
+			{
+				auto _entry = reinterpret_cast<const w_linux_dirent64*>(pBuffer.data() + _offset);
+				_offset += _entry->d_reclen;
+
+				if (s_is_dot(_entry->d_name)) continue;
+
+				w_directory_child _child;
+				_child.name = _entry->d_name;
+				s_stat_child_at(_fd, _child);
+				pListing.children.push_back(std::move(_child));
+			}
+		}
+
+		close(_fd);
+		return _hr;
+	}
+
+#else
+
+	static W_RESULT s_list_directory(
+		_In_ const std::string& pPath,
+		_Inout_ std::vector<char>& pBuffer,
+		_Inout_ w_directory_listing& pListing)
+	{
+		(void)pBuffer;
+
+		auto _dir = opendir(pPath.c_str());
+		if (!_dir) return W_FAILED;
+
+		//time is taken before reading, so changes while listing are seen by next scan
+		const auto _fd = dirfd(_dir);
+		struct stat _stat;
+		if (fstat(_fd, &_stat) != 0)
+		{
+			closedir(_dir);
+			return W_FAILED;
+		}
+		pListing.modified_time = s_to_time(W_STAT_MTIME(_stat));
+
+		errno = 0;
+		while (auto _entry = readdir(_dir))
+		{
+			if (s_is_dot(_entry->d_name)) continue;
+
+			w_directory_child _child;
+			_child.name = _entry->d_name;
+			s_stat_child_at(_fd, _child);
+			pListing.children.push_back(std::move(_child));
+		}
+		const auto _hr = errno == 0 ? W_PASSED : W_FAILED;
+
+		closedir(_dir);
+		return _hr;
+	}
+
+#endif
+#endif
+
+	class w_directory_scanner_pimp
+	{
+	public:
+		w_directory_scanner_pimp() :
+			_is_initialized(false),
+			_is_dirty(false),
+			_listed_directories(0),
+			_cached_directories(0)
+		{
+		}
+
+		W_RESULT initialize(_In_ const w_directory_scanner_config& pConfig)
+		{
+			release();
+
+			this->_config = pConfig;
+			if (this->_config.worker_threads)
+			{
+				this->_pool.allocate(this->_config.worker_threads, w_thread_pool_mode::W_WORK_STEALING);
+			}
+			if (this->_config.use_cache && !this->_config.cache_path.empty())
+			{
+				_load_cache();
+			}
+			this->_is_initialized = true;
+			return W_PASSED;
+		}
+
+		W_RESULT scan(
+			_In_z_ const char* pDirectory,
+			_Inout_ std::vector<w_directory_entry>& pEntries,
+			_In_ const w_directory_scan_filter& pFilter)
+		{
+			if (!pDirectory) return W_INVALIDARG;
+			if (!this->_is_initialized)
+			{
+				logger.error("scanner is not initialized. trace info: w_directory_scanner::scan");
+				return W_FAILED;
+			}
+
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+
+			w_scan_state _state;
+			if (!s_get_full_path(pDirectory, _state.root))
+			{
+				logger.error("could not find directory {}. trace info: w_directory_scanner::scan", pDirectory);
+				return W_FAILED;
+			}
+			while (_state.root.size() > 1 && _state.root.back() == '/')
+			{
+				_state.root.pop_back();
+			}
+			_state.filter = &pFilter;
+			_state.start_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count();
+
+			if (!_visit(std::string(), _state))
+			{
+				logger.error("could not list directory {}. trace info: w_directory_scanner::scan", pDirectory);
+				return W_FAILED;
+			}
+			if (this->_config.worker_threads)
+			{
+				this->_pool.wait_all();
+			}
+			else
+			{
+				while (!_state.pending.empty())
+				{
+					auto _relative = std::move(_state.pending.back());
+					_state.pending.pop_back();
+					_visit(_relative, _state);
+				}
+			}
+
+			_add_entries(_state, pEntries);
+
+			this->_listed_directories = 0;
+			this->_cached_directories = 0;
+			for (const auto& _directory : _state.directories)
+			{
+				if (_directory.is_cached)
+				{
+					this->_cached_directories++;
+				}
+				else
+				{
+					this->_listed_directories++;
+				}
+			}
+			if (this->_config.use_cache)
+			{
+				_update_cache(_state);
+				if (this->_is_dirty && !this->_config.cache_path.empty())
+				{
+					_save_cache();
+				}
+			}
+			return W_PASSED;
+		}
+
+		void clear_cache()
+		{
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+
+			this->_cache.clear();
+			this->_is_dirty = false;
+			if (!this->_config.cache_path.empty())
+			{
+				std::remove(this->_config.cache_path.c_str());
+			}
+		}
+
+		void release()
+		{
+			if (!this->_is_initialized) return;
+
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+
+			if (this->_is_dirty && !this->_config.cache_path.empty())
+			{
+				_save_cache();
+			}
+			this->_pool.release();
+			this->_cache.clear();
+			this->_is_initialized = false;
+		}
+
+#pragma region Getters
+
+		size_t get_listed_directories() const
+		{
+			return this->_listed_directories;
+		}
+
+		size_t get_cached_directories() const
+		{
+			return this->_cached_directories;
+		}
+
+		size_t get_cache_size() const
+		{
+			return this->_cache.size();
+		}
+
+#pragma endregion
+
+	private:
+		//returns false if directory could not be listed
+		bool _visit(_In_ const std::string& pRelative, _Inout_ w_scan_state& pState)
+		{
+			w_scanned_directory _directory;
+			_directory.relative = pRelative;
+			//root is "/" or a drive on windows
+			_directory.absolute = pRelative.empty() ? pState.root :
+				pState.root.back() == '/' ? pState.root + pRelative : pState.root + "/" + pRelative;
+
+			//cache is not changed while scanning, so workers read it without lock
+			if (this->_config.use_cache)
+			{
+				auto _iter = this->_cache.find(_directory.absolute);
+				int64_t _time;
+				if (_iter != this->_cache.end() &&
+					_iter->second->is_trusted &&
+					s_get_directory_time(_directory.absolute, _time) &&
+					_time == _iter->second->modified_time)
+				{
+					if (this->_config.validate_files)
+					{
+						auto _listing = std::make_shared<w_directory_listing>(*_iter->second);
+						for (auto& _child : _listing->children)
+						{
+							s_stat_child(_directory.absolute, _child);
+						}
+						_directory.listing = _listing;
+					}
+					else
+					{
+						_directory.listing = _iter->second;
+					}
+					_directory.is_cached = true;
+				}
+			}
+
+			if (!_directory.listing)
+			{
+				//buffer of getdents is reused by each thread
+				thread_local std::vector<char> s_buffer;
+
+				auto _listing = std::make_shared<w_directory_listing>();
+				if (s_list_directory(_directory.absolute, s_buffer, *_listing) != W_PASSED)
+				{
+					if (!pRelative.empty())
+					{
+						logger.warning("could not list directory {}. trace info: w_directory_scanner::scan", _directory.absolute);
+					}
+					return false;
+				}
+				_listing->is_trusted = pState.start_time - _listing->modified_time > W_DIRECTORY_CACHE_RACY_WINDOW;
+				_directory.listing = _listing;
+			}
+
+			const auto& _filter = *pState.filter;
+			const auto& _children = _directory.listing->children;
+			std::vector<std::string> _sub_directories;
+			for (size_t i = 0; i < _children.size(); ++i)
+			{
+				const auto& _child = _children[i];
+				if (_child.type != w_directory_entry_type::DIRECTORY) continue;
+				if (!_filter.include_hidden && s_is_hidden(_child.name)) continue;
+
+				auto _relative = s_join(pRelative, _child.name);
+				if (_filter.directory && !_filter.directory(_relative)) continue;
+
+				_directory.directories.push_back(i);
+				if (_filter.recursive)
+				{
+					_sub_directories.push_back(std::move(_relative));
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> _lock(pState.mutex);
+				pState.directories.push_back(std::move(_directory));
+				if (!this->_config.worker_threads)
+				{
+					for (auto& _sub : _sub_directories)
+					{
+						pState.pending.push_back(std::move(_sub));
+					}
+					return true;
+				}
+			}
+
+			for (auto& _sub : _sub_directories)
+			{
+				this->_pool.add_job([this, &pState, _sub]()
+				{
+					_visit(_sub, pState);
+				});
+			}
+			return true;
+		}
+
+		void _add_entries(_In_ w_scan_state& pState, _Inout_ std::vector<w_directory_entry>& pEntries)
+		{
+			const auto& _filter = *pState.filter;
+			const auto _first = pEntries.size();
+
+			w_directory_entry _entry;
+			for (const auto& _directory : pState.directories)
+			{
+				const auto& _children = _directory.listing->children;
+				auto _accepted = _directory.directories.begin();
+				for (size_t i = 0; i < _children.size(); ++i)
+				{
+					const auto& _child = _children[i];
+					if (_child.type == w_directory_entry_type::DIRECTORY)
+					{
+						//directories were filtered while scanning
+						if (_accepted == _directory.directories.end() || *_accepted != i) continue;
+						++_accepted;
+						if (!_filter.include_directories) continue;
+					}
+					else if (!_filter.include_hidden && s_is_hidden(_child.name))
+					{
+						continue;
+					}
+
+					_entry.path = s_join(_directory.relative, _child.name);
+					_entry.size = _child.size;
+					_entry.modified_time = _child.modified_time;
+					_entry.type = _child.type;
+					if (_filter.entry && !_filter.entry(_entry)) continue;
+
+					pEntries.push_back(std::move(_entry));
+				}
+			}
+
+			std::sort(pEntries.begin() + _first, pEntries.end(),
+				[](const w_directory_entry& pLeft, const w_directory_entry& pRight)
+				{
+					return pLeft.path < pRight.path;
+				});
+		}
+
+		void _update_cache(_In_ w_scan_state& pState)
+		{
+			std::unordered_set<std::string> _visited;
+			for (auto& _directory : pState.directories)
+			{
+				_visited.insert(_directory.absolute);
+				if (_directory.is_cached && !this->_config.validate_files) continue;
+
+				this->_cache[_directory.absolute] = _directory.listing;
+				this->_is_dirty = true;
+			}
+
+			//only a complete scan knows which directories of root were removed
+			const auto& _filter = *pState.filter;
+			if (!_filter.recursive || _filter.directory || !_filter.include_hidden) return;
+
+			const auto _prefix = pState.root.back() == '/' ? pState.root : pState.root + "/";
+			for (auto _iter = this->_cache.begin(); _iter != this->_cache.end();)
+			{
+				const auto& _path = _iter->first;
+				const bool _is_inside = _path == pState.root || _path.compare(0, _prefix.size(), _prefix) == 0;
+				if (_is_inside && _visited.find(_path) == _visited.end())
+				{
+					_iter = this->_cache.erase(_iter);
+					this->_is_dirty = true;
+				}
+				else
+				{
+					++_iter;
+				}
+			}
+		}
+
+		/*
+			layout is magic, version and number of directories, then for each directory its path, time
+			and children. Strings are 32 bit length and bytes, fields are in order of this machine
+		*/
+		void _load_cache()
+		{
+			this->_cache.clear();
+
+			std::ifstream _stream(this->_config.cache_path, std::ios::binary | std::ios::ate);
+			if (!_stream) return;
+
+			const auto _file_size = static_cast<std::streamoff>(_stream.tellg());
+			if (_file_size <= 0) return;
+
+			std::vector<char> _data(static_cast<size_t>(_file_size));
+			_stream.seekg(0);
+			if (!_stream.read(_data.data(), _file_size)) return;
+
+			size_t _offset = 0;
+			auto _read = [&](void* pDestination, const size_t pSize) -> bool
+			{
+				if (_data.size() - _offset < pSize) return false;
+				std::memcpy(pDestination, _data.data() + _offset, pSize);
+				_offset += pSize;
+				return true;
+			};
+			auto _read_string = [&](std::string& pString) -> bool
+			{
+				uint32_t _size;
+				if (!_read(&_size, sizeof(_size)) || _data.size() - _offset < _size) return false;
+				pString.assign(_data.data() + _offset, _size);
+				_offset += _size;
+				return true;
+			};
+
+			uint32_t _magic = 0, _version = 0;
+			uint64_t _count = 0;
+			bool _is_valid = _read(&_magic, sizeof(_magic)) && _read(&_version, sizeof(_version)) && _read(&_count, sizeof(_count)) &&
+				_magic == W_DIRECTORY_CACHE_MAGIC && _version == W_DIRECTORY_CACHE_VERSION;
+
+			for (uint64_t i = 0; _is_valid && i < _count; ++i)
+			{
+				std::string _path;
+				auto _listing = std::make_shared<w_directory_listing>();
+				uint32_t _children = 0;
+				_is_valid = _read_string(_path) &&
+					_read(&_listing->modified_time, sizeof(_listing->modified_time)) &&
+					_read(&_children, sizeof(_children));
+
+				for (uint32_t j = 0; _is_valid && j < _children; ++j)
+				{
+					w_directory_child _child;
+					uint8_t _type = 0;
+					_is_valid = _read_string(_child.name) &&
+						_read(&_child.size, sizeof(_child.size)) &&
+						_read(&_child.modified_time, sizeof(_child.modified_time)) &&
+						_read(&_type, sizeof(_type)) &&
+						_type <= static_cast<uint8_t>(w_directory_entry_type::OTHER);
+					_child.type = static_cast<w_directory_entry_type>(_type);
+					_listing->children.push_back(std::move(_child));
+				}
+
+				_listing->is_trusted = true;
+				this->_cache[std::move(_path)] = std::move(_listing);
+			}
+
+			if (!_is_valid || _offset != _data.size())
+			{
+				logger.warning("cache file {} is not valid, it will be replaced. trace info: w_directory_scanner::initialize",
+					this->_config.cache_path);
+				this->_cache.clear();
+				this->_is_dirty = true;
+			}
+		}
+
+		void _save_cache()
+		{
+			std::vector<char> _data;
+			auto _write = [&](const void* pSource, const size_t pSize)
+			{
+				const auto _src = static_cast<const char*>(pSource);
+				_data.insert(_data.end(), _src, _src + pSize);
+			};
+			auto _write_string = [&](const std::string& pString)
+			{
+				const auto _size = static_cast<uint32_t>(pString.size());
+				_write(&_size, sizeof(_size));
+				_write(pString.data(), pString.size());
+			};
+
+			//listings which are not trusted are listed again anyway
+			uint64_t _count = 0;
+			for (const auto& _iter : this->_cache)
+			{
+				if (_iter.second->is_trusted) _count++;
+			}
+
+			const uint32_t _magic = W_DIRECTORY_CACHE_MAGIC;
+			const uint32_t _version = W_DIRECTORY_CACHE_VERSION;
+			_write(&_magic, sizeof(_magic));
+			_write(&_version, sizeof(_version));
+			_write(&_count, sizeof(_count));
+
+			for (const auto& _iter : this->_cache)
+			{
+				const auto& _listing = *_iter.second;
+				if (!_listing.is_trusted) continue;
+
+				const auto _children = static_cast<uint32_t>(_listing.children.size());
+				_write_string(_iter.first);
+				_write(&_listing.modified_time, sizeof(_listing.modified_time));
+				_write(&_children, sizeof(_children));
+				for (const auto& _child : _listing.children)
+				{
+					const auto _type = static_cast<uint8_t>(_child.type);
+					_write_string(_child.name);
+					_write(&_child.size, sizeof(_child.size));
+					_write(&_child.modified_time, sizeof(_child.modified_time));
+					_write(&_type, sizeof(_type));
+				}
+			}
+
+			//write to a temporary file and replace, so a crash does not leave a partial cache
+			const auto _temp_path = this->_config.cache_path + ".tmp";
+			{
+				std::ofstream _stream(_temp_path, std::ios::binary | std::ios::trunc);
+				if (!_stream || !_stream.write(_data.data(), _data.size()))
+				{
+					logger.error("could not write cache file {}. trace info: w_directory_scanner::scan", _temp_path);
+					return;
+				}
+			}
+#if defined(__WIN32) || defined(_MSC_VER)
+			std::remove(this->_config.cache_path.c_str());
+#endif
+			if (std::rename(_temp_path.c_str(), this->_config.cache_path.c_str()) != 0)
+			{
+				logger.error("could not replace cache file {}. trace info: w_directory_scanner::scan", this->_config.cache_path);
+				std::remove(_temp_path.c_str());
+				return;
+			}
+			this->_is_dirty = false;
+		}
+
+		w_directory_scanner_config													_config;
+		w_thread_pool																_pool;
+		//listings by absolute path of directory
+		std::unordered_map<std::string, std::shared_ptr<const w_directory_listing>>	_cache;
+		std::mutex																	_mutex;
+		bool																		_is_initialized;
+		bool																		_is_dirty;
+		size_t																		_listed_directories;
+		size_t																		_cached_directories;
+	};
+}
+
+using namespace wolf::system;
+
+w_directory_scanner::w_directory_scanner() : _pimp(new w_directory_scanner_pimp())
+{
+}
+
+w_directory_scanner::~w_directory_scanner()
+{
+	release();
+	SAFE_DELETE(this->_pimp);
+}
+
+W_RESULT w_directory_scanner::initialize(_In_ const w_directory_scanner_config& pConfig)
+{
+	if (!this->_pimp) return W_FAILED;
+	return this->_pimp->initialize(pConfig);
+}
+
+W_RESULT w_directory_scanner::scan(
+	_In_z_ const char* pDirectory,
+	_Inout_ std::vector<w_directory_entry>& pEntries,
+	_In_ const w_directory_scan_filter& pFilter)
+{
+	if (!this->_pimp) return W_FAILED;
+	return this->_pimp->scan(pDirectory, pEntries, pFilter);
+}
+
+void w_directory_scanner::clear_cache()
+{
+	if (!this->_pimp) return;
+	this->_pimp->clear_cache();
+}
+
+void w_directory_scanner::release()
+{
+	if (!this->_pimp) return;
+	this->_pimp->release();
+}
+
+#pragma region Getters
+
+size_t w_directory_scanner::get_listed_directories() const
+{
+	if (!this->_pimp) return 0;
+	return this->_pimp->get_listed_directories();
+}
+
+size_t w_directory_scanner::get_cached_directories() const
+{
+	if (!this->_pimp) return 0;
+	return this->_pimp->get_cached_directories();
+}
+
+size_t w_directory_scanner::get_cache_size() const
+{
+	if (!this->_pimp) return 0;
+	return this->_pimp->get_cache_size();
+}
+
+#pragma endregion
@@ -0,0 +1,104 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_directory_scanner.h
+	Description		 : Recursive directory scanner, directories are listed in parallel by a pool of workers
+	Comment          : On linux directories are read in batches with getdents64, FindFirstFileEx with large fetch on windows
+					   and readdir on other platforms.
+					   Listings of directories may be cached in memory and in a file, a directory is listed again only if
+					   its modification time changed. Changing content of a file does not change modification time of its
+					   directory, so size and time of cached files are from the scan which listed them unless validate_files is set
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace wolf::system
+{
+	enum class w_directory_entry_type : uint8_t
+	{
+		FILE = 0,
+		DIRECTORY,
+		//symbolic links which are not followed, devices, pipes and sockets
+		OTHER
+	};
+
+	struct w_directory_entry
+	{
+		//relative to scanned directory with '/' separators
+		std::string					path;
+		uint64_t					size = 0;
+		//nanoseconds since unix epoch
+		int64_t						modified_time = 0;
+		w_directory_entry_type		type = w_directory_entry_type::FILE;
+	};
+
+	struct w_directory_scan_filter
+	{
+		//return false for skipping a directory and its sub directories, it is called by worker threads with relative path
+		std::function<bool(const std::string&)>				directory;
+		//return false for skipping an entry, it is called by the thread which scans
+		std::function<bool(const w_directory_entry&)>		entry;
+		bool												recursive = true;
+		//add directories to the result
+		bool												include_directories = false;
+		//names which start with '.'
+		bool												include_hidden = true;
+	};
+
+	struct w_directory_scanner_config
+	{
+		//0 lists directories on the thread which scans
+		uint32_t		worker_threads = 4;
+		//listings are kept between scans of the same scanner
+		bool			use_cache = true;
+		//listings are loaded from and saved to this file, empty keeps them only in memory
+		std::string		cache_path;
+		//refresh size and time of files whose directory did not change
+		bool			validate_files = false;
+	};
+
+	class w_directory_scanner_pimp;
+	class w_directory_scanner
+	{
+	public:
+		WSYS_EXP w_directory_scanner();
+		WSYS_EXP ~w_directory_scanner();
+
+		//cache file is loaded if it exists, a corrupted or outdated cache file is ignored
+		WSYS_EXP W_RESULT initialize(_In_ const w_directory_scanner_config& pConfig = w_directory_scanner_config());
+
+		//entries of pDirectory are appended to pEntries sorted by path, cache file is saved if it changed
+		WSYS_EXP W_RESULT scan(
+			_In_z_ const char* pDirectory,
+			_Inout_ std::vector<w_directory_entry>& pEntries,
+			_In_ const w_directory_scan_filter& pFilter = w_directory_scan_filter());
+
+		//drop cached listings, cache file is removed as well
+		WSYS_EXP void clear_cache();
+
+		//cache file is saved and workers are released
+		WSYS_EXP void release();
+
+#pragma region Getters
+		//directories which were listed from disk by the last scan
+		WSYS_EXP size_t get_listed_directories() const;
+		//directories which were taken from cache by the last scan
+		WSYS_EXP size_t get_cached_directories() const;
+		WSYS_EXP size_t get_cache_size() const;
+#pragma endregion
+
+	private:
+		//Prevent copying
+		w_directory_scanner(w_directory_scanner const&);
+		w_directory_scanner& operator= (w_directory_scanner const&);
+
+		w_directory_scanner_pimp*		_pimp;
+	};
+}
@@ -0,0 +1,636 @@
+#include "w_system_pch.h"
+#include "w_fiber_scheduler.h"
+#include "w_concurrent_queue.h"
+#include "w_thread_pool.h"
+#include "w_task.h"
+#include <deque>
+
+#if !defined(__WIN32) && !defined(__UWP)
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#define W_NOINLINE __declspec(noinline)
+#else
+#define W_NOINLINE __attribute__((noinline))
+#endif
+
+namespace wolf::system
+{
+	enum w_fiber_state
+	{
+		W_FIBER_IDLE = 0,
+		W_FIBER_FINISHED,
+		W_FIBER_WAITING
+	};
+
+	struct w_fiber
+	{
+		std::function<void()>       job;
+		w_fiber_counter*            counter = nullptr;
+		w_fiber_state               state = W_FIBER_IDLE;
+		w_fiber_counter*            wait_counter = nullptr;
+		uint32_t                    wait_value = 0;
+#if defined(__WIN32) || defined(__UWP)
+		LPVOID                      handle = nullptr;
+#else
+		ucontext_t                  context;
+#endif
+	};
+
+	struct w_fiber_worker
+	{
+		w_fiber_scheduler_pimp*     scheduler = nullptr;
+		w_fiber*                    current = nullptr;
+#if defined(__WIN32) || defined(__UWP)
+		LPVOID                      handle = nullptr;
+#else
+		ucontext_t                  context;
+#endif
+	};
+
+	static thread_local w_fiber_worker* s_worker = nullptr;
+
+	//fibers may resume on another thread, so thread local storage must not be cached across a switch
+	static W_NOINLINE w_fiber_worker* _get_worker()
+	{
+		return s_worker;
+	}
+
+	static void _switch_to_worker(_In_ w_fiber* pFiber)
+	{
+		auto _worker = _get_worker();
+#if defined(__WIN32) || defined(__UWP)
+		(void)pFiber;
+		SwitchToFiber(_worker->handle);
+#else
+		swapcontext(&pFiber->context, &_worker->context);
+#endif
+	}
+
+	static void _fiber_loop()
+	{
+		while (true)
+		{
+			auto _fiber = _get_worker()->current;
+			if (_fiber->job)
+			{
+				_fiber->job();
+			}
+			_fiber->state = W_FIBER_FINISHED;
+			_switch_to_worker(_fiber);
+		}
+	}
+
+#if defined(__WIN32) || defined(__UWP)
+	static void WINAPI _fiber_entry(_In_ LPVOID pParameter)
+	{
+		(void)pParameter;
+		_fiber_loop();
+	}
+#endif
+
+	struct w_fiber_scheduler_pimp
+	{
+		struct w_job
+		{
+			std::function<void()>   job;
+			w_fiber_counter*        counter;
+		};
+
+		w_fiber_scheduler_pimp(
+			_In_ w_thread_pool& pThreadPool,
+			_In_ const size_t& pNumberOfThreads,
+			_In_ const size_t& pNumberOfFibers) :
+			free_fibers(pNumberOfFibers),
+			ready_fibers(pNumberOfFibers),
+			fibers(pNumberOfFibers),
+			thread_pool(&pThreadPool),
+			max_workers(pNumberOfThreads),
+			active_workers(0),
+			jobs_count(0),
+			pending(0),
+			waiting_fibers(0),
+			exhausted(false),
+			stacks(nullptr),
+			stacks_size(0)
+		{
+		}
+
+		W_RESULT create_fibers(_In_ const size_t& pStackSize)
+		{
+#if defined(__WIN32) || defined(__UWP)
+			for (auto& _fiber : this->fibers)
+			{
+				_fiber.handle = CreateFiber(pStackSize, _fiber_entry, &_fiber);
+				if (!_fiber.handle) return W_OUTOFMEMORY;
+				this->free_fibers.try_push(&_fiber);
+			}
+#else
+			//one mapping for all stacks, lowest page of each stack is a guard page
+			const size_t _page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			const size_t _stack_size = ((pStackSize + _page_size - 1) / _page_size) * _page_size;
+			const size_t _stride = _stack_size + _page_size;
+
+			this->stacks_size = _stride * this->fibers.size();
+			auto _memory = mmap(nullptr, this->stacks_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (_memory == MAP_FAILED)
+			{
+				this->stacks_size = 0;
+				return W_OUTOFMEMORY;
+			}
+			this->stacks = static_cast<uint8_t*>(_memory);
+
+			for (size_t i = 0; i < this->fibers.size(); ++i)
+			{
+				auto _guard = this->stacks + i * _stride;
+				mprotect(_guard, _page_size, PROT_NONE);
+
+				auto& _fiber = this->fibers[i];
+				getcontext(&_fiber.context);
+				_fiber.context.uc_stack.ss_sp = _guard + _page_size;
+				_fiber.context.uc_stack.ss_size = _stack_size;
+				_fiber.context.uc_link = nullptr;
+				makecontext(&_fiber.context, _fiber_loop, 0);
+
+				this->free_fibers.try_push(&_fiber);
+			}
+#endif
+			return W_PASSED;
+		}
+
+		void destroy_fibers()
+		{
+#if defined(__WIN32) || defined(__UWP)
+			for (auto& _fiber : this->fibers)
+			{
+				if (_fiber.handle)
+				{
+					DeleteFiber(_fiber.handle);
+					_fiber.handle = nullptr;
+				}
+			}
+#else
+			if (this->stacks)
+			{
+				munmap(this->stacks, this->stacks_size);
+				this->stacks = nullptr;
+			}
+#endif
+		}
+
+		void add_jobs(_In_ const std::function<void()>* pJobs, _In_ const size_t& pCount, _In_opt_ w_fiber_counter* pCounter)
+		{
+			if (pCounter)
+			{
+				pCounter->increment(static_cast<uint32_t>(pCount));
+			}
+			this->pending.fetch_add(pCount);
+
+			{
+				std::lock_guard<std::mutex> _lock(this->jobs_mutex);
+				for (size_t i = 0; i < pCount; ++i)
+				{
+					this->jobs.push_back({ pJobs[i], pCounter });
+				}
+				this->jobs_count.fetch_add(pCount);
+			}
+			dispatch(pCount);
+		}
+
+		//take a queued job of pCounter which did not start yet
+		bool pop_job(_In_ w_fiber_counter* pCounter, _Inout_ std::function<void()>& pJob)
+		{
+			if (this->jobs_count.load() == 0) return false;
+
+			std::lock_guard<std::mutex> _lock(this->jobs_mutex);
+			for (auto _iter = this->jobs.begin(); _iter != this->jobs.end(); ++_iter)
+			{
+				if (_iter->counter == pCounter)
+				{
+					pJob = std::move(_iter->job);
+					this->jobs.erase(_iter);
+					this->jobs_count.fetch_sub(1);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void finish_job(_In_opt_ w_fiber_counter* pCounter)
+		{
+			if (pCounter)
+			{
+				pCounter->decrement();
+			}
+			if (this->pending.fetch_sub(1) == 1)
+			{
+				{
+					std::lock_guard<std::mutex> _lock(this->done_mutex);
+				}
+				this->done_cv.notify_all();
+			}
+		}
+
+		//called under the mutex of counter which pFiber waited on
+		void wake(_In_ w_fiber* pFiber)
+		{
+			this->waiting_fibers.fetch_sub(1);
+			resume(pFiber);
+		}
+
+		void resume(_In_ w_fiber* pFiber)
+		{
+			//ready queue has a slot for each fiber, so it never gets full
+			this->ready_fibers.try_push(pFiber);
+			dispatch(1);
+		}
+
+		//add up to pCount jobs to the pool which run fibers, while less than max_workers are running
+		void dispatch(_In_ const size_t& pCount)
+		{
+			//pairs with the fence of retire, either it sees the new work or we see it retired
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			for (size_t i = 0; i < pCount && try_activate(); ++i)
+			{
+				this->thread_pool->add_job([this]()
+					{
+						worker_main();
+					});
+			}
+		}
+
+		bool try_activate()
+		{
+			auto _active = this->active_workers.load();
+			do
+			{
+				if (_active >= this->max_workers) return false;
+			} while (!this->active_workers.compare_exchange_weak(_active, _active + 1));
+			return true;
+		}
+
+		/*
+			called by a worker which found nothing to run, returns true if it has to continue.
+			It is done under done_mutex, so release can not destroy the scheduler before the worker leaves it
+		*/
+		bool retire()
+		{
+			std::lock_guard<std::mutex> _lock(this->done_mutex);
+			this->active_workers.fetch_sub(1);
+
+			//work which was added meanwhile may have seen all workers active
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (has_work() && try_activate()) return true;
+
+			this->done_cv.notify_all();
+			return false;
+		}
+
+		bool has_work()
+		{
+			return !this->ready_fibers.empty() || (this->jobs_count.load() > 0 && !this->free_fibers.empty());
+		}
+
+		//pick a resumed fiber first, otherwise bind a queued job to a free fiber
+		w_fiber* next_fiber()
+		{
+			w_fiber* _fiber = nullptr;
+			if (this->ready_fibers.try_pop(_fiber)) return _fiber;
+			if (this->jobs_count.load() == 0 || !this->free_fibers.try_pop(_fiber)) return nullptr;
+
+			{
+				std::lock_guard<std::mutex> _lock(this->jobs_mutex);
+				if (!this->jobs.empty())
+				{
+					auto& _job = this->jobs.front();
+					_fiber->job = std::move(_job.job);
+					_fiber->counter = _job.counter;
+					this->jobs.pop_front();
+					this->jobs_count.fetch_sub(1);
+					return _fiber;
+				}
+			}
+
+			this->free_fibers.try_push(_fiber);
+			return nullptr;
+		}
+
+		//runs as a job of the pool until no fiber is ready
+		void worker_main()
+		{
+			//a fiber job which helps its pool may run this job, so the worker of that fiber is restored at the end
+			auto _outer = _get_worker();
+
+			w_fiber_worker _worker;
+			_worker.scheduler = this;
+			s_worker = &_worker;
+
+#if defined(__WIN32) || defined(__UWP)
+			const bool _is_fiber = IsThreadAFiber() != FALSE;
+			_worker.handle = _is_fiber ? GetCurrentFiber() : ConvertThreadToFiber(nullptr);
+#endif
+
+			while (true)
+			{
+				auto _fiber = next_fiber();
+				if (!_fiber)
+				{
+					if (retire()) continue;
+					break;
+				}
+
+				_fiber->state = W_FIBER_IDLE;
+				_worker.current = _fiber;
+#if defined(__WIN32) || defined(__UWP)
+				SwitchToFiber(_fiber->handle);
+#else
+				swapcontext(&_worker.context, &_fiber->context);
+#endif
+				_worker.current = nullptr;
+
+				//the fiber is switched out now, so it is safe to hand it to other threads
+				if (_fiber->state == W_FIBER_FINISHED)
+				{
+					auto _counter = _fiber->counter;
+					_fiber->job = nullptr;
+					_fiber->counter = nullptr;
+					this->free_fibers.try_push(_fiber);
+					finish_job(_counter);
+				}
+				else if (_fiber->state == W_FIBER_WAITING)
+				{
+					auto _counter = _fiber->wait_counter;
+					std::unique_lock<std::mutex> _lock(_counter->_mutex);
+					if (_counter->_value.load() <= _fiber->wait_value)
+					{
+						_lock.unlock();
+						resume(_fiber);
+					}
+					else
+					{
+						_counter->_waiters.push_back({ _fiber, this, _fiber->wait_value });
+
+						//queued jobs can not start until a counter which is not decremented by jobs changes
+						if (this->waiting_fibers.fetch_add(1) + 1 == this->fibers.size() &&
+							this->jobs_count.load() > 0 && !this->exhausted.exchange(true))
+						{
+							logger.error("all {} fibers are suspended while jobs are queued. trace info: w_fiber_scheduler::wait_for_counter", this->fibers.size());
+						}
+					}
+				}
+			}
+
+#if defined(__WIN32) || defined(__UWP)
+			if (!_is_fiber)
+			{
+				ConvertFiberToThread();
+			}
+#endif
+			s_worker = _outer;
+		}
+
+		w_bounded_concurrent_queue<w_fiber*>    free_fibers;
+		w_bounded_concurrent_queue<w_fiber*>    ready_fibers;
+		std::vector<w_fiber>                    fibers;
+
+		w_thread_pool*                          thread_pool;
+		size_t                                  max_workers;
+		//jobs of the pool which are running fibers
+		std::atomic<size_t>                     active_workers;
+
+		std::mutex                              jobs_mutex;
+		std::deque<w_job>                       jobs;
+		std::atomic<size_t>                     jobs_count;
+		//jobs which are queued, running or suspended
+		std::atomic<size_t>                     pending;
+		//suspended fibers which are registered on a counter
+		std::atomic<size_t>                     waiting_fibers;
+		//pool exhaustion is reported once
+		std::atomic<bool>                       exhausted;
+
+		std::mutex                              done_mutex;
+		std::condition_variable                 done_cv;
+
+		uint8_t*                                stacks;
+		size_t                                  stacks_size;
+	};
+}
+
+using namespace wolf::system;
+
+#pragma region w_fiber_counter
+
+w_fiber_counter::w_fiber_counter() :
+	_value(0)
+{
+}
+
+void w_fiber_counter::increment(_In_ const uint32_t& pValue)
+{
+	this->_value.fetch_add(pValue);
+}
+
+void w_fiber_counter::decrement()
+{
+	//waiters check the value under the same lock, so the counter is not destroyed before we are done with it
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+	auto _value = this->_value.fetch_sub(1) - 1;
+	for (size_t i = 0; i < this->_waiters.size();)
+	{
+		auto& _waiter = this->_waiters[i];
+		if (_value <= _waiter.value)
+		{
+			_waiter.scheduler->wake(_waiter.fiber);
+			_waiter = this->_waiters.back();
+			this->_waiters.pop_back();
+		}
+		else
+		{
+			++i;
+		}
+	}
+	this->_cv.notify_all();
+}
+
+uint32_t w_fiber_counter::get_value() const
+{
+	return this->_value.load();
+}
+
+#pragma endregion
+
+#pragma region w_fiber_scheduler
+
+w_fiber_scheduler::w_fiber_scheduler() :
+	_pimp(nullptr)
+{
+}
+
+w_fiber_scheduler::~w_fiber_scheduler()
+{
+	release();
+}
+
+W_RESULT w_fiber_scheduler::initialize(
+	_In_ w_thread_pool& pThreadPool,
+	_In_ const size_t& pNumberOfThreads,
+	_In_ const size_t& pNumberOfFibers,
+	_In_ const size_t& pStackSize)
+{
+	if (this->_pimp)
+	{
+		logger.error("fiber scheduler already initialized. trace info: w_fiber_scheduler::initialize");
+		return W_FAILED;
+	}
+	if (!pNumberOfFibers || !pStackSize) return W_INVALIDARG;
+
+	const auto _pool_size = pThreadPool.get_pool_size();
+	if (!_pool_size)
+	{
+		logger.error("thread pool is not allocated. trace info: w_fiber_scheduler::initialize");
+		return W_INVALIDARG;
+	}
+	const auto _threads = pNumberOfThreads ? pNumberOfThreads : _pool_size;
+
+	this->_pimp = new (std::nothrow) w_fiber_scheduler_pimp(pThreadPool, _threads, pNumberOfFibers);
+	if (!this->_pimp)
+	{
+		logger.error("could not allocate memory for fiber scheduler. trace info: w_fiber_scheduler::initialize");
+		return W_OUTOFMEMORY;
+	}
+
+	if (this->_pimp->create_fibers(pStackSize) != W_PASSED)
+	{
+		logger.error("could not create fibers. trace info: w_fiber_scheduler::initialize");
+		this->_pimp->destroy_fibers();
+		SAFE_DELETE(this->_pimp);
+		return W_OUTOFMEMORY;
+	}
+
+	return W_PASSED;
+}
+
+W_RESULT w_fiber_scheduler::initialize(
+	_In_ const size_t& pNumberOfThreads,
+	_In_ const size_t& pNumberOfFibers,
+	_In_ const size_t& pStackSize)
+{
+	return initialize(w_task::get_shared_thread_pool(), pNumberOfThreads, pNumberOfFibers, pStackSize);
+}
+
+void w_fiber_scheduler::add_job(_In_ const std::function<void()>& pJob, _In_opt_ w_fiber_counter* pCounter)
+{
+	if (!this->_pimp) return;
+	this->_pimp->add_jobs(&pJob, 1, pCounter);
+}
+
+void w_fiber_scheduler::add_jobs(_In_ const std::function<void()>* pJobs, _In_ const size_t& pCount, _In_opt_ w_fiber_counter* pCounter)
+{
+	if (!this->_pimp || !pJobs || !pCount) return;
+	this->_pimp->add_jobs(pJobs, pCount, pCounter);
+}
+
+void w_fiber_scheduler::wait_for_counter(_In_ w_fiber_counter* pCounter, _In_ const uint32_t& pValue)
+{
+	if (!pCounter) return;
+
+	auto _worker = _get_worker();
+	if (_worker && _worker->current && _worker->scheduler == this->_pimp)
+	{
+		auto _fiber = _worker->current;
+
+		//when no fiber is free, jobs of counter which did not start yet run on this fiber, so suspended jobs can not hold all fibers
+		std::function<void()> _job;
+		while (pCounter->_value.load() > pValue && this->_pimp->free_fibers.empty() && this->_pimp->pop_job(pCounter, _job))
+		{
+			_job();
+			_job = nullptr;
+			this->_pimp->finish_job(pCounter);
+		}
+
+		{
+			std::lock_guard<std::mutex> _lock(pCounter->_mutex);
+			if (pCounter->_value.load() <= pValue) return;
+		}
+
+		//suspend this fiber, the worker registers it on the counter after the switch
+		_fiber->state = W_FIBER_WAITING;
+		_fiber->wait_counter = pCounter;
+		_fiber->wait_value = pValue;
+		_switch_to_worker(_fiber);
+
+		//make sure the thread which resumed us has released the counter
+		std::lock_guard<std::mutex> _lock(pCounter->_mutex);
+		return;
+	}
+
+	//fibers may need the worker which waits, so it runs jobs of the pool meanwhile
+	auto _pool = this->_pimp ? this->_pimp->thread_pool : nullptr;
+	const bool _is_worker = _pool && _pool->get_current_worker_index() >= 0;
+
+	std::unique_lock<std::mutex> _lock(pCounter->_mutex);
+	while (pCounter->_value.load() > pValue)
+	{
+		if (_is_worker)
+		{
+			_lock.unlock();
+			const bool _executed = _pool->execute_one_job();
+			_lock.lock();
+			if (_executed) continue;
+
+			pCounter->_cv.wait_for(_lock, std::chrono::milliseconds(1));
+			continue;
+		}
+		pCounter->_cv.wait(_lock);
+	}
+}
+
+ULONG w_fiber_scheduler::release()
+{
+	if (!this->_pimp) return 1;
+
+	if (get_is_in_fiber() && _get_worker()->scheduler == this->_pimp)
+	{
+		logger.error("fiber scheduler can not be released from its own jobs. trace info: w_fiber_scheduler::release");
+		return 1;
+	}
+
+	//jobs of the pool which run fibers return when nothing is pending
+	{
+		std::unique_lock<std::mutex> _lock(this->_pimp->done_mutex);
+		this->_pimp->done_cv.wait(_lock, [this]()
+			{
+				return this->_pimp->pending.load() == 0 && this->_pimp->active_workers.load() == 0;
+			});
+	}
+
+	this->_pimp->destroy_fibers();
+	SAFE_DELETE(this->_pimp);
+
+	return 0;
+}
+
+#pragma region Getters
+
+size_t w_fiber_scheduler::get_number_of_threads() const
+{
+	return this->_pimp ? this->_pimp->max_workers : 0;
+}
+
+size_t w_fiber_scheduler::get_number_of_fibers() const
+{
+	return this->_pimp ? this->_pimp->fibers.size() : 0;
+}
+
+bool w_fiber_scheduler::get_is_in_fiber()
+{
+	auto _worker = _get_worker();
+	return _worker && _worker->current;
+}
+
+#pragma endregion
+
+#pragma endregion
@@ -0,0 +1,113 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_fiber_scheduler.h
+	Description		 : M:N job system which runs jobs on a fixed pool of fibers over workers of w_thread_pool
+	Comment          : Jobs which call wait_for_counter are suspended and their worker thread continues with other jobs.
+					   Fibers are run by jobs of the pool which return once no fiber is ready, so workers are shared with other jobs.
+					   Fibers use Windows fibers on Win32 and ucontext on POSIX, stacks are allocated once in initialize
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+namespace wolf::system
+{
+	struct w_fiber;
+	class w_thread_pool;
+	class w_fiber_scheduler;
+	struct w_fiber_scheduler_pimp;
+
+	//counts unfinished jobs, fibers can wait on it without blocking their worker thread
+	class w_fiber_counter
+	{
+		friend class w_fiber_scheduler;
+		friend struct w_fiber_scheduler_pimp;
+	public:
+		WSYS_EXP w_fiber_counter();
+
+		WSYS_EXP void increment(_In_ const uint32_t& pValue = 1);
+		WSYS_EXP void decrement();
+
+#pragma region Getters
+		WSYS_EXP uint32_t get_value() const;
+#pragma endregion
+
+	private:
+		//prevent copying
+		w_fiber_counter(w_fiber_counter const&);
+		w_fiber_counter& operator= (w_fiber_counter const&);
+
+		struct w_waiter
+		{
+			w_fiber*                    fiber;
+			w_fiber_scheduler_pimp*     scheduler;
+			uint32_t                    value;
+		};
+
+		std::atomic<uint32_t>       _value;
+		std::mutex                  _mutex;
+		std::condition_variable     _cv;
+		//suspended fibers
+		std::vector<w_waiter>       _waiters;
+	};
+
+	class w_fiber_scheduler
+	{
+	public:
+		WSYS_EXP w_fiber_scheduler();
+		WSYS_EXP ~w_fiber_scheduler();
+
+		/*
+			create fibers which run on workers of pThreadPool, the pool must outlive the scheduler
+			pNumberOfThreads limits the workers which run fibers at the same time, zero means size of pool
+			pNumberOfFibers limits the number of jobs which can run or be suspended at the same time
+			pStackSize is the stack size of each fiber in bytes
+		*/
+		WSYS_EXP W_RESULT initialize(
+			_In_ w_thread_pool& pThreadPool,
+			_In_ const size_t& pNumberOfThreads = 0,
+			_In_ const size_t& pNumberOfFibers = 128,
+			_In_ const size_t& pStackSize = 64 * 1024);
+		//create fibers which run on the shared pool of w_task
+		WSYS_EXP W_RESULT initialize(
+			_In_ const size_t& pNumberOfThreads = 0,
+			_In_ const size_t& pNumberOfFibers = 128,
+			_In_ const size_t& pStackSize = 64 * 1024);
+		//add a job, pCounter will be incremented now and decremented when job is done
+		WSYS_EXP void add_job(_In_ const std::function<void()>& pJob, _In_opt_ w_fiber_counter* pCounter = nullptr);
+		//add pCount jobs which share the same counter
+		WSYS_EXP void add_jobs(_In_ const std::function<void()>* pJobs, _In_ const size_t& pCount, _In_opt_ w_fiber_counter* pCounter = nullptr);
+		/*
+			wait until counter reaches pValue or less.
+			Inside a job, queued jobs of pCounter run on the calling fiber while no fiber is free, then the fiber will be suspended
+			and its worker thread runs other jobs. Workers of the pool run jobs of the pool while they wait, other threads block
+		*/
+		WSYS_EXP void wait_for_counter(_In_ w_fiber_counter* pCounter, _In_ const uint32_t& pValue = 0);
+		//wait for running jobs and destroy fibers, do not call it from a job of the pool
+		WSYS_EXP ULONG release();
+
+#pragma region Getters
+		//maximum number of workers which run fibers at the same time
+		WSYS_EXP size_t get_number_of_threads() const;
+		WSYS_EXP size_t get_number_of_fibers() const;
+		//returns true if calling thread is running a job of any fiber scheduler
+		WSYS_EXP static bool get_is_in_fiber();
+#pragma endregion
+
+	private:
+		//prevent copying
+		w_fiber_scheduler(w_fiber_scheduler const&);
+		w_fiber_scheduler& operator= (w_fiber_scheduler const&);
+
+		w_fiber_scheduler_pimp*     _pimp;
+	};
+}
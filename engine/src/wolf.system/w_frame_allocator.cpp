@@ -0,0 +1,70 @@
+#include "w_system_pch.h"
+#include "w_frame_allocator.h"
+#include <algorithm>
+
+using namespace wolf::system;
+
+w_frame_allocator::w_frame_allocator(_In_ const size_t& pChunkSize, _In_ const uint32_t& pFramesInFlight) :
+	_frame_number(0),
+	_current(nullptr)
+{
+	const auto _frames = std::max<uint32_t>(1, pFramesInFlight);
+	for (uint32_t i = 0; i < _frames; ++i)
+	{
+		this->_arenas.push_back(std::unique_ptr<w_linear_allocator>(new w_linear_allocator(pChunkSize)));
+	}
+	this->_current = this->_arenas[0].get();
+}
+
+w_frame_allocator::~w_frame_allocator()
+{
+	this->_current = nullptr;
+	this->_arenas.clear();
+}
+
+void w_frame_allocator::begin_frame()
+{
+	this->_frame_number++;
+	this->_current = this->_arenas[this->_frame_number % this->_arenas.size()].get();
+	this->_current->clear();
+}
+
+void* w_frame_allocator::allocate(_In_ const size_t& pSize, _In_ const uint8_t& pAlignment)
+{
+	if (!pSize) return nullptr;
+	return this->_current->allocate(pSize, pAlignment);
+}
+
+#pragma region Getters
+
+uint64_t w_frame_allocator::get_frame_number() const
+{
+	return this->_frame_number;
+}
+
+uint32_t w_frame_allocator::get_frames_in_flight() const
+{
+	return static_cast<uint32_t>(this->_arenas.size());
+}
+
+w_linear_allocator& w_frame_allocator::get_current_allocator()
+{
+	return *this->_current;
+}
+
+size_t w_frame_allocator::get_used_memory() const
+{
+	return this->_current->get_used_memory();
+}
+
+size_t w_frame_allocator::get_peak_used_memory() const
+{
+	size_t _peak = 0;
+	for (auto& _arena : this->_arenas)
+	{
+		_peak = std::max(_peak, _arena->get_peak_used_memory());
+	}
+	return _peak;
+}
+
+#pragma endregion
@@ -0,0 +1,77 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_frame_allocator.h
+	Description		 : Scratch memory for data of a frame (e.g. culling results, draw lists, temporary strings)
+	Comment          : Each frame in flight has its own linear allocator which is cleared when that frame begins again,
+					   so memory of a frame stays valid while the next frames are recorded. Not thread safe
+*/
+
+#pragma once
+
+#include "w_linear_allocator.h"
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace wolf::system
+{
+	class w_frame_allocator
+	{
+	public:
+		/*
+			pChunkSize is the initial size of the arena of each frame, arenas chain more chunks when needed.
+			pFramesInFlight is 2 for double buffering and 3 for triple buffering
+		*/
+		WSYS_EXP w_frame_allocator(_In_ const size_t& pChunkSize, _In_ const uint32_t& pFramesInFlight = 2);
+		WSYS_EXP ~w_frame_allocator();
+
+		//move to the arena of the next frame and clear it, memory of the oldest frame becomes invalid
+		WSYS_EXP void begin_frame();
+
+		WSYS_EXP void* allocate(_In_ const size_t& pSize, _In_ const uint8_t& pAlignment = 16);
+
+		//destructors are never called, so only trivially destructible types are allowed
+		template<typename T, typename... Args>
+		T* create(Args&&... pArgs)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "frame memory never calls destructors");
+			auto _memory = allocate(sizeof(T), alignof(T));
+			return _memory ? new (_memory) T(std::forward<Args>(pArgs)...) : nullptr;
+		}
+
+		template<typename T>
+		T* create_array(_In_ const size_t& pLength)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "frame memory never calls destructors");
+			auto _memory = static_cast<T*>(allocate(sizeof(T) * pLength, alignof(T)));
+			if (!_memory) return nullptr;
+
+			for (size_t i = 0; i < pLength; ++i)
+			{
+				new (&_memory[i]) T();
+			}
+			return _memory;
+		}
+
+#pragma region Getters
+		WSYS_EXP uint64_t get_frame_number() const;
+		WSYS_EXP uint32_t get_frames_in_flight() const;
+		//arena of the current frame
+		WSYS_EXP w_linear_allocator& get_current_allocator();
+		WSYS_EXP size_t get_used_memory() const;
+		//maximum used memory of a frame
+		WSYS_EXP size_t get_peak_used_memory() const;
+#pragma endregion
+
+	private:
+		//prevent copying
+		w_frame_allocator(w_frame_allocator const&);
+		w_frame_allocator& operator= (w_frame_allocator const&);
+
+		std::vector<std::unique_ptr<w_linear_allocator>>    _arenas;
+		uint64_t                                            _frame_number;
+		w_linear_allocator*                                 _current;
+	};
+}
@@ -0,0 +1,271 @@
+#include "w_system_pch.h"
+#include "w_frame_pacer.h"
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <cerrno>
+
+#if defined(__WIN32) || defined(__UWP)
+#include <intrin.h>
+#elif defined(__linux) || defined(__ANDROID)
+#include <time.h>
+#include <sys/prctl.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+using namespace wolf::system;
+
+//spin margin before the deadline until the first oversleep was measured
+static const int64_t s_default_spin = 1000000;
+//spin margin is never less than this
+static const int64_t s_min_spin = 50000;
+
+static inline void _cpu_relax()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+w_frame_pacer::w_frame_pacer() :
+	_requested_period(1000000000 / 60),
+	_period(1000000000 / 60),
+	_max_spin(2 * s_default_spin),
+	_oversleep(s_default_spin),
+	_started(false),
+	_missed_frames(0),
+	_history_index(0),
+	_history_count(0)
+{
+	this->_history.fill(0);
+}
+
+std::chrono::nanoseconds w_frame_pacer::wait()
+{
+	auto _now = w_clock::now();
+	if (!this->_started)
+	{
+		//first frame starts now
+		this->_started = true;
+		this->_next_deadline = _now + std::chrono::nanoseconds(this->_period);
+		this->_last_frame = _now;
+		return std::chrono::nanoseconds(0);
+	}
+
+	const auto _deadline = this->_next_deadline;
+	if (_now < _deadline)
+	{
+		//sleep until a margin before the deadline, and measure how late OS woke us up
+		const auto _sleep_target = _deadline - get_spin_margin();
+		if (_now < _sleep_target)
+		{
+			_sleep_until(_sleep_target);
+			_now = w_clock::now();
+
+			auto _error = std::chrono::duration_cast<std::chrono::nanoseconds>(_now - _sleep_target).count();
+			if (_error < 0)
+			{
+				_error = 0;
+			}
+			//follow spikes immediately and decay slowly
+			this->_oversleep = std::max(_error, this->_oversleep - this->_oversleep / 64);
+		}
+
+		while (_now < _deadline)
+		{
+			_cpu_relax();
+			_now = w_clock::now();
+		}
+	}
+
+	const auto _lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(_now - _deadline);
+
+	//next deadline is based on the previous deadline not on the wake up time, so errors do not drift
+	this->_next_deadline = _deadline + std::chrono::nanoseconds(this->_period);
+	if (_lateness.count() > this->_period)
+	{
+		//we missed a whole frame (e.g. a hitch or paused in the debugger), do not try to catch up
+		this->_missed_frames++;
+		this->_next_deadline = _now + std::chrono::nanoseconds(this->_period);
+	}
+
+	this->_history[this->_history_index] = std::chrono::duration_cast<std::chrono::nanoseconds>(_now - this->_last_frame).count();
+	this->_history_index = (this->_history_index + 1) % HISTORY_SIZE;
+	this->_history_count = std::min(this->_history_count + 1, HISTORY_SIZE);
+	this->_last_frame = _now;
+
+	return _lateness;
+}
+
+void w_frame_pacer::on_presented(_In_ const w_clock::time_point& pPresentTime)
+{
+	const auto _last = this->_last_present;
+	this->_last_present = pPresentTime;
+	if (_last.time_since_epoch().count() == 0 || pPresentTime <= _last) return;
+
+	//only follow intervals which are within 5% of requested period, others are dropped or repeated frames
+	const auto _interval = std::chrono::duration_cast<std::chrono::nanoseconds>(pPresentTime - _last).count();
+	if (std::abs(_interval - this->_requested_period) * 20 > this->_requested_period) return;
+
+	this->_period += (_interval - this->_period) / 16;
+}
+
+void w_frame_pacer::reset()
+{
+	this->_started = false;
+	this->_period = this->_requested_period;
+	this->_last_present = w_clock::time_point();
+	this->_missed_frames = 0;
+	this->_history_index = 0;
+	this->_history_count = 0;
+}
+
+void w_frame_pacer::_sleep_until(_In_ const w_clock::time_point& pTime)
+{
+#if defined(__WIN32) || defined(__UWP)
+	//a high resolution waitable timer for each thread, Sleep has a granularity of 1 to 15 milliseconds
+	struct w_waitable_timer
+	{
+		w_waitable_timer()
+		{
+#ifdef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+			this->handle = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+			if (!this->handle)
+#endif
+			{
+				this->handle = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+			}
+		}
+		~w_waitable_timer()
+		{
+			if (this->handle)
+			{
+				CloseHandle(this->handle);
+			}
+		}
+		HANDLE handle = nullptr;
+	};
+	static thread_local w_waitable_timer _timer;
+
+	const auto _duration = std::chrono::duration_cast<std::chrono::nanoseconds>(pTime - w_clock::now()).count();
+	if (_duration <= 0) return;
+
+	if (_timer.handle)
+	{
+		//negative value is relative time in 100 nanoseconds
+		LARGE_INTEGER _due_time;
+		_due_time.QuadPart = -(_duration / 100);
+		if (SetWaitableTimer(_timer.handle, &_due_time, 0, nullptr, nullptr, FALSE))
+		{
+			WaitForSingleObject(_timer.handle, INFINITE);
+			return;
+		}
+	}
+	std::this_thread::sleep_until(pTime);
+#elif defined(__linux) || defined(__ANDROID)
+	//default timer slack of a thread is 50 microseconds, reduce it once for each thread
+	static thread_local bool _slack_is_set = false;
+	if (!_slack_is_set)
+	{
+		_slack_is_set = true;
+		prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+	}
+
+	//steady clock is CLOCK_MONOTONIC, so sleep to the absolute time to avoid errors of computing the duration
+	const auto _ns = std::chrono::duration_cast<std::chrono::nanoseconds>(pTime.time_since_epoch()).count();
+	struct timespec _time;
+	_time.tv_sec = static_cast<time_t>(_ns / 1000000000);
+	_time.tv_nsec = static_cast<long>(_ns % 1000000000);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &_time, nullptr) == EINTR)
+	{
+	}
+#else
+	std::this_thread::sleep_until(pTime);
+#endif
+}
+
+#pragma region Getters
+
+std::chrono::nanoseconds w_frame_pacer::get_period() const
+{
+	return std::chrono::nanoseconds(this->_period);
+}
+
+std::chrono::nanoseconds w_frame_pacer::get_max_spin() const
+{
+	return std::chrono::nanoseconds(this->_max_spin);
+}
+
+std::chrono::nanoseconds w_frame_pacer::get_spin_margin() const
+{
+	//leave some room over the worst oversleep we have seen recently
+	auto _margin = this->_oversleep + this->_oversleep / 2 + s_min_spin;
+	return std::chrono::nanoseconds(std::min(_margin, this->_max_spin));
+}
+
+w_frame_statistics w_frame_pacer::get_statistics() const
+{
+	w_frame_statistics _statistics;
+	_statistics.missed_frames = this->_missed_frames;
+	_statistics.samples = this->_history_count;
+	if (!this->_history_count) return _statistics;
+
+	std::array<int64_t, HISTORY_SIZE> _sorted;
+	std::copy(this->_history.begin(), this->_history.begin() + this->_history_count, _sorted.begin());
+	std::sort(_sorted.begin(), _sorted.begin() + this->_history_count);
+
+	const auto _count = this->_history_count;
+	const double _to_ms = 1.0 / 1000000.0;
+
+	double _sum = 0.0;
+	for (size_t i = 0; i < _count; ++i)
+	{
+		_sum += static_cast<double>(_sorted[i]);
+	}
+	const auto _mean = _sum / _count;
+
+	double _variance = 0.0;
+	for (size_t i = 0; i < _count; ++i)
+	{
+		const auto _diff = static_cast<double>(_sorted[i]) - _mean;
+		_variance += _diff * _diff;
+	}
+	_variance /= _count;
+
+	_statistics.p50 = _sorted[(_count - 1) * 50 / 100] * _to_ms;
+	_statistics.p99 = _sorted[(_count - 1) * 99 / 100] * _to_ms;
+	_statistics.mean = _mean * _to_ms;
+	_statistics.shortest = _sorted[0] * _to_ms;
+	_statistics.longest = _sorted[_count - 1] * _to_ms;
+	_statistics.jitter = std::sqrt(_variance) * _to_ms;
+
+	return _statistics;
+}
+
+#pragma endregion
+
+#pragma region Setters
+
+void w_frame_pacer::set_period(_In_ const std::chrono::nanoseconds& pPeriod)
+{
+	if (pPeriod.count() <= 0 || pPeriod.count() == this->_requested_period) return;
+
+	this->_requested_period = pPeriod.count();
+	this->_period = this->_requested_period;
+	if (this->_started)
+	{
+		this->_next_deadline = this->_last_frame + pPeriod;
+	}
+}
+
+void w_frame_pacer::set_max_spin(_In_ const std::chrono::nanoseconds& pMaxSpin)
+{
+	this->_max_spin = std::max<int64_t>(0, pMaxSpin.count());
+}
+
+#pragma endregion
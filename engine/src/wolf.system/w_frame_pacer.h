@@ -0,0 +1,89 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_frame_pacer.h
+	Description		 : Wait for deadline of frames with hybrid sleep then spin
+	Comment          : The OS sleep is used until a short margin before the deadline and the rest is spent spinning.
+					   The margin follows the measured oversleep of the OS, so the thread spins only for a fraction of a millisecond.
+					   Deadlines are absolute, so errors of a frame do not accumulate over time
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include <chrono>
+#include <array>
+
+namespace wolf::system
+{
+	//statistics of the last frames, all values are in milliseconds
+	struct w_frame_statistics
+	{
+		double      p50 = 0.0;
+		double      p99 = 0.0;
+		double      mean = 0.0;
+		double      shortest = 0.0;
+		double      longest = 0.0;
+		//standard deviation of frame times
+		double      jitter = 0.0;
+		//number of frames in history
+		size_t      samples = 0;
+		//number of frames which missed their deadline by more than a period
+		uint64_t    missed_frames = 0;
+	};
+
+	//not thread safe, wait and on_presented must be called from the thread of the frame loop
+	class w_frame_pacer
+	{
+	public:
+		typedef std::chrono::steady_clock w_clock;
+
+		WSYS_EXP w_frame_pacer();
+
+		//block until the deadline of next frame, returns how late the thread woke up
+		WSYS_EXP std::chrono::nanoseconds wait();
+		//feedback of presentation time, the period follows the refresh rate of display if it is close to the requested period
+		WSYS_EXP void on_presented(_In_ const w_clock::time_point& pPresentTime);
+		//restart deadlines from the next wait and clear history
+		WSYS_EXP void reset();
+
+#pragma region Getters
+		WSYS_EXP std::chrono::nanoseconds get_period() const;
+		WSYS_EXP std::chrono::nanoseconds get_max_spin() const;
+		//current spin margin before each deadline
+		WSYS_EXP std::chrono::nanoseconds get_spin_margin() const;
+		WSYS_EXP w_frame_statistics get_statistics() const;
+#pragma endregion
+
+#pragma region Setters
+		WSYS_EXP void set_period(_In_ const std::chrono::nanoseconds& pPeriod);
+		//upper bound of spinning before each deadline, zero only sleeps
+		WSYS_EXP void set_max_spin(_In_ const std::chrono::nanoseconds& pMaxSpin);
+#pragma endregion
+
+	private:
+		static constexpr size_t HISTORY_SIZE = 256;
+
+		void _sleep_until(_In_ const w_clock::time_point& pTime);
+
+		//period which is requested by user and period which is followed
+		int64_t                                 _requested_period;
+		int64_t                                 _period;
+		int64_t                                 _max_spin;
+		//decaying maximum of OS oversleep
+		int64_t                                 _oversleep;
+
+		bool                                    _started;
+		w_clock::time_point                     _next_deadline;
+		w_clock::time_point                     _last_frame;
+		w_clock::time_point                     _last_present;
+		uint64_t                                _missed_frames;
+
+		//frame times in nanoseconds
+		std::array<int64_t, HISTORY_SIZE>       _history;
+		size_t                                  _history_index;
+		size_t                                  _history_count;
+	};
+}
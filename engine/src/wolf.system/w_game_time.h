@@ -21,6 +21,7 @@
 
 #include <exception>
 #include "w_logger.h"
+#include "w_frame_pacer.h"
 
 #include "python_exporter/w_boost_python_helper.h"
 
@@ -38,9 +39,11 @@ namespace wolf::system
 			_frames_this_second(0),
 			_seconds_counter(0),
 			_fixed_time_step(false),
+			_frame_pacing(false),
 			_target_elapsed_ticks((uint64_t)(TICKS_PER_SECOND / 60))
 		{
 			this->_name = "game_time";
+			this->_frame_pacer.set_period(_ticks_to_nanoseconds(this->_target_elapsed_ticks));
 
 #if defined(__WIN32) || defined(__UWP)
 			//Get frequency
@@ -88,6 +91,13 @@ namespace wolf::system
 
 		bool get_fixed_time_step() const { return this->_fixed_time_step; }
 
+		bool get_frame_pacing() const { return this->_frame_pacing; }
+
+		// Get frame times of the paced frames, all values are in milliseconds.
+		w_frame_statistics get_frame_statistics() const { return this->_frame_pacer.get_statistics(); }
+
+		w_frame_pacer& get_frame_pacer() { return this->_frame_pacer; }
+
 #pragma endregion
 
 #pragma region Setters
@@ -96,8 +106,18 @@ namespace wolf::system
 		void set_fixed_time_step(bool pValue) { this->_fixed_time_step = pValue; }
 
 		// Set how often to call Update when in fixed timestep mode.
-		void set_target_elapsed_ticks(uint64_t pValue) { this->_target_elapsed_ticks = pValue; }
-		void set_target_elapsed_seconds(double pValue) { this->_target_elapsed_ticks = seconds_to_ticks(pValue); }
+		void set_target_elapsed_ticks(uint64_t pValue)
+		{
+			this->_target_elapsed_ticks = pValue;
+			this->_frame_pacer.set_period(_ticks_to_nanoseconds(pValue));
+		}
+		void set_target_elapsed_seconds(double pValue) { set_target_elapsed_ticks(seconds_to_ticks(pValue)); }
+
+		/*
+			Set whether tick waits for the deadline of the next frame in fixed timestep mode.
+			It sleeps and then spins for a fraction of a millisecond, so a fixed rate loop neither burns a core nor oversleeps.
+		*/
+		void set_frame_pacing(bool pValue) { this->_frame_pacing = pValue; }
 
 #pragma endregion
 
@@ -115,12 +135,20 @@ namespace wolf::system
 			this->_fps = 0;
 			this->_frames_this_second = 0;
 			this->_seconds_counter = 0;
+
+			this->_frame_pacer.reset();
 		}
 
 		// Update timer state, calling the specified Update function the appropriate number of times.
 		template<typename TUpdate>
 		void tick(const TUpdate& pUpdate)
 		{
+			// Wait for the deadline of the next frame.
+			if (this->_fixed_time_step && this->_frame_pacing)
+			{
+				this->_frame_pacer.wait();
+			}
+
 			// Query the current time.
 			auto _current_time = _get_time();
 
@@ -234,6 +262,11 @@ namespace wolf::system
 	private:
 		std::string _name;
 
+		static std::chrono::nanoseconds _ticks_to_nanoseconds(uint64_t pTicks)
+		{
+			return std::chrono::nanoseconds(static_cast<int64_t>(pTicks) * static_cast<int64_t>(1000000000 / TICKS_PER_SECOND));
+		}
+
 
 #if defined(__WIN32) || defined(__UWP)
 		//get current time in second
@@ -283,7 +316,11 @@ namespace wolf::system
 
 		// Members for configuring fixed timestep mode.
 		bool _fixed_time_step;
+		bool _frame_pacing;
 		uint64_t _target_elapsed_ticks;
+
+		// Members for pacing frames in fixed timestep mode.
+		w_frame_pacer _frame_pacer;
 	};
 }
 
@@ -2,6 +2,8 @@
 #include "w_image.h"
 #include <turbojpeg.h>
 #include <png.h>
+#include "w_parallel.h"
+#include "w_large_allocator.h"
 
 namespace wolf
 {
@@ -154,112 +156,69 @@ namespace wolf
 				//allocate memory
 				auto _pixels = (uint8_t*)malloc(_comp * pWidth * pHeight * sizeof(uint8_t));
 				auto _bytes_per_row = png_get_rowbytes(_png_ptr, _info_ptr);
-				auto _raw_data = (uint8_t*)malloc(_bytes_per_row * sizeof(uint8_t));
-
-				//pixels counter
-				uint32_t _k = 0;
-
-				//read single row at a time and then convert it to desired pixel format
-				switch (pPixelFormat)
+				auto _raw_size = _bytes_per_row * pHeight * sizeof(uint8_t);
+				//rows of big images are only needed while converting, recycled blocks of w_large_allocator are already resident
+				auto _is_large_raw = _raw_size >= W_LARGE_ALLOCATION_SIZE;
+				auto _raw_data = (uint8_t*)(_is_large_raw ? w_large_allocator::allocate(_raw_size) : malloc(_raw_size));
+
+				//decoding is serial, so read the whole image first and then convert rows in parallel
+				std::vector<png_bytep> _rows(pHeight);
+				for (auto i = 0; i < pHeight; ++i)
 				{
-				case w_png_pixel_format::RGB_PNG:
-					for (auto i = 0; i < pHeight; ++i)
-					{
-						png_read_row(_png_ptr, (png_bytep)_raw_data, NULL);
-
-						const auto _row_offset = i * pWidth;
-
-						uint32_t _byte_index = 0;
-						for (auto j = 0; j < pWidth; ++j)
-						{
-							const uint32_t _r = _raw_data[_byte_index++];
-							const uint32_t _g = _raw_data[_byte_index++];
-							const uint32_t _b = _raw_data[_byte_index++];
-							const uint32_t _a = _raw_data[_byte_index++];//ignored
-
-							_pixels[_k] = _r;
-							_pixels[_k + 1] = _g;
-							_pixels[_k + 2] = _b;
-
-							_k += _comp;
-						}
-					}
-					break;
-				case w_png_pixel_format::BGR_PNG:
-					for (auto i = 0; i < pHeight; ++i)
-					{
-						png_read_row(_png_ptr, (png_bytep)_raw_data, NULL);
-
-						const auto _row_offset = i * pWidth;
-
-						uint32_t _byte_index = 0;
-						for (auto j = 0; j < pWidth; ++j)
-						{
-							const uint32_t _r = _raw_data[_byte_index++];
-							const uint32_t _g = _raw_data[_byte_index++];
-							const uint32_t _b = _raw_data[_byte_index++];
-							const uint32_t _a = _raw_data[_byte_index++];//ignored
-
-							_pixels[_k] = _b;
-							_pixels[_k + 1] = _g;
-							_pixels[_k + 2] = _r;
-
-							_k += _comp;
-						}
-					}
-					break;
-				case w_png_pixel_format::RGBA_PNG:
-					for (auto i = 0; i < pHeight; ++i)
-					{
-						png_read_row(_png_ptr, (png_bytep)_raw_data, NULL);
+					_rows[i] = (png_bytep)(_raw_data + i * _bytes_per_row);
+				}
+				png_read_image(_png_ptr, _rows.data());
 
-						const auto _row_offset = i * pWidth;
+				const auto _width = pWidth;
+				parallel_for(0, pHeight, 16, [&](size_t i)
+				{
+					auto _src = _raw_data + i * _bytes_per_row;
+					auto _dst = _pixels + i * _width * _comp;
 
-						uint32_t _byte_index = 0;
-						for (auto j = 0; j < pWidth; ++j)
-						{
-							const uint32_t _r = _raw_data[_byte_index++];
-							const uint32_t _g = _raw_data[_byte_index++];
-							const uint32_t _b = _raw_data[_byte_index++];
-							const uint32_t _a = _raw_data[_byte_index++];//ignored
-
-							_pixels[_k] = _r;
-							_pixels[_k + 1] = _g;
-							_pixels[_k + 2] = _b;
-							_pixels[_k + 3] = _a;
-
-							_k += _comp;
-						}
-					}
-					break;
-				case w_png_pixel_format::BGRA_PNG:
-					for (auto i = 0; i < pHeight; ++i)
+					for (auto j = 0; j < _width; ++j, _src += 4, _dst += _comp)
 					{
-						png_read_row(_png_ptr, (png_bytep)_raw_data, NULL);
-
-						const auto _row_offset = i * pWidth;
+						const uint8_t _r = _src[0];
+						const uint8_t _g = _src[1];
+						const uint8_t _b = _src[2];
+						const uint8_t _a = _src[3];
 
-						uint32_t _byte_index = 0;
-						for (auto j = 0; j < pWidth; ++j)
+						switch (pPixelFormat)
 						{
-							const uint32_t _r = _raw_data[_byte_index++];
-							const uint32_t _g = _raw_data[_byte_index++];
-							const uint32_t _b = _raw_data[_byte_index++];
-							const uint32_t _a = _raw_data[_byte_index++];//ignored
-
-							_pixels[_k] = _b;
-							_pixels[_k + 1] = _g;
-							_pixels[_k + 2] = _r;
-							_pixels[_k + 3] = _a;
-
-							_k += _comp;
-						}
+						case w_png_pixel_format::RGB_PNG:
+							_dst[0] = _r;
+							_dst[1] = _g;
+							_dst[2] = _b;
+							break;
+						case w_png_pixel_format::BGR_PNG:
+							_dst[0] = _b;
+							_dst[1] = _g;
+							_dst[2] = _r;
+							break;
+						case w_png_pixel_format::RGBA_PNG:
+							_dst[0] = _r;
+							_dst[1] = _g;
+							_dst[2] = _b;
+							_dst[3] = _a;
+							break;
+						case w_png_pixel_format::BGRA_PNG:
+							_dst[0] = _b;
+							_dst[1] = _g;
+							_dst[2] = _r;
+							_dst[3] = _a;
+							break;
+						};
 					}
-					break;
-				};
+				});
 
 				png_destroy_read_struct(&_png_ptr, &_info_ptr, (png_infopp)0);
-				free(_raw_data);
+				if (_is_large_raw)
+				{
+					w_large_allocator::free(_raw_data);
+				}
+				else
+				{
+					free(_raw_data);
+				}
 
 				return _pixels;
 			}
@@ -38,6 +38,7 @@
 
 #include "w_std.h"
 #include "w_convert.h"
+#include "w_vfs.h"
 #include <memory>
 #include <string>
 #include <fstream>
@@ -45,6 +46,7 @@
 #include <vector>
 #include <algorithm>
 #include <iterator>
+#include <cstring>
 #include <sys/stat.h>
 #include "w_image.h"
 
@@ -152,6 +154,8 @@ namespace wolf::system::io
 	//check whether a file does exist or not
 	inline W_RESULT get_is_file(_In_z_ const char* pPath)
 	{
+		if (w_vfs::get_is_packed(pPath) == W_PASSED) return W_PASSED;
+
 		//On Windows
 		FILE* _file = nullptr;
 		fopen_s(&_file, pPath, "r");
@@ -166,6 +170,8 @@ namespace wolf::system::io
 	//check whether a file does exist or not
 	inline W_RESULT get_is_fileW(_In_z_ const wchar_t* pPath)
 	{
+		if (w_vfs::get_has_mounts() && w_vfs::get_is_packed(convert::to_utf8(pPath).c_str()) == W_PASSED) return W_PASSED;
+
 		FILE* _file = nullptr;
 		_wfopen_s(&_file, pPath, L"r");
 		if (_file)
@@ -179,6 +185,12 @@ namespace wolf::system::io
 	//get size of file
 	inline unsigned long get_file_sizeW(_In_z_ const wchar_t* pPath)
 	{
+		uint64_t _packed_size = 0;
+		if (w_vfs::get_has_mounts() && w_vfs::get_packed_size(convert::to_utf8(pPath).c_str(), _packed_size) == W_PASSED)
+		{
+			return static_cast<unsigned long>(_packed_size);
+		}
+
 		std::ifstream _file(pPath, std::ifstream::ate | std::ifstream::binary);
 		auto _size = static_cast<unsigned long>(_file.tellg());
 		_file.close();
@@ -188,6 +200,12 @@ namespace wolf::system::io
 	//get size of file
 	inline unsigned long get_file_size(_In_z_ const char* pPath)
 	{
+		uint64_t _packed_size = 0;
+		if (w_vfs::get_packed_size(pPath, _packed_size) == W_PASSED)
+		{
+			return static_cast<unsigned long>(_packed_size);
+		}
+
 		std::ifstream _file(pPath, std::ifstream::ate | std::ifstream::binary);
 		auto _size = static_cast<unsigned long>(_file.tellg());
 		_file.close();
@@ -380,6 +398,8 @@ namespace wolf::system::io
 	//check whether a file does exist or not
 	inline W_RESULT get_is_file(_In_z_ const char* pPath)
 	{
+		if (w_vfs::get_is_packed(pPath) == W_PASSED) return W_PASSED;
+
 		struct stat _stat;
 		auto _result = stat(pPath, &_stat);
 		return _result == -1 ? W_FAILED : W_PASSED;
@@ -388,6 +408,12 @@ namespace wolf::system::io
 	//check size of file
 	inline long long get_file_size(_In_z_ const char* pPath)
 	{
+		uint64_t _packed_size = 0;
+		if (w_vfs::get_packed_size(pPath, _packed_size) == W_PASSED)
+		{
+			return static_cast<long long>(_packed_size);
+		}
+
 		struct stat _stat;
 		stat(pPath, &_stat);
 		return _stat.st_size;
@@ -756,6 +782,24 @@ namespace wolf::system::io
 	*/
 	inline const char* read_text_file(_In_z_ const char* pPath, _Out_ int& pState)
 	{
+		w_vfs_file _packed;
+		if (w_vfs::open_packed(pPath, _packed) == W_PASSED)
+		{
+			if (_packed.get_size() == 0)
+			{
+				//file is empty
+				pState = -3;
+				return "";
+			}
+
+			auto _source = new char[_packed.get_size() + 1];
+			std::memcpy(_source, _packed.get_data(), _packed.get_size());
+			_source[_packed.get_size()] = '\0';
+
+			pState = 1;
+			return _source;
+		}
+
 		std::ifstream _file(pPath, std::ios::ate | std::ios::in);
 		if (!_file)
 		{
@@ -819,6 +863,27 @@ namespace wolf::system::io
 	*/
 	inline const wchar_t* read_text_fileW(_In_z_ const wchar_t* pPath, _Out_ int& pState)
 	{
+		w_vfs_file _packed;
+		if (w_vfs::get_has_mounts() && w_vfs::open_packed(convert::to_utf8(pPath).c_str(), _packed) == W_PASSED)
+		{
+			if (_packed.get_size() == 0)
+			{
+				//file is empty
+				pState = -3;
+				return L"";
+			}
+
+			auto _source = new wchar_t[_packed.get_size() + 1];
+			for (size_t i = 0; i < _packed.get_size(); ++i)
+			{
+				_source[i] = static_cast<unsigned char>(_packed.get_data()[i]);
+			}
+			_source[_packed.get_size()] = L'\0';
+
+			pState = 1;
+			return _source;
+		}
+
 		std::ifstream _file(pPath, std::ios::ate | std::ios::in);
 		if (!_file)
 		{
@@ -882,6 +947,14 @@ namespace wolf::system::io
 		_Out_ int& pFileState)
 	{
 		pFileState = 1;
+
+		w_vfs_file _packed;
+		if (w_vfs::get_has_mounts() && w_vfs::open_packed(convert::to_utf8(pPath).c_str(), _packed) == W_PASSED)
+		{
+			pData.insert(pData.end(), _packed.get_data(), _packed.get_data() + _packed.get_size());
+			return;
+		}
+
 		std::ifstream _file(pPath, std::ios::binary);
 		if (!_file)
 		{
@@ -928,6 +1001,14 @@ namespace wolf::system::io
 		_Out_ int& pFileState)
 	{
 		pFileState = 1;
+
+		w_vfs_file _packed;
+		if (w_vfs::open_packed(pPath, _packed) == W_PASSED)
+		{
+			pData.insert(pData.end(), _packed.get_data(), _packed.get_data() + _packed.get_size());
+			return;
+		}
+
 		std::ifstream _file(pPath, std::ios::binary);
 		if (!_file)
 		{
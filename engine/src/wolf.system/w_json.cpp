@@ -0,0 +1,41 @@
+#include "w_system_pch.h"
+#include "w_json.h"
+#include "w_convert.h"
+#include "rapidjson/error/en.h"
+
+using namespace wolf::system;
+
+W_RESULT w_json::load(_In_z_ const char* pPath, _Inout_ w_file_buffer& pBuffer, _Inout_ rapidjson::Document& pDoc)
+{
+	if (!pPath) return W_INVALIDARG;
+
+	if (pBuffer.read(pPath) != W_PASSED)
+	{
+		logger.error("could not read json file {}. trace info: w_json::load", pPath);
+		return W_FAILED;
+	}
+
+	if (parse(pBuffer.get_data(), pDoc) != W_PASSED)
+	{
+		logger.error("could not parse json file {}, {} at offset {}. trace info: w_json::load",
+			pPath,
+			rapidjson::GetParseError_En(pDoc.GetParseError()),
+			pDoc.GetErrorOffset());
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
+
+W_RESULT w_json::loadW(_In_z_ const wchar_t* pPath, _Inout_ w_file_buffer& pBuffer, _Inout_ rapidjson::Document& pDoc)
+{
+	if (!pPath) return W_INVALIDARG;
+	return load(convert::to_utf8(pPath).c_str(), pBuffer, pDoc);
+}
+
+W_RESULT w_json::parse(_Inout_z_ char* pJson, _Inout_ rapidjson::Document& pDoc)
+{
+	if (!pJson) return W_INVALIDARG;
+
+	pDoc.ParseInsitu(pJson);
+	return pDoc.HasParseError() ? W_FAILED : W_PASSED;
+}
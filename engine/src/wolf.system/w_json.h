@@ -0,0 +1,29 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_json.h
+	Description		 : JSON parser using rapid json "https://github.com/Tencent/rapidjson"
+	Comment          : Documents are parsed in situ, strings of document point into the parsed buffer
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include "w_vfs.h"
+#include "rapidjson/document.h"
+
+namespace wolf::system
+{
+	class w_json
+	{
+	public:
+		//read file into pBuffer and parse it in situ, pBuffer must outlive pDoc
+		WSYS_EXP static W_RESULT load(_In_z_ const char* pPath, _Inout_ w_file_buffer& pBuffer, _Inout_ rapidjson::Document& pDoc);
+		WSYS_EXP static W_RESULT loadW(_In_z_ const wchar_t* pPath, _Inout_ w_file_buffer& pBuffer, _Inout_ rapidjson::Document& pDoc);
+
+		//parse a mutable and null terminated string in situ
+		WSYS_EXP static W_RESULT parse(_Inout_z_ char* pJson, _Inout_ rapidjson::Document& pDoc);
+	};
+}
@@ -0,0 +1,357 @@
+#include "w_system_pch.h"
+#include "w_large_allocator.h"
+#include "w_memory_tracker.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if !defined(__WIN32) && !defined(_MSC_VER)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace wolf::system;
+
+static const size_t s_huge_page_size = 2 * 1024 * 1024;
+static const size_t s_default_max_cached_bytes = 256 * 1024 * 1024;
+
+namespace
+{
+	struct w_large_block
+	{
+		size_t      size;
+		bool        huge_pages;
+		bool        tracked;
+	};
+
+	struct w_cached_block
+	{
+		void*       ptr;
+		bool        huge_pages;
+	};
+
+	struct w_large_registry
+	{
+		std::mutex                                                      mutex;
+		std::unordered_map<void*, w_large_block>                        live;
+		//freed blocks by size class
+		std::unordered_map<size_t, std::vector<w_cached_block>>         cache;
+		size_t                                                          max_cached_bytes = s_default_max_cached_bytes;
+		bool                                                            use_huge_pages = true;
+		w_large_allocator_statistics                                    statistics;
+	};
+
+	//never destroyed, blocks may be freed from destructors of other static objects
+	w_large_registry& _registry()
+	{
+		static auto _instance = new w_large_registry();
+		return *_instance;
+	}
+
+	size_t _page_size()
+	{
+#if defined(__WIN32) || defined(_MSC_VER)
+		static const size_t _size = []()
+		{
+			SYSTEM_INFO _info;
+			GetSystemInfo(&_info);
+			/*
+				VirtualAlloc aligns reservations to allocation granularity (64KB) by itself, pages are committed
+				and faulted in units of page size, so prefaulting and size classes use the page size
+			*/
+			return static_cast<size_t>(_info.dwPageSize);
+		}();
+#else
+		static const size_t _size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+		return _size;
+	}
+
+	size_t _next_power_of_two(size_t pValue)
+	{
+		size_t _power = 1;
+		while (_power < pValue) _power <<= 1;
+		return _power;
+	}
+
+	/*
+		size classes have eight steps between two powers of two, so less than 12.5% of a block is wasted
+		while blocks of nearby sizes still share a class
+	*/
+	size_t _size_class(size_t pSize)
+	{
+		auto _granule = _next_power_of_two(pSize) / 16;
+		if (_granule < _page_size()) _granule = _page_size();
+		return (pSize + _granule - 1) / _granule * _granule;
+	}
+
+	void _prefault(void* pPtr, size_t pSize)
+	{
+		auto _page = _page_size();
+		auto _bytes = static_cast<volatile char*>(pPtr);
+		for (size_t i = 0; i < pSize; i += _page)
+		{
+			_bytes[i] = 0;
+		}
+	}
+
+	void* _map(size_t pSize, bool pPrefault, bool pTryHugePages, bool& pHugePages)
+	{
+		pHugePages = false;
+
+#if defined(__WIN32) || defined(_MSC_VER)
+		if (pTryHugePages)
+		{
+			auto _large_page = GetLargePageMinimum();
+			if (_large_page && pSize % _large_page == 0)
+			{
+				//fails without SeLockMemoryPrivilege, large pages are always resident
+				auto _ptr = VirtualAlloc(nullptr, pSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+				if (_ptr)
+				{
+					pHugePages = true;
+					return _ptr;
+				}
+			}
+		}
+
+		auto _ptr = VirtualAlloc(nullptr, pSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (_ptr && pPrefault) _prefault(_ptr, pSize);
+		return _ptr;
+#else
+
+#ifdef MAP_HUGETLB
+		//explicit huge pages come from the pool of vm.nr_hugepages, which is often empty
+		if (pTryHugePages && pSize % s_huge_page_size == 0)
+		{
+			auto _flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_POPULATE
+			if (pPrefault) _flags |= MAP_POPULATE;
+#endif
+			auto _ptr = mmap(nullptr, pSize, PROT_READ | PROT_WRITE, _flags, -1, 0);
+			if (_ptr != MAP_FAILED)
+			{
+				pHugePages = true;
+				return _ptr;
+			}
+		}
+#endif
+
+		//map extra 2MB and trim both ends, so transparent huge pages can back the whole block
+		auto _align = pSize >= s_huge_page_size ? s_huge_page_size : 0;
+		auto _mapped = mmap(nullptr, pSize + _align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (_mapped == MAP_FAILED) return nullptr;
+
+		auto _ptr = static_cast<char*>(_mapped);
+		if (_align)
+		{
+			auto _address = reinterpret_cast<uintptr_t>(_mapped);
+			auto _aligned = (_address + _align - 1) & ~(static_cast<uintptr_t>(_align) - 1);
+			auto _head = _aligned - _address;
+			auto _tail = _align - _head;
+			if (_head) munmap(_mapped, _head);
+			if (_tail) munmap(reinterpret_cast<char*>(_aligned) + pSize, _tail);
+			_ptr = reinterpret_cast<char*>(_aligned);
+
+#ifdef MADV_HUGEPAGE
+			madvise(_ptr, pSize, MADV_HUGEPAGE);
+#endif
+		}
+
+		if (pPrefault)
+		{
+#ifdef MADV_POPULATE_WRITE
+			if (madvise(_ptr, pSize, MADV_POPULATE_WRITE) != 0)
+#endif
+			{
+				_prefault(_ptr, pSize);
+			}
+		}
+		return _ptr;
+#endif
+	}
+
+	void _unmap(void* pPtr, size_t pSize)
+	{
+#if defined(__WIN32) || defined(_MSC_VER)
+		VirtualFree(pPtr, 0, MEM_RELEASE);
+#else
+		munmap(pPtr, pSize);
+#endif
+	}
+}
+
+void* w_large_allocator::allocate(_In_ const size_t& pSizeInBytes, _In_ const bool& pPrefault)
+{
+	if (!pSizeInBytes) return nullptr;
+
+	auto _size = _size_class(pSizeInBytes);
+	auto& _reg = _registry();
+
+	void* _ptr = nullptr;
+	bool _huge_pages = false;
+	bool _use_huge_pages;
+	{
+		std::lock_guard<std::mutex> _lock(_reg.mutex);
+
+		auto _iter = _reg.cache.find(_size);
+		if (_iter != _reg.cache.end() && !_iter->second.empty())
+		{
+			//pages of a recycled block are already resident, so no need to prefault
+			auto _block = _iter->second.back();
+			_iter->second.pop_back();
+			_ptr = _block.ptr;
+			_huge_pages = _block.huge_pages;
+
+			_reg.statistics.cached_bytes -= _size;
+			_reg.statistics.cached_blocks--;
+			_reg.statistics.recycled_blocks++;
+		}
+		_use_huge_pages = _reg.use_huge_pages;
+	}
+
+	bool _mapped = false;
+	if (!_ptr)
+	{
+		//map outside of lock, system calls and prefaulting are slow
+		_ptr = _map(_size, pPrefault, _use_huge_pages, _huge_pages);
+		if (!_ptr)
+		{
+			//cached blocks of other sizes may be what keeps the mapping from succeeding
+			trim();
+			_ptr = _map(_size, pPrefault, _use_huge_pages, _huge_pages);
+			if (!_ptr) return nullptr;
+		}
+		_mapped = true;
+	}
+
+	auto _tracked = w_memory_tracker::track_allocation(MEMORY_TAG_LARGE, _size);
+
+	std::lock_guard<std::mutex> _lock(_reg.mutex);
+	_reg.live[_ptr] = { _size, _huge_pages, _tracked };
+	_reg.statistics.live_bytes += _size;
+	_reg.statistics.live_blocks++;
+	if (_mapped)
+	{
+		_reg.statistics.mapped_blocks++;
+		if (_huge_pages) _reg.statistics.huge_page_blocks++;
+	}
+	return _ptr;
+}
+
+void w_large_allocator::free(_In_ void* pBlock)
+{
+	if (!pBlock) return;
+
+	auto& _reg = _registry();
+	w_large_block _block;
+	bool _cached = false;
+	{
+		std::lock_guard<std::mutex> _lock(_reg.mutex);
+
+		auto _iter = _reg.live.find(pBlock);
+		if (_iter == _reg.live.end())
+		{
+			logger.error("block was not allocated with w_large_allocator. trace info: w_large_allocator::free");
+			return;
+		}
+		_block = _iter->second;
+		_reg.live.erase(_iter);
+
+		_reg.statistics.live_bytes -= _block.size;
+		_reg.statistics.live_blocks--;
+
+		if (_reg.statistics.cached_bytes + _block.size <= _reg.max_cached_bytes)
+		{
+			_reg.cache[_block.size].push_back({ pBlock, _block.huge_pages });
+			_reg.statistics.cached_bytes += _block.size;
+			_reg.statistics.cached_blocks++;
+			_cached = true;
+		}
+		else
+		{
+			_reg.statistics.unmapped_blocks++;
+		}
+	}
+
+	if (_block.tracked) w_memory_tracker::record_free(MEMORY_TAG_LARGE, _block.size);
+	if (!_cached) _unmap(pBlock, _block.size);
+}
+
+void w_large_allocator::trim()
+{
+	auto& _reg = _registry();
+
+	std::unordered_map<size_t, std::vector<w_cached_block>> _cache;
+	{
+		std::lock_guard<std::mutex> _lock(_reg.mutex);
+		_cache.swap(_reg.cache);
+		_reg.statistics.unmapped_blocks += _reg.statistics.cached_blocks;
+		_reg.statistics.cached_bytes = 0;
+		_reg.statistics.cached_blocks = 0;
+	}
+
+	for (auto& _iter : _cache)
+	{
+		for (auto& _block : _iter.second)
+		{
+			_unmap(_block.ptr, _iter.first);
+		}
+	}
+}
+
+#pragma region Getters
+
+size_t w_large_allocator::get_block_size(_In_ const void* pBlock)
+{
+	auto& _reg = _registry();
+	std::lock_guard<std::mutex> _lock(_reg.mutex);
+
+	auto _iter = _reg.live.find(const_cast<void*>(pBlock));
+	return _iter == _reg.live.end() ? 0 : _iter->second.size;
+}
+
+size_t w_large_allocator::get_max_cached_bytes()
+{
+	auto& _reg = _registry();
+	std::lock_guard<std::mutex> _lock(_reg.mutex);
+	return _reg.max_cached_bytes;
+}
+
+bool w_large_allocator::get_use_huge_pages()
+{
+	auto& _reg = _registry();
+	std::lock_guard<std::mutex> _lock(_reg.mutex);
+	return _reg.use_huge_pages;
+}
+
+w_large_allocator_statistics w_large_allocator::get_statistics()
+{
+	auto& _reg = _registry();
+	std::lock_guard<std::mutex> _lock(_reg.mutex);
+	return _reg.statistics;
+}
+
+#pragma endregion
+
+#pragma region Setters
+
+void w_large_allocator::set_max_cached_bytes(_In_ const size_t& pMaxCachedBytes)
+{
+	{
+		auto& _reg = _registry();
+		std::lock_guard<std::mutex> _lock(_reg.mutex);
+		_reg.max_cached_bytes = pMaxCachedBytes;
+		if (_reg.statistics.cached_bytes <= pMaxCachedBytes) return;
+	}
+	trim();
+}
+
+void w_large_allocator::set_use_huge_pages(_In_ const bool& pUse)
+{
+	auto& _reg = _registry();
+	std::lock_guard<std::mutex> _lock(_reg.mutex);
+	_reg.use_huge_pages = pUse;
+}
+
+#pragma endregion
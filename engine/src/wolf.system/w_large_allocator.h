@@ -0,0 +1,69 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_large_allocator.h
+	Description		 : Large blocks (decoded images, vertex arrays, video frames) directly from pages of OS
+	Comment          : On linux blocks of 2MB or more try MAP_HUGETLB first, then fall back to normal pages aligned to 2MB
+					   with MADV_HUGEPAGE hint for transparent huge pages. On windows MEM_LARGE_PAGES is tried first, which needs
+					   SeLockMemoryPrivilege. Freed blocks are kept in a cache by size class and handed out again without a system call,
+					   so the content of a recycled block is not zeroed
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+
+namespace wolf::system
+{
+	//buffers smaller than this gain nothing from the large allocator, use malloc for them
+	static const size_t W_LARGE_ALLOCATION_SIZE = 256 * 1024;
+
+	struct w_large_allocator_statistics
+	{
+		//bytes and blocks handed out, sizes are rounded up to size classes
+		size_t      live_bytes = 0;
+		size_t      live_blocks = 0;
+		//freed blocks which are waiting for reuse
+		size_t      cached_bytes = 0;
+		size_t      cached_blocks = 0;
+		//blocks mapped from OS
+		uint64_t    mapped_blocks = 0;
+		//blocks mapped with explicit huge pages (MAP_HUGETLB or MEM_LARGE_PAGES)
+		uint64_t    huge_page_blocks = 0;
+		//allocations served from the cache
+		uint64_t    recycled_blocks = 0;
+		//blocks returned to OS
+		uint64_t    unmapped_blocks = 0;
+	};
+
+	class w_large_allocator
+	{
+	public:
+		/*
+			returns a block of at least pSizeInBytes aligned to page size (2MB for blocks of 2MB or more),
+			pPrefault maps all pages up front so first writes do not page fault. returns nullptr on failure
+		*/
+		WSYS_EXP static void* allocate(_In_ const size_t& pSizeInBytes, _In_ const bool& pPrefault = false);
+		//pBlock must be allocated with w_large_allocator, nullptr is ignored
+		WSYS_EXP static void free(_In_ void* pBlock);
+		//return all cached blocks to OS
+		WSYS_EXP static void trim();
+
+#pragma region Getters
+		//size of the size class of pBlock, 0 if pBlock was not allocated with w_large_allocator
+		WSYS_EXP static size_t get_block_size(_In_ const void* pBlock);
+		WSYS_EXP static size_t get_max_cached_bytes();
+		WSYS_EXP static bool get_use_huge_pages();
+		WSYS_EXP static w_large_allocator_statistics get_statistics();
+#pragma endregion
+
+#pragma region Setters
+		//freed blocks which do not fit in the cache are returned to OS, the default is 256MB
+		WSYS_EXP static void set_max_cached_bytes(_In_ const size_t& pMaxCachedBytes);
+		//enabled by default, when disabled only transparent huge page hints are used
+		WSYS_EXP static void set_use_huge_pages(_In_ const bool& pUse);
+#pragma endregion
+	};
+}
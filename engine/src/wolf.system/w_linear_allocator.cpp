@@ -1,56 +1,97 @@
 #include "w_system_pch.h"
-
-#ifdef __WIN32
-
 #include "w_linear_allocator.h"
-#include <string>
+#include "w_memory_tracker.h"
+#include <algorithm>
 
 using namespace wolf::system;
 
-w_linear_allocator::w_linear_allocator(size_t pSize, void* pStart) : w_allocator(pSize, pStart), _current_pos(pStart)
+static inline void _free_chunk(_In_ uint8_t* pStart, _In_ const size_t& pSize, _In_ const bool& pTracked)
+{
+	free(pStart);
+	if (pTracked)
+	{
+		w_memory_tracker::record_free(MEMORY_TAG_ALLOCATOR, pSize);
+	}
+}
+
+w_linear_allocator::w_linear_allocator(size_t pSize, void* pStart) : w_allocator(pSize, pStart),
+	_chunk_index(0),
+	_current_pos(static_cast<uint8_t*>(pStart)),
+	_current_end(static_cast<uint8_t*>(pStart) + pSize),
+	_chunk_size(pSize),
+	_peak_used_memory(0)
 {
 	assert(pSize > 0);
+	this->_chunks.push_back({ static_cast<uint8_t*>(pStart), pSize, false, false });
+}
+
+w_linear_allocator::w_linear_allocator(size_t pChunkSize) : w_allocator(pChunkSize, nullptr),
+	_chunk_index(0),
+	_current_pos(nullptr),
+	_current_end(nullptr),
+	_chunk_size(pChunkSize),
+	_peak_used_memory(0)
+{
+	assert(pChunkSize > 0);
+
+	auto _start = static_cast<uint8_t*>(malloc(pChunkSize));
+	if (_start)
+	{
+		this->_chunks.push_back({ _start, pChunkSize, true, w_memory_tracker::track_allocation(MEMORY_TAG_ALLOCATOR, pChunkSize) });
+		this->_start = _start;
+		this->_current_pos = _start;
+		this->_current_end = _start + pChunkSize;
+	}
+	else
+	{
+		this->_size = 0;
+	}
 }
 
 w_linear_allocator::~w_linear_allocator()
 {
-	this->_current_pos   = nullptr;
+	for (auto& _chunk : this->_chunks)
+	{
+		if (_chunk.owned)
+		{
+			_free_chunk(_chunk.start, _chunk.size, _chunk.tracked);
+		}
+	}
+	this->_chunks.clear();
+
+	this->_current_pos = nullptr;
+	this->_current_end = nullptr;
+	this->_used_memory = 0;
+	this->_num_allocations = 0;
 }
 
 void* w_linear_allocator::allocate(size_t pSize, uint8_t pAlignment)
 {
 	assert(pSize != 0);
 
-	uint8_t _adjustment =  pointer_math::align_forward_adjustment(this->_current_pos, pAlignment);
+	uint8_t _adjustment = this->_current_pos ? pointer_math::align_forward_adjustment(this->_current_pos, pAlignment) : 0;
 
-	if (this->_used_memory + _adjustment + pSize > this->_size)
+	if (!this->_current_pos || static_cast<size_t>(this->_current_end - this->_current_pos) < _adjustment + pSize)
 	{
-		//OutputDebugString(L"/////////////////////////ERROR\n");
-		//OutputDebugString(std::to_wstring(_used_memory).c_str());
-		//OutputDebugString(L"\n");
-		//OutputDebugString(std::to_wstring(adjustment).c_str());
-		//OutputDebugString(L"\n");
-		//OutputDebugString(std::to_wstring(size).c_str());
-		//OutputDebugString(L"\n");
-		//OutputDebugString(std::to_wstring(_size).c_str());
-		//OutputDebugString(L"\n");
-		//OutputDebugString(L"/////////////////////////ERROR\n");
-
-		return nullptr;
+		//chain the next chunk instead of failing
+		if (!_next_chunk(pSize, pAlignment)) return nullptr;
+		_adjustment = pointer_math::align_forward_adjustment(this->_current_pos, pAlignment);
 	}
 
-	uintptr_t _aligned_address = (uintptr_t)this->_current_pos + _adjustment;
+	auto _aligned_address = this->_current_pos + _adjustment;
 
-	this->_current_pos = (void*)(_aligned_address + pSize);
+	this->_current_pos = _aligned_address + pSize;
 
 	this->_used_memory += pSize + _adjustment;
 	this->_num_allocations++;
+	this->_peak_used_memory = std::max(this->_peak_used_memory, this->_used_memory);
 
-	return (void*)_aligned_address;
+	return _aligned_address;
 }
 
 void w_linear_allocator::deallocate(void* pMemory)
 {
+	(void)pMemory;
 	assert( false && "Use clear() instead" );
 }
 
@@ -58,7 +99,83 @@ void w_linear_allocator::clear()
 {
 	this->_num_allocations = 0;
 	this->_used_memory = 0;
-	this->_current_pos = _start;
+	this->_chunk_index = 0;
+	if (this->_chunks.empty())
+	{
+		this->_current_pos = nullptr;
+		this->_current_end = nullptr;
+	}
+	else
+	{
+		this->_current_pos = this->_chunks[0].start;
+		this->_current_end = this->_chunks[0].start + this->_chunks[0].size;
+	}
+}
+
+void w_linear_allocator::shrink()
+{
+	//the first chunk is always kept
+	while (this->_chunks.size() > this->_chunk_index + 1 && this->_chunks.size() > 1)
+	{
+		auto& _chunk = this->_chunks.back();
+		if (_chunk.owned)
+		{
+			_free_chunk(_chunk.start, _chunk.size, _chunk.tracked);
+		}
+		this->_chunks.pop_back();
+	}
+}
+
+bool w_linear_allocator::_next_chunk(size_t pSize, uint8_t pAlignment)
+{
+	const auto _needed = pSize + pAlignment;
+
+	//reuse the next spare chunk if it is large enough
+	auto _next = this->_chunks.empty() ? 0 : this->_chunk_index + 1;
+	if (_next >= this->_chunks.size() || this->_chunks[_next].size < _needed)
+	{
+		const auto _size = std::max(this->_chunk_size, _needed);
+		auto _start = static_cast<uint8_t*>(malloc(_size));
+		if (!_start)
+		{
+			logger.error("could not allocate chunk of {} bytes. trace info: w_linear_allocator::_next_chunk", _size);
+			return false;
+		}
+		this->_chunks.insert(this->_chunks.begin() + _next, { _start, _size, true, w_memory_tracker::track_allocation(MEMORY_TAG_ALLOCATOR, _size) });
+	}
+
+	//memory which is left at the end of the current chunk counts as used until clear
+	if (this->_current_pos)
+	{
+		this->_used_memory += this->_current_end - this->_current_pos;
+	}
+
+	this->_chunk_index = _next;
+	this->_current_pos = this->_chunks[_next].start;
+	this->_current_end = this->_current_pos + this->_chunks[_next].size;
+	return true;
+}
+
+#pragma region Getters
+
+size_t w_linear_allocator::get_chunks_count() const
+{
+	return this->_chunks.size();
+}
+
+size_t w_linear_allocator::get_reserved_memory() const
+{
+	size_t _size = 0;
+	for (auto& _chunk : this->_chunks)
+	{
+		_size += _chunk.size;
+	}
+	return _size;
+}
+
+size_t w_linear_allocator::get_peak_used_memory() const
+{
+	return this->_peak_used_memory;
 }
 
-#endif // __WIN32
\ No newline at end of file
+#pragma endregion
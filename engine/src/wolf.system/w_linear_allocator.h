@@ -4,42 +4,74 @@
 	Website			 : https://WolfEngine.App
 	Name			 : w_linear_allocator.h
 	Description		 : Responsible for allocating memory linear. This code modified and optimized based on "LinearAllocator" class written by "Tiago Costa", Copyright(c) 2013
-	Comment          : TODO: depricated
+	Comment          : When the current chunk is full, a new chunk is chained from heap instead of failing.
+					   Chained chunks are kept after clear, so a steady workload stops allocating from heap after warm up
 */
 
 #pragma once
 
-#ifdef __WIN32
-
 #include "w_allocator.h"
+#include <vector>
 
 namespace wolf::system
 {
 	class w_linear_allocator : public w_allocator
 	{
 	public:
-		w_linear_allocator(size_t pSize, void* pStart);
-		~w_linear_allocator();
+		//allocate from pStart, chained chunks have the same size
+		WSYS_EXP w_linear_allocator(size_t pSize, void* pStart);
+		//allocate from chunks of pChunkSize bytes which are owned by allocator
+		WSYS_EXP explicit w_linear_allocator(size_t pChunkSize);
+		WSYS_EXP ~w_linear_allocator();
+
+		WSYS_EXP void* allocate(size_t pSize, uint8_t pAlignment = 4) override;
+
+		WSYS_EXP void deallocate(void* pmemory) override;
+
+		//release all allocations, chunks are kept for reuse
+		WSYS_EXP void clear();
+		//free chunks which are not in use
+		WSYS_EXP void shrink();
 
-		void* allocate(size_t pSize, uint8_t pAlignment) override;
+#pragma region Getters
+		WSYS_EXP size_t get_chunks_count() const;
+		//total bytes of all chunks
+		WSYS_EXP size_t get_reserved_memory() const;
+		//maximum of used memory since construction
+		WSYS_EXP size_t get_peak_used_memory() const;
+#pragma endregion
 
-		void deallocate(void* pmemory) override;
+	protected:
+		struct w_chunk
+		{
+			uint8_t*    start;
+			size_t      size;
+			bool        owned;
+			//recorded by w_memory_tracker
+			bool        tracked;
+		};
+
+		//move to the next chunk which has room for pSize bytes, chain a new one if needed
+		bool _next_chunk(size_t pSize, uint8_t pAlignment);
 
-		void clear();
+		std::vector<w_chunk>    _chunks;
+		size_t                  _chunk_index;
+		uint8_t*                _current_pos;
+		uint8_t*                _current_end;
+		size_t                  _chunk_size;
+		size_t                  _peak_used_memory;
 
 	private:
 		//Prevent copies because it might cause errors
 		w_linear_allocator(const w_linear_allocator&);
 		w_linear_allocator& operator=(const w_linear_allocator&);
-
-		void* _current_pos;
 	};
 
 	namespace allocator
 	{
 		inline w_linear_allocator* newLinearAllocator(size_t pSize, w_allocator& pAllocator)
 		{
-			void* p = pAllocator.allocate(pSize + sizeof(w_linear_allocator), __alignof(w_linear_allocator));
+			void* p = pAllocator.allocate(pSize + sizeof(w_linear_allocator), alignof(w_linear_allocator));
 			return new (p) w_linear_allocator(pSize, pointer_math::add(p, sizeof(w_linear_allocator)));
 		}
 
@@ -51,5 +83,3 @@ namespace wolf::system
 		}
 	};
 }
-
-#endif // __WIN32
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "w_system_pch.h"
 #include "w_logger.h"
+#include "w_memory_tracker.h"
 #include <curl/curl.h>
 
 //Declaration of extern objects as shared
@@ -14,6 +15,12 @@ std::map<uint32_t, float> wolf::windows_frame_time_in_sec;
 
 void wolf::release_heap_data()
 {
+	//report memory which is still alive before the logger is released
+	if (system::w_memory_tracker::get_is_enabled())
+	{
+		system::w_memory_tracker::report_leaks();
+	}
+
 	//release all loggers
 	curl_global_cleanup();
 	spdlog::drop_all();
@@ -69,8 +69,7 @@ W_RESULT w_lua::load_file(const wchar_t* pPath)
 #if defined(__WIN32) || defined(__UWP)
     auto _is_exists = wolf::system::io::get_is_fileW(pPath);
 #else
-   auto _c_str = wolf::system::convert::wstring_to_string(pPath).c_str();
-    auto _is_exists = wolf::system::io::get_is_file(_c_str);
+    auto _is_exists = wolf::system::io::get_is_file(_utf8_path.c_str());
 #endif
     
     if (_is_exists == W_FAILED)
@@ -88,8 +87,17 @@ W_RESULT w_lua::load_file(const wchar_t* pPath)
 	}
 	luaL_openlibs(_lua);
 
-	//load the lua file
-	int _hr = luaL_loadfile(_lua, _utf8_path.c_str());
+	//scripts are compiled from the mapped file or archive, they are not copied first
+	w_vfs_file _file;
+	if (_file.open(_utf8_path.c_str()) != W_PASSED)
+	{
+		_last_error = "lua: could not open lua file on following path: " + _utf8_path;
+		return W_FAILED;
+	}
+
+	//load the lua file, "@" makes lua report the path in errors
+	const auto _chunk_name = "@" + _utf8_path;
+	int _hr = luaL_loadbuffer(_lua, _file.get_data(), _file.get_size(), _chunk_name.c_str());
 	if (_hr)
 	{
 		_VL(_hr);
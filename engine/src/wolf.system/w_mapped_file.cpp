@@ -0,0 +1,459 @@
+#include "w_system_pch.h"
+#include "w_mapped_file.h"
+#include "w_convert.h"
+
+#if !defined(__WIN32) && !defined(_MSC_VER)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace wolf::system;
+
+w_mapped_file::w_mapped_file() :
+	_view(nullptr),
+	_view_size(0),
+	_delta(0),
+	_size(0),
+	_file_size(0),
+	_is_open(false),
+	_access(w_mapped_file_access::READ_ONLY)
+#if defined(__WIN32) || defined(_MSC_VER)
+	, _file(INVALID_HANDLE_VALUE)
+#endif
+{
+}
+
+w_mapped_file::~w_mapped_file()
+{
+	close();
+}
+
+w_mapped_file::w_mapped_file(w_mapped_file&& pOther) noexcept : w_mapped_file()
+{
+	_move(pOther);
+}
+
+w_mapped_file& w_mapped_file::operator=(w_mapped_file&& pOther) noexcept
+{
+	if (this != &pOther)
+	{
+		close();
+		_move(pOther);
+	}
+	return *this;
+}
+
+void w_mapped_file::_move(_Inout_ w_mapped_file& pOther)
+{
+	this->_view = pOther._view;
+	this->_view_size = pOther._view_size;
+	this->_delta = pOther._delta;
+	this->_size = pOther._size;
+	this->_file_size = pOther._file_size;
+	this->_is_open = pOther._is_open;
+	this->_access = pOther._access;
+#if defined(__WIN32) || defined(_MSC_VER)
+	this->_file = pOther._file;
+	pOther._file = INVALID_HANDLE_VALUE;
+#endif
+
+	pOther._view = nullptr;
+	pOther._view_size = 0;
+	pOther._delta = 0;
+	pOther._size = 0;
+	pOther._file_size = 0;
+	pOther._is_open = false;
+}
+
+#if defined(__WIN32) || defined(_MSC_VER)
+
+W_RESULT w_mapped_file::open(
+	_In_z_ const char* pPath,
+	_In_ const w_mapped_file_access& pAccess,
+	_In_ const uint64_t& pOffset,
+	_In_ const size_t& pSize)
+{
+	if (!pPath) return W_INVALIDARG;
+	return openW(convert::from_utf8(pPath).c_str(), pAccess, pOffset, pSize);
+}
+
+W_RESULT w_mapped_file::openW(
+	_In_z_ const wchar_t* pPath,
+	_In_ const w_mapped_file_access& pAccess,
+	_In_ const uint64_t& pOffset,
+	_In_ const size_t& pSize)
+{
+	if (!pPath) return W_INVALIDARG;
+	close();
+
+	const auto _write = pAccess == w_mapped_file_access::READ_WRITE;
+	auto _file = CreateFileW(
+		pPath,
+		_write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+		_write ? FILE_SHARE_READ : FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL,
+		_write ? OPEN_ALWAYS : OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		NULL);
+	if (_file == INVALID_HANDLE_VALUE)
+	{
+		logger.error(L"could not open file {}. trace info: w_mapped_file::openW", pPath);
+		return W_FAILED;
+	}
+
+	LARGE_INTEGER _file_size;
+	if (!GetFileSizeEx(_file, &_file_size))
+	{
+		CloseHandle(_file);
+		logger.error(L"could not get size of file {}. trace info: w_mapped_file::openW", pPath);
+		return W_FAILED;
+	}
+
+	uint64_t _size = pSize;
+	const auto _current_size = static_cast<uint64_t>(_file_size.QuadPart);
+	if (!_write && pOffset > _current_size)
+	{
+		CloseHandle(_file);
+		logger.error(L"offset is past the end of file {}. trace info: w_mapped_file::openW", pPath);
+		return W_INVALIDARG;
+	}
+	if (_size == 0) _size = _current_size > pOffset ? _current_size - pOffset : 0;
+	if (!_write && _size > _current_size - pOffset) _size = _current_size - pOffset;
+	if (_size > SIZE_MAX)
+	{
+		CloseHandle(_file);
+		logger.error(L"file {} does not fit in address space. trace info: w_mapped_file::openW", pPath);
+		return W_INVALIDARG;
+	}
+
+	this->_access = pAccess;
+	this->_file_size = std::max(_current_size, pOffset + _size);
+	this->_size = static_cast<size_t>(_size);
+	this->_is_open = true;
+	this->_file = _file;
+
+	//mapping an empty range fails, an empty view is still a valid view
+	if (this->_size == 0) return W_PASSED;
+
+	//mapping grows the file to its maximum size for READ_WRITE
+	const auto _end = pOffset + _size;
+	auto _mapping = CreateFileMappingW(
+		_file,
+		NULL,
+		_write ? PAGE_READWRITE : PAGE_READONLY,
+		static_cast<DWORD>(_end >> 32),
+		static_cast<DWORD>(_end & 0xFFFFFFFF),
+		NULL);
+	if (!_mapping)
+	{
+		close();
+		logger.error(L"could not create mapping of file {}. trace info: w_mapped_file::openW", pPath);
+		return W_FAILED;
+	}
+
+	const auto _aligned_offset = pOffset - pOffset % get_page_size();
+	this->_delta = static_cast<size_t>(pOffset - _aligned_offset);
+	this->_view_size = this->_delta + this->_size;
+	this->_view = MapViewOfFile(
+		_mapping,
+		_write ? FILE_MAP_WRITE : FILE_MAP_READ,
+		static_cast<DWORD>(_aligned_offset >> 32),
+		static_cast<DWORD>(_aligned_offset & 0xFFFFFFFF),
+		this->_view_size);
+	//view keeps the mapping alive
+	CloseHandle(_mapping);
+
+	if (!this->_view)
+	{
+		close();
+		logger.error(L"could not map view of file {}. trace info: w_mapped_file::openW", pPath);
+		return W_FAILED;
+	}
+
+	return W_PASSED;
+}
+
+W_RESULT w_mapped_file::advise(
+	_In_ const w_mapped_file_advice& pAdvice,
+	_In_ const size_t& pOffset,
+	_In_ const size_t& pSize)
+{
+	if (!this->_is_open || pOffset > this->_size) return W_INVALIDARG;
+	if (!this->_view || pAdvice != w_mapped_file_advice::WILL_NEED) return W_PASSED;
+
+#if _WIN32_WINNT >= 0x0602
+	//other hints have no equivalent for views of files
+	WIN32_MEMORY_RANGE_ENTRY _range;
+	_range.VirtualAddress = static_cast<char*>(this->_view) + this->_delta + pOffset;
+	_range.NumberOfBytes = pSize ? std::min(pSize, this->_size - pOffset) : this->_size - pOffset;
+	if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &_range, 0))
+	{
+		logger.error("could not prefetch view. trace info: w_mapped_file::advise");
+		return W_FAILED;
+	}
+#endif
+	return W_PASSED;
+}
+
+W_RESULT w_mapped_file::flush(_In_ const bool& pAsync)
+{
+	if (!this->_is_open) return W_INVALIDARG;
+	if (!this->_view || this->_access == w_mapped_file_access::READ_ONLY) return W_PASSED;
+
+	if (!FlushViewOfFile(this->_view, this->_view_size))
+	{
+		logger.error("could not flush view. trace info: w_mapped_file::flush");
+		return W_FAILED;
+	}
+	//FlushViewOfFile only starts writing, wait for the disk too
+	if (!pAsync && !FlushFileBuffers(this->_file))
+	{
+		logger.error("could not flush file. trace info: w_mapped_file::flush");
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
+
+void w_mapped_file::close()
+{
+	if (this->_view)
+	{
+		UnmapViewOfFile(this->_view);
+	}
+	if (this->_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(this->_file);
+		this->_file = INVALID_HANDLE_VALUE;
+	}
+
+	this->_view = nullptr;
+	this->_view_size = 0;
+	this->_delta = 0;
+	this->_size = 0;
+	this->_file_size = 0;
+	this->_is_open = false;
+}
+
+size_t w_mapped_file::get_page_size()
+{
+	static const size_t _size = []()
+	{
+		SYSTEM_INFO _info;
+		GetSystemInfo(&_info);
+		//views must start on allocation granularity, not on page size
+		return static_cast<size_t>(_info.dwAllocationGranularity);
+	}();
+	return _size;
+}
+
+#else
+
+W_RESULT w_mapped_file::open(
+	_In_z_ const char* pPath,
+	_In_ const w_mapped_file_access& pAccess,
+	_In_ const uint64_t& pOffset,
+	_In_ const size_t& pSize)
+{
+	if (!pPath) return W_INVALIDARG;
+	close();
+
+	const auto _write = pAccess == w_mapped_file_access::READ_WRITE;
+	auto _fd = ::open(pPath, _write ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0644);
+	if (_fd == -1)
+	{
+		logger.error("could not open file {}. trace info: w_mapped_file::open", pPath);
+		return W_FAILED;
+	}
+
+	struct stat _stat;
+	if (fstat(_fd, &_stat) == -1)
+	{
+		::close(_fd);
+		logger.error("could not get size of file {}. trace info: w_mapped_file::open", pPath);
+		return W_FAILED;
+	}
+
+	uint64_t _size = pSize;
+	const auto _current_size = static_cast<uint64_t>(_stat.st_size);
+	if (!_write && pOffset > _current_size)
+	{
+		::close(_fd);
+		logger.error("offset is past the end of file {}. trace info: w_mapped_file::open", pPath);
+		return W_INVALIDARG;
+	}
+	if (_size == 0) _size = _current_size > pOffset ? _current_size - pOffset : 0;
+	if (!_write && _size > _current_size - pOffset) _size = _current_size - pOffset;
+	if (_size > SIZE_MAX)
+	{
+		::close(_fd);
+		logger.error("file {} does not fit in address space. trace info: w_mapped_file::open", pPath);
+		return W_INVALIDARG;
+	}
+
+	//pages past the end of file can not be written through a view
+	if (_write && pOffset + _size > _current_size && ftruncate(_fd, static_cast<off_t>(pOffset + _size)) == -1)
+	{
+		::close(_fd);
+		logger.error("could not grow file {}. trace info: w_mapped_file::open", pPath);
+		return W_FAILED;
+	}
+
+	this->_access = pAccess;
+	this->_file_size = std::max(_current_size, pOffset + _size);
+	this->_size = static_cast<size_t>(_size);
+	this->_is_open = true;
+
+	//mapping an empty range fails, an empty view is still a valid view
+	if (this->_size == 0)
+	{
+		::close(_fd);
+		return W_PASSED;
+	}
+
+	const auto _aligned_offset = pOffset - pOffset % get_page_size();
+	this->_delta = static_cast<size_t>(pOffset - _aligned_offset);
+	this->_view_size = this->_delta + this->_size;
+	auto _view = mmap(
+		nullptr,
+		this->_view_size,
+		_write ? PROT_READ | PROT_WRITE : PROT_READ,
+		MAP_SHARED,
+		_fd,
+		static_cast<off_t>(_aligned_offset));
+	//view keeps the file alive
+	::close(_fd);
+
+	if (_view == MAP_FAILED)
+	{
+		close();
+		logger.error("could not map file {}. trace info: w_mapped_file::open", pPath);
+		return W_FAILED;
+	}
+	this->_view = _view;
+
+	return W_PASSED;
+}
+
+W_RESULT w_mapped_file::openW(
+	_In_z_ const wchar_t* pPath,
+	_In_ const w_mapped_file_access& pAccess,
+	_In_ const uint64_t& pOffset,
+	_In_ const size_t& pSize)
+{
+	if (!pPath) return W_INVALIDARG;
+	return open(convert::wstring_to_string(pPath).c_str(), pAccess, pOffset, pSize);
+}
+
+W_RESULT w_mapped_file::advise(
+	_In_ const w_mapped_file_advice& pAdvice,
+	_In_ const size_t& pOffset,
+	_In_ const size_t& pSize)
+{
+	if (!this->_is_open || pOffset > this->_size) return W_INVALIDARG;
+	if (!this->_view) return W_PASSED;
+
+	int _advice;
+	switch (pAdvice)
+	{
+	default:
+	case w_mapped_file_advice::NORMAL:
+		_advice = MADV_NORMAL;
+		break;
+	case w_mapped_file_advice::SEQUENTIAL:
+		_advice = MADV_SEQUENTIAL;
+		break;
+	case w_mapped_file_advice::RANDOM:
+		_advice = MADV_RANDOM;
+		break;
+	case w_mapped_file_advice::WILL_NEED:
+		_advice = MADV_WILLNEED;
+		break;
+	case w_mapped_file_advice::DONT_NEED:
+		_advice = MADV_DONTNEED;
+		break;
+	}
+
+	//madvise needs a page aligned start
+	const auto _start = this->_delta + pOffset;
+	const auto _aligned_start = _start - _start % get_page_size();
+	const auto _size = pSize ? std::min(pSize, this->_size - pOffset) : this->_size - pOffset;
+	if (madvise(static_cast<char*>(this->_view) + _aligned_start, _size + (_start - _aligned_start), _advice) == -1)
+	{
+		logger.error("madvise failed. trace info: w_mapped_file::advise");
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
+
+W_RESULT w_mapped_file::flush(_In_ const bool& pAsync)
+{
+	if (!this->_is_open) return W_INVALIDARG;
+	if (!this->_view || this->_access == w_mapped_file_access::READ_ONLY) return W_PASSED;
+
+	if (msync(this->_view, this->_view_size, pAsync ? MS_ASYNC : MS_SYNC) == -1)
+	{
+		logger.error("msync failed. trace info: w_mapped_file::flush");
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
+
+void w_mapped_file::close()
+{
+	if (this->_view)
+	{
+		munmap(this->_view, this->_view_size);
+	}
+
+	this->_view = nullptr;
+	this->_view_size = 0;
+	this->_delta = 0;
+	this->_size = 0;
+	this->_file_size = 0;
+	this->_is_open = false;
+}
+
+size_t w_mapped_file::get_page_size()
+{
+	static const size_t _size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	return _size;
+}
+
+#endif
+
+#pragma region Getters
+
+const char* w_mapped_file::get_data() const
+{
+	return this->_view ? static_cast<const char*>(this->_view) + this->_delta : nullptr;
+}
+
+char* w_mapped_file::get_mutable_data()
+{
+	if (!this->_view || this->_access == w_mapped_file_access::READ_ONLY) return nullptr;
+	return static_cast<char*>(this->_view) + this->_delta;
+}
+
+size_t w_mapped_file::get_size() const
+{
+	return this->_size;
+}
+
+uint64_t w_mapped_file::get_file_size() const
+{
+	return this->_file_size;
+}
+
+bool w_mapped_file::get_is_open() const
+{
+	return this->_is_open;
+}
+
+w_mapped_file_access w_mapped_file::get_access() const
+{
+	return this->_access;
+}
+
+#pragma endregion
@@ -0,0 +1,110 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_mapped_file.h
+	Description		 : Memory mapped view of a file, loaders read assets straight from page cache without copying them
+	Comment          : Views always start on a page (allocation granularity on windows), an offset in the middle of a page
+					   maps from the start of that page and get_data points to the requested byte.
+					   Access hints are madvise on posix and PrefetchVirtualMemory on windows
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+
+namespace wolf::system
+{
+	enum class w_mapped_file_access
+	{
+		READ_ONLY,
+		//changes are written back to the file, which is created if it does not exist
+		READ_WRITE
+	};
+
+	enum class w_mapped_file_advice
+	{
+		NORMAL,
+		//pages are read ahead aggressively and dropped soon after they were read
+		SEQUENTIAL,
+		//no read ahead
+		RANDOM,
+		//start reading pages in background
+		WILL_NEED,
+		//pages are not needed for a while
+		DONT_NEED
+	};
+
+	class w_mapped_file
+	{
+	public:
+		WSYS_EXP w_mapped_file();
+		WSYS_EXP ~w_mapped_file();
+
+		WSYS_EXP w_mapped_file(w_mapped_file&& pOther) noexcept;
+		WSYS_EXP w_mapped_file& operator=(w_mapped_file&& pOther) noexcept;
+
+		/*
+			map pSize bytes of pPath from pOffset, pSize 0 means up to the end of file.
+			With READ_WRITE, a view which goes past the end of file grows the file
+		*/
+		WSYS_EXP W_RESULT open(
+			_In_z_ const char* pPath,
+			_In_ const w_mapped_file_access& pAccess = w_mapped_file_access::READ_ONLY,
+			_In_ const uint64_t& pOffset = 0,
+			_In_ const size_t& pSize = 0);
+
+		WSYS_EXP W_RESULT openW(
+			_In_z_ const wchar_t* pPath,
+			_In_ const w_mapped_file_access& pAccess = w_mapped_file_access::READ_ONLY,
+			_In_ const uint64_t& pOffset = 0,
+			_In_ const size_t& pSize = 0);
+
+		//hint for pSize bytes from pOffset of view, pSize 0 means up to the end of view
+		WSYS_EXP W_RESULT advise(
+			_In_ const w_mapped_file_advice& pAdvice,
+			_In_ const size_t& pOffset = 0,
+			_In_ const size_t& pSize = 0);
+
+		//write changes of a READ_WRITE view to the file, pAsync only schedules the write
+		WSYS_EXP W_RESULT flush(_In_ const bool& pAsync = false);
+
+		//unmap the view, it is called by destructor
+		WSYS_EXP void close();
+
+#pragma region Getters
+		//nullptr if file is not open or the view is empty
+		WSYS_EXP const char* get_data() const;
+		//nullptr for READ_ONLY views
+		WSYS_EXP char* get_mutable_data();
+		WSYS_EXP size_t get_size() const;
+		//size of whole file when it was opened
+		WSYS_EXP uint64_t get_file_size() const;
+		WSYS_EXP bool get_is_open() const;
+		WSYS_EXP w_mapped_file_access get_access() const;
+		//views start on multiples of this
+		WSYS_EXP static size_t get_page_size();
+#pragma endregion
+
+	private:
+		//Prevent copying
+		w_mapped_file(w_mapped_file const&);
+		w_mapped_file& operator= (w_mapped_file const&);
+
+		void _move(_Inout_ w_mapped_file& pOther);
+
+		//the view starts _delta bytes before data
+		void*                       _view;
+		size_t                      _view_size;
+		size_t                      _delta;
+		size_t                      _size;
+		uint64_t                    _file_size;
+		bool                        _is_open;
+		w_mapped_file_access        _access;
+#if defined(__WIN32) || defined(_MSC_VER)
+		//kept for flushing
+		HANDLE                      _file;
+#endif
+	};
+}
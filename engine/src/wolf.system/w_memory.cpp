@@ -1,13 +1,10 @@
 #include "w_system_pch.h"
-
-#ifdef __WIN32
-
 #include "w_memory.h"
 #include <memory>
 
 using namespace wolf::system;
 
-w_memory::w_memory() : _writeAddress(0), _isReleased(false)
+w_memory::w_memory() : _isReleased(true), _mem(nullptr), _linearAllocator(nullptr), _writeAddress(0)
 {
 
 }
@@ -20,27 +17,25 @@ w_memory::~w_memory()
 bool w_memory::Malloc(size_t pSize)
 {
 	//First free it, if we allocated before
-	if (this->_mem) free(this->_mem);
-	if (this->_linearAllocator)
-	{
-		this->_linearAllocator->clear();
-		delete this->_linearAllocator;
-	}
+	Free();
 
 	//Allocate memory
 	this->_mem = malloc(pSize);
 	if (!this->_mem) return false;
 	
-	this->_linearAllocator = new w_linear_allocator(pSize, this->_mem);
+	this->_linearAllocator = new (std::nothrow) w_linear_allocator(pSize, this->_mem);
 	if (!this->_linearAllocator) return false;
 
 	this->_writeAddress = 0;
+	this->_isReleased = false;
 
 	return true;
 }
 
 bool w_memory::Allocate(size_t pSize, uint8_t pAlignment)
 {
+	if (!this->_linearAllocator) return false;
+
 	auto _memory = this->_linearAllocator->allocate(pSize, pAlignment);
 	if (!_memory || this->_writeAddress >= MAX_PTR_ALLOCS)
 	{
@@ -83,13 +78,18 @@ void w_memory::Free()
 {
 	if (this->_isReleased) return;
 
-	if (this->_mem) free(this->_mem);
+	//allocator frees the chunks it chained, _mem is freed here
 	if (this->_linearAllocator)
 	{
 		this->_linearAllocator->clear();
 		delete this->_linearAllocator;
+		this->_linearAllocator = nullptr;
 	}
+	if (this->_mem)
+	{
+		free(this->_mem);
+		this->_mem = nullptr;
+	}
+	this->_writeAddress = 0;
 	this->_isReleased = true;
 }
-
-#endif
\ No newline at end of file
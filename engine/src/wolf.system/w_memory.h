@@ -9,8 +9,6 @@
 
 #pragma once
 
-#ifdef __WIN32
-
 #include "w_system_export.h"
 #include "w_linear_allocator.h"
 
@@ -51,5 +49,3 @@ namespace wolf::system
 		size_t				_writeAddress;
 	};
 }
-
-#endif // __WIN32
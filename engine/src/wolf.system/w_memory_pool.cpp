@@ -0,0 +1,422 @@
+#include "w_system_pch.h"
+#include "w_memory_pool.h"
+#include "w_memory_tracker.h"
+#include <unordered_map>
+#include <algorithm>
+
+using namespace wolf::system;
+
+//number of blocks which are moved between a thread cache and the shared list at once
+static const size_t s_batch_size = 64;
+
+struct w_fixed_memory_pool::w_thread_cache
+{
+	void*                   head = nullptr;
+	//written only by the owner thread, read by statistics
+	std::atomic<size_t>     count;
+
+	w_thread_cache() : count(0)
+	{
+	}
+};
+
+namespace wolf::system
+{
+	//pools which are alive, so exiting threads do not touch a released pool
+	static std::mutex& _get_pools_mutex()
+	{
+		static auto _mutex = new std::mutex();
+		return *_mutex;
+	}
+
+	static std::unordered_map<uint64_t, w_fixed_memory_pool*>& _get_pools()
+	{
+		static auto _pools = new std::unordered_map<uint64_t, w_fixed_memory_pool*>();
+		return *_pools;
+	}
+
+	struct w_thread_cache_list
+	{
+		std::vector<std::pair<uint64_t, w_fixed_memory_pool::w_thread_cache*>> caches;
+		//last found entry, most threads use one pool at a time
+		uint64_t                                last_id = 0;
+		w_fixed_memory_pool::w_thread_cache*    last_cache = nullptr;
+
+		~w_thread_cache_list()
+		{
+			std::lock_guard<std::mutex> _lock(_get_pools_mutex());
+			auto& _pools = _get_pools();
+			for (auto& _iter : this->caches)
+			{
+				auto _pool = _pools.find(_iter.first);
+				if (_pool != _pools.end())
+				{
+					_pool->second->_flush(_iter.second, _iter.second->count.load(std::memory_order_relaxed));
+				}
+			}
+		}
+
+		w_fixed_memory_pool::w_thread_cache* find(_In_ const uint64_t& pId)
+		{
+			if (this->last_id == pId) return this->last_cache;
+
+			for (auto& _iter : this->caches)
+			{
+				if (_iter.first == pId)
+				{
+					this->last_id = _iter.first;
+					this->last_cache = _iter.second;
+					return _iter.second;
+				}
+			}
+			return nullptr;
+		}
+
+		void add(_In_ const uint64_t& pId, _In_ w_fixed_memory_pool::w_thread_cache* pCache)
+		{
+			//drop entries of released pools, their caches were deleted by release and ids are never reused
+			{
+				std::lock_guard<std::mutex> _lock(_get_pools_mutex());
+				auto& _pools = _get_pools();
+				this->caches.erase(std::remove_if(this->caches.begin(), this->caches.end(),
+					[&_pools](_In_ const std::pair<uint64_t, w_fixed_memory_pool::w_thread_cache*>& pIter)
+					{
+						return _pools.find(pIter.first) == _pools.end();
+					}), this->caches.end());
+			}
+			this->caches.push_back(std::make_pair(pId, pCache));
+			this->last_id = pId;
+			this->last_cache = pCache;
+		}
+	};
+}
+
+static thread_local w_thread_cache_list s_thread_caches;
+static std::atomic<uint64_t> s_last_pool_id(0);
+
+static inline void* _allocate_slab(_In_ const size_t& pSize, _In_ const size_t& pAlignment)
+{
+#if defined(__WIN32) || defined(_MSC_VER)
+	return _aligned_malloc(pSize, pAlignment);
+#else
+	void* _ptr = nullptr;
+	return posix_memalign(&_ptr, std::max(pAlignment, sizeof(void*)), pSize) == 0 ? _ptr : nullptr;
+#endif
+}
+
+static inline void _free_slab(_In_ void* pSlab)
+{
+#if defined(__WIN32) || defined(_MSC_VER)
+	_aligned_free(pSlab);
+#else
+	::free(pSlab);
+#endif
+}
+
+w_fixed_memory_pool::w_fixed_memory_pool() :
+	_id(0),
+	_block_size(0),
+	_alignment(0),
+	_blocks_per_slab(0),
+	_tracked_slabs(0),
+	_shared_free_list(nullptr),
+	_shared_free_count(0),
+	_total_blocks(0),
+	_peak_used_blocks(0)
+{
+}
+
+w_fixed_memory_pool::~w_fixed_memory_pool()
+{
+	release();
+}
+
+W_RESULT w_fixed_memory_pool::initialize(
+	_In_ const size_t& pBlockSize,
+	_In_ const size_t& pAlignment,
+	_In_ const size_t& pBlocksPerSlab)
+{
+	if (!pBlockSize || !pBlocksPerSlab || !pAlignment || (pAlignment & (pAlignment - 1)) != 0)
+	{
+		logger.error("invalid block size or alignment. trace info: w_fixed_memory_pool::initialize");
+		return W_INVALIDARG;
+	}
+
+	release();
+
+	//each free block stores the pointer to next free block
+	this->_alignment = std::max(pAlignment, alignof(void*));
+	auto _size = std::max(pBlockSize, sizeof(void*));
+	this->_block_size = (_size + this->_alignment - 1) & ~(this->_alignment - 1);
+	this->_blocks_per_slab = pBlocksPerSlab;
+
+	std::lock_guard<std::mutex> _lock(_get_pools_mutex());
+	this->_id = ++s_last_pool_id;
+	_get_pools()[this->_id] = this;
+
+	return W_PASSED;
+}
+
+void* w_fixed_memory_pool::allocate()
+{
+	auto _cache = _get_thread_cache();
+	if (!_cache) return nullptr;
+
+	if (!_cache->head && !_refill(_cache)) return nullptr;
+
+	auto _block = _cache->head;
+	_cache->head = *static_cast<void**>(_block);
+	_cache->count.store(_cache->count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+	return _block;
+}
+
+void w_fixed_memory_pool::free(_In_ void* pBlock)
+{
+	if (!pBlock) return;
+
+	auto _cache = _get_thread_cache();
+	if (!_cache) return;
+
+	*static_cast<void**>(pBlock) = _cache->head;
+	_cache->head = pBlock;
+	const auto _count = _cache->count.load(std::memory_order_relaxed) + 1;
+	_cache->count.store(_count, std::memory_order_relaxed);
+
+	//keep a batch for the next allocations and return the rest
+	if (_count >= 2 * s_batch_size)
+	{
+		_flush(_cache, s_batch_size);
+	}
+}
+
+void w_fixed_memory_pool::flush_thread_cache()
+{
+	auto _cache = _get_thread_cache();
+	if (_cache)
+	{
+		_flush(_cache, _cache->count.load(std::memory_order_relaxed));
+	}
+}
+
+ULONG w_fixed_memory_pool::release()
+{
+	if (!this->_id) return 1;
+
+	{
+		std::lock_guard<std::mutex> _lock(_get_pools_mutex());
+		_get_pools().erase(this->_id);
+	}
+
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+	for (auto _slab : this->_slabs)
+	{
+		_free_slab(_slab);
+	}
+	this->_slabs.clear();
+
+	for (size_t i = 0; i < this->_tracked_slabs; ++i)
+	{
+		w_memory_tracker::record_free(MEMORY_TAG_POOL, this->_blocks_per_slab * this->_block_size);
+	}
+	this->_tracked_slabs = 0;
+
+	//entries of threads which point to these caches are never found again, since ids are not reused.
+	//they are dropped when those threads add a cache of another pool
+	for (auto _cache : this->_caches)
+	{
+		delete _cache;
+	}
+	this->_caches.clear();
+
+	this->_id = 0;
+	this->_shared_free_list = nullptr;
+	this->_shared_free_count = 0;
+	this->_total_blocks = 0;
+	this->_peak_used_blocks = 0;
+
+	return 0;
+}
+
+w_fixed_memory_pool::w_thread_cache* w_fixed_memory_pool::_get_thread_cache()
+{
+	if (!this->_id) return nullptr;
+
+	auto _cache = s_thread_caches.find(this->_id);
+	if (_cache) return _cache;
+
+	_cache = new (std::nothrow) w_thread_cache();
+	if (!_cache) return nullptr;
+
+	{
+		std::lock_guard<std::mutex> _lock(this->_mutex);
+		this->_caches.push_back(_cache);
+	}
+	s_thread_caches.add(this->_id, _cache);
+	return _cache;
+}
+
+bool w_fixed_memory_pool::_refill(_Inout_ w_thread_cache* pCache)
+{
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+
+	//the cache is empty, so this is a good time to sample the peak
+	size_t _free = this->_shared_free_count;
+	for (auto _cache : this->_caches)
+	{
+		_free += _cache->count.load(std::memory_order_relaxed);
+	}
+	if (this->_total_blocks > _free)
+	{
+		this->_peak_used_blocks = std::max(this->_peak_used_blocks, this->_total_blocks - _free);
+	}
+
+	if (!this->_shared_free_list)
+	{
+		const auto _slab_size = this->_block_size * this->_blocks_per_slab;
+		auto _slab = static_cast<uint8_t*>(_allocate_slab(_slab_size, this->_alignment));
+		if (!_slab)
+		{
+			logger.error("could not allocate slab of {} bytes. trace info: w_fixed_memory_pool::_refill", _slab_size);
+			return false;
+		}
+		this->_slabs.push_back(_slab);
+		if (w_memory_tracker::track_allocation(MEMORY_TAG_POOL, _slab_size))
+		{
+			this->_tracked_slabs++;
+		}
+
+		//link blocks of the new slab in order of their address
+		for (size_t i = 0; i < this->_blocks_per_slab; ++i)
+		{
+			auto _block = _slab + i * this->_block_size;
+			*reinterpret_cast<void**>(_block) = (i + 1 < this->_blocks_per_slab) ? _block + this->_block_size : nullptr;
+		}
+		this->_shared_free_list = _slab;
+		this->_shared_free_count = this->_blocks_per_slab;
+		this->_total_blocks += this->_blocks_per_slab;
+	}
+
+	//move a batch from the shared list to the cache
+	auto _first = this->_shared_free_list;
+	auto _last = _first;
+	size_t _count = 1;
+	while (_count < s_batch_size && *static_cast<void**>(_last))
+	{
+		_last = *static_cast<void**>(_last);
+		_count++;
+	}
+	this->_shared_free_list = *static_cast<void**>(_last);
+	this->_shared_free_count -= _count;
+
+	*static_cast<void**>(_last) = pCache->head;
+	pCache->head = _first;
+	pCache->count.store(pCache->count.load(std::memory_order_relaxed) + _count, std::memory_order_relaxed);
+
+	return true;
+}
+
+void w_fixed_memory_pool::_flush(_Inout_ w_thread_cache* pCache, _In_ const size_t& pCount)
+{
+	if (!pCount || !pCache->head) return;
+
+	//detach pCount blocks from the head of the cache
+	auto _first = pCache->head;
+	auto _last = _first;
+	size_t _count = 1;
+	while (_count < pCount && *static_cast<void**>(_last))
+	{
+		_last = *static_cast<void**>(_last);
+		_count++;
+	}
+	pCache->head = *static_cast<void**>(_last);
+	pCache->count.store(pCache->count.load(std::memory_order_relaxed) - _count, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+	*static_cast<void**>(_last) = this->_shared_free_list;
+	this->_shared_free_list = _first;
+	this->_shared_free_count += _count;
+}
+
+#pragma region Getters
+
+size_t w_fixed_memory_pool::get_block_size() const
+{
+	return this->_block_size;
+}
+
+size_t w_fixed_memory_pool::get_block_alignment() const
+{
+	return this->_alignment;
+}
+
+w_fixed_memory_pool_statistics w_fixed_memory_pool::get_statistics() const
+{
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+
+	w_fixed_memory_pool_statistics _statistics;
+	_statistics.block_size = this->_block_size;
+	_statistics.blocks_per_slab = this->_blocks_per_slab;
+	_statistics.slabs = this->_slabs.size();
+	_statistics.reserved_bytes = this->_slabs.size() * this->_blocks_per_slab * this->_block_size;
+	_statistics.shared_free_blocks = this->_shared_free_count;
+	for (auto _cache : this->_caches)
+	{
+		_statistics.cached_free_blocks += _cache->count.load(std::memory_order_relaxed);
+	}
+
+	//a cache may hold more blocks than it allocated (blocks freed from other threads) while another one is not updated yet
+	const auto _free = _statistics.shared_free_blocks + _statistics.cached_free_blocks;
+	_statistics.used_blocks = this->_total_blocks > _free ? this->_total_blocks - _free : 0;
+	_statistics.peak_used_blocks = std::max(this->_peak_used_blocks, _statistics.used_blocks);
+
+	return _statistics;
+}
+
+std::vector<w_fixed_memory_slab_statistics> w_fixed_memory_pool::get_slab_statistics() const
+{
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+
+	//sort slabs by address, so the slab of each free block is found with a binary search
+	std::vector<w_fixed_memory_slab_statistics> _slabs(this->_slabs.size());
+	for (size_t i = 0; i < this->_slabs.size(); ++i)
+	{
+		_slabs[i].address = this->_slabs[i];
+		_slabs[i].used_blocks = this->_blocks_per_slab;
+	}
+	std::sort(_slabs.begin(), _slabs.end(),
+		[](const w_fixed_memory_slab_statistics& pLeft, const w_fixed_memory_slab_statistics& pRight)
+	{
+		return pLeft.address < pRight.address;
+	});
+
+	const auto _slab_size = this->_block_size * this->_blocks_per_slab;
+	auto _count_free = [&](_In_ void* pHead)
+	{
+		for (auto _block = pHead; _block; _block = *static_cast<void**>(_block))
+		{
+			auto _iter = std::upper_bound(_slabs.begin(), _slabs.end(), _block,
+				[](const void* pBlock, const w_fixed_memory_slab_statistics& pSlab)
+			{
+				return pBlock < pSlab.address;
+			});
+			if (_iter == _slabs.begin()) continue;
+
+			--_iter;
+			if (static_cast<uint8_t*>(_block) < static_cast<uint8_t*>(_iter->address) + _slab_size)
+			{
+				_iter->free_blocks++;
+				_iter->used_blocks--;
+			}
+		}
+	};
+
+	_count_free(this->_shared_free_list);
+	for (auto _cache : this->_caches)
+	{
+		_count_free(_cache->head);
+	}
+
+	return _slabs;
+}
+
+#pragma endregion
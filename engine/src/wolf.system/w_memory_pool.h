@@ -2,9 +2,11 @@
 	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
 	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
 	Website			 : https://WolfEngine.App
-	Name			 : w_memory_pool based intel tbb fixed memory pool
+	Name			 : w_memory_pool.h
 	Description		 : Memory pool manager
-	Comment          :
+	Comment          : w_memory_pool manages a single aligned block of memory, large blocks come from w_large_allocator.
+					   w_fixed_memory_pool serves fixed size blocks from large aligned slabs through an intrusive free list,
+					   each thread keeps a small cache of free blocks and exchanges them with the shared list in batches
 */
 
 #pragma once
@@ -12,6 +14,13 @@
 #include "w_system_export.h"
 #include "w_std.h"
 #include <w_aligned_malloc.h>
+#include "w_large_allocator.h"
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <utility>
 
 #define __1KB__ 1024
 #define __1MB__ 1024 * __1KB__
@@ -36,29 +45,84 @@ namespace wolf::system
 		//Allocate block of memory (in bytes)
 		void* alloc(_In_ size_t pSizeInBytes, _In_ size_t pAlignment = 16)
 		{
+			release();
+
 			this->_size_in_bytes = pSizeInBytes;
 			this->_alignment = pAlignment;
 
+			//large blocks (e.g. decoded video frames) come from pages of OS, see w_large_allocator
+			this->_is_large = _is_large_block(pSizeInBytes, pAlignment);
+			if (this->_is_large)
+			{
+				this->_ptr = w_large_allocator::allocate(pSizeInBytes);
+			}
+			else
+			{
 #if defined(__WIN32) || defined(_MSC_VER) 
-			this->_ptr = _aligned_malloc(pSizeInBytes, pAlignment);
+				this->_ptr = _aligned_malloc(pSizeInBytes, pAlignment);
 #else
-			this->_ptr = aligned_malloc(pSizeInBytes, pAlignment);
+				this->_ptr = aligned_malloc(pSizeInBytes, pAlignment);
 #endif
+			}
+			this->_is_released = this->_ptr == nullptr;
 			return this->_ptr;
 		}
 
-		//Re-allocate block of memory (in bytes)
+		//Re-allocate block of memory (in bytes), contents are preserved up to the smaller size
 		void* re_alloc(_In_ size_t pSizeInBytes, _In_ size_t pAlignment = 16)
 		{
-			this->_size_in_bytes = pSizeInBytes;
-			this->_alignment = pAlignment;
+			if (!this->_ptr) return alloc(pSizeInBytes, pAlignment);
 
+			void* _ptr = nullptr;
+			auto _is_large = _is_large_block(pSizeInBytes, pAlignment);
+			if (_is_large || this->_is_large)
+			{
+				//the block of size class may already be big enough
+				if (_is_large && this->_is_large && pSizeInBytes <= w_large_allocator::get_block_size(this->_ptr))
+				{
+					_ptr = this->_ptr;
+				}
+				else
+				{
+					if (_is_large)
+					{
+						_ptr = w_large_allocator::allocate(pSizeInBytes);
+					}
+					else
+					{
+#if defined(__WIN32) || defined(_MSC_VER) 
+						_ptr = _aligned_malloc(pSizeInBytes, pAlignment);
+#else
+						_ptr = aligned_malloc(pSizeInBytes, pAlignment);
+#endif
+					}
+					if (_ptr)
+					{
+						std::memcpy(_ptr, this->_ptr, this->_size_in_bytes < pSizeInBytes ? this->_size_in_bytes : pSizeInBytes);
+						_free(this->_ptr, this->_is_large);
+					}
+				}
+			}
+			else
+			{
 #if defined(__WIN32) || defined(_MSC_VER) 
-			this->_ptr = _aligned_realloc(this->_ptr, pSizeInBytes, pAlignment);
+				_ptr = _aligned_realloc(this->_ptr, pSizeInBytes, pAlignment);
 #else
-			aligned_free(this->_ptr);
-			this->_ptr = aligned_malloc(pSizeInBytes, pAlignment);
+				_ptr = aligned_malloc(pSizeInBytes, pAlignment);
+				if (_ptr)
+				{
+					std::memcpy(_ptr, this->_ptr, this->_size_in_bytes < pSizeInBytes ? this->_size_in_bytes : pSizeInBytes);
+					aligned_free(this->_ptr);
+				}
 #endif
+			}
+			//on failure the old block is still valid
+			if (!_ptr) return nullptr;
+
+			this->_ptr = _ptr;
+			this->_is_large = _is_large;
+			this->_size_in_bytes = pSizeInBytes;
+			this->_alignment = pAlignment;
 			return this->_ptr;
 		}
 
@@ -67,16 +131,15 @@ namespace wolf::system
 		{
 			if (this->_is_released) return 1;
 
-#if defined(__WIN32) || defined(_MSC_VER) 
-			_aligned_free(this->_ptr);
-#else
-			aligned_free(this->_ptr);
-#endif
+			_free(this->_ptr, this->_is_large);
 			this->_ptr = nullptr;
+			this->_is_large = false;
 			this->_size_in_bytes = 0;
 			this->_alignment = 0;
 
 			this->_is_released = true;
+			this->write_index = 0;
+			this->read_index = 0;
 			return 0;
 		}
 
@@ -87,17 +150,18 @@ namespace wolf::system
 		}
 
 		//Get total size of memory in bytes
-		const size_t get_size_in_bytes() const
+		size_t get_size_in_bytes() const
 		{
 			return this->_size_in_bytes;
 		}
 
 		//Get alignment of memory
-		const size_t get_alignment() const
+		size_t get_alignment() const
 		{
 			return this->_alignment;
 		}
 
+		//offsets for using the block as a ring buffer (e.g. video frames of w_media_core)
 		size_t											write_index = 0;
 		size_t											read_index = 0;
 	private:
@@ -105,9 +169,142 @@ namespace wolf::system
 		w_memory_pool(w_memory_pool const&);
 		w_memory_pool& operator= (w_memory_pool const&);
 
+		static bool _is_large_block(_In_ const size_t& pSizeInBytes, _In_ const size_t& pAlignment)
+		{
+			//blocks of w_large_allocator are aligned to pages
+			return pSizeInBytes >= W_LARGE_ALLOCATION_SIZE && pAlignment <= 4096;
+		}
+
+		static void _free(_In_ void* pPtr, _In_ const bool& pIsLarge)
+		{
+			if (pIsLarge)
+			{
+				w_large_allocator::free(pPtr);
+				return;
+			}
+#if defined(__WIN32) || defined(_MSC_VER) 
+			_aligned_free(pPtr);
+#else
+			aligned_free(pPtr);
+#endif
+		}
+
 		void* _ptr = nullptr;
 		size_t                                          _size_in_bytes = 0;
 		size_t                                          _alignment = 0;
-		bool                                            _is_released = false;
+		bool                                            _is_released = true;
+		bool                                            _is_large = false;
+	};
+
+	struct w_fixed_memory_pool_statistics
+	{
+		size_t      block_size = 0;
+		size_t      blocks_per_slab = 0;
+		size_t      slabs = 0;
+		//total bytes of slabs
+		size_t      reserved_bytes = 0;
+		size_t      used_blocks = 0;
+		//sampled whenever a thread cache is refilled
+		size_t      peak_used_blocks = 0;
+		//free blocks in the shared list and in caches of threads
+		size_t      shared_free_blocks = 0;
+		size_t      cached_free_blocks = 0;
+	};
+
+	struct w_fixed_memory_slab_statistics
+	{
+		void*       address = nullptr;
+		size_t      used_blocks = 0;
+		size_t      free_blocks = 0;
+	};
+
+	/*
+		A pool of fixed size blocks, allocate and free are O(1) and do not lock as long as the cache of calling thread
+		has blocks or room. A block can be freed on any thread. Slabs are returned to OS only on release
+	*/
+	class w_fixed_memory_pool
+	{
+	public:
+		WSYS_EXP w_fixed_memory_pool();
+		WSYS_EXP ~w_fixed_memory_pool();
+
+		/*
+			pBlockSize is rounded up to a multiple of pAlignment, pAlignment must be a power of two.
+			Each slab has pBlocksPerSlab blocks
+		*/
+		WSYS_EXP W_RESULT initialize(
+			_In_ const size_t& pBlockSize,
+			_In_ const size_t& pAlignment = 16,
+			_In_ const size_t& pBlocksPerSlab = 4096);
+
+		//returns nullptr if pool was not initialized or out of memory
+		WSYS_EXP void* allocate();
+		//pBlock must be allocated from this pool
+		WSYS_EXP void free(_In_ void* pBlock);
+
+		//construct an object of type T on a block
+		template<typename T, typename... Args>
+		T* create(Args&&... pArgs)
+		{
+			static_assert(alignof(T) <= 4096, "alignment of type is too large");
+			if (sizeof(T) > this->_block_size || alignof(T) > this->_alignment) return nullptr;
+
+			auto _block = allocate();
+			return _block ? new (_block) T(std::forward<Args>(pArgs)...) : nullptr;
+		}
+
+		template<typename T>
+		void destroy(_In_ T* pObject)
+		{
+			if (!pObject) return;
+			pObject->~T();
+			free(pObject);
+		}
+
+		//return free blocks of the calling thread to the shared list, it is also done when the thread exits
+		WSYS_EXP void flush_thread_cache();
+
+		//free all slabs, all blocks become invalid. No other thread may use the pool during release
+		WSYS_EXP ULONG release();
+
+#pragma region Getters
+		WSYS_EXP size_t get_block_size() const;
+		WSYS_EXP size_t get_block_alignment() const;
+		WSYS_EXP w_fixed_memory_pool_statistics get_statistics() const;
+		//walks all free lists, call it only when no other thread uses the pool
+		WSYS_EXP std::vector<w_fixed_memory_slab_statistics> get_slab_statistics() const;
+#pragma endregion
+
+	private:
+		//prevent copying
+		w_fixed_memory_pool(w_fixed_memory_pool const&);
+		w_fixed_memory_pool& operator= (w_fixed_memory_pool const&);
+
+		struct w_thread_cache;
+		//caches of a thread, returns their blocks when the thread exits
+		friend struct w_thread_cache_list;
+
+		w_thread_cache* _get_thread_cache();
+		//move blocks from shared list or a new slab to pCache, returns false if out of memory
+		bool _refill(_Inout_ w_thread_cache* pCache);
+		//move pCount blocks of pCache to shared list
+		void _flush(_Inout_ w_thread_cache* pCache, _In_ const size_t& pCount);
+
+		//unique id of the pool which is used for finding the cache of threads
+		uint64_t                                        _id;
+		size_t                                          _block_size;
+		size_t                                          _alignment;
+		size_t                                          _blocks_per_slab;
+
+		mutable std::mutex                              _mutex;
+		std::vector<void*>                              _slabs;
+		//slabs which are recorded by w_memory_tracker
+		size_t                                          _tracked_slabs;
+		std::vector<w_thread_cache*>                    _caches;
+		void*                                           _shared_free_list;
+		size_t                                          _shared_free_count;
+		//blocks which were carved from slabs
+		size_t                                          _total_blocks;
+		size_t                                          _peak_used_blocks;
 	};
 }
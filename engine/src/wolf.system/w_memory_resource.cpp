@@ -0,0 +1,202 @@
+#include "w_system_pch.h"
+#include "w_memory_resource.h"
+
+#ifdef W_HAS_PMR
+
+#include "w_linear_allocator.h"
+#include "w_frame_allocator.h"
+#include "w_memory_pool.h"
+
+using namespace wolf::system;
+
+//w_allocator takes alignment as uint8_t
+static const size_t s_max_alignment = 128;
+
+#pragma region w_linear_memory_resource
+
+w_linear_memory_resource::w_linear_memory_resource(_In_ w_linear_allocator& pAllocator) :
+	_allocator(pAllocator)
+{
+}
+
+void* w_linear_memory_resource::do_allocate(size_t pBytes, size_t pAlignment)
+{
+	if (pAlignment > s_max_alignment) throw std::bad_alloc();
+
+	auto _ptr = this->_allocator.allocate(pBytes ? pBytes : 1, static_cast<uint8_t>(pAlignment));
+	if (!_ptr) throw std::bad_alloc();
+	return _ptr;
+}
+
+void w_linear_memory_resource::do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment)
+{
+	//released with clear or rollback of the allocator
+	(void)pPointer;
+	(void)pBytes;
+	(void)pAlignment;
+}
+
+bool w_linear_memory_resource::do_is_equal(const std::pmr::memory_resource& pOther) const noexcept
+{
+	return this == &pOther;
+}
+
+w_linear_allocator& w_linear_memory_resource::get_allocator() const
+{
+	return this->_allocator;
+}
+
+#pragma endregion
+
+#pragma region w_frame_memory_resource
+
+w_frame_memory_resource::w_frame_memory_resource(_In_ w_frame_allocator& pAllocator) :
+	_allocator(pAllocator)
+{
+}
+
+void* w_frame_memory_resource::do_allocate(size_t pBytes, size_t pAlignment)
+{
+	if (pAlignment > s_max_alignment) throw std::bad_alloc();
+
+	auto _ptr = this->_allocator.allocate(pBytes ? pBytes : 1, static_cast<uint8_t>(pAlignment));
+	if (!_ptr) throw std::bad_alloc();
+	return _ptr;
+}
+
+void w_frame_memory_resource::do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment)
+{
+	//released when the frame begins again
+	(void)pPointer;
+	(void)pBytes;
+	(void)pAlignment;
+}
+
+bool w_frame_memory_resource::do_is_equal(const std::pmr::memory_resource& pOther) const noexcept
+{
+	return this == &pOther;
+}
+
+#pragma endregion
+
+#pragma region w_pool_memory_resource
+
+w_pool_memory_resource::w_pool_memory_resource(
+	_In_ w_fixed_memory_pool& pPool,
+	_In_opt_ std::pmr::memory_resource* pUpstream) :
+	_pool(pPool),
+	_upstream(pUpstream ? pUpstream : std::pmr::new_delete_resource())
+{
+}
+
+void* w_pool_memory_resource::do_allocate(size_t pBytes, size_t pAlignment)
+{
+	if (!_fits(pBytes, pAlignment))
+	{
+		return this->_upstream->allocate(pBytes, pAlignment);
+	}
+
+	auto _ptr = this->_pool.allocate();
+	if (!_ptr) throw std::bad_alloc();
+	return _ptr;
+}
+
+void w_pool_memory_resource::do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment)
+{
+	//pmr passes the same size and alignment as allocate, so the owner is known without a lookup
+	if (!_fits(pBytes, pAlignment))
+	{
+		this->_upstream->deallocate(pPointer, pBytes, pAlignment);
+		return;
+	}
+	this->_pool.free(pPointer);
+}
+
+bool w_pool_memory_resource::do_is_equal(const std::pmr::memory_resource& pOther) const noexcept
+{
+	return this == &pOther;
+}
+
+bool w_pool_memory_resource::_fits(size_t pBytes, size_t pAlignment) const
+{
+	return pBytes <= this->_pool.get_block_size() && pAlignment <= this->_pool.get_block_alignment();
+}
+
+#pragma endregion
+
+#pragma region w_tracked_memory_resource
+
+w_tracked_memory_resource::w_tracked_memory_resource(
+	_In_ const w_memory_tag& pTag,
+	_In_opt_ std::pmr::memory_resource* pUpstream) :
+	_tag(pTag),
+	_upstream(pUpstream ? pUpstream : std::pmr::new_delete_resource())
+{
+}
+
+void* w_tracked_memory_resource::do_allocate(size_t pBytes, size_t pAlignment)
+{
+	auto _ptr = this->_upstream->allocate(pBytes, pAlignment);
+	w_memory_tracker::record_allocation(this->_tag, pBytes);
+	return _ptr;
+}
+
+void w_tracked_memory_resource::do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment)
+{
+	this->_upstream->deallocate(pPointer, pBytes, pAlignment);
+	w_memory_tracker::record_free(this->_tag, pBytes);
+}
+
+bool w_tracked_memory_resource::do_is_equal(const std::pmr::memory_resource& pOther) const noexcept
+{
+	return this == &pOther;
+}
+
+#pragma endregion
+
+#pragma region w_large_memory_resource
+
+w_large_memory_resource::w_large_memory_resource(
+	_In_ const size_t& pMinSizeInBytes,
+	_In_opt_ std::pmr::memory_resource* pUpstream) :
+	_min_size_in_bytes(pMinSizeInBytes),
+	_upstream(pUpstream ? pUpstream : std::pmr::new_delete_resource())
+{
+}
+
+void* w_large_memory_resource::do_allocate(size_t pBytes, size_t pAlignment)
+{
+	if (!_is_large(pBytes, pAlignment))
+	{
+		return this->_upstream->allocate(pBytes, pAlignment);
+	}
+
+	auto _ptr = w_large_allocator::allocate(pBytes);
+	if (!_ptr) throw std::bad_alloc();
+	return _ptr;
+}
+
+void w_large_memory_resource::do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment)
+{
+	if (!_is_large(pBytes, pAlignment))
+	{
+		this->_upstream->deallocate(pPointer, pBytes, pAlignment);
+		return;
+	}
+	w_large_allocator::free(pPointer);
+}
+
+bool w_large_memory_resource::do_is_equal(const std::pmr::memory_resource& pOther) const noexcept
+{
+	return this == &pOther;
+}
+
+bool w_large_memory_resource::_is_large(size_t pBytes, size_t pAlignment) const
+{
+	//blocks are aligned to at least 4KB pages
+	return pBytes && pBytes >= this->_min_size_in_bytes && pAlignment <= 4096;
+}
+
+#pragma endregion
+
+#endif
@@ -0,0 +1,132 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_memory_resource.h
+	Description		 : std::pmr::memory_resource adapters for wolf allocators
+	Comment          : Available when std::pmr is (C++17), W_HAS_PMR is defined in that case.
+					   Containers which use w_linear_memory_resource never free, the whole arena is released with clear or rollback
+*/
+
+#pragma once
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && ((defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || __cplusplus >= 201703L)
+#define W_HAS_PMR
+#endif
+#endif
+
+#ifdef W_HAS_PMR
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include "w_memory_tracker.h"
+#include "w_large_allocator.h"
+#include <memory_resource>
+
+namespace wolf::system
+{
+	class w_linear_allocator;
+	class w_frame_allocator;
+	class w_fixed_memory_pool;
+
+	//allocates from a w_linear_allocator or w_stack_allocator, deallocation does nothing
+	class w_linear_memory_resource : public std::pmr::memory_resource
+	{
+	public:
+		WSYS_EXP w_linear_memory_resource(_In_ w_linear_allocator& pAllocator);
+
+#pragma region Getters
+		WSYS_EXP w_linear_allocator& get_allocator() const;
+#pragma endregion
+
+	protected:
+		WSYS_EXP void* do_allocate(size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP void do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP bool do_is_equal(const std::pmr::memory_resource& pOther) const noexcept override;
+
+	private:
+		w_linear_allocator&     _allocator;
+	};
+
+	//allocates from the arena of the current frame, containers must not outlive the frames in flight
+	class w_frame_memory_resource : public std::pmr::memory_resource
+	{
+	public:
+		WSYS_EXP w_frame_memory_resource(_In_ w_frame_allocator& pAllocator);
+
+	protected:
+		WSYS_EXP void* do_allocate(size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP void do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP bool do_is_equal(const std::pmr::memory_resource& pOther) const noexcept override;
+
+	private:
+		w_frame_allocator&      _allocator;
+	};
+
+	/*
+		allocations which fit in a block of the pool (e.g. nodes of std::pmr::map or std::pmr::list) come from the pool,
+		larger ones come from pUpstream
+	*/
+	class w_pool_memory_resource : public std::pmr::memory_resource
+	{
+	public:
+		WSYS_EXP w_pool_memory_resource(
+			_In_ w_fixed_memory_pool& pPool,
+			_In_opt_ std::pmr::memory_resource* pUpstream = std::pmr::get_default_resource());
+
+	protected:
+		WSYS_EXP void* do_allocate(size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP void do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP bool do_is_equal(const std::pmr::memory_resource& pOther) const noexcept override;
+
+	private:
+		bool _fits(size_t pBytes, size_t pAlignment) const;
+
+		w_fixed_memory_pool&            _pool;
+		std::pmr::memory_resource*      _upstream;
+	};
+
+	//records each allocation of pUpstream in w_memory_tracker with pTag, even if tracking is disabled
+	class w_tracked_memory_resource : public std::pmr::memory_resource
+	{
+	public:
+		WSYS_EXP w_tracked_memory_resource(
+			_In_ const w_memory_tag& pTag,
+			_In_opt_ std::pmr::memory_resource* pUpstream = std::pmr::get_default_resource());
+
+	protected:
+		WSYS_EXP void* do_allocate(size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP void do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP bool do_is_equal(const std::pmr::memory_resource& pOther) const noexcept override;
+
+	private:
+		w_memory_tag                    _tag;
+		std::pmr::memory_resource*      _upstream;
+	};
+
+	/*
+		allocations of pMinSizeInBytes or more (e.g. vertex arrays of w_cpipeline_scene) come from w_large_allocator,
+		smaller ones come from pUpstream
+	*/
+	class w_large_memory_resource : public std::pmr::memory_resource
+	{
+	public:
+		WSYS_EXP w_large_memory_resource(
+			_In_ const size_t& pMinSizeInBytes = W_LARGE_ALLOCATION_SIZE,
+			_In_opt_ std::pmr::memory_resource* pUpstream = std::pmr::get_default_resource());
+
+	protected:
+		WSYS_EXP void* do_allocate(size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP void do_deallocate(void* pPointer, size_t pBytes, size_t pAlignment) override;
+		WSYS_EXP bool do_is_equal(const std::pmr::memory_resource& pOther) const noexcept override;
+
+	private:
+		bool _is_large(size_t pBytes, size_t pAlignment) const;
+
+		size_t                          _min_size_in_bytes;
+		std::pmr::memory_resource*      _upstream;
+	};
+}
+
+#endif
@@ -0,0 +1,401 @@
+#include "w_system_pch.h"
+#include "w_memory_tracker.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+using namespace wolf::system;
+
+//pending bytes of a thread are added to the shared live bytes when they pass this, which updates the peak
+static const int64_t s_flush_bytes = 64 * 1024;
+
+static const char* s_tag_names[MEMORY_TAG_COUNT] =
+{
+	"unknown",
+	"aligned_malloc",
+	"allocator",
+	"pool",
+	"buffer",
+	"texture",
+	"mesh",
+	"user_0",
+	"user_1",
+	"user_2",
+	"user_3",
+	"large"
+};
+
+namespace
+{
+	//written only by the owner thread without read-modify-write, read by snapshots
+	struct w_memory_counters
+	{
+		std::atomic<int64_t>    live_bytes[MEMORY_TAG_COUNT];
+		std::atomic<int64_t>    live_allocations[MEMORY_TAG_COUNT];
+		std::atomic<uint64_t>   allocations[MEMORY_TAG_COUNT];
+		std::atomic<uint64_t>   frees[MEMORY_TAG_COUNT];
+		std::atomic<uint64_t>   allocated_bytes[MEMORY_TAG_COUNT];
+		std::atomic<uint64_t>   size_histogram[MEMORY_TAG_COUNT][W_MEMORY_SIZE_CLASSES];
+		//bytes which are not added to the shared live bytes yet
+		int64_t                 pending_bytes[MEMORY_TAG_COUNT];
+
+		w_memory_counters()
+		{
+			for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+			{
+				this->live_bytes[i].store(0, std::memory_order_relaxed);
+				this->live_allocations[i].store(0, std::memory_order_relaxed);
+				this->allocations[i].store(0, std::memory_order_relaxed);
+				this->frees[i].store(0, std::memory_order_relaxed);
+				this->allocated_bytes[i].store(0, std::memory_order_relaxed);
+				for (size_t j = 0; j < W_MEMORY_SIZE_CLASSES; ++j)
+				{
+					this->size_histogram[i][j].store(0, std::memory_order_relaxed);
+				}
+				this->pending_bytes[i] = 0;
+			}
+		}
+	};
+
+	struct w_memory_registry
+	{
+		std::mutex                              mutex;
+		std::vector<w_memory_counters*>         threads;
+		//counters of threads which exited
+		w_memory_counters                       retired;
+		std::atomic<int64_t>                    live_bytes[MEMORY_TAG_COUNT];
+		std::atomic<int64_t>                    peak_bytes[MEMORY_TAG_COUNT];
+		bool                                    started = false;
+		std::chrono::steady_clock::time_point   start_time;
+
+		w_memory_registry()
+		{
+			for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+			{
+				this->live_bytes[i].store(0, std::memory_order_relaxed);
+				this->peak_bytes[i].store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+}
+
+static std::atomic<bool> s_enabled(false);
+static thread_local bool s_thread_exited = false;
+//trivial thread local, so the fast path does not check the initialization of w_memory_thread_counters
+static thread_local w_memory_counters* s_thread_counters = nullptr;
+
+//never destroyed, threads may exit after static destructors
+static w_memory_registry& _get_registry()
+{
+	static auto _registry = new w_memory_registry();
+	return *_registry;
+}
+
+template<typename T>
+static inline void _add(_Inout_ std::atomic<T>& pCounter, _In_ const T& pValue)
+{
+	pCounter.store(pCounter.load(std::memory_order_relaxed) + pValue, std::memory_order_relaxed);
+}
+
+static inline size_t _size_class(_In_ uint64_t pBytes)
+{
+	//floor of log2 with a binary search over the bits
+	size_t _class = 0;
+	for (size_t _shift = 32; _shift; _shift >>= 1)
+	{
+		if (pBytes >> _shift)
+		{
+			pBytes >>= _shift;
+			_class += _shift;
+		}
+	}
+	return std::min(_class, W_MEMORY_SIZE_CLASSES - 1);
+}
+
+static void _flush_pending(_Inout_ w_memory_counters& pCounters, _In_ const size_t& pTag)
+{
+	auto& _registry = _get_registry();
+	const auto _pending = pCounters.pending_bytes[pTag];
+	pCounters.pending_bytes[pTag] = 0;
+
+	const auto _live = _registry.live_bytes[pTag].fetch_add(_pending, std::memory_order_relaxed) + _pending;
+	auto _peak = _registry.peak_bytes[pTag].load(std::memory_order_relaxed);
+	while (_live > _peak && !_registry.peak_bytes[pTag].compare_exchange_weak(_peak, _live, std::memory_order_relaxed))
+	{
+	}
+}
+
+static void _merge(_Inout_ w_memory_counters& pTo, _In_ const w_memory_counters& pFrom)
+{
+	for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+	{
+		_add(pTo.live_bytes[i], pFrom.live_bytes[i].load(std::memory_order_relaxed));
+		_add(pTo.live_allocations[i], pFrom.live_allocations[i].load(std::memory_order_relaxed));
+		_add(pTo.allocations[i], pFrom.allocations[i].load(std::memory_order_relaxed));
+		_add(pTo.frees[i], pFrom.frees[i].load(std::memory_order_relaxed));
+		_add(pTo.allocated_bytes[i], pFrom.allocated_bytes[i].load(std::memory_order_relaxed));
+		for (size_t j = 0; j < W_MEMORY_SIZE_CLASSES; ++j)
+		{
+			_add(pTo.size_histogram[i][j], pFrom.size_histogram[i][j].load(std::memory_order_relaxed));
+		}
+	}
+}
+
+namespace
+{
+	//registers counters of a thread, and moves them to the retired counters when the thread exits
+	struct w_memory_thread_counters
+	{
+		w_memory_counters*  counters;
+
+		w_memory_thread_counters() : counters(new w_memory_counters())
+		{
+			auto& _registry = _get_registry();
+			std::lock_guard<std::mutex> _lock(_registry.mutex);
+			_registry.threads.push_back(this->counters);
+		}
+
+		~w_memory_thread_counters()
+		{
+			auto& _registry = _get_registry();
+			{
+				std::lock_guard<std::mutex> _lock(_registry.mutex);
+				for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+				{
+					_flush_pending(*this->counters, i);
+				}
+				_merge(_registry.retired, *this->counters);
+				_registry.threads.erase(std::find(_registry.threads.begin(), _registry.threads.end(), this->counters));
+			}
+			delete this->counters;
+			s_thread_counters = nullptr;
+			s_thread_exited = true;
+		}
+	};
+}
+
+static w_memory_counters* _get_thread_counters()
+{
+	if (s_thread_counters) return s_thread_counters;
+
+	//destructors of other thread locals may free memory after the counters of this thread are retired
+	if (s_thread_exited) return nullptr;
+
+	static thread_local w_memory_thread_counters _thread;
+	s_thread_counters = _thread.counters;
+	return s_thread_counters;
+}
+
+static void _record(_Inout_ w_memory_counters& pCounters, _In_ const size_t& pTag, _In_ const size_t& pBytes, _In_ const bool& pAllocation)
+{
+	const auto _bytes = static_cast<int64_t>(pBytes);
+	if (pAllocation)
+	{
+		_add<int64_t>(pCounters.live_bytes[pTag], _bytes);
+		_add<int64_t>(pCounters.live_allocations[pTag], 1);
+		_add<uint64_t>(pCounters.allocations[pTag], 1);
+		_add<uint64_t>(pCounters.allocated_bytes[pTag], pBytes);
+		_add<uint64_t>(pCounters.size_histogram[pTag][_size_class(pBytes)], 1);
+		pCounters.pending_bytes[pTag] += _bytes;
+	}
+	else
+	{
+		_add<int64_t>(pCounters.live_bytes[pTag], -_bytes);
+		_add<int64_t>(pCounters.live_allocations[pTag], -1);
+		_add<uint64_t>(pCounters.frees[pTag], 1);
+		pCounters.pending_bytes[pTag] -= _bytes;
+	}
+
+	if (pCounters.pending_bytes[pTag] >= s_flush_bytes || pCounters.pending_bytes[pTag] <= -s_flush_bytes)
+	{
+		_flush_pending(pCounters, pTag);
+	}
+}
+
+static void _record(_In_ const w_memory_tag& pTag, _In_ const size_t& pBytes, _In_ const bool& pAllocation)
+{
+	const auto _tag = static_cast<size_t>(pTag) < MEMORY_TAG_COUNT ? static_cast<size_t>(pTag) : static_cast<size_t>(MEMORY_TAG_UNKNOWN);
+
+	auto _counters = _get_thread_counters();
+	if (_counters)
+	{
+		_record(*_counters, _tag, pBytes, pAllocation);
+		return;
+	}
+
+	auto& _registry = _get_registry();
+	std::lock_guard<std::mutex> _lock(_registry.mutex);
+	_record(_registry.retired, _tag, pBytes, pAllocation);
+	_flush_pending(_registry.retired, _tag);
+}
+
+void w_memory_tracker::enable(_In_ const bool& pEnable)
+{
+	if (pEnable)
+	{
+		auto& _registry = _get_registry();
+		std::lock_guard<std::mutex> _lock(_registry.mutex);
+		if (!_registry.started)
+		{
+			_registry.started = true;
+			_registry.start_time = std::chrono::steady_clock::now();
+		}
+	}
+	s_enabled.store(pEnable, std::memory_order_relaxed);
+}
+
+bool w_memory_tracker::track_allocation(_In_ const w_memory_tag& pTag, _In_ const size_t& pBytes)
+{
+	if (!s_enabled.load(std::memory_order_relaxed)) return false;
+
+	_record(pTag, pBytes, true);
+	return true;
+}
+
+void w_memory_tracker::record_allocation(_In_ const w_memory_tag& pTag, _In_ const size_t& pBytes)
+{
+	_record(pTag, pBytes, true);
+}
+
+void w_memory_tracker::record_free(_In_ const w_memory_tag& pTag, _In_ const size_t& pBytes)
+{
+	_record(pTag, pBytes, false);
+}
+
+w_memory_snapshot w_memory_tracker::get_snapshot()
+{
+	auto& _registry = _get_registry();
+
+	w_memory_snapshot _snapshot;
+	_snapshot.time = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> _lock(_registry.mutex);
+	if (_registry.started)
+	{
+		_snapshot.seconds = std::chrono::duration<double>(_snapshot.time - _registry.start_time).count();
+	}
+
+	auto _sum = [&](_In_ const w_memory_counters& pCounters)
+	{
+		for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+		{
+			auto& _tag = _snapshot.tags[i];
+			_tag.live_bytes += pCounters.live_bytes[i].load(std::memory_order_relaxed);
+			_tag.live_allocations += pCounters.live_allocations[i].load(std::memory_order_relaxed);
+			_tag.allocations += pCounters.allocations[i].load(std::memory_order_relaxed);
+			_tag.frees += pCounters.frees[i].load(std::memory_order_relaxed);
+			_tag.allocated_bytes += pCounters.allocated_bytes[i].load(std::memory_order_relaxed);
+			for (size_t j = 0; j < W_MEMORY_SIZE_CLASSES; ++j)
+			{
+				_tag.size_histogram[j] += pCounters.size_histogram[i][j].load(std::memory_order_relaxed);
+			}
+		}
+	};
+
+	_sum(_registry.retired);
+	for (auto _counters : _registry.threads)
+	{
+		_sum(*_counters);
+	}
+
+	//the sum is exact, so it also raises the peak
+	for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+	{
+		auto& _tag = _snapshot.tags[i];
+		auto _peak = _registry.peak_bytes[i].load(std::memory_order_relaxed);
+		while (_tag.live_bytes > _peak && !_registry.peak_bytes[i].compare_exchange_weak(_peak, _tag.live_bytes, std::memory_order_relaxed))
+		{
+		}
+		_tag.peak_bytes = std::max(_peak, _tag.live_bytes);
+	}
+
+	return _snapshot;
+}
+
+w_memory_snapshot w_memory_tracker::diff(_In_ const w_memory_snapshot& pOlder, _In_ const w_memory_snapshot& pNewer)
+{
+	w_memory_snapshot _diff;
+	_diff.time = pNewer.time;
+	_diff.seconds = std::chrono::duration<double>(pNewer.time - pOlder.time).count();
+
+	for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+	{
+		const auto& _older = pOlder.tags[i];
+		const auto& _newer = pNewer.tags[i];
+		auto& _tag = _diff.tags[i];
+
+		_tag.live_bytes = _newer.live_bytes - _older.live_bytes;
+		_tag.live_allocations = _newer.live_allocations - _older.live_allocations;
+		_tag.peak_bytes = _newer.peak_bytes;
+		_tag.allocations = _newer.allocations - _older.allocations;
+		_tag.frees = _newer.frees - _older.frees;
+		_tag.allocated_bytes = _newer.allocated_bytes - _older.allocated_bytes;
+		for (size_t j = 0; j < W_MEMORY_SIZE_CLASSES; ++j)
+		{
+			_tag.size_histogram[j] = _newer.size_histogram[j] - _older.size_histogram[j];
+		}
+	}
+
+	return _diff;
+}
+
+int64_t w_memory_tracker::report_leaks()
+{
+	const auto _snapshot = get_snapshot();
+
+	int64_t _leaks = 0;
+	for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+	{
+		const auto& _tag = _snapshot.tags[i];
+		if (!_tag.live_allocations && !_tag.live_bytes) continue;
+
+		_leaks += _tag.live_allocations;
+		logger.warning("{} bytes in {} allocations of {} are not freed. trace info: w_memory_tracker::report_leaks",
+			_tag.live_bytes,
+			_tag.live_allocations,
+			s_tag_names[i]);
+	}
+
+	return _leaks;
+}
+
+#pragma region Getters
+
+bool w_memory_tracker::get_is_enabled()
+{
+	return s_enabled.load(std::memory_order_relaxed);
+}
+
+const char* w_memory_tracker::get_tag_name(_In_ const w_memory_tag& pTag)
+{
+	return static_cast<size_t>(pTag) < MEMORY_TAG_COUNT ? s_tag_names[pTag] : s_tag_names[MEMORY_TAG_UNKNOWN];
+}
+
+#pragma endregion
+
+#pragma region w_memory_snapshot
+
+int64_t w_memory_snapshot::get_live_bytes() const
+{
+	int64_t _bytes = 0;
+	for (auto& _tag : this->tags)
+	{
+		_bytes += _tag.live_bytes;
+	}
+	return _bytes;
+}
+
+double w_memory_snapshot::get_allocations_per_second(_In_ const w_memory_tag& pTag) const
+{
+	if (this->seconds <= 0.0 || static_cast<size_t>(pTag) >= MEMORY_TAG_COUNT) return 0.0;
+	return static_cast<double>(this->tags[pTag].allocations) / this->seconds;
+}
+
+double w_memory_snapshot::get_bytes_per_second(_In_ const w_memory_tag& pTag) const
+{
+	if (this->seconds <= 0.0 || static_cast<size_t>(pTag) >= MEMORY_TAG_COUNT) return 0.0;
+	return static_cast<double>(this->tags[pTag].allocated_bytes) / this->seconds;
+}
+
+#pragma endregion
@@ -0,0 +1,95 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_memory_tracker.h
+	Description		 : Opt-in tracking of memory for each subsystem
+	Comment          : Disabled by default, call w_memory_tracker::enable(true) at startup.
+					   Each thread writes its own counters without locks, snapshots sum the counters of all threads.
+					   Peak bytes are updated when the pending bytes of a thread pass 64KB, so they are exact within 64KB for each thread
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include <array>
+#include <chrono>
+
+namespace wolf::system
+{
+	enum w_memory_tag
+	{
+		MEMORY_TAG_UNKNOWN = 0,
+		//aligned_malloc and aligned_free
+		MEMORY_TAG_ALIGNED_MALLOC,
+		//chunks of w_linear_allocator, w_stack_allocator and w_frame_allocator
+		MEMORY_TAG_ALLOCATOR,
+		//slabs of w_fixed_memory_pool
+		MEMORY_TAG_POOL,
+		//device memory of w_buffer
+		MEMORY_TAG_BUFFER,
+		//device memory of w_texture
+		MEMORY_TAG_TEXTURE,
+		//vertices and indices of w_cpipeline_mesh
+		MEMORY_TAG_MESH,
+		//free for game and server code
+		MEMORY_TAG_USER_0,
+		MEMORY_TAG_USER_1,
+		MEMORY_TAG_USER_2,
+		MEMORY_TAG_USER_3,
+		//blocks of w_large_allocator
+		MEMORY_TAG_LARGE,
+		MEMORY_TAG_COUNT
+	};
+
+	//size class i counts allocations in [2^i, 2^(i + 1)) bytes, the last one counts larger allocations too
+	static const size_t W_MEMORY_SIZE_CLASSES = 32;
+
+	struct w_memory_tag_statistics
+	{
+		int64_t                                         live_bytes = 0;
+		int64_t                                         live_allocations = 0;
+		int64_t                                         peak_bytes = 0;
+		uint64_t                                        allocations = 0;
+		uint64_t                                        frees = 0;
+		uint64_t                                        allocated_bytes = 0;
+		std::array<uint64_t, W_MEMORY_SIZE_CLASSES>     size_histogram = {};
+	};
+
+	struct w_memory_snapshot
+	{
+		std::chrono::steady_clock::time_point                   time;
+		//seconds since tracking was enabled, or between two snapshots for a diff
+		double                                                  seconds = 0.0;
+		std::array<w_memory_tag_statistics, MEMORY_TAG_COUNT>   tags;
+
+		WSYS_EXP int64_t get_live_bytes() const;
+		WSYS_EXP double get_allocations_per_second(_In_ const w_memory_tag& pTag) const;
+		WSYS_EXP double get_bytes_per_second(_In_ const w_memory_tag& pTag) const;
+	};
+
+	class w_memory_tracker
+	{
+	public:
+		WSYS_EXP static void enable(_In_ const bool& pEnable);
+
+		//record an allocation if tracking is enabled. returns false if it was not recorded, so its free must not be recorded
+		WSYS_EXP static bool track_allocation(_In_ const w_memory_tag& pTag, _In_ const size_t& pBytes);
+		//record an allocation even if tracking is disabled
+		WSYS_EXP static void record_allocation(_In_ const w_memory_tag& pTag, _In_ const size_t& pBytes);
+		WSYS_EXP static void record_free(_In_ const w_memory_tag& pTag, _In_ const size_t& pBytes);
+
+		//sum of counters of all threads
+		WSYS_EXP static w_memory_snapshot get_snapshot();
+		//what happened between two snapshots, peak bytes are taken from the newer one
+		WSYS_EXP static w_memory_snapshot diff(_In_ const w_memory_snapshot& pOlder, _In_ const w_memory_snapshot& pNewer);
+		//log live allocations of each tag, returns the number of live allocations
+		WSYS_EXP static int64_t report_leaks();
+
+#pragma region Getters
+		WSYS_EXP static bool get_is_enabled();
+		WSYS_EXP static const char* get_tag_name(_In_ const w_memory_tag& pTag);
+#pragma endregion
+	};
+}
@@ -0,0 +1,158 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_parallel.h
+	Description		 : parallel_for and parallel_reduce on top of w_thread_pool
+	Comment          : Participants grab chunks from a shared counter, chunks shrink as the range drains (guided scheduling)
+					   but never become smaller than the grain size. The caller only waits for chunks which are running,
+					   never for queued helpers, so nested calls from inside jobs can not deadlock
+*/
+
+#pragma once
+
+#include "w_thread_pool.h"
+#include "w_task.h"
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+
+namespace wolf::system
+{
+	namespace parallel_internal
+	{
+		template<typename F>
+		struct w_parallel_state
+		{
+			w_parallel_state(_In_ const size_t& pBegin, _In_ const size_t& pEnd, _In_ const size_t& pGrainSize, _In_ const size_t& pParticipants, _In_ F* pFunc) :
+				next(pBegin),
+				end(pEnd),
+				grain_size(pGrainSize),
+				participants(pParticipants),
+				in_flight(0),
+				func(pFunc)
+			{
+			}
+
+			//claim and run chunks until the range is drained
+			void run()
+			{
+				this->in_flight.fetch_add(1);
+				while (true)
+				{
+					auto _next = this->next.load(std::memory_order_relaxed);
+					if (_next >= this->end) break;
+
+					auto _chunk = std::max(this->grain_size, (this->end - _next) / (2 * this->participants));
+					auto _begin = this->next.fetch_add(_chunk);
+					if (_begin >= this->end) break;
+
+					(*this->func)(_begin, std::min(_begin + _chunk, this->end));
+				}
+				this->in_flight.fetch_sub(1);
+			}
+
+			std::atomic<size_t>     next;
+			const size_t            end;
+			const size_t            grain_size;
+			const size_t            participants;
+			std::atomic<size_t>     in_flight;
+			F*                      func;
+		};
+
+		//run pFunc(begin, end) over chunks of [pBegin, pEnd) on the pool and the calling thread
+		template<typename F>
+		void run_chunks(_In_ w_thread_pool& pThreadPool, _In_ const size_t& pBegin, _In_ const size_t& pEnd, _In_ size_t pGrainSize, _In_ F& pFunc)
+		{
+			if (pEnd <= pBegin) return;
+
+			const auto _size = pEnd - pBegin;
+			const auto _pool_size = pThreadPool.get_pool_size();
+			if (pGrainSize == 0)
+			{
+				pGrainSize = std::max<size_t>(1, _size / (8 * std::max<size_t>(1, _pool_size)));
+			}
+
+			//tiny ranges run inline
+			const auto _chunks = (_size + pGrainSize - 1) / pGrainSize;
+			if (_chunks <= 1 || _pool_size == 0)
+			{
+				pFunc(pBegin, pEnd);
+				return;
+			}
+
+			const auto _helpers = std::min(_pool_size, _chunks - 1);
+			auto _state = std::make_shared<w_parallel_state<F>>(pBegin, pEnd, pGrainSize, _helpers + 1, &pFunc);
+			for (size_t i = 0; i < _helpers; ++i)
+			{
+				pThreadPool.add_job([_state]()
+					{
+						_state->run();
+					});
+			}
+			_state->run();
+
+			//wait for chunks which are still running on other threads
+			while (_state->in_flight.load() > 0)
+			{
+				if (!pThreadPool.execute_one_job())
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+	}
+
+	//call pFunc(i) for each i in [pBegin, pEnd), pGrainSize is the minimum number of iterations of a chunk, zero means automatic
+	template<typename F>
+	void parallel_for(_In_ w_thread_pool& pThreadPool, _In_ const size_t& pBegin, _In_ const size_t& pEnd, _In_ const size_t& pGrainSize, _In_ const F& pFunc)
+	{
+		auto _body = [&pFunc](size_t pChunkBegin, size_t pChunkEnd)
+		{
+			for (auto i = pChunkBegin; i < pChunkEnd; ++i)
+			{
+				pFunc(i);
+			}
+		};
+		parallel_internal::run_chunks(pThreadPool, pBegin, pEnd, pGrainSize, _body);
+	}
+
+	//call pFunc(i) for each i in [pBegin, pEnd) on the shared thread pool
+	template<typename F>
+	void parallel_for(_In_ const size_t& pBegin, _In_ const size_t& pEnd, _In_ const size_t& pGrainSize, _In_ const F& pFunc)
+	{
+		parallel_for(w_task::get_shared_thread_pool(), pBegin, pEnd, pGrainSize, pFunc);
+	}
+
+	/*
+		reduce [pBegin, pEnd) into a single value
+		pFunc(chunk_begin, chunk_end, value) returns value accumulated over the chunk
+		pReduce(a, b) combines two values, it must be associative and pIdentity must not change the result.
+		Order of combination is not deterministic
+	*/
+	template<typename T, typename F, typename R>
+	T parallel_reduce(_In_ w_thread_pool& pThreadPool, _In_ const size_t& pBegin, _In_ const size_t& pEnd, _In_ const size_t& pGrainSize,
+		_In_ const T& pIdentity, _In_ const F& pFunc, _In_ const R& pReduce)
+	{
+		T _result = pIdentity;
+		std::mutex _mutex;
+
+		auto _body = [&](size_t pChunkBegin, size_t pChunkEnd)
+		{
+			auto _partial = pFunc(pChunkBegin, pChunkEnd, pIdentity);
+			std::lock_guard<std::mutex> _lock(_mutex);
+			_result = pReduce(_result, _partial);
+		};
+		parallel_internal::run_chunks(pThreadPool, pBegin, pEnd, pGrainSize, _body);
+
+		return _result;
+	}
+
+	//reduce [pBegin, pEnd) into a single value on the shared thread pool
+	template<typename T, typename F, typename R>
+	T parallel_reduce(_In_ const size_t& pBegin, _In_ const size_t& pEnd, _In_ const size_t& pGrainSize,
+		_In_ const T& pIdentity, _In_ const F& pFunc, _In_ const R& pReduce)
+	{
+		return parallel_reduce(w_task::get_shared_thread_pool(), pBegin, pEnd, pGrainSize, pIdentity, pFunc, pReduce);
+	}
+}
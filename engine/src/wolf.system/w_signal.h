@@ -2,9 +2,12 @@
 	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
 	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
 	Website			 : https://WolfEngine.App
-	Name			 : w_event.h
+	Name			 : w_signal.h
 	Description		 : A class for signal and slot
-	Comment          :
+	Comment          : Slots are stored in an immutable list which is replaced on connect/disconnect (copy on write),
+					   so rise does not allocate or wait for writers and slots can be connected or disconnected from any thread,
+					   even from inside a slot. The snapshot is taken with std::atomic_load, which is a short spin lock
+					   in libstdc++ and msvc. Slots which were disconnected during a rise may still be called by that rise
 */
 
 #pragma once
@@ -12,71 +15,416 @@
 #include <vector>
 #include <functional>
 #include <utility>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+#include "w_std.h"
 
 namespace wolf::system
 {
+	//handle of a connected slot, zero is invalid
+	typedef uint64_t w_signal_connection;
+
+	template<typename sig, size_t SIZE = 48>
+	class w_inplace_function;
+
+	//type erased callable, callables up to SIZE bytes are stored inside the object without heap allocation
+	template<typename R, typename... Args, size_t SIZE>
+	class w_inplace_function<R(Args...), SIZE>
+	{
+	public:
+		w_inplace_function() :
+			_ops(nullptr)
+		{
+		}
+
+		template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, w_inplace_function>::value>::type>
+		w_inplace_function(F&& pFunc) :
+			_ops(nullptr)
+		{
+			typedef typename std::decay<F>::type _func_type;
+			if constexpr (_is_inline<_func_type>())
+			{
+				new (this->_storage) _func_type(std::forward<F>(pFunc));
+				this->_ops = _get_ops<_func_type, true>();
+			}
+			else
+			{
+				*reinterpret_cast<_func_type**>(this->_storage) = new _func_type(std::forward<F>(pFunc));
+				this->_ops = _get_ops<_func_type, false>();
+			}
+		}
+
+		w_inplace_function(const w_inplace_function& pOther) :
+			_ops(pOther._ops)
+		{
+			if (this->_ops)
+			{
+				this->_ops->copy(this->_storage, pOther._storage);
+			}
+		}
+
+		w_inplace_function(w_inplace_function&& pOther) :
+			_ops(pOther._ops)
+		{
+			if (this->_ops)
+			{
+				this->_ops->move(this->_storage, pOther._storage);
+				pOther._ops = nullptr;
+			}
+		}
+
+		~w_inplace_function()
+		{
+			_reset();
+		}
+
+		w_inplace_function& operator = (const w_inplace_function& pOther)
+		{
+			if (this != &pOther)
+			{
+				_reset();
+				if (pOther._ops)
+				{
+					pOther._ops->copy(this->_storage, pOther._storage);
+					this->_ops = pOther._ops;
+				}
+			}
+			return *this;
+		}
+
+		w_inplace_function& operator = (w_inplace_function&& pOther)
+		{
+			if (this != &pOther)
+			{
+				_reset();
+				if (pOther._ops)
+				{
+					pOther._ops->move(this->_storage, pOther._storage);
+					this->_ops = pOther._ops;
+					pOther._ops = nullptr;
+				}
+			}
+			return *this;
+		}
+
+		R operator()(Args... pArgs) const
+		{
+			return this->_ops->invoke(const_cast<unsigned char*>(this->_storage), std::forward<Args>(pArgs)...);
+		}
+
+		explicit operator bool() const
+		{
+			return this->_ops != nullptr;
+		}
+
+#pragma region Getters
+		//returns false if callable was too big and allocated on heap
+		bool get_is_inline() const
+		{
+			return !this->_ops || this->_ops->is_inline;
+		}
+#pragma endregion
+
+	private:
+		struct w_ops
+		{
+			R(*invoke)(void*, Args&&...);
+			void(*copy)(void*, const void*);
+			void(*move)(void*, void*);
+			void(*destroy)(void*);
+			bool is_inline;
+		};
+
+		static constexpr size_t _storage_size = SIZE < sizeof(void*) ? sizeof(void*) : SIZE;
+
+		template<typename F>
+		static constexpr bool _is_inline()
+		{
+			return sizeof(F) <= _storage_size && alignof(F) <= alignof(std::max_align_t);
+		}
+
+		template<typename F, bool INLINE>
+		static const w_ops* _get_ops()
+		{
+			static const w_ops _ops =
+			{
+				[](void* pStorage, Args&&... pArgs) -> R
+				{
+					return (*_get<F, INLINE>(pStorage))(std::forward<Args>(pArgs)...);
+				},
+				[](void* pDestination, const void* pSource)
+				{
+					if constexpr (INLINE)
+					{
+						new (pDestination) F(*static_cast<const F*>(pSource));
+					}
+					else
+					{
+						*static_cast<F**>(pDestination) = new F(**static_cast<F* const*>(pSource));
+					}
+				},
+				[](void* pDestination, void* pSource)
+				{
+					if constexpr (INLINE)
+					{
+						new (pDestination) F(std::move(*static_cast<F*>(pSource)));
+						static_cast<F*>(pSource)->~F();
+					}
+					else
+					{
+						*static_cast<F**>(pDestination) = *static_cast<F**>(pSource);
+					}
+				},
+				[](void* pStorage)
+				{
+					if constexpr (INLINE)
+					{
+						static_cast<F*>(pStorage)->~F();
+					}
+					else
+					{
+						delete *static_cast<F**>(pStorage);
+					}
+				},
+				INLINE
+			};
+			return &_ops;
+		}
+
+		template<typename F, bool INLINE>
+		static F* _get(void* pStorage)
+		{
+			if constexpr (INLINE)
+			{
+				return static_cast<F*>(pStorage);
+			}
+			else
+			{
+				return *static_cast<F**>(pStorage);
+			}
+		}
+
+		void _reset()
+		{
+			if (this->_ops)
+			{
+				this->_ops->destroy(this->_storage);
+				this->_ops = nullptr;
+			}
+		}
+
+		alignas(std::max_align_t) unsigned char     _storage[_storage_size];
+		const w_ops*                                _ops;
+	};
+
+	//collects queued emissions of signals, the owner thread runs them in a batch with dispatch
+	class w_signal_mailbox
+	{
+	public:
+		typedef w_inplace_function<void(), 64> w_message;
+
+		w_signal_mailbox()
+		{
+		}
+
+		void post(_In_ w_message&& pMessage)
+		{
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+			this->_messages.push_back(std::move(pMessage));
+		}
+
+		//run all posted messages on the calling thread, only the owner thread should call it
+		size_t dispatch()
+		{
+			{
+				std::lock_guard<std::mutex> _lock(this->_mutex);
+				if (this->_messages.empty()) return 0;
+				std::swap(this->_messages, this->_dispatching);
+			}
+
+			//both buffers keep their capacity, so dispatching does not allocate after warm up
+			const auto _size = this->_dispatching.size();
+			for (auto& _message : this->_dispatching)
+			{
+				_message();
+			}
+			this->_dispatching.clear();
+			return _size;
+		}
+
+#pragma region Getters
+		size_t get_pending_count() const
+		{
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+			return this->_messages.size();
+		}
+#pragma endregion
+
+	private:
+		//prevent copying
+		w_signal_mailbox(w_signal_mailbox const&);
+		w_signal_mailbox& operator= (w_signal_mailbox const&);
+
+		mutable std::mutex              _mutex;
+		std::vector<w_message>          _messages;
+		std::vector<w_message>          _dispatching;
+	};
+
 	template<typename sig>
 	class w_signal;
 
 	template<typename T, typename... Args>
 	class w_signal<T(Args...)>
 	{
-		typedef std::function<T(Args...)>   w_slot;
-
 	public:
-		void operator()(Args... pArgs)
+		typedef w_inplace_function<T(Args...)>  w_slot;
+
+		w_signal() :
+			_slots(std::make_shared<w_slot_list>()),
+			_last_connection(0)
+		{
+		}
+
+		w_signal(const w_signal& pOther) :
+			_slots(std::atomic_load(&pOther._slots)),
+			_last_connection(pOther._last_connection.load())
+		{
+		}
+
+		w_signal& operator = (const w_signal& pOther)
+		{
+			if (this != &pOther)
+			{
+				std::lock_guard<std::mutex> _lock(this->_mutex);
+				std::atomic_store(&this->_slots, std::atomic_load(&pOther._slots));
+				this->_last_connection.store(pOther._last_connection.load());
+			}
+			return *this;
+		}
+
+		void operator()(Args... pArgs) const
 		{
-			rise(std::forward<Args>(pArgs)...);
+			rise(pArgs...);
 		}
 
+		//call all slots on the calling thread, queued slots post to their mailbox
 		void rise(Args... pArgs) const
 		{
-		        if (this->_slots.empty())
-			        return;
-			for (auto i = this->_slots.begin(); i != this->_slots.end(); ++i)
+			auto _slots = std::atomic_load(&this->_slots);
+			for (auto& _slot : *_slots)
 			{
-				(*i)(std::forward<Args>(pArgs)...);
+				_slot.second(pArgs...);
 			}
 		}
 
+		//connect a slot and return its handle
+		w_signal_connection connect(_In_ const w_slot& pSlot)
+		{
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+
+			auto _connection = ++this->_last_connection;
+			auto _slots = std::make_shared<w_slot_list>(*this->_slots);
+			_slots->push_back(std::make_pair(_connection, pSlot));
+			std::atomic_store(&this->_slots, std::shared_ptr<const w_slot_list>(_slots));
+
+			return _connection;
+		}
+
+		/*
+			connect a slot which runs when pMailbox is dispatched. Arguments are copied into the mailbox,
+			so pointers must remain valid until then. Disconnect before pMailbox is destroyed.
+			The slot has not run when rise returns, so rise gets a default constructed T from it
+		*/
+		w_signal_connection connect_queued(_In_ w_signal_mailbox& pMailbox, _In_ const w_slot& pSlot)
+		{
+			static_assert(std::is_void<T>::value || std::is_default_constructible<T>::value,
+				"queued slots need a void or default constructible return type");
+
+			auto _mailbox = &pMailbox;
+			auto _slot = std::make_shared<w_slot>(pSlot);
+			return connect([_mailbox, _slot](Args... pArgs) -> T
+			{
+				_mailbox->post([_slot, pArgs...]() mutable
+				{
+					(*_slot)(pArgs...);
+				});
+				return T();
+			});
+		}
+
+		//returns false if connection was not found
+		bool disconnect(_In_ const w_signal_connection& pConnection)
+		{
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+
+			auto& _current = *this->_slots;
+			for (size_t i = 0; i < _current.size(); ++i)
+			{
+				if (_current[i].first == pConnection)
+				{
+					auto _slots = std::make_shared<w_slot_list>(_current);
+					_slots->erase(_slots->begin() + i);
+					std::atomic_store(&this->_slots, std::shared_ptr<const w_slot_list>(_slots));
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//remove slot at pIndex in order of connection
 		void remove(const size_t pIndex)
 		{
-			this->_slots.erase(pIndex);
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+
+			if (pIndex >= this->_slots->size()) return;
+
+			auto _slots = std::make_shared<w_slot_list>(*this->_slots);
+			_slots->erase(_slots->begin() + pIndex);
+			std::atomic_store(&this->_slots, std::shared_ptr<const w_slot_list>(_slots));
 		}
 
 		void remove_all()
 		{
-			this->_slots.clear();
+			std::lock_guard<std::mutex> _lock(this->_mutex);
+			std::atomic_store(&this->_slots, std::shared_ptr<const w_slot_list>(std::make_shared<w_slot_list>()));
 		}
 
-		w_signal& operator = (w_slot pSlot)
+		w_signal& operator = (const w_slot& pSlot)
 		{
-			this->_slots.clear();
-			this->_slots.push_back(pSlot);
+			remove_all();
+			connect(pSlot);
 			return *this;
 		}
 
-		w_signal& operator += (w_slot pSlot)
+		w_signal& operator += (const w_slot& pSlot)
 		{
-			this->_slots.push_back(pSlot);
+			connect(pSlot);
 			return *this;
 		}
 
-		w_signal& operator -= (w_slot pSlot)
+		w_signal& operator -= (const w_signal_connection& pConnection)
 		{
-			for (auto i = this->_slots.begin(); i != this->_slots.end(); ++i)
-			{
-				if (*i == pSlot)
-				{
-					this->_slots.erase(i);
-					break;
-				}
-			}
+			disconnect(pConnection);
 			return *this;
 		}
 
+#pragma region Getters
+		size_t get_slots_count() const
+		{
+			return std::atomic_load(&this->_slots)->size();
+		}
+#pragma endregion
+
 	private:
-		std::vector<w_slot>     _slots;
+		typedef std::vector<std::pair<w_signal_connection, w_slot>> w_slot_list;
+
+		//writers are serialized by _mutex, readers only take a snapshot
+		std::mutex                                  _mutex;
+		std::shared_ptr<const w_slot_list>          _slots;
+		std::atomic<w_signal_connection>            _last_connection;
 	};
 }
-
@@ -0,0 +1,38 @@
+#include "w_system_pch.h"
+#include "w_stack_allocator.h"
+
+using namespace wolf::system;
+
+w_stack_allocator::w_stack_allocator(size_t pSize, void* pStart) : w_linear_allocator(pSize, pStart)
+{
+}
+
+w_stack_allocator::w_stack_allocator(size_t pChunkSize) : w_linear_allocator(pChunkSize)
+{
+}
+
+w_stack_allocator::w_marker w_stack_allocator::get_marker() const
+{
+	w_marker _marker;
+	_marker.chunk_index = this->_chunk_index;
+	_marker.position = this->_current_pos;
+	_marker.used_memory = this->_used_memory;
+	_marker.num_allocations = this->_num_allocations;
+	return _marker;
+}
+
+void w_stack_allocator::rollback(_In_ const w_marker& pMarker)
+{
+	assert(pMarker.chunk_index <= this->_chunk_index && pMarker.used_memory <= this->_used_memory);
+
+	//chunks after the marker are kept as spare chunks
+	this->_chunk_index = pMarker.chunk_index;
+	this->_current_pos = pMarker.position;
+	if (this->_chunk_index < this->_chunks.size())
+	{
+		auto& _chunk = this->_chunks[this->_chunk_index];
+		this->_current_end = _chunk.start + _chunk.size;
+	}
+	this->_used_memory = pMarker.used_memory;
+	this->_num_allocations = pMarker.num_allocations;
+}
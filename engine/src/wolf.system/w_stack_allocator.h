@@ -0,0 +1,64 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_stack_allocator.h
+	Description		 : A linear allocator which can roll back to a marker
+	Comment          : Use w_stack_scope for temporary allocations of a scope
+*/
+
+#pragma once
+
+#include "w_linear_allocator.h"
+
+namespace wolf::system
+{
+	class w_stack_allocator : public w_linear_allocator
+	{
+	public:
+		//position of the stack, everything which is allocated after it is freed by rollback
+		struct w_marker
+		{
+			size_t      chunk_index = 0;
+			uint8_t*    position = nullptr;
+			size_t      used_memory = 0;
+			size_t      num_allocations = 0;
+		};
+
+		WSYS_EXP w_stack_allocator(size_t pSize, void* pStart);
+		WSYS_EXP explicit w_stack_allocator(size_t pChunkSize);
+
+		WSYS_EXP w_marker get_marker() const;
+		//pMarker must be taken from this allocator after the last clear and not rolled back already
+		WSYS_EXP void rollback(_In_ const w_marker& pMarker);
+	};
+
+	//roll back the stack allocator to its position at the beginning of the scope
+	class w_stack_scope
+	{
+	public:
+		w_stack_scope(_In_ w_stack_allocator& pAllocator) :
+			_allocator(pAllocator),
+			_marker(pAllocator.get_marker())
+		{
+		}
+
+		~w_stack_scope()
+		{
+			this->_allocator.rollback(this->_marker);
+		}
+
+		void* allocate(size_t pSize, uint8_t pAlignment = 4)
+		{
+			return this->_allocator.allocate(pSize, pAlignment);
+		}
+
+	private:
+		//prevent copying
+		w_stack_scope(w_stack_scope const&);
+		w_stack_scope& operator= (w_stack_scope const&);
+
+		w_stack_allocator&              _allocator;
+		w_stack_allocator::w_marker     _marker;
+	};
+}
@@ -1,54 +1,223 @@
 #include "w_system_pch.h"
 #include "w_task.h"
+#include "w_thread_pool.h"
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+namespace wolf::system
+{
+	struct w_task_state
+	{
+		w_task_state(_In_ const w_task_status& pStatus) :
+			status(pStatus),
+			result(W_FAILED)
+		{
+		}
+
+		bool is_done() const
+		{
+			auto _status = this->status.load();
+			return _status == w_task_status::W_TASK_COMPLETED || _status == w_task_status::W_TASK_CANCELLED;
+		}
+
+		//move status from pFrom to pTo, returns false if status was changed by another thread
+		bool exchange_status(_In_ w_task_status pFrom, _In_ const w_task_status& pTo)
+		{
+			return this->status.compare_exchange_strong(pFrom, pTo);
+		}
+
+		std::mutex                                      mutex;
+		std::condition_variable                         cv;
+		std::atomic<w_task_status>                      status;
+		W_RESULT                                        result;
+		std::function<W_RESULT(void)>                   work;
+		std::function<void(W_RESULT)>                   call_back;
+		std::vector<std::shared_ptr<w_task_state>>      continuations;
+	};
+}
 
 using namespace wolf::system;
 
-std::future<W_RESULT> w_task::_deferred;
+thread_local w_task_handle w_task::_deferred;
 
-void w_task::execute_async(
-	_In_ const std::function<W_RESULT(void)>& pTaskWork, 
-    _In_ const std::function<void(W_RESULT)>& pCallBack)
+/*
+	a worker of the shared pool which blocks on a task may leave no worker for running it, so workers
+	execute jobs of the pool until the task is done or pDeadline passes. Returns false if the calling thread
+	is not a worker and has to block
+*/
+static bool s_help_until_done(
+	_In_ const std::shared_ptr<w_task_state>& pState,
+	_In_ const std::chrono::steady_clock::time_point& pDeadline)
 {
-
 #if defined(__WIN32) || defined(__UWP)
+	//async tasks run on ppl
+	(void)pState;
+	(void)pDeadline;
+	return false;
+#else
+	//only async tasks wait here and they created the pool already
+	auto& _pool = w_task::get_shared_thread_pool();
+	if (_pool.get_current_worker_index() < 0) return false;
+
+	while (!pState->is_done())
+	{
+		if (std::chrono::steady_clock::now() >= pDeadline) break;
+		if (_pool.execute_one_job()) continue;
+
+		std::unique_lock<std::mutex> _lock(pState->mutex);
+		pState->cv.wait_for(_lock, std::chrono::milliseconds(1), [&pState]()
+			{
+				return pState->is_done();
+			});
+	}
+	return true;
+#endif
+}
 
-	concurrency::create_task(pTaskWork).then([pCallBack](W_RESULT pHR)
+#pragma region w_task_handle
+
+w_task_handle::w_task_handle()
+{
+}
+
+void w_task_handle::wait() const
+{
+	if (!this->_state) return;
+
+	//deferred task will be executed on the calling thread
+	if (this->_state->status.load() == w_task_status::W_TASK_DEFERRED)
 	{
-		if (pCallBack)
+		w_task::_run(this->_state);
+	}
+	if (this->_state->is_done()) return;
+	if (s_help_until_done(this->_state, std::chrono::steady_clock::time_point::max())) return;
+
+	std::unique_lock<std::mutex> _lock(this->_state->mutex);
+	this->_state->cv.wait(_lock, [this]()
 		{
-			pCallBack(pHR);
-		}
-	});
+			return this->_state->is_done();
+		});
+}
 
-#else
+std::future_status w_task_handle::wait_for(_In_ const long long pMilliSeconds) const
+{
+	if (!this->_state) return std::future_status::ready;
+	if (this->_state->status.load() == w_task_status::W_TASK_DEFERRED) return std::future_status::deferred;
+	if (this->_state->is_done()) return std::future_status::ready;
 
-	std::async(std::launch::async, [pTaskWork, pCallBack]()
+	const auto _deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(pMilliSeconds);
+	if (s_help_until_done(this->_state, _deadline))
 	{
-		auto _hr = pTaskWork();
-		if (pCallBack)
+		return this->_state->is_done() ? std::future_status::ready : std::future_status::timeout;
+	}
+
+	std::unique_lock<std::mutex> _lock(this->_state->mutex);
+	auto _done = this->_state->cv.wait_for(_lock, std::chrono::milliseconds(pMilliSeconds), [this]()
 		{
-			pCallBack(_hr);
+			return this->_state->is_done();
+		});
+	return _done ? std::future_status::ready : std::future_status::timeout;
+}
+
+W_RESULT w_task_handle::get() const
+{
+	if (!this->_state) return W_FAILED;
+
+	wait();
+	return this->_state->result;
+}
+
+bool w_task_handle::cancel() const
+{
+	if (!this->_state) return false;
+
+	if (this->_state->exchange_status(w_task_status::W_TASK_PENDING, w_task_status::W_TASK_CANCELLED) ||
+		this->_state->exchange_status(w_task_status::W_TASK_DEFERRED, w_task_status::W_TASK_CANCELLED))
+	{
+		w_task::_finish(this->_state, w_task_status::W_TASK_CANCELLED, W_FAILED);
+		return true;
+	}
+	return false;
+}
+
+w_task_handle w_task_handle::then(_In_ const std::function<W_RESULT(W_RESULT)>& pContinuation) const
+{
+	w_task_handle _handle;
+	if (!this->_state || !pContinuation) return _handle;
+
+	auto _parent = this->_state;
+	_handle._state = std::make_shared<w_task_state>(w_task_status::W_TASK_PENDING);
+	_handle._state->work = [_parent, pContinuation]()
+	{
+		return pContinuation(_parent->result);
+	};
+
+	{
+		std::lock_guard<std::mutex> _lock(_parent->mutex);
+		if (!_parent->is_done())
+		{
+			_parent->continuations.push_back(_handle._state);
+			return _handle;
 		}
-		return _hr;
-	});
+	}
 
-#endif
+	//parent was already done
+	if (_parent->status.load() == w_task_status::W_TASK_COMPLETED)
+	{
+		w_task::_schedule(_handle._state);
+	}
+	else
+	{
+		_handle.cancel();
+	}
+	return _handle;
 }
 
-void w_task::execute_deferred(_In_ const std::function<W_RESULT(void)>& pTaskWork)
+w_task_status w_task_handle::get_status() const
 {
-	_deferred = std::async(std::launch::deferred, pTaskWork);
+	if (!this->_state) return w_task_status::W_TASK_CANCELLED;
+	return this->_state->status.load();
 }
 
-template<typename _REP, typename _PER>
-std::future_status w_task::wait_for(_In_ const std::chrono::duration<_REP, _PER>& pTime)
+bool w_task_handle::get_is_valid() const
 {
-	return _deferred.wait_for(pTime);
+	return this->_state != nullptr;
+}
+
+#pragma endregion
+
+#pragma region w_task
+
+w_task_handle w_task::execute_async(
+	_In_ const std::function<W_RESULT(void)>& pTaskWork,
+    _In_ const std::function<void(W_RESULT)>& pCallBack)
+{
+	w_task_handle _handle;
+	_handle._state = std::make_shared<w_task_state>(w_task_status::W_TASK_PENDING);
+	_handle._state->work = pTaskWork;
+	_handle._state->call_back = pCallBack;
+
+	_schedule(_handle._state);
+
+	return _handle;
+}
+
+w_task_handle w_task::execute_deferred(_In_ const std::function<W_RESULT(void)>& pTaskWork)
+{
+	w_task_handle _handle;
+	_handle._state = std::make_shared<w_task_state>(w_task_status::W_TASK_DEFERRED);
+	_handle._state->work = pTaskWork;
+
+	_deferred = _handle;
+
+	return _handle;
 }
 
 std::future_status w_task::wait_for(_In_ const long long pMilliSeconds)
 {
-	return _deferred.wait_for(std::chrono::milliseconds(pMilliSeconds));
+	return _deferred.wait_for(pMilliSeconds);
 }
 
 void w_task::wait()
@@ -59,4 +228,100 @@ void w_task::wait()
 void w_task::get()
 {
 	_deferred.get();
-}
\ No newline at end of file
+}
+
+w_thread_pool& w_task::get_shared_thread_pool()
+{
+	static w_thread_pool _pool;
+	static std::once_flag _once;
+	std::call_once(_once, []()
+		{
+			auto _size = w_thread::get_number_of_hardware_thread_contexts();
+			_pool.allocate(_size ? _size : 1, w_thread_pool_mode::W_WORK_STEALING);
+		});
+	return _pool;
+}
+
+void w_task::_schedule(_In_ const std::shared_ptr<w_task_state>& pState)
+{
+#if defined(__WIN32) || defined(__UWP)
+
+	concurrency::create_task([pState]()
+	{
+		_run(pState);
+	});
+
+#else
+
+	get_shared_thread_pool().add_job([pState]()
+	{
+		_run(pState);
+	});
+
+#endif
+}
+
+void w_task::_run(_In_ const std::shared_ptr<w_task_state>& pState)
+{
+	//the task might be cancelled or executed by another thread
+	if (!pState->exchange_status(w_task_status::W_TASK_PENDING, w_task_status::W_TASK_RUNNING) &&
+		!pState->exchange_status(w_task_status::W_TASK_DEFERRED, w_task_status::W_TASK_RUNNING))
+	{
+		return;
+	}
+
+	//a task which throws completes with W_FAILED, so waiters and continuations do not wait for it forever
+	W_RESULT _hr = W_FAILED;
+	try
+	{
+		_hr = pState->work ? pState->work() : W_PASSED;
+	}
+	catch (const std::exception& pException)
+	{
+		logger.error("task threw an exception, {}. trace info: w_task::_run", pException.what());
+	}
+	catch (...)
+	{
+		logger.error("task threw an unknown exception. trace info: w_task::_run");
+	}
+
+	if (pState->call_back)
+	{
+		pState->call_back(_hr);
+	}
+
+	_finish(pState, w_task_status::W_TASK_COMPLETED, _hr);
+}
+
+void w_task::_finish(
+	_In_ const std::shared_ptr<w_task_state>& pState,
+	_In_ const w_task_status& pStatus,
+	_In_ const W_RESULT& pResult)
+{
+	std::vector<std::shared_ptr<w_task_state>> _continuations;
+	{
+		std::lock_guard<std::mutex> _lock(pState->mutex);
+		pState->result = pResult;
+		pState->status.store(pStatus);
+		std::swap(_continuations, pState->continuations);
+
+		//release captured resources as soon as possible
+		pState->work = nullptr;
+		pState->call_back = nullptr;
+	}
+	pState->cv.notify_all();
+
+	for (auto& _continuation : _continuations)
+	{
+		if (pStatus == w_task_status::W_TASK_COMPLETED)
+		{
+			_schedule(_continuation);
+		}
+		else if (_continuation->exchange_status(w_task_status::W_TASK_PENDING, w_task_status::W_TASK_CANCELLED))
+		{
+			_finish(_continuation, w_task_status::W_TASK_CANCELLED, W_FAILED);
+		}
+	}
+}
+
+#pragma endregion
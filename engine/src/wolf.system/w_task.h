@@ -4,7 +4,7 @@
 	Website			 : https://WolfEngine.App
 	Name			 : w_task.h
 	Description		 : A task class
-	Comment          :
+	Comment          : On POSIX async tasks run on a shared work stealing w_thread_pool
 */
 
 #pragma once
@@ -17,28 +17,82 @@
 
 #include <future>
 #include <functional>
+#include <memory>
 #include "w_system_export.h"
 #include "w_std.h"
 
 namespace wolf::system
 {
+	enum w_task_status
+	{
+		W_TASK_DEFERRED = 0,
+		W_TASK_PENDING,
+		W_TASK_RUNNING,
+		W_TASK_COMPLETED,
+		W_TASK_CANCELLED
+	};
+
+	class w_thread_pool;
+	struct w_task_state;
+
+	//a handle to a task which was created by w_task
+	class w_task_handle
+	{
+		friend class w_task;
+	public:
+		WSYS_EXP w_task_handle();
+
+		//wait for task, deferred tasks will be executed on the calling thread. Workers of the shared pool execute other jobs meanwhile
+		WSYS_EXP void wait() const;
+		/*
+			wait for task, returns std::future_status::deferred for deferred tasks which were not executed yet.
+			Workers of the shared pool execute other jobs meanwhile, so they may return after pMilliSeconds
+		*/
+		WSYS_EXP std::future_status wait_for(_In_ const long long pMilliSeconds) const;
+		//wait and get the result of task, returns W_FAILED for cancelled tasks and tasks which threw an exception
+		WSYS_EXP W_RESULT get() const;
+		//cancel the task and its continuations if they are not started yet
+		WSYS_EXP bool cancel() const;
+		//add a continuation which will be executed with the result of this task
+		WSYS_EXP w_task_handle then(_In_ const std::function<W_RESULT(W_RESULT)>& pContinuation) const;
+
+#pragma region Getters
+		WSYS_EXP w_task_status get_status() const;
+		WSYS_EXP bool get_is_valid() const;
+#pragma endregion
+
+	private:
+		std::shared_ptr<w_task_state> _state;
+	};
+
 	class w_task
 	{
+		friend class w_task_handle;
 	public:
-		WSYS_EXP static void execute_async(_In_ const std::function<W_RESULT(void)>& pTaskWork, _In_ const std::function<void(W_RESULT)>& pCallBack = nullptr);
-		WSYS_EXP static void execute_deferred(_In_ const std::function<W_RESULT(void)>& pTaskWork);
-		//wait only work for deferred task
+		WSYS_EXP static w_task_handle execute_async(_In_ const std::function<W_RESULT(void)>& pTaskWork, _In_ const std::function<void(W_RESULT)>& pCallBack = nullptr);
+		WSYS_EXP static w_task_handle execute_deferred(_In_ const std::function<W_RESULT(void)>& pTaskWork);
+		//wait only work for the last deferred task of the calling thread, use w_task_handle instead
 		WSYS_EXP static std::future_status wait_for(_In_ const long long pMilliSeconds);
-		//wait only work for deferred task
+		//wait only work for the last deferred task of the calling thread, use w_task_handle instead
 		template<typename _REP, typename _PER>
-		static std::future_status wait_for(_In_ const std::chrono::duration<_REP, _PER>& pTime);
-		//wait only work for deferred task
+		static std::future_status wait_for(_In_ const std::chrono::duration<_REP, _PER>& pTime)
+		{
+			return wait_for(std::chrono::duration_cast<std::chrono::milliseconds>(pTime).count());
+		}
+		//wait only work for the last deferred task of the calling thread, use w_task_handle instead
 		WSYS_EXP static void wait();
-		//get only work for deferred task
+		//get only work for the last deferred task of the calling thread, use w_task_handle instead
 		WSYS_EXP static void get();
 
+		//the work stealing pool which runs async tasks on POSIX and parallel_for on all platforms
+		WSYS_EXP static w_thread_pool& get_shared_thread_pool();
+
 	private:
-		static std::future<W_RESULT> _deferred;
+		static void _schedule(_In_ const std::shared_ptr<w_task_state>& pState);
+		static void _run(_In_ const std::shared_ptr<w_task_state>& pState);
+		static void _finish(_In_ const std::shared_ptr<w_task_state>& pState, _In_ const w_task_status& pStatus, _In_ const W_RESULT& pResult);
+
+		static thread_local w_task_handle _deferred;
 	};
 }
 
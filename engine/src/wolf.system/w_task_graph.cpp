@@ -0,0 +1,282 @@
+#include "w_system_pch.h"
+#include "w_task_graph.h"
+#include "w_thread_pool.h"
+#include <chrono>
+#include <algorithm>
+
+using namespace wolf::system;
+
+static int64_t _now_in_nanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+w_task_graph::w_task_graph() :
+	_thread_pool(nullptr),
+	_remaining(0),
+	_is_executing(false),
+	_is_done(false),
+	_start_time(0),
+	_last_execution_time(0.0),
+	_critical_path_length(0.0),
+	_is_compiled(false)
+{
+}
+
+w_task_graph::~w_task_graph()
+{
+	clear();
+}
+
+size_t w_task_graph::add_node(_In_z_ const std::string& pName, _In_ const std::function<void()>& pJob)
+{
+	w_node _node;
+	_node.name = pName;
+	_node.job = pJob;
+	this->_nodes.push_back(_node);
+	this->_is_compiled = false;
+
+	return this->_nodes.size() - 1;
+}
+
+W_RESULT w_task_graph::add_dependency(_In_ const size_t& pNode, _In_ const size_t& pDependsOn)
+{
+	const auto _size = this->_nodes.size();
+	if (pNode >= _size || pDependsOn >= _size || pNode == pDependsOn) return W_INVALIDARG;
+
+	auto& _successors = this->_nodes[pDependsOn].successors;
+	if (std::find(_successors.begin(), _successors.end(), pNode) != _successors.end()) return W_PASSED;
+
+	_successors.push_back(pNode);
+	this->_nodes[pNode].predecessors_count++;
+	this->_is_compiled = false;
+
+	return W_PASSED;
+}
+
+W_RESULT w_task_graph::compile()
+{
+	const auto _size = this->_nodes.size();
+
+	this->_roots.clear();
+	this->_topological_order.clear();
+	this->_topological_order.reserve(_size);
+
+	//Kahn's algorithm for finding roots, order of nodes and cycles
+	std::vector<uint32_t> _in_degrees(_size);
+	for (size_t i = 0; i < _size; ++i)
+	{
+		_in_degrees[i] = this->_nodes[i].predecessors_count;
+		if (_in_degrees[i] == 0)
+		{
+			this->_roots.push_back(i);
+			this->_topological_order.push_back(i);
+		}
+	}
+	for (size_t i = 0; i < this->_topological_order.size(); ++i)
+	{
+		for (auto& _successor : this->_nodes[this->_topological_order[i]].successors)
+		{
+			if (--_in_degrees[_successor] == 0)
+			{
+				this->_topological_order.push_back(_successor);
+			}
+		}
+	}
+
+	if (this->_topological_order.size() != _size)
+	{
+		logger.error("task graph contains a cycle. trace info: w_task_graph::compile");
+		this->_is_compiled = false;
+		return W_FAILED;
+	}
+
+	this->_counters.reset(new std::atomic<uint32_t>[_size]);
+	this->_path_lengths.resize(_size);
+	this->_path_parents.resize(_size);
+	this->_critical_path.reserve(_size);
+
+	this->_is_compiled = true;
+	return W_PASSED;
+}
+
+W_RESULT w_task_graph::execute(_In_ w_thread_pool& pThreadPool)
+{
+	if (!this->_is_compiled && compile() == W_FAILED) return W_FAILED;
+	if (this->_nodes.empty()) return W_PASSED;
+
+	bool _expected = false;
+	if (!this->_is_executing.compare_exchange_strong(_expected, true))
+	{
+		logger.error("task graph is already executing. trace info: w_task_graph::execute");
+		return W_FAILED;
+	}
+
+	for (size_t i = 0; i < this->_nodes.size(); ++i)
+	{
+		this->_counters[i].store(this->_nodes[i].predecessors_count, std::memory_order_relaxed);
+	}
+	this->_thread_pool = &pThreadPool;
+	this->_remaining.store(this->_nodes.size());
+	this->_is_done = false;
+	this->_start_time = _now_in_nanoseconds();
+
+	for (auto& _root : this->_roots)
+	{
+		pThreadPool.add_job([this, _root]()
+			{
+				_run_node(_root);
+			});
+	}
+
+	//help with executing nodes instead of blocking
+	while (this->_remaining.load() > 0)
+	{
+		if (pThreadPool.execute_one_job()) continue;
+
+		std::unique_lock<std::mutex> _lock(this->_done_mutex);
+		this->_done_cv.wait_for(_lock, std::chrono::milliseconds(1), [this]()
+			{
+				return this->_is_done;
+			});
+	}
+
+	//the last node may still be notifying, graph must not be destroyed before it leaves the mutex
+	{
+		std::unique_lock<std::mutex> _lock(this->_done_mutex);
+		this->_done_cv.wait(_lock, [this]()
+			{
+				return this->_is_done;
+			});
+	}
+
+	this->_last_execution_time = static_cast<double>(_now_in_nanoseconds() - this->_start_time) / 1000000000.0;
+	_compute_critical_path();
+
+	this->_is_executing.store(false);
+	return W_PASSED;
+}
+
+void w_task_graph::clear()
+{
+	this->_nodes.clear();
+	this->_roots.clear();
+	this->_topological_order.clear();
+	this->_path_lengths.clear();
+	this->_path_parents.clear();
+	this->_critical_path.clear();
+	this->_counters.reset();
+	this->_critical_path_length = 0.0;
+	this->_is_compiled = false;
+}
+
+void w_task_graph::_run_node(_In_ const size_t& pNode)
+{
+	auto& _node = this->_nodes[pNode];
+
+	_node.start_time = _now_in_nanoseconds() - this->_start_time;
+	if (_node.job)
+	{
+		_node.job();
+	}
+	_node.end_time = _now_in_nanoseconds() - this->_start_time;
+
+	for (auto& _successor : _node.successors)
+	{
+		if (this->_counters[_successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			this->_thread_pool->add_job([this, _successor]()
+				{
+					_run_node(_successor);
+				});
+		}
+	}
+
+	if (this->_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		//completion is published and notified under the mutex, execute can not return before this node unlocks it
+		std::lock_guard<std::mutex> _lock(this->_done_mutex);
+		this->_is_done = true;
+		this->_done_cv.notify_all();
+	}
+}
+
+void w_task_graph::_compute_critical_path()
+{
+	const auto _invalid = this->_nodes.size();
+	for (size_t i = 0; i < this->_nodes.size(); ++i)
+	{
+		this->_path_lengths[i] = 0;
+		this->_path_parents[i] = _invalid;
+	}
+
+	//longest path over measured durations in topological order
+	size_t _last = _invalid;
+	int64_t _longest = -1;
+	for (auto& _index : this->_topological_order)
+	{
+		auto& _node = this->_nodes[_index];
+		this->_path_lengths[_index] += _node.end_time - _node.start_time;
+		if (this->_path_lengths[_index] > _longest)
+		{
+			_longest = this->_path_lengths[_index];
+			_last = _index;
+		}
+
+		for (auto& _successor : _node.successors)
+		{
+			if (this->_path_lengths[_index] > this->_path_lengths[_successor])
+			{
+				this->_path_lengths[_successor] = this->_path_lengths[_index];
+				this->_path_parents[_successor] = _index;
+			}
+		}
+	}
+
+	this->_critical_path.clear();
+	for (auto i = _last; i != _invalid; i = this->_path_parents[i])
+	{
+		this->_critical_path.push_back(i);
+	}
+	std::reverse(this->_critical_path.begin(), this->_critical_path.end());
+
+	this->_critical_path_length = static_cast<double>(_longest) / 1000000000.0;
+}
+
+#pragma region Getters
+
+size_t w_task_graph::get_nodes_count() const
+{
+	return this->_nodes.size();
+}
+
+std::string w_task_graph::get_node_name(_In_ const size_t& pNode) const
+{
+	if (pNode >= this->_nodes.size()) return "";
+	return this->_nodes[pNode].name;
+}
+
+double w_task_graph::get_node_duration(_In_ const size_t& pNode) const
+{
+	if (pNode >= this->_nodes.size()) return 0.0;
+	auto& _node = this->_nodes[pNode];
+	return static_cast<double>(_node.end_time - _node.start_time) / 1000000000.0;
+}
+
+double w_task_graph::get_last_execution_time() const
+{
+	return this->_last_execution_time;
+}
+
+double w_task_graph::get_critical_path_length() const
+{
+	return this->_critical_path_length;
+}
+
+const std::vector<size_t>& w_task_graph::get_critical_path() const
+{
+	return this->_critical_path;
+}
+
+#pragma endregion
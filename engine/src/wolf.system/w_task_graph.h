@@ -0,0 +1,96 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_task_graph.h
+	Description		 : A dependency driven graph of jobs which runs on w_thread_pool
+	Comment          : Build the graph once, then call execute every frame. Each node has an atomic counter of
+					   unfinished predecessors and becomes ready when it reaches zero
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include <functional>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace wolf::system
+{
+	class w_thread_pool;
+	class w_task_graph
+	{
+	public:
+		WSYS_EXP w_task_graph();
+		WSYS_EXP ~w_task_graph();
+
+		//add a node to graph and return its index
+		WSYS_EXP size_t add_node(_In_z_ const std::string& pName, _In_ const std::function<void()>& pJob);
+		//pNode will be executed after pDependsOn is done
+		WSYS_EXP W_RESULT add_dependency(_In_ const size_t& pNode, _In_ const size_t& pDependsOn);
+		//validate graph and prepare it for execution, returns W_FAILED if graph has a cycle
+		WSYS_EXP W_RESULT compile();
+		//execute all nodes on thread pool and wait for them, the calling thread helps executing nodes in work stealing mode
+		WSYS_EXP W_RESULT execute(_In_ w_thread_pool& pThreadPool);
+		//remove all nodes
+		WSYS_EXP void clear();
+
+#pragma region Getters
+		WSYS_EXP size_t get_nodes_count() const;
+		WSYS_EXP std::string get_node_name(_In_ const size_t& pNode) const;
+		//duration of node in seconds on the last execution
+		WSYS_EXP double get_node_duration(_In_ const size_t& pNode) const;
+		//wall clock time of the last execution in seconds
+		WSYS_EXP double get_last_execution_time() const;
+		//sum of durations of the longest dependency chain on the last execution in seconds
+		WSYS_EXP double get_critical_path_length() const;
+		//nodes of the longest dependency chain on the last execution
+		WSYS_EXP const std::vector<size_t>& get_critical_path() const;
+#pragma endregion
+
+	private:
+		//prevent copying
+		w_task_graph(w_task_graph const&);
+		w_task_graph& operator= (w_task_graph const&);
+
+		void _run_node(_In_ const size_t& pNode);
+		void _compute_critical_path();
+
+		struct w_node
+		{
+			std::string                 name;
+			std::function<void()>       job;
+			std::vector<size_t>         successors;
+			uint32_t                    predecessors_count = 0;
+			//nanoseconds since start of execution
+			int64_t                     start_time = 0;
+			int64_t                     end_time = 0;
+		};
+
+		std::vector<w_node>                         _nodes;
+		//unfinished predecessors of each node
+		std::unique_ptr<std::atomic<uint32_t>[]>    _counters;
+		std::vector<size_t>                         _roots;
+		std::vector<size_t>                         _topological_order;
+		//longest finish time of each node on the critical path
+		std::vector<int64_t>                        _path_lengths;
+		std::vector<size_t>                         _path_parents;
+		std::vector<size_t>                         _critical_path;
+
+		w_thread_pool*                              _thread_pool;
+		std::atomic<size_t>                         _remaining;
+		std::atomic<bool>                           _is_executing;
+		std::mutex                                  _done_mutex;
+		std::condition_variable                     _done_cv;
+		//set by the last node while holding _done_mutex
+		bool                                        _is_done;
+		int64_t                                     _start_time;
+		double                                      _last_execution_time;
+		double                                      _critical_path_length;
+		bool                                        _is_compiled;
+	};
+}
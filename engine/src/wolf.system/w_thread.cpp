@@ -1,12 +1,16 @@
 #include "w_system_pch.h"
 #include "w_thread.h"
 
+#include "w_cpu_topology.h"
+
 #ifdef __WIN32
 #include <process.h>
 #else
 #include <mutex>
 #include <condition_variable>
 #include <sstream>
+#include <pthread.h>
+#include <sched.h>
 #endif
 
 namespace wolf
@@ -104,6 +108,43 @@ namespace wolf
 }
 
 using namespace wolf::system;
+
+static W_RESULT _set_thread_affinity(
+    _In_ std::thread::native_handle_type pHandle,
+    _In_ const bool& pIsCurrentThread,
+    _In_ const uint32_t& pLogicalProcessor)
+{
+    auto _processor = w_cpu_topology::get_logical_processor(pLogicalProcessor);
+    if (!_processor) return W_INVALIDARG;
+
+#if defined(__WIN32) || defined(__UWP)
+    (void)pIsCurrentThread;
+    GROUP_AFFINITY _affinity = {};
+    _affinity.Group = _processor->group;
+    _affinity.Mask = (KAFFINITY)1 << _processor->group_index;
+    return SetThreadGroupAffinity(pHandle, &_affinity, nullptr) ? W_PASSED : W_FAILED;
+#elif defined(__linux) && !defined(__ANDROID)
+    (void)pIsCurrentThread;
+    cpu_set_t _set;
+    CPU_ZERO(&_set);
+    CPU_SET(_processor->id, &_set);
+    return pthread_setaffinity_np(pHandle, sizeof(_set), &_set) == 0 ? W_PASSED : W_FAILED;
+#elif defined(__ANDROID)
+    //bionic can only change affinity of the calling thread
+    (void)pHandle;
+    if (!pIsCurrentThread) return W_FAILED;
+    cpu_set_t _set;
+    CPU_ZERO(&_set);
+    CPU_SET(_processor->id, &_set);
+    return sched_setaffinity(0, sizeof(_set), &_set) == 0 ? W_PASSED : W_FAILED;
+#else
+    //affinity is only a hint on macOS and iOS
+    (void)pHandle;
+    (void)pIsCurrentThread;
+    return W_FAILED;
+#endif
+}
+
 w_thread::w_thread() : _pimp(new w_thread_pimp())
 {
 }
@@ -143,3 +184,23 @@ void w_thread::release()
     this->_pimp->release();
     this->_pimp = nullptr;
 }
+
+W_RESULT w_thread::set_affinity(_In_ const uint32_t& pLogicalProcessor)
+{
+    if (!this->_pimp) return W_FAILED;
+    return _set_thread_affinity(this->_pimp->get_native_handle(), false, pLogicalProcessor);
+}
+
+W_RESULT w_thread::set_affinity(_In_ std::thread& pThread, _In_ const uint32_t& pLogicalProcessor)
+{
+    return _set_thread_affinity(pThread.native_handle(), pThread.get_id() == std::this_thread::get_id(), pLogicalProcessor);
+}
+
+W_RESULT w_thread::set_current_thread_affinity(_In_ const uint32_t& pLogicalProcessor)
+{
+#if defined(__WIN32) || defined(__UWP)
+    return _set_thread_affinity(GetCurrentThread(), true, pLogicalProcessor);
+#else
+    return _set_thread_affinity(pthread_self(), true, pLogicalProcessor);
+#endif
+}
@@ -344,6 +344,15 @@ namespace wolf::system
 			return this->_thread_id;
 		}
 
+		std::thread::native_handle_type get_native_handle()
+		{
+#if defined(__WIN32) || defined(__UWP)
+			return this->_thread_handle;
+#else
+			return this->_thread_handle.native_handle();
+#endif
+		}
+
 	private:
 #if defined(__WIN32) || defined(__UWP)
 		HANDLE                                  _thread_handle;
@@ -409,6 +418,11 @@ namespace wolf::system
 			this->_pimp->wait<Predicate>(pred);
 		}
 
+        //pin thread to a logical processor of w_cpu_topology
+        WSYS_EXP W_RESULT set_affinity(_In_ const uint32_t& pLogicalProcessor);
+        WSYS_EXP static W_RESULT set_affinity(_In_ std::thread& pThread, _In_ const uint32_t& pLogicalProcessor);
+        WSYS_EXP static W_RESULT set_current_thread_affinity(_In_ const uint32_t& pLogicalProcessor);
+
         //hardware_thread_contexts usually equal to number of CPU cores
         WSYS_EXP static unsigned int get_number_of_hardware_thread_contexts()
         {
@@ -1,9 +1,279 @@
 #include "w_system_pch.h"
 #include "w_thread_pool.h"
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace wolf::system
+{
+    class w_thread_pool_pimp
+    {
+    public:
+        w_thread_pool_pimp(_In_ const size_t& pNumberOfThreads) :
+            _queued(0),
+            _pending(0),
+            _sleepers(0),
+            _done_waiters(0),
+            _next_queue(0),
+            _is_released(false)
+        {
+            for (size_t i = 0; i < pNumberOfThreads; ++i)
+            {
+                this->_queues.push_back(std::unique_ptr<w_worker_queue>(new w_worker_queue()));
+            }
+            for (size_t i = 0; i < pNumberOfThreads; ++i)
+            {
+                this->_workers.push_back(std::thread(&w_thread_pool_pimp::_worker, this, i));
+            }
+        }
+
+        ~w_thread_pool_pimp()
+        {
+            release();
+        }
+
+        void push(_In_ const std::function<void()>& pJob, _In_ const int& pQueueIndex)
+        {
+            if (this->_queues.empty()) return;
+
+            //jobs which are added by a worker of this pool go to its own deque
+            size_t _index;
+            if (pQueueIndex >= 0)
+            {
+                _index = static_cast<size_t>(pQueueIndex) % this->_queues.size();
+            }
+            else if (s_pool == this)
+            {
+                _index = static_cast<size_t>(s_worker_index);
+            }
+            else
+            {
+                _index = this->_next_queue.fetch_add(1, std::memory_order_relaxed) % this->_queues.size();
+            }
+
+            this->_pending.fetch_add(1);
+            {
+                auto& _queue = *this->_queues[_index];
+                std::lock_guard<std::mutex> _lock(_queue.mutex);
+                _queue.jobs.push_back(pJob);
+            }
+            this->_queued.fetch_add(1);
+
+            //wake up a sleeping worker, locking makes sure it is waiting on the condition variable
+            if (this->_sleepers.load() > 0)
+            {
+                {
+                    std::lock_guard<std::mutex> _lock(this->_wake_mutex);
+                }
+                this->_wake_cv.notify_one();
+            }
+        }
+
+        bool execute_one()
+        {
+            std::function<void()> _job;
+            const bool _is_worker = s_pool == this;
+            if ((_is_worker && _pop(static_cast<size_t>(s_worker_index), _job)) ||
+                _steal(_is_worker ? static_cast<size_t>(s_worker_index) : this->_queues.size(), _job))
+            {
+                _run(_job);
+                return true;
+            }
+            return false;
+        }
+
+        void wait_all()
+        {
+            if (s_pool == this)
+            {
+                logger.error("wait_all must not be called from a job of the same pool. trace info: w_thread_pool::wait_all");
+                return;
+            }
+
+            while (this->_pending.load() > 0)
+            {
+                if (execute_one()) continue;
+
+                std::unique_lock<std::mutex> _lock(this->_done_mutex);
+                this->_done_waiters.fetch_add(1);
+                //wake up periodically for helping with jobs which were added meanwhile
+                this->_done_cv.wait_for(_lock, std::chrono::milliseconds(1), [this]()
+                    {
+                        return this->_pending.load() == 0;
+                    });
+                this->_done_waiters.fetch_sub(1);
+            }
+        }
+
+        void release()
+        {
+            if (this->_is_released.load()) return;
+
+            wait_all();
+
+            {
+                std::lock_guard<std::mutex> _lock(this->_wake_mutex);
+                this->_is_released.store(true);
+            }
+            this->_wake_cv.notify_all();
+
+            for (auto& _t : this->_workers)
+            {
+                if (_t.joinable())
+                {
+                    _t.join();
+                }
+            }
+            this->_workers.clear();
+            this->_queues.clear();
+        }
+
+        size_t get_size() const
+        {
+            return this->_workers.size();
+        }
+
+        int get_current_worker_index() const
+        {
+            return s_pool == this ? s_worker_index : -1;
+        }
+
+        W_RESULT set_affinity(_In_ const size_t& pWorkerIndex, _In_ const uint32_t& pLogicalProcessor)
+        {
+            if (pWorkerIndex >= this->_workers.size()) return W_INVALIDARG;
+            return w_thread::set_affinity(this->_workers[pWorkerIndex], pLogicalProcessor);
+        }
+
+    private:
+        struct w_worker_queue
+        {
+            std::mutex                              mutex;
+            std::deque<std::function<void()>>       jobs;
+        };
+
+        void _worker(_In_ size_t pIndex)
+        {
+            s_pool = this;
+            s_worker_index = static_cast<int>(pIndex);
+
+            const int _spin_count = 64;
+            while (true)
+            {
+                std::function<void()> _job;
+                if (_pop(pIndex, _job) || _steal(pIndex, _job))
+                {
+                    _run(_job);
+                    continue;
+                }
+
+                //spin for a while before parking
+                bool _has_job = false;
+                for (int i = 0; i < _spin_count; ++i)
+                {
+                    if (this->_queued.load(std::memory_order_relaxed) > 0 || this->_is_released.load(std::memory_order_relaxed))
+                    {
+                        _has_job = true;
+                        break;
+                    }
+                    std::this_thread::yield();
+                }
+                if (_has_job && !this->_is_released.load()) continue;
+
+                std::unique_lock<std::mutex> _lock(this->_wake_mutex);
+                this->_sleepers.fetch_add(1);
+                this->_wake_cv.wait(_lock, [this]()
+                    {
+                        return this->_queued.load() > 0 || this->_is_released.load();
+                    });
+                this->_sleepers.fetch_sub(1);
+                if (this->_is_released.load()) break;
+            }
+
+            s_pool = nullptr;
+            s_worker_index = -1;
+        }
+
+        //owner pops from the back of its own deque
+        bool _pop(_In_ const size_t& pIndex, _Inout_ std::function<void()>& pJob)
+        {
+            auto& _queue = *this->_queues[pIndex];
+            std::lock_guard<std::mutex> _lock(_queue.mutex);
+            if (_queue.jobs.empty()) return false;
+
+            pJob = std::move(_queue.jobs.back());
+            _queue.jobs.pop_back();
+            this->_queued.fetch_sub(1);
+            return true;
+        }
+
+        //thieves take from the front of the other deques
+        bool _steal(_In_ const size_t& pThief, _Inout_ std::function<void()>& pJob)
+        {
+            const auto _size = this->_queues.size();
+            if (this->_queued.load(std::memory_order_relaxed) == 0) return false;
+
+            for (size_t i = 1; i <= _size; ++i)
+            {
+                const auto _victim = (pThief + i) % _size;
+                if (_victim == pThief) continue;
+
+                auto& _queue = *this->_queues[_victim];
+                std::unique_lock<std::mutex> _lock(_queue.mutex, std::try_to_lock);
+                if (!_lock.owns_lock() || _queue.jobs.empty()) continue;
+
+                pJob = std::move(_queue.jobs.front());
+                _queue.jobs.pop_front();
+                this->_queued.fetch_sub(1);
+                return true;
+            }
+            return false;
+        }
+
+        void _run(_In_ std::function<void()>& pJob)
+        {
+            pJob();
+
+            if (this->_pending.fetch_sub(1) == 1 && this->_done_waiters.load() > 0)
+            {
+                {
+                    std::lock_guard<std::mutex> _lock(this->_done_mutex);
+                }
+                this->_done_cv.notify_all();
+            }
+        }
+
+        std::vector<std::unique_ptr<w_worker_queue>>    _queues;
+        std::vector<std::thread>                        _workers;
+
+        //number of jobs inside deques
+        std::atomic<size_t>                             _queued;
+        //number of jobs which are queued or running
+        std::atomic<size_t>                             _pending;
+        std::atomic<size_t>                             _sleepers;
+        std::atomic<size_t>                             _done_waiters;
+        std::atomic<size_t>                             _next_queue;
+        std::atomic<bool>                               _is_released;
+
+        std::mutex                                      _wake_mutex;
+        std::condition_variable                         _wake_cv;
+        std::mutex                                      _done_mutex;
+        std::condition_variable                         _done_cv;
+
+        static thread_local w_thread_pool_pimp*         s_pool;
+        static thread_local int                         s_worker_index;
+    };
+
+    thread_local w_thread_pool_pimp* w_thread_pool_pimp::s_pool = nullptr;
+    thread_local int w_thread_pool_pimp::s_worker_index = -1;
+}
 
 using namespace wolf::system;
 
-w_thread_pool::w_thread_pool()
+w_thread_pool::w_thread_pool() :
+    _mode(w_thread_pool_mode::W_PINNED),
+    _next_thread(0),
+    _pimp(nullptr)
 {
 }
 
@@ -12,14 +282,33 @@ w_thread_pool::~w_thread_pool()
     release();
 }
 
-void w_thread_pool::allocate(_In_ const size_t& pSize)
+void w_thread_pool::allocate(_In_ const size_t& pSize, _In_ const w_thread_pool_mode& pMode)
 {
     release();
-    this->_threads.resize(pSize);
+
+    this->_mode = pMode;
+    if (this->_mode == w_thread_pool_mode::W_WORK_STEALING)
+    {
+        this->_pimp = new (std::nothrow) w_thread_pool_pimp(pSize);
+        if (!this->_pimp)
+        {
+            logger.error("could not allocate memory for work stealing scheduler. trace info: w_thread_pool::allocate");
+        }
+    }
+    else
+    {
+        this->_threads.resize(pSize);
+    }
 }
 
 void w_thread_pool::wait_for(_In_ const size_t& pThreadIndex)
 {
+    if (this->_pimp)
+    {
+        this->_pimp->wait_all();
+        return;
+    }
+
     if (pThreadIndex < this->_threads.size())
     {
         this->_threads[pThreadIndex].wait_until_complete();
@@ -28,34 +317,104 @@ void w_thread_pool::wait_for(_In_ const size_t& pThreadIndex)
 
 void w_thread_pool::wait_all()
 {
+    if (this->_pimp)
+    {
+        this->_pimp->wait_all();
+        return;
+    }
+
     for (auto& _t : this->_threads)
     {
         _t.wait_until_complete();
     }
 }
 
+bool w_thread_pool::execute_one_job()
+{
+    if (!this->_pimp) return false;
+    return this->_pimp->execute_one();
+}
+
 void w_thread_pool::release()
 {
+    SAFE_DELETE(this->_pimp);
+
     for (auto& _t : this->_threads)
     {
         _t.release();
     }
     this->_threads.clear();
+    this->_next_thread.store(0);
+}
+
+void w_thread_pool::add_job(_In_ const std::function<void()>& pJob)
+{
+    if (this->_pimp)
+    {
+        this->_pimp->push(pJob, -1);
+        return;
+    }
+
+    if (this->_threads.size())
+    {
+        const auto _index = this->_next_thread.fetch_add(1, std::memory_order_relaxed);
+        this->_threads[_index % this->_threads.size()].add_job(pJob);
+    }
 }
 
 #pragma region Getters
 
 size_t w_thread_pool::get_pool_size() const
 {
+    if (this->_pimp) return this->_pimp->get_size();
     return this->_threads.size();
 }
 
+w_thread_pool_mode w_thread_pool::get_mode() const
+{
+    return this->_mode;
+}
+
+int w_thread_pool::get_current_worker_index() const
+{
+    if (!this->_pimp) return -1;
+    return this->_pimp->get_current_worker_index();
+}
+
 #pragma endregion
 
 #pragma region Setters
 
+W_RESULT w_thread_pool::set_affinity(_In_ const std::vector<uint32_t>& pLogicalProcessors)
+{
+    if (pLogicalProcessors.empty()) return W_INVALIDARG;
+
+    W_RESULT _hr = W_PASSED;
+    const auto _size = get_pool_size();
+    for (size_t i = 0; i < _size; ++i)
+    {
+        const auto _processor = pLogicalProcessors[i % pLogicalProcessors.size()];
+        auto _result = this->_pimp ? this->_pimp->set_affinity(i, _processor) : this->_threads[i].set_affinity(_processor);
+        if (_result != W_PASSED)
+        {
+            logger.warning("could not set affinity of worker {} to logical processor {}. trace info: w_thread_pool::set_affinity", i, _processor);
+            _hr = _result;
+        }
+    }
+    return _hr;
+}
+
 void w_thread_pool::add_jobs_for_thread(_In_ const size_t& pThreadIndex, _In_ const std::vector<std::function<void()>>& pJobs)
 {
+    if (this->_pimp)
+    {
+        for (auto& _job : pJobs)
+        {
+            this->_pimp->push(_job, static_cast<int>(pThreadIndex));
+        }
+        return;
+    }
+
     if (pThreadIndex < this->_threads.size())
     {
         for (auto& _job : pJobs)
@@ -67,6 +426,12 @@ void w_thread_pool::add_jobs_for_thread(_In_ const size_t& pThreadIndex, _In_ co
 
 void w_thread_pool::add_job_for_thread(_In_ const size_t& pThreadIndex, _In_ const std::function<void()>& pJob)
 {
+    if (this->_pimp)
+    {
+        this->_pimp->push(pJob, static_cast<int>(pThreadIndex));
+        return;
+    }
+
     if (pThreadIndex < this->_threads.size())
     {
         this->_threads[pThreadIndex].add_job(pJob);
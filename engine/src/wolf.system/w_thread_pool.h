@@ -3,17 +3,31 @@
 	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
 	Website			 : https://WolfEngine.App
 	Name			 : w_thread_pool.h
-	Description		 : A cross platform thread pool class 
-	Comment          :
+	Description		 : A cross platform thread pool class
+	Comment          : In W_WORK_STEALING mode each worker owns a deque, workers pop their own jobs from the back
+					   and idle workers steal from the front of other workers' deques
 */
 
 #pragma once
 
 #include "w_thread.h"
 #include <vector>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <type_traits>
 
 namespace wolf::system
 {
+	enum w_thread_pool_mode
+	{
+		//each job runs on the thread it was added for
+		W_PINNED = 0,
+		//jobs are balanced between workers by stealing
+		W_WORK_STEALING
+	};
+
+	class w_thread_pool_pimp;
 	class w_thread_pool
 	{
 	public:
@@ -21,19 +35,59 @@ namespace wolf::system
 		WSYS_EXP ~w_thread_pool();
 
 		//allocate thread pool with number of threads
-		WSYS_EXP void allocate(_In_ const size_t& pNumberOfThreads);
-		//wait for specific thread to be done
+		WSYS_EXP void allocate(
+			_In_ const size_t& pNumberOfThreads,
+			_In_ const w_thread_pool_mode& pMode = w_thread_pool_mode::W_PINNED);
+		//wait for specific thread to be done, in work stealing mode jobs are not bound to a thread, so it waits for all jobs
 		WSYS_EXP void wait_for(_In_ const size_t& pThreadIndex);
-		//wait for all threads
+		//wait for all jobs, in work stealing mode the caller executes pending jobs while waiting. Do not call it from inside a job, use wait(future) instead
 		WSYS_EXP void wait_all();
+		//execute one pending job on the calling thread, returns false if there was nothing to run (only work stealing mode)
+		WSYS_EXP bool execute_one_job();
 		//release all resources
 		WSYS_EXP void release();
 
+		//add a job and let the scheduler choose the worker
+		WSYS_EXP void add_job(_In_ const std::function<void()>& pJob);
+
+		//submit a job and get a future of its result
+		template<typename F>
+		auto submit(_In_ F&& pJob) -> std::future<decltype(pJob())>
+		{
+			using _result_type = decltype(pJob());
+
+			auto _task = std::make_shared<std::packaged_task<_result_type()>>(std::forward<F>(pJob));
+			auto _future = _task->get_future();
+			add_job([_task]()
+				{
+					(*_task)();
+				});
+			return _future;
+		}
+
+		//wait for a submitted job, the caller executes pending jobs instead of blocking a worker
+		template<typename T>
+		void wait(_In_ const std::future<T>& pFuture)
+		{
+			while (pFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				if (!execute_one_job())
+				{
+					pFuture.wait_for(std::chrono::microseconds(100));
+				}
+			}
+		}
+
 #pragma region Getters
 		WSYS_EXP size_t get_pool_size() const;
+		WSYS_EXP w_thread_pool_mode get_mode() const;
+		//index of the worker of this pool which is calling, -1 for other threads
+		WSYS_EXP int get_current_worker_index() const;
 #pragma endregion
 
 #pragma region Setters
+		//pin worker i to pLogicalProcessors[i % size], use w_cpu_topology::get_worker_processors to choose them
+		WSYS_EXP W_RESULT set_affinity(_In_ const std::vector<uint32_t>& pLogicalProcessors);
 		//add jobs for specific thread
 		WSYS_EXP void add_jobs_for_thread(_In_ const size_t& pThreadIndex, _In_ const std::vector<std::function<void()>>& pJobs);
 		//add a job for specific thread
@@ -41,7 +95,14 @@ namespace wolf::system
 #pragma endregion
 
 	private:
-		std::vector<w_thread> _threads;
+		//prevent copying
+		w_thread_pool(w_thread_pool const&);
+		w_thread_pool& operator= (w_thread_pool const&);
+
+		w_thread_pool_mode					_mode;
+		std::vector<w_thread>				_threads;
+		//workers may add jobs concurrently in pinned mode
+		std::atomic<size_t>					_next_thread;
+		w_thread_pool_pimp*					_pimp;
 	};
 }
-
@@ -0,0 +1,411 @@
+#include "w_system_pch.h"
+#include "w_timing_wheel.h"
+#include "w_thread_pool.h"
+#include "w_game_time.h"
+#include <algorithm>
+
+using namespace wolf::system;
+
+//number of callbacks of each job when dispatching to thread pool
+static const size_t s_dispatch_chunk = 64;
+
+w_timing_wheel::w_timing_wheel() :
+	_free_list(INVALID),
+	_current_tick(0),
+	_active_timers(0),
+	_resolution(1),
+	_thread_pool(nullptr),
+	_is_running(false)
+{
+	this->_heads.assign(LEVELS * SLOTS, INVALID);
+	std::fill(this->_level_counts, this->_level_counts + LEVELS, 0);
+	this->_start_time = std::chrono::steady_clock::now();
+}
+
+w_timing_wheel::~w_timing_wheel()
+{
+	release();
+}
+
+W_RESULT w_timing_wheel::initialize(
+	_In_ const uint32_t& pResolutionInMilliseconds,
+	_In_opt_ w_thread_pool* pThreadPool)
+{
+	if (!pResolutionInMilliseconds) return W_INVALIDARG;
+
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+	this->_resolution = pResolutionInMilliseconds;
+	this->_thread_pool = pThreadPool;
+	this->_start_time = std::chrono::steady_clock::now();
+	this->_current_tick = 0;
+
+	return W_PASSED;
+}
+
+w_timer_handle w_timing_wheel::schedule(
+	_In_ const uint64_t& pDelayInMilliseconds,
+	_In_ const w_timer_callback_func& pCallback,
+	_In_ const uint64_t& pIntervalInMilliseconds,
+	_In_ const w_timer_precision& pPrecision)
+{
+	if (!pCallback) return 0;
+
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+
+	auto _index = _allocate_node();
+	auto& _node = this->_nodes[_index];
+
+	//round up, a timer always fires at least one tick later
+	auto _delay = (pDelayInMilliseconds + this->_resolution - 1) / this->_resolution;
+	_node.expiry = this->_current_tick + (_delay ? _delay : 1);
+	_node.interval = pIntervalInMilliseconds ? std::max<uint64_t>(1, (pIntervalInMilliseconds + this->_resolution - 1) / this->_resolution) : 0;
+	_node.callback = pCallback;
+	_node.coarse = pPrecision == w_timer_precision::W_TIMER_COARSE;
+
+	_insert(_index);
+	this->_active_timers.fetch_add(1);
+
+	return (static_cast<uint64_t>(_node.generation) << 32) | (static_cast<uint64_t>(_index) + 1);
+}
+
+bool w_timing_wheel::cancel(_In_ const w_timer_handle& pHandle)
+{
+	if (!pHandle) return false;
+
+	const auto _index = static_cast<uint32_t>(pHandle & 0xFFFFFFFF) - 1;
+	const auto _generation = static_cast<uint32_t>(pHandle >> 32);
+
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+	if (_index >= this->_nodes.size()) return false;
+
+	auto& _node = this->_nodes[_index];
+	if (_node.generation != _generation || _node.slot == INVALID) return false;
+
+	_unlink(_index);
+	_free_node(_index);
+	this->_active_timers.fetch_sub(1);
+
+	return true;
+}
+
+size_t w_timing_wheel::advance(_In_ const uint64_t& pTicks)
+{
+	std::lock_guard<std::mutex> _advance_lock(this->_advance_mutex);
+
+	{
+		std::lock_guard<std::mutex> _lock(this->_mutex);
+		const auto _target = this->_current_tick + pTicks;
+		while (this->_current_tick < _target)
+		{
+			//nothing to expire, jump to the end
+			if (this->_active_timers.load() == 0)
+			{
+				this->_current_tick = _target;
+				break;
+			}
+
+			//nothing on the finer levels, jump to the tick before the next cascade
+			uint32_t _lowest = 0;
+			while (_lowest < LEVELS - 1 && this->_level_counts[_lowest] == 0)
+			{
+				_lowest++;
+			}
+			if (_lowest > 0)
+			{
+				const uint64_t _granularity = static_cast<uint64_t>(1) << (SLOT_BITS * _lowest);
+				const auto _next_cascade = ((this->_current_tick / _granularity) + 1) * _granularity;
+				this->_current_tick = std::min(_next_cascade, _target) - 1;
+			}
+
+			this->_current_tick++;
+
+			//move timers of coarser levels down when the finer level wraps around
+			const auto _tick = this->_current_tick;
+			if ((_tick & (SLOTS - 1)) == 0)
+			{
+				uint32_t _top = 1;
+				while (_top < LEVELS - 1 && ((_tick >> (SLOT_BITS * _top)) & (SLOTS - 1)) == 0)
+				{
+					_top++;
+				}
+				for (auto _level = _top; _level >= 1; --_level)
+				{
+					_cascade(_level);
+				}
+			}
+
+			_expire_slot(static_cast<uint32_t>(_tick & (SLOTS - 1)));
+		}
+	}
+
+	const auto _expired = this->_expired.size();
+	_dispatch();
+	return _expired;
+}
+
+size_t w_timing_wheel::update()
+{
+	const auto _elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - this->_start_time).count();
+	const auto _due = static_cast<uint64_t>(_elapsed) / this->_resolution;
+
+	uint64_t _current;
+	{
+		std::lock_guard<std::mutex> _lock(this->_mutex);
+		_current = this->_current_tick;
+	}
+	return _due > _current ? advance(_due - _current) : 0;
+}
+
+size_t w_timing_wheel::update(_In_ const w_game_time& pGameTime)
+{
+	const auto _due = static_cast<uint64_t>(pGameTime.get_total_seconds() * 1000.0) / this->_resolution;
+
+	uint64_t _current;
+	{
+		std::lock_guard<std::mutex> _lock(this->_mutex);
+		_current = this->_current_tick;
+	}
+	return _due > _current ? advance(_due - _current) : 0;
+}
+
+W_RESULT w_timing_wheel::start()
+{
+	bool _expected = false;
+	if (!this->_is_running.compare_exchange_strong(_expected, true))
+	{
+		logger.error("driver thread of timing wheel is already running. trace info: w_timing_wheel::start");
+		return W_FAILED;
+	}
+
+	this->_driver = std::thread([this]()
+		{
+			while (this->_is_running.load())
+			{
+				update();
+
+				uint64_t _next;
+				{
+					std::lock_guard<std::mutex> _lock(this->_mutex);
+					_next = this->_current_tick + 1;
+				}
+				std::this_thread::sleep_until(this->_start_time + std::chrono::milliseconds(_next * this->_resolution));
+			}
+		});
+
+	return W_PASSED;
+}
+
+void w_timing_wheel::stop()
+{
+	this->_is_running.store(false);
+	if (this->_driver.joinable())
+	{
+		this->_driver.join();
+	}
+}
+
+ULONG w_timing_wheel::release()
+{
+	stop();
+
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+	this->_nodes.clear();
+	this->_heads.assign(LEVELS * SLOTS, INVALID);
+	std::fill(this->_level_counts, this->_level_counts + LEVELS, 0);
+	this->_free_list = INVALID;
+	this->_expired.clear();
+	this->_active_timers.store(0);
+
+	return 0;
+}
+
+uint32_t w_timing_wheel::_allocate_node()
+{
+	if (this->_free_list != INVALID)
+	{
+		auto _index = this->_free_list;
+		this->_free_list = this->_nodes[_index].next;
+		this->_nodes[_index].next = INVALID;
+		return _index;
+	}
+
+	this->_nodes.emplace_back();
+	return static_cast<uint32_t>(this->_nodes.size() - 1);
+}
+
+void w_timing_wheel::_free_node(_In_ const uint32_t& pIndex)
+{
+	auto& _node = this->_nodes[pIndex];
+	_node.callback = w_timer_callback_func();
+	_node.slot = INVALID;
+	_node.prev = INVALID;
+	_node.generation++;
+	_node.next = this->_free_list;
+	this->_free_list = pIndex;
+}
+
+static uint32_t _get_level(_In_ const uint64_t& pDelta, _In_ const uint32_t& pLevels, _In_ const uint32_t& pSlotBits)
+{
+	uint32_t _level = 0;
+	while (_level < pLevels - 1 && pDelta >= (1ULL << (pSlotBits * (_level + 1))))
+	{
+		_level++;
+	}
+	return _level;
+}
+
+void w_timing_wheel::_insert(_In_ const uint32_t& pIndex)
+{
+	auto& _node = this->_nodes[pIndex];
+
+	auto _delta = _node.expiry > this->_current_tick ? _node.expiry - this->_current_tick : 0;
+	auto _level = _get_level(_delta, LEVELS, SLOT_BITS);
+
+	//coarse timers fire on the boundary of their level, so they skip the finer levels
+	if (_node.coarse && _level > 0)
+	{
+		const auto _granularity = 1ULL << (SLOT_BITS * _level);
+		_node.expiry = ((_node.expiry + _granularity - 1) / _granularity) * _granularity;
+		_delta = _node.expiry - this->_current_tick;
+		_level = _get_level(_delta, LEVELS, SLOT_BITS);
+	}
+
+	//timers beyond the range of the wheel wait in the coarsest level and will be inserted again
+	auto _expiry = _node.expiry;
+	const auto _range = 1ULL << (SLOT_BITS * LEVELS);
+	if (_delta >= _range)
+	{
+		_expiry = this->_current_tick + _range - 1;
+	}
+
+	const auto _slot = _level * SLOTS + static_cast<uint32_t>((_expiry >> (SLOT_BITS * _level)) & (SLOTS - 1));
+	this->_level_counts[_level]++;
+	_node.slot = _slot;
+	_node.prev = INVALID;
+	_node.next = this->_heads[_slot];
+	if (_node.next != INVALID)
+	{
+		this->_nodes[_node.next].prev = pIndex;
+	}
+	this->_heads[_slot] = pIndex;
+}
+
+void w_timing_wheel::_unlink(_In_ const uint32_t& pIndex)
+{
+	auto& _node = this->_nodes[pIndex];
+	this->_level_counts[_node.slot / SLOTS]--;
+	if (_node.prev != INVALID)
+	{
+		this->_nodes[_node.prev].next = _node.next;
+	}
+	else
+	{
+		this->_heads[_node.slot] = _node.next;
+	}
+	if (_node.next != INVALID)
+	{
+		this->_nodes[_node.next].prev = _node.prev;
+	}
+	_node.prev = INVALID;
+	_node.next = INVALID;
+	_node.slot = INVALID;
+}
+
+void w_timing_wheel::_cascade(_In_ const uint32_t& pLevel)
+{
+	const auto _slot = pLevel * SLOTS + static_cast<uint32_t>((this->_current_tick >> (SLOT_BITS * pLevel)) & (SLOTS - 1));
+
+	auto _index = this->_heads[_slot];
+	this->_heads[_slot] = INVALID;
+	while (_index != INVALID)
+	{
+		auto _next = this->_nodes[_index].next;
+		this->_level_counts[pLevel]--;
+		_insert(_index);
+		_index = _next;
+	}
+}
+
+void w_timing_wheel::_expire_slot(_In_ const uint32_t& pSlot)
+{
+	auto _index = this->_heads[pSlot];
+	this->_heads[pSlot] = INVALID;
+	while (_index != INVALID)
+	{
+		auto& _node = this->_nodes[_index];
+		auto _next = _node.next;
+		this->_level_counts[0]--;
+
+		if (_node.expiry > this->_current_tick)
+		{
+			//belongs to the next revolution of this slot
+			_insert(_index);
+		}
+		else if (_node.interval)
+		{
+			this->_expired.push_back(_node.callback);
+			_node.expiry = this->_current_tick + _node.interval;
+			_insert(_index);
+		}
+		else
+		{
+			this->_expired.push_back(std::move(_node.callback));
+			_free_node(_index);
+			this->_active_timers.fetch_sub(1);
+		}
+		_index = _next;
+	}
+}
+
+void w_timing_wheel::_dispatch()
+{
+	if (this->_expired.empty()) return;
+
+	if (!this->_thread_pool || this->_expired.size() == 1)
+	{
+		for (auto& _callback : this->_expired)
+		{
+			_callback();
+		}
+		this->_expired.clear();
+		return;
+	}
+
+	//one job per chunk of callbacks, the batch is shared by all jobs
+	auto _batch = std::make_shared<std::vector<w_timer_callback_func>>();
+	_batch->swap(this->_expired);
+	this->_expired.reserve(_batch->capacity());
+
+	for (size_t _begin = 0; _begin < _batch->size(); _begin += s_dispatch_chunk)
+	{
+		const auto _end = std::min(_begin + s_dispatch_chunk, _batch->size());
+		this->_thread_pool->add_job([_batch, _begin, _end]()
+			{
+				for (auto i = _begin; i < _end; ++i)
+				{
+					(*_batch)[i]();
+				}
+			});
+	}
+}
+
+#pragma region Getters
+
+size_t w_timing_wheel::get_active_timers_count() const
+{
+	return this->_active_timers.load();
+}
+
+uint64_t w_timing_wheel::get_current_tick() const
+{
+	std::lock_guard<std::mutex> _lock(this->_mutex);
+	return this->_current_tick;
+}
+
+uint32_t w_timing_wheel::get_resolution_in_milliseconds() const
+{
+	return this->_resolution;
+}
+
+#pragma endregion
@@ -0,0 +1,136 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_timing_wheel.h
+	Description		 : A hierarchical timing wheel for scheduling large number of timers
+	Comment          : Four levels of 256 slots, schedule and cancel are O(1). Timers of a level are moved to finer levels
+					   when time reaches their slot. Expired callbacks of a tick are dispatched as a batch,
+					   on the driving thread or on a w_thread_pool
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include "w_signal.h"
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+namespace wolf::system
+{
+	class w_thread_pool;
+	class w_game_time;
+
+	//handle of a scheduled timer, zero is invalid
+	typedef uint64_t w_timer_handle;
+
+	enum w_timer_precision
+	{
+		//fires on the exact tick
+		W_TIMER_FINE = 0,
+		//fires at the boundary of its wheel level, never early and never moved between levels
+		W_TIMER_COARSE
+	};
+
+	class w_timing_wheel
+	{
+	public:
+		typedef w_inplace_function<void()> w_timer_callback_func;
+
+		WSYS_EXP w_timing_wheel();
+		WSYS_EXP ~w_timing_wheel();
+
+		/*
+			pResolutionInMilliseconds is the duration of a tick of the finest level.
+			If pThreadPool is not null, expired callbacks run on it, otherwise on the thread which advances the wheel
+		*/
+		WSYS_EXP W_RESULT initialize(
+			_In_ const uint32_t& pResolutionInMilliseconds = 1,
+			_In_opt_ w_thread_pool* pThreadPool = nullptr);
+
+		//schedule pCallback after pDelayInMilliseconds, repeat every pIntervalInMilliseconds if it is not zero. Thread safe
+		WSYS_EXP w_timer_handle schedule(
+			_In_ const uint64_t& pDelayInMilliseconds,
+			_In_ const w_timer_callback_func& pCallback,
+			_In_ const uint64_t& pIntervalInMilliseconds = 0,
+			_In_ const w_timer_precision& pPrecision = w_timer_precision::W_TIMER_FINE);
+		//returns false if timer was already fired or cancelled. Callbacks which are already dispatched can not be cancelled
+		WSYS_EXP bool cancel(_In_ const w_timer_handle& pHandle);
+
+		//advance the wheel by pTicks and dispatch expired timers, returns number of expired timers
+		WSYS_EXP size_t advance(_In_ const uint64_t& pTicks);
+		//advance the wheel to the steady clock
+		WSYS_EXP size_t update();
+		//advance the wheel to total time of pGameTime, do not mix it with update or the driver thread
+		WSYS_EXP size_t update(_In_ const w_game_time& pGameTime);
+
+		//run update on a dedicated driver thread
+		WSYS_EXP W_RESULT start();
+		WSYS_EXP void stop();
+		//stop driver thread and remove all timers
+		WSYS_EXP ULONG release();
+
+#pragma region Getters
+		WSYS_EXP size_t get_active_timers_count() const;
+		WSYS_EXP uint64_t get_current_tick() const;
+		WSYS_EXP uint32_t get_resolution_in_milliseconds() const;
+#pragma endregion
+
+	private:
+		//prevent copying
+		w_timing_wheel(w_timing_wheel const&);
+		w_timing_wheel& operator= (w_timing_wheel const&);
+
+		static constexpr uint32_t LEVELS = 4;
+		static constexpr uint32_t SLOT_BITS = 8;
+		static constexpr uint32_t SLOTS = 1 << SLOT_BITS;
+		static constexpr uint32_t INVALID = UINT32_MAX;
+
+		struct w_timer_node
+		{
+			w_timer_callback_func   callback;
+			uint64_t                expiry = 0;
+			uint64_t                interval = 0;
+			uint32_t                prev = INVALID;
+			uint32_t                next = INVALID;
+			uint32_t                slot = INVALID;
+			uint32_t                generation = 0;
+			bool                    coarse = false;
+		};
+
+		uint32_t _allocate_node();
+		void _free_node(_In_ const uint32_t& pIndex);
+		void _insert(_In_ const uint32_t& pIndex);
+		void _unlink(_In_ const uint32_t& pIndex);
+		void _cascade(_In_ const uint32_t& pLevel);
+		void _expire_slot(_In_ const uint32_t& pSlot);
+		void _dispatch();
+
+		//mutable, getters read the current tick under it
+		mutable std::mutex                          _mutex;
+		std::vector<w_timer_node>                   _nodes;
+		uint32_t                                    _free_list;
+		//first node of each slot of each level
+		std::vector<uint32_t>                       _heads;
+		//number of timers of each level, used for skipping empty ticks
+		size_t                                      _level_counts[LEVELS];
+		uint64_t                                    _current_tick;
+		std::atomic<size_t>                         _active_timers;
+
+		//callbacks which expired during the last advance
+		std::vector<w_timer_callback_func>          _expired;
+
+		uint32_t                                    _resolution;
+		w_thread_pool*                              _thread_pool;
+		std::chrono::steady_clock::time_point       _start_time;
+
+		std::thread                                 _driver;
+		std::atomic<bool>                           _is_running;
+		//serializes advance calls and dispatching
+		std::mutex                                  _advance_mutex;
+	};
+}
@@ -0,0 +1,478 @@
+#include "w_system_pch.h"
+#include "w_vfs.h"
+#include "w_archive.h"
+#include "w_convert.h"
+#include <atomic>
+#include <shared_mutex>
+#include <algorithm>
+#include <fstream>
+
+using namespace wolf::system;
+
+struct w_vfs_mount
+{
+	//normalized by s_normalize_path, empty means relative paths are relative to root of archive
+	std::string                     mount_point;
+	std::string                     archive_path;
+	std::shared_ptr<w_archive>      archive;
+};
+
+static std::shared_mutex            s_mutex;
+static std::vector<w_vfs_mount>     s_mounts;
+static std::atomic<bool>            s_has_mounts(false);
+#ifdef _DEBUG
+static std::atomic<bool>            s_loose_files_overlay(true);
+#else
+static std::atomic<bool>            s_loose_files_overlay(false);
+#endif
+
+//same as w_archive::normalize_path, but a leading separator is kept, so relative paths never match absolute mount points
+static std::string s_normalize_path(_In_z_ const char* pPath)
+{
+	auto _path = w_archive::normalize_path(pPath);
+	if (pPath && (pPath[0] == '/' || pPath[0] == '\\'))
+	{
+		_path.insert(_path.begin(), '/');
+	}
+	return _path;
+}
+
+//paths which start with a separator or a drive letter
+static bool s_is_absolute_path(_In_ const std::string& pNormalizedPath)
+{
+	return (!pNormalizedPath.empty() && pNormalizedPath[0] == '/') ||
+		(pNormalizedPath.size() > 1 && pNormalizedPath[1] == ':');
+}
+
+//io:: helpers resolve through w_vfs, so loose files are checked without them
+static bool s_is_loose_file(_In_z_ const char* pPath)
+{
+#if defined(__WIN32) || defined(__UWP)
+	const auto _attributes = GetFileAttributesW(convert::from_utf8(pPath).c_str());
+	return _attributes != INVALID_FILE_ATTRIBUTES && !(_attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+	struct stat _stat;
+	return stat(pPath, &_stat) == 0 && S_ISREG(_stat.st_mode);
+#endif
+}
+
+#pragma region w_vfs_file
+
+w_vfs_file::w_vfs_file() :
+	_entry(nullptr),
+	_data(nullptr),
+	_size(0),
+	_is_open(false)
+{
+}
+
+w_vfs_file::~w_vfs_file()
+{
+	close();
+}
+
+w_vfs_file::w_vfs_file(w_vfs_file&& pOther) noexcept : w_vfs_file()
+{
+	*this = std::move(pOther);
+}
+
+w_vfs_file& w_vfs_file::operator=(w_vfs_file&& pOther) noexcept
+{
+	if (this != &pOther)
+	{
+		close();
+		//buffers of vector and view of mapped file do not move, so data stays valid
+		this->_archive = std::move(pOther._archive);
+		this->_entry = pOther._entry;
+		this->_decompressed = std::move(pOther._decompressed);
+		this->_loose = std::move(pOther._loose);
+		this->_data = pOther._data;
+		this->_size = pOther._size;
+		this->_is_open = pOther._is_open;
+
+		pOther._entry = nullptr;
+		pOther._data = nullptr;
+		pOther._size = 0;
+		pOther._is_open = false;
+	}
+	return *this;
+}
+
+W_RESULT w_vfs_file::open(_In_z_ const char* pPath)
+{
+	if (!pPath) return W_INVALIDARG;
+	close();
+
+	if (w_vfs::open_packed(pPath, *this) == W_PASSED)
+	{
+		return W_PASSED;
+	}
+
+	if (this->_loose.open(pPath) != W_PASSED)
+	{
+		return W_FAILED;
+	}
+	this->_data = this->_loose.get_data();
+	this->_size = this->_loose.get_size();
+	this->_is_open = true;
+	return W_PASSED;
+}
+
+W_RESULT w_vfs_file::openW(_In_z_ const wchar_t* pPath)
+{
+	if (!pPath) return W_INVALIDARG;
+	return open(convert::to_utf8(pPath).c_str());
+}
+
+W_RESULT w_vfs_file::advise(_In_ const w_mapped_file_advice& pAdvice)
+{
+	if (!this->_is_open) return W_INVALIDARG;
+
+	if (this->_archive)
+	{
+		//decompressed entries are already in memory
+		return this->_decompressed.empty() ? this->_archive->advise(this->_entry, pAdvice) : W_PASSED;
+	}
+	return this->_loose.advise(pAdvice);
+}
+
+void w_vfs_file::close()
+{
+	this->_archive.reset();
+	this->_entry = nullptr;
+	this->_decompressed.clear();
+	this->_decompressed.shrink_to_fit();
+	this->_loose.close();
+	this->_data = nullptr;
+	this->_size = 0;
+	this->_is_open = false;
+}
+
+#pragma region Getters
+
+const char* w_vfs_file::get_data() const
+{
+	return this->_data;
+}
+
+size_t w_vfs_file::get_size() const
+{
+	return this->_size;
+}
+
+bool w_vfs_file::get_is_open() const
+{
+	return this->_is_open;
+}
+
+bool w_vfs_file::get_is_packed() const
+{
+	return this->_archive != nullptr;
+}
+
+#ifdef W_VFS_STRING_VIEW
+std::string_view w_vfs_file::get_view() const
+{
+	if (!this->_data) return std::string_view();
+	return std::string_view(this->_data, this->_size);
+}
+#endif
+
+#pragma endregion
+
+#pragma endregion
+
+#pragma region w_file_buffer
+
+w_file_buffer::w_file_buffer() :
+	_size(0)
+{
+}
+
+w_file_buffer::~w_file_buffer()
+{
+	release();
+}
+
+W_RESULT w_file_buffer::read(_In_z_ const char* pPath)
+{
+	if (!pPath) return W_INVALIDARG;
+	this->_size = 0;
+
+	//one byte for null terminator
+	if (w_vfs::read_packed(pPath, this->_buffer, this->_size, 1) == W_PASSED)
+	{
+		return W_PASSED;
+	}
+
+#if defined(__WIN32) || defined(__UWP)
+	std::ifstream _file(convert::from_utf8(pPath), std::ios::binary | std::ios::ate);
+#else
+	std::ifstream _file(pPath, std::ios::binary | std::ios::ate);
+#endif
+	if (!_file) return W_FAILED;
+
+	const auto _size = static_cast<size_t>(_file.tellg());
+	_file.seekg(0, std::ios::beg);
+
+	//grow only, memory of previous reads is reused
+	if (this->_buffer.size() < _size + 1)
+	{
+		this->_buffer.resize(_size + 1);
+	}
+	if (_size && !_file.read(this->_buffer.data(), static_cast<std::streamsize>(_size)))
+	{
+		return W_FAILED;
+	}
+	this->_buffer[_size] = '\0';
+	this->_size = _size;
+
+	return W_PASSED;
+}
+
+W_RESULT w_file_buffer::readW(_In_z_ const wchar_t* pPath)
+{
+	if (!pPath) return W_INVALIDARG;
+	return read(convert::to_utf8(pPath).c_str());
+}
+
+void w_file_buffer::release()
+{
+	this->_buffer.clear();
+	this->_buffer.shrink_to_fit();
+	this->_size = 0;
+}
+
+#pragma region Getters
+
+char* w_file_buffer::get_data()
+{
+	if (this->_buffer.empty()) return nullptr;
+	return this->_buffer.data();
+}
+
+size_t w_file_buffer::get_size() const
+{
+	return this->_size;
+}
+
+#ifdef W_VFS_STRING_VIEW
+std::string_view w_file_buffer::get_view() const
+{
+	if (this->_buffer.empty()) return std::string_view();
+	return std::string_view(this->_buffer.data(), this->_size);
+}
+#endif
+
+#pragma endregion
+
+#pragma endregion
+
+#pragma region w_vfs
+
+W_RESULT w_vfs::mount(_In_z_ const char* pArchivePath, _In_z_ const char* pMountPoint)
+{
+	if (!pArchivePath || !pMountPoint) return W_INVALIDARG;
+
+	auto _archive = std::make_shared<w_archive>();
+	if (_archive->open(pArchivePath) != W_PASSED)
+	{
+		logger.error("could not mount archive {}. trace info: w_vfs::mount", pArchivePath);
+		return W_FAILED;
+	}
+
+	std::unique_lock<std::shared_mutex> _lock(s_mutex);
+
+	//mounting again moves archive to top
+	s_mounts.erase(std::remove_if(s_mounts.begin(), s_mounts.end(), [pArchivePath](const w_vfs_mount& pMount)
+	{
+		return pMount.archive_path == pArchivePath;
+	}), s_mounts.end());
+
+	w_vfs_mount _mount;
+	_mount.mount_point = s_normalize_path(pMountPoint);
+	_mount.archive_path = pArchivePath;
+	_mount.archive = _archive;
+	s_mounts.push_back(std::move(_mount));
+	s_has_mounts.store(true);
+
+	return W_PASSED;
+}
+
+W_RESULT w_vfs::unmount(_In_z_ const char* pArchivePath)
+{
+	if (!pArchivePath) return W_INVALIDARG;
+
+	std::unique_lock<std::shared_mutex> _lock(s_mutex);
+
+	//opened files keep their archive until they are closed
+	const auto _size = s_mounts.size();
+	s_mounts.erase(std::remove_if(s_mounts.begin(), s_mounts.end(), [pArchivePath](const w_vfs_mount& pMount)
+	{
+		return pMount.archive_path == pArchivePath;
+	}), s_mounts.end());
+	s_has_mounts.store(!s_mounts.empty());
+
+	return _size == s_mounts.size() ? W_FAILED : W_PASSED;
+}
+
+void w_vfs::unmount_all()
+{
+	std::unique_lock<std::shared_mutex> _lock(s_mutex);
+	s_mounts.clear();
+	s_has_mounts.store(false);
+}
+
+bool w_vfs::_find(
+	_In_z_ const char* pPath,
+	_Inout_ std::shared_ptr<w_archive>& pArchive,
+	_Inout_ const w_archive_entry*& pEntry)
+{
+	if (!pPath || !s_has_mounts.load()) return false;
+
+	const auto _path = s_normalize_path(pPath);
+	const bool _is_absolute = s_is_absolute_path(_path);
+	{
+		std::shared_lock<std::shared_mutex> _lock(s_mutex);
+		for (auto _iter = s_mounts.rbegin(); _iter != s_mounts.rend(); ++_iter)
+		{
+			const auto& _mount_point = _iter->mount_point;
+			const char* _relative = _path.c_str();
+			if (_mount_point.empty())
+			{
+				if (_is_absolute) continue;
+			}
+			else
+			{
+				//root mount point "/" already ends with a separator
+				const bool _is_root = _mount_point.back() == '/';
+				if (_path.size() <= _mount_point.size() ||
+					_path.compare(0, _mount_point.size(), _mount_point) != 0 ||
+					(!_is_root && _path[_mount_point.size()] != '/')) continue;
+				_relative += _mount_point.size() + (_is_root ? 0 : 1);
+			}
+
+			auto _entry = _iter->archive->find(_relative);
+			if (_entry)
+			{
+				pArchive = _iter->archive;
+				pEntry = _entry;
+				break;
+			}
+		}
+	}
+	if (!pEntry) return false;
+
+	//only packed paths pay for checking the disk
+	if (s_loose_files_overlay.load() && s_is_loose_file(pPath))
+	{
+		pArchive.reset();
+		pEntry = nullptr;
+		return false;
+	}
+	return true;
+}
+
+W_RESULT w_vfs::open_packed(_In_z_ const char* pPath, _Inout_ w_vfs_file& pFile)
+{
+	pFile.close();
+
+	std::shared_ptr<w_archive> _archive;
+	const w_archive_entry* _entry = nullptr;
+	if (!_find(pPath, _archive, _entry)) return W_FAILED;
+
+	if (_entry->flags == W_ARCHIVE_ENTRY_STORED)
+	{
+		pFile._data = _archive->get_data(_entry);
+	}
+	else
+	{
+		pFile._decompressed.resize(static_cast<size_t>(_entry->original_size));
+		if (_archive->read(_entry, pFile._decompressed.data(), pFile._decompressed.size()) != W_PASSED)
+		{
+			pFile.close();
+			return W_FAILED;
+		}
+		pFile._data = pFile._decompressed.data();
+	}
+	pFile._size = static_cast<size_t>(_entry->original_size);
+	pFile._archive = _archive;
+	pFile._entry = _entry;
+	pFile._is_open = true;
+
+	return W_PASSED;
+}
+
+W_RESULT w_vfs::read_packed(
+	_In_z_ const char* pPath,
+	_Inout_ std::vector<char>& pBuffer,
+	_Out_ size_t& pSize,
+	_In_ const size_t& pPadding)
+{
+	pSize = 0;
+
+	std::shared_ptr<w_archive> _archive;
+	const w_archive_entry* _entry = nullptr;
+	if (!_find(pPath, _archive, _entry)) return W_FAILED;
+
+	const auto _size = static_cast<size_t>(_entry->original_size);
+	if (pBuffer.size() < _size + pPadding)
+	{
+		pBuffer.resize(_size + pPadding);
+	}
+	if (_archive->read(_entry, pBuffer.data(), _size) != W_PASSED)
+	{
+		return W_FAILED;
+	}
+	if (pPadding)
+	{
+		std::memset(pBuffer.data() + _size, 0, pPadding);
+	}
+	pSize = _size;
+
+	return W_PASSED;
+}
+
+W_RESULT w_vfs::get_is_packed(_In_z_ const char* pPath)
+{
+	std::shared_ptr<w_archive> _archive;
+	const w_archive_entry* _entry = nullptr;
+	return _find(pPath, _archive, _entry) ? W_PASSED : W_FAILED;
+}
+
+W_RESULT w_vfs::get_packed_size(_In_z_ const char* pPath, _Out_ uint64_t& pSize)
+{
+	pSize = 0;
+
+	std::shared_ptr<w_archive> _archive;
+	const w_archive_entry* _entry = nullptr;
+	if (!_find(pPath, _archive, _entry)) return W_FAILED;
+
+	pSize = _entry->original_size;
+	return W_PASSED;
+}
+
+#pragma region Getters
+
+bool w_vfs::get_has_mounts()
+{
+	return s_has_mounts.load();
+}
+
+bool w_vfs::get_loose_files_overlay()
+{
+	return s_loose_files_overlay.load();
+}
+
+#pragma endregion
+
+#pragma region Setters
+
+void w_vfs::set_loose_files_overlay(_In_ const bool& pEnable)
+{
+	s_loose_files_overlay.store(pEnable);
+}
+
+#pragma endregion
+
+#pragma endregion
@@ -0,0 +1,157 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (https://PooyaEimandar.github.io) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/WolfEngine/Wolf.Engine/issues
+	Website			 : https://WolfEngine.App
+	Name			 : w_vfs.h
+	Description		 : Virtual file system, entries of mounted archives are resolved by the same paths as loose files
+	Comment          : Archives are mounted on a directory (e.g. content path), the last mounted archive wins.
+					   With loose files overlay, files on disk hide entries of archives, it is enabled on debug builds.
+					   io:: helpers resolve through it while an archive is mounted.
+					   w_vfs_file is a read only view, w_file_buffer is a mutable copy for in situ parsers
+*/
+
+#pragma once
+
+#include "w_system_export.h"
+#include "w_std.h"
+#include "w_mapped_file.h"
+#include <memory>
+#include <vector>
+
+//w_io.h includes this header and it is used by C++14 projects too, views are declared for C++17
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define W_VFS_STRING_VIEW
+#endif
+
+namespace wolf::system
+{
+	class w_archive;
+	struct w_archive_entry;
+
+	//a file which is opened through w_vfs, data is in place for stored entries and loose files
+	class w_vfs_file
+	{
+		friend class w_vfs;
+	public:
+		WSYS_EXP w_vfs_file();
+		WSYS_EXP ~w_vfs_file();
+
+		WSYS_EXP w_vfs_file(w_vfs_file&& pOther) noexcept;
+		WSYS_EXP w_vfs_file& operator=(w_vfs_file&& pOther) noexcept;
+
+		//open from mounted archives, otherwise map the loose file
+		WSYS_EXP W_RESULT open(_In_z_ const char* pPath);
+		WSYS_EXP W_RESULT openW(_In_z_ const wchar_t* pPath);
+
+		WSYS_EXP W_RESULT advise(_In_ const w_mapped_file_advice& pAdvice);
+
+		//it is called by destructor, data is not valid after it
+		WSYS_EXP void close();
+
+#pragma region Getters
+		WSYS_EXP const char* get_data() const;
+		WSYS_EXP size_t get_size() const;
+		WSYS_EXP bool get_is_open() const;
+		//true if it was found in an archive
+		WSYS_EXP bool get_is_packed() const;
+#ifdef W_VFS_STRING_VIEW
+		//valid until the file is closed
+		WSYS_EXP std::string_view get_view() const;
+#endif
+#pragma endregion
+
+	private:
+		//Prevent copying
+		w_vfs_file(w_vfs_file const&);
+		w_vfs_file& operator= (w_vfs_file const&);
+
+		//keeps archive mapped while the entry is used
+		std::shared_ptr<w_archive>      _archive;
+		const w_archive_entry*          _entry;
+		//compressed entries
+		std::vector<char>               _decompressed;
+		w_mapped_file                   _loose;
+		const char*                     _data;
+		size_t                          _size;
+		bool                            _is_open;
+	};
+
+	/*
+		a mutable and null terminated copy of a file for in situ parsers, it is the only copy which is made.
+		Memory is kept for next reads, data and views are valid until the next read or release
+	*/
+	class w_file_buffer
+	{
+	public:
+		WSYS_EXP w_file_buffer();
+		WSYS_EXP ~w_file_buffer();
+
+		//read from mounted archives, otherwise from disk
+		WSYS_EXP W_RESULT read(_In_z_ const char* pPath);
+		WSYS_EXP W_RESULT readW(_In_z_ const wchar_t* pPath);
+
+		//free memory
+		WSYS_EXP void release();
+
+#pragma region Getters
+		//null terminated, nullptr before the first read
+		WSYS_EXP char* get_data();
+		WSYS_EXP size_t get_size() const;
+#ifdef W_VFS_STRING_VIEW
+		WSYS_EXP std::string_view get_view() const;
+#endif
+#pragma endregion
+
+	private:
+		//Prevent copying
+		w_file_buffer(w_file_buffer const&);
+		w_file_buffer& operator= (w_file_buffer const&);
+
+		std::vector<char>               _buffer;
+		size_t                          _size;
+	};
+
+	class w_vfs
+	{
+	public:
+		//entries of archive become visible under pMountPoint, relative and absolute paths only match mount points of their own kind
+		WSYS_EXP static W_RESULT mount(_In_z_ const char* pArchivePath, _In_z_ const char* pMountPoint);
+		WSYS_EXP static W_RESULT unmount(_In_z_ const char* pArchivePath);
+		WSYS_EXP static void unmount_all();
+
+		//open an entry of mounted archives, returns W_FAILED if it is not packed or a loose file hides it
+		WSYS_EXP static W_RESULT open_packed(_In_z_ const char* pPath, _Inout_ w_vfs_file& pFile);
+
+		/*
+			copy or decompress an entry of mounted archives to pBuffer, which is grown for its size and pPadding zeros.
+			Returns W_FAILED if it is not packed or a loose file hides it
+		*/
+		WSYS_EXP static W_RESULT read_packed(
+			_In_z_ const char* pPath,
+			_Inout_ std::vector<char>& pBuffer,
+			_Out_ size_t& pSize,
+			_In_ const size_t& pPadding = 0);
+
+		//W_PASSED if the path is an entry of mounted archives
+		WSYS_EXP static W_RESULT get_is_packed(_In_z_ const char* pPath);
+		//original size of entry, W_FAILED if it is not packed
+		WSYS_EXP static W_RESULT get_packed_size(_In_z_ const char* pPath, _Out_ uint64_t& pSize);
+
+#pragma region Getters
+		//true while at least one archive is mounted, io:: helpers skip archives otherwise
+		WSYS_EXP static bool get_has_mounts();
+		WSYS_EXP static bool get_loose_files_overlay();
+#pragma endregion
+
+#pragma region Setters
+		WSYS_EXP static void set_loose_files_overlay(_In_ const bool& pEnable);
+#pragma endregion
+
+	private:
+		static bool _find(
+			_In_z_ const char* pPath,
+			_Inout_ std::shared_ptr<w_archive>& pArchive,
+			_Inout_ const w_archive_entry*& pEntry);
+	};
+}
@@ -62,6 +62,34 @@ W_RESULT w_xml::save(_In_z_ const char* pPath,
 	return W_PASSED;
 }
 
+W_RESULT w_xml::load(_In_z_ const char* pPath, _Inout_ w_file_buffer& pBuffer, _Inout_ xml_document<>& pDoc)
+{
+	if (!pPath) return W_INVALIDARG;
+
+	if (pBuffer.read(pPath) != W_PASSED)
+	{
+		logger.error("could not read xml file {}. trace info: w_xml::load", pPath);
+		return W_FAILED;
+	}
+
+	try
+	{
+		pDoc.parse<0>(pBuffer.get_data());
+	}
+	catch (const parse_error& pError)
+	{
+		logger.error("could not parse xml file {}, {}. trace info: w_xml::load", pPath, pError.what());
+		return W_FAILED;
+	}
+	return W_PASSED;
+}
+
+W_RESULT w_xml::loadW(_In_z_ const wchar_t* pPath, _Inout_ w_file_buffer& pBuffer, _Inout_ xml_document<>& pDoc)
+{
+	if (!pPath) return W_INVALIDARG;
+	return load(convert::to_utf8(pPath).c_str(), pBuffer, pDoc);
+}
+
 void w_xml::_write_element(_In_ w_xml_data& pData, _In_ xml_document<wchar_t>& pDoc, _Inout_ xml_node<wchar_t>** pParentNode)
 {
 	auto _node = pDoc.allocate_node(node_element, pData.node.c_str());
@@ -13,6 +13,7 @@
 #include "rapidxml/rapidxml.hpp"
 #include <string>
 #include "w_std.h"
+#include "w_vfs.h"
 
 namespace wolf::system
 {
@@ -42,6 +43,10 @@ namespace wolf::system
 #endif
 			_In_ const bool& pUTF_8, _In_ wolf::system::w_xml_data & pData, _In_z_ const std::wstring pPreComment = L"");
 
+		//read file into pBuffer and parse it in situ, names and values of nodes point into pBuffer
+		WSYS_EXP static W_RESULT load(_In_z_ const char* pPath, _Inout_ w_file_buffer& pBuffer, _Inout_ rapidxml::xml_document<>& pDoc);
+		WSYS_EXP static W_RESULT loadW(_In_z_ const wchar_t* pPath, _Inout_ w_file_buffer& pBuffer, _Inout_ rapidxml::xml_document<>& pDoc);
+
 		//get xml node value
 		WSYS_EXP static const std::string	get_node_value(_In_ rapidxml::xml_node<> * pNode);
 		//get xml node attribute value
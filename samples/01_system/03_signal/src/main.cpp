@@ -48,7 +48,7 @@ WOLF_MAIN()
             //send message
             _sender.id = _number_of_messages;
             _sender.message = "hello with id: " + std::to_string(_number_of_messages);
-            _signal.emit(_sender);
+            _signal.rise(_sender);
             
             //decrease number of messages
             _number_of_messages--;
@@ -74,18 +74,12 @@ WOLF_MAIN()
     
     if(w_xml::save(_path, _save_as_utf8, _root, L"<!-- Sample XML -->") == W_PASSED)
     {
-            //Successfully saved, now load it again
-            std::ifstream _file("test.xml");
-            std::stringstream _string_stream;
-            _string_stream << _file.rdbuf();
-            _file.close();
-            std::string _content(_string_stream.str());
-        
+            //Successfully saved, now load it again, it is parsed in situ and nodes point into the buffer
             using namespace rapidxml;
+            w_file_buffer _buffer;
             xml_document<> _doc;
-            try
+            if (w_xml::load("test.xml", _buffer, _doc) == W_PASSED)
             {
-                _doc.parse<0>(&_content[0]);
                 auto _node = _doc.first_node();
                 if (_node)
                 {
@@ -97,7 +91,7 @@ WOLF_MAIN()
                 }
                 _doc.clear();
             }
-            catch (...)
+            else
             {
                 logger.error(L"Could not parse xml file");
             }
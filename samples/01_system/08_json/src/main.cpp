@@ -56,16 +56,13 @@ WOLF_MAIN()
     auto _str = _string_buffer.GetString();
     logger.write(_str);
     
-    //read it again
+    //read it again, the copy is parsed in situ and strings of document point into it
     Document _doc;
 
-    auto _buffer = new char[_size];
-    memcpy(&_buffer[0], &_str[0], _size);
-
-	auto _parse = &_doc.Parse<rapidjson::kParseStopWhenDoneFlag>(_buffer);
-    if (_parse->HasParseError())
+    std::vector<char> _buffer(_str, _str + _size + 1);
+    if (w_json::parse(_buffer.data(), _doc) == W_FAILED)
     {
-        logger.error("error on parsing json. error code: {}", _parse->GetParseError());
+        logger.error("error on parsing json. error code: {}", _doc.GetParseError());
     }
     else
     {
@@ -68,7 +68,20 @@ WOLF_MAIN()
         logger.write("{}", _new_f[i].number);
         logger.write(_new_f[i].name);
     }
-    
+
+    //fixed size blocks for objects which are created and destroyed frequently
+    w_fixed_memory_pool _pool;
+    _pool.initialize(sizeof(my_struct));
+
+    auto _item = _pool.create<my_struct>();
+    _item->number = 7;
+    logger.write("{}", _item->number);
+    _pool.destroy(_item);
+
+    auto _stats = _pool.get_statistics();
+    logger.write("slabs: {} used blocks: {}", _stats.slabs, _stats.used_blocks);
+    _pool.release();
+
     logger.release();
 
 	return EXIT_SUCCESS;
@@ -0,0 +1,583 @@
+/*
+	Project			 : Wolf Engine. Copyright(c) Pooya Eimandar (http://PooyaEimandar.com) . All rights reserved.
+	Source			 : Please direct any bug to https://github.com/PooyaEimandar/Wolf.Engine/issues
+	Website			 : http://WolfSource.io
+	Name			 : main.cpp
+	Description		 : This sample benchmarks every codec of w_compress on files of content and on packed scenes
+	Comment          : usage: 24_compress_benchmark [--content path] [--format table|csv|json] [--iterations n]
+					   [--codecs lz4_fast,lzma,...] [--pack-size MB]
+					   Throughput is in MB/s (10^6 bytes) of decompressed data, the best of all iterations is kept.
+					   Peak memory is the growth of resident memory over a round trip, it is only reset on linux
+*/
+
+#include "pch.h"
+#include <w_io.h>
+#include <w_compress.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <thread>
+
+#ifdef __WIN32
+#include <psapi.h>
+#endif
+
+//namespaces
+using namespace wolf;
+using namespace wolf::system;
+
+//a file of content, or a packed scene which was decompressed from a .wscene file
+struct w_asset
+{
+	std::string             name;
+	std::string             asset_class;
+	std::string             data;
+};
+
+typedef W_RESULT(*w_encode_fn)(_In_ const std::string& pSrc, _Inout_ w_compress_result& pCompressed);
+//pDecompressed->size_out is the expected size
+typedef W_RESULT(*w_decode_fn)(_In_ const w_compress_result& pCompressed, _Inout_ w_compress_result& pDecompressed);
+
+struct w_codec_case
+{
+	const char*             name;
+	w_encode_fn             encode;
+	w_decode_fn             decode;
+};
+
+struct w_benchmark_row
+{
+	std::string             codec;
+	std::string             asset_class;
+	size_t                  files = 0;
+	size_t                  size_in = 0;
+	size_t                  size_out = 0;
+	double                  compress_seconds = 0;
+	double                  decompress_seconds = 0;
+	size_t                  peak_memory = 0;
+	bool                    passed = true;
+};
+
+#pragma region memory
+
+//reset peak of resident memory, only linux supports it
+static void _reset_peak_memory()
+{
+#if defined(__linux) && !defined(__ANDROID)
+	std::ofstream _clear_refs("/proc/self/clear_refs");
+	if (_clear_refs) _clear_refs << "5";
+#endif
+}
+
+//current and peak resident memory of process in bytes
+static void _get_memory(_Inout_ size_t& pResident, _Inout_ size_t& pPeak)
+{
+	pResident = 0;
+	pPeak = 0;
+#if defined(__WIN32)
+	PROCESS_MEMORY_COUNTERS _counters = {};
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &_counters, sizeof(_counters)))
+	{
+		pResident = _counters.WorkingSetSize;
+		pPeak = _counters.PeakWorkingSetSize;
+	}
+#elif defined(__linux) && !defined(__ANDROID)
+	std::ifstream _status("/proc/self/status");
+	std::string _line;
+	while (std::getline(_status, _line))
+	{
+		//values are in kB
+		if (_line.compare(0, 6, "VmRSS:") == 0) pResident = std::strtoull(_line.c_str() + 6, nullptr, 10) * 1024;
+		else if (_line.compare(0, 6, "VmHWM:") == 0) pPeak = std::strtoull(_line.c_str() + 6, nullptr, 10) * 1024;
+	}
+#endif
+}
+
+#pragma endregion
+
+#pragma region codecs
+
+//destination of w_lz4_stream_writer in memory
+struct w_memory_writer
+{
+	w_compress_result*      result;
+	size_t                  capacity;
+
+	static size_t write(void* pUserData, const char* pData, size_t pSize)
+	{
+		//grow like a vector, stream writes arrive in small chunks
+		auto _writer = static_cast<w_memory_writer*>(pUserData);
+		auto _result = _writer->result;
+		if (_result->size_out + pSize > _writer->capacity)
+		{
+			auto _capacity = std::max(_writer->capacity * 2, _result->size_out + pSize);
+			auto _data = static_cast<char*>(realloc(_result->data, _capacity));
+			if (!_data) return 0;
+			_result->data = _data;
+			_writer->capacity = _capacity;
+		}
+		std::memcpy(_result->data + _result->size_out, pData, pSize);
+		_result->size_out += pSize;
+		return pSize;
+	}
+};
+
+static W_RESULT _encode_lz4(const std::string& pSrc, w_compress_result& pCompressed, w_compress_mode pMode, int pAcceleration)
+{
+	pCompressed.size_in = pSrc.size();
+	return w_compress::compress_lz4(pSrc.data(), &pCompressed, pMode, pAcceleration);
+}
+
+static W_RESULT _encode_lz4_fast(const std::string& pSrc, w_compress_result& pCompressed)
+{
+	return _encode_lz4(pSrc, pCompressed, w_compress_mode::W_FAST, 8);
+}
+
+static W_RESULT _encode_lz4_default(const std::string& pSrc, w_compress_result& pCompressed)
+{
+	return _encode_lz4(pSrc, pCompressed, w_compress_mode::W_DEFAULT, 1);
+}
+
+static W_RESULT _encode_lz4_hc(const std::string& pSrc, w_compress_result& pCompressed)
+{
+	return _encode_lz4(pSrc, pCompressed, w_compress_mode::W_HIGH, W_COMPRESS_HC_LEVEL_DEFAULT);
+}
+
+static W_RESULT _encode_lz4_frame(const std::string& pSrc, w_compress_result& pCompressed)
+{
+	w_memory_writer _memory = { &pCompressed, 0 };
+	w_lz4_stream_writer _writer;
+	auto _hr = _writer.begin(w_memory_writer::write, &_memory);
+	if (_hr != W_PASSED) return _hr;
+	_writer.write(pSrc.data(), pSrc.size());
+
+	//sizes of frame go to another result, data is already in pCompressed
+	w_compress_result _frame = {};
+	_hr = _writer.end(&_frame);
+	pCompressed.size_in = _frame.size_in;
+	pCompressed.codec = _frame.codec;
+	return _hr;
+}
+
+static W_RESULT _encode_lz4_parallel(const std::string& pSrc, w_compress_result& pCompressed)
+{
+	pCompressed.size_in = pSrc.size();
+	return w_compress::compress_lz4_parallel(pSrc.data(), &pCompressed);
+}
+
+static W_RESULT _encode_lz4_hc_parallel(const std::string& pSrc, w_compress_result& pCompressed)
+{
+	pCompressed.size_in = pSrc.size();
+	return w_compress::compress_lz4_parallel(pSrc.data(), &pCompressed, w_compress_mode::W_HIGH, W_COMPRESS_HC_LEVEL_DEFAULT);
+}
+
+static W_RESULT _encode_lzma(const std::string& pSrc, w_compress_result& pCompressed)
+{
+	pCompressed.size_in = pSrc.size();
+	return w_compress::compress_lzma(reinterpret_cast<const uint8_t*>(pSrc.data()), &pCompressed);
+}
+
+static W_RESULT _encode_lzma_parallel(const std::string& pSrc, w_compress_result& pCompressed)
+{
+	pCompressed.size_in = pSrc.size();
+	return w_compress::compress_lzma_parallel(pSrc.data(), &pCompressed);
+}
+
+//same path which loaders use, codec comes from result of compress
+static W_RESULT _decode(const w_compress_result& pCompressed, w_compress_result& pDecompressed)
+{
+	pDecompressed.size_in = pCompressed.size_out;
+	pDecompressed.codec = pCompressed.codec;
+	return w_compress::decompress(pCompressed.data, &pDecompressed);
+}
+
+//reads frame in chunks into a buffer of known size, like loaders which stream from disk
+static W_RESULT _decode_lz4_frame(const w_compress_result& pCompressed, w_compress_result& pDecompressed)
+{
+	//one more byte, so a frame which is larger than expected is caught, and the end of frame is always read
+	const auto _capacity = pDecompressed.size_out + 1;
+	pDecompressed.data = static_cast<char*>(malloc(_capacity));
+	pDecompressed.size_out = 0;
+	if (!pDecompressed.data) return W_OUTOFMEMORY;
+
+	w_compress_memory_reader _memory = { pCompressed.data, pCompressed.size_out };
+	w_lz4_stream_reader _reader;
+	auto _hr = _reader.begin(w_compress_memory_reader::read, &_memory);
+	if (_hr != W_PASSED) return _hr;
+
+	const size_t _chunk_size = 64 * 1024;
+	size_t _read_size;
+	do
+	{
+		_read_size = _reader.read(pDecompressed.data + pDecompressed.size_out, std::min(_chunk_size, _capacity - pDecompressed.size_out));
+		pDecompressed.size_out += _read_size;
+	} while (_read_size && pDecompressed.size_out < _capacity);
+
+	return _reader.end();
+}
+
+static const w_codec_case s_codecs[] =
+{
+	{ "lz4_fast", _encode_lz4_fast, _decode },
+	{ "lz4_default", _encode_lz4_default, _decode },
+	{ "lz4_hc", _encode_lz4_hc, _decode },
+	{ "lz4_frame", _encode_lz4_frame, _decode_lz4_frame },
+	{ "lz4_parallel", _encode_lz4_parallel, _decode },
+	{ "lz4_hc_parallel", _encode_lz4_hc_parallel, _decode },
+	{ "lzma", _encode_lzma, _decode },
+	{ "lzma_parallel", _encode_lzma_parallel, _decode },
+};
+
+#pragma endregion
+
+#pragma region assets
+
+static bool _read_file(_In_ const std::string& pPath, _Inout_ std::string& pData)
+{
+	std::ifstream _file(pPath, std::ios::binary | std::ios::ate);
+	if (!_file) return false;
+
+	pData.resize(static_cast<size_t>(_file.tellg()));
+	_file.seekg(0, std::ios::beg);
+	return static_cast<bool>(_file.read(&pData[0], pData.size()));
+}
+
+//class of asset is the first folder of content, e.g. shaders or textures
+static void _collect_assets(
+	_In_ const std::string& pRoot,
+	_In_ const std::string& pRelativePath,
+	_Inout_ std::vector<w_asset>& pAssets)
+{
+	std::vector<std::string> _names;
+	io::get_files_folders_in_directory(pRoot + pRelativePath, _names);
+	std::sort(_names.begin(), _names.end());
+
+	for (auto& _name : _names)
+	{
+		if (_name == "." || _name == "..") continue;
+
+		const auto _relative_path = pRelativePath.empty() ? _name : pRelativePath + "/" + _name;
+		const auto _path = pRoot + _relative_path;
+		if (io::get_is_directory(_path.c_str()) == W_PASSED)
+		{
+			_collect_assets(pRoot, _relative_path, pAssets);
+			continue;
+		}
+
+		w_asset _asset;
+		if (!_read_file(_path, _asset.data) || _asset.data.empty()) continue;
+
+		_asset.name = _relative_path;
+		if (io::get_file_extention(_name) == ".wscene")
+		{
+			//packed scenes are compressed already, benchmark the msgpack data which content pipeline compresses
+			w_compress_result _scene = {};
+			_scene.size_in = _asset.data.size();
+			_scene.codec = w_compress::get_codec(_asset.data.data(), _asset.data.size());
+			if (_scene.codec == W_CODEC_UNKNOWN) _scene.codec = W_CODEC_LZ4;
+			if (w_compress::decompress(_asset.data.data(), &_scene) != W_PASSED)
+			{
+				logger.warning("could not decompress scene {}", _path);
+				continue;
+			}
+			_asset.data.assign(_scene.data, _scene.size_out);
+			free(_scene.data);
+			_asset.asset_class = "wscene";
+		}
+		else
+		{
+			auto _separator = _relative_path.find('/');
+			_asset.asset_class = _separator == std::string::npos ? "root" : _relative_path.substr(0, _separator);
+		}
+		pAssets.push_back(std::move(_asset));
+	}
+}
+
+//one large pack made of all scenes, scenes of big levels do not fit in the few MB of sample models
+static bool _generate_scene_pack(_In_ const size_t& pSize, _Inout_ std::vector<w_asset>& pAssets)
+{
+	w_asset _pack;
+	_pack.name = "generated.wscene";
+	_pack.asset_class = "wscene_pack";
+	while (_pack.data.size() < pSize)
+	{
+		auto _size = _pack.data.size();
+		for (auto& _asset : pAssets)
+		{
+			if (_asset.asset_class == "wscene") _pack.data += _asset.data;
+		}
+		if (_pack.data.size() == _size) return false;
+	}
+	_pack.data.resize(pSize);
+	pAssets.push_back(std::move(_pack));
+	return true;
+}
+
+static std::string _find_content_directory()
+{
+	std::string _path = "content/";
+	for (int i = 0; i < 6; ++i)
+	{
+		if (io::get_is_directory(_path.c_str()) == W_PASSED) return _path;
+		_path = "../" + _path;
+	}
+	return "";
+}
+
+#pragma endregion
+
+#pragma region reports
+
+static double _mb_per_second(_In_ const size_t& pSize, _In_ const double& pSeconds)
+{
+	return pSeconds > 0 ? static_cast<double>(pSize) / 1e6 / pSeconds : 0;
+}
+
+static double _ratio(_In_ const w_benchmark_row& pRow)
+{
+	return pRow.size_out ? static_cast<double>(pRow.size_in) / static_cast<double>(pRow.size_out) : 0;
+}
+
+static void _print_table(_In_ const std::vector<w_benchmark_row>& pRows)
+{
+	printf("%-16s %-12s %6s %12s %12s %8s %12s %12s %10s %s\n",
+		"codec", "class", "files", "size", "compressed", "ratio", "comp MB/s", "decomp MB/s", "peak MB", "");
+	for (auto& _row : pRows)
+	{
+		printf("%-16s %-12s %6zu %12zu %12zu %8.3f %12.1f %12.1f %10.1f %s\n",
+			_row.codec.c_str(),
+			_row.asset_class.c_str(),
+			_row.files,
+			_row.size_in,
+			_row.size_out,
+			_ratio(_row),
+			_mb_per_second(_row.size_in, _row.compress_seconds),
+			_mb_per_second(_row.size_in, _row.decompress_seconds),
+			static_cast<double>(_row.peak_memory) / 1e6,
+			_row.passed ? "" : "FAILED");
+	}
+}
+
+static void _print_csv(_In_ const std::vector<w_benchmark_row>& pRows)
+{
+	printf("codec,class,files,size_in,size_out,ratio,compress_mb_per_sec,decompress_mb_per_sec,peak_memory_bytes,passed\n");
+	for (auto& _row : pRows)
+	{
+		printf("%s,%s,%zu,%zu,%zu,%.4f,%.2f,%.2f,%zu,%d\n",
+			_row.codec.c_str(),
+			_row.asset_class.c_str(),
+			_row.files,
+			_row.size_in,
+			_row.size_out,
+			_ratio(_row),
+			_mb_per_second(_row.size_in, _row.compress_seconds),
+			_mb_per_second(_row.size_in, _row.decompress_seconds),
+			_row.peak_memory,
+			_row.passed ? 1 : 0);
+	}
+}
+
+static std::string _json_string(_In_ const std::string& pValue)
+{
+	std::string _str = "\"";
+	for (auto _c : pValue)
+	{
+		if (_c == '"' || _c == '\\') _str += '\\';
+		_str += _c;
+	}
+	return _str + "\"";
+}
+
+static void _print_json(
+	_In_ const std::vector<w_benchmark_row>& pRows,
+	_In_ const std::string& pContentDirectory,
+	_In_ const int& pIterations)
+{
+	printf("{\n\t\"version\": \"%d.%d.%d.%d\",\n", WOLF_MAJOR_VERSION, WOLF_MINOR_VERSION, WOLF_PATCH_VERSION, WOLF_DEBUG_VERSION);
+	printf("\t\"content\": %s,\n", _json_string(pContentDirectory).c_str());
+	printf("\t\"threads\": %u,\n\t\"iterations\": %d,\n\t\"results\": [\n", std::thread::hardware_concurrency(), pIterations);
+	for (size_t i = 0; i < pRows.size(); ++i)
+	{
+		auto& _row = pRows[i];
+		printf("\t\t{ \"codec\": %s, \"class\": %s, \"files\": %zu, \"size_in\": %zu, \"size_out\": %zu, \"ratio\": %.4f, "
+			"\"compress_mb_per_sec\": %.2f, \"decompress_mb_per_sec\": %.2f, \"peak_memory_bytes\": %zu, \"passed\": %s }%s\n",
+			_json_string(_row.codec).c_str(),
+			_json_string(_row.asset_class).c_str(),
+			_row.files,
+			_row.size_in,
+			_row.size_out,
+			_ratio(_row),
+			_mb_per_second(_row.size_in, _row.compress_seconds),
+			_mb_per_second(_row.size_in, _row.decompress_seconds),
+			_row.peak_memory,
+			_row.passed ? "true" : "false",
+			i + 1 < pRows.size() ? "," : "");
+	}
+	printf("\t]\n}\n");
+}
+
+#pragma endregion
+
+//compress and decompress pAsset pIterations times, returns false if data did not survive the round trip
+static bool _run(
+	_In_ const w_codec_case& pCodec,
+	_In_ const w_asset& pAsset,
+	_In_ const int& pIterations,
+	_Inout_ w_benchmark_row& pRow)
+{
+	typedef std::chrono::steady_clock w_clock;
+
+	double _compress_seconds = 0;
+	double _decompress_seconds = 0;
+	size_t _peak_memory = 0;
+	size_t _size_out = 0;
+
+	for (int i = 0; i < pIterations; ++i)
+	{
+		size_t _resident, _peak;
+		_reset_peak_memory();
+		_get_memory(_resident, _peak);
+
+		w_compress_result _compressed = {};
+		auto _t0 = w_clock::now();
+		auto _hr = pCodec.encode(pAsset.data, _compressed);
+		auto _t1 = w_clock::now();
+
+		w_compress_result _decompressed = {};
+		_decompressed.size_out = pAsset.data.size();
+		if (_hr == W_PASSED) _hr = pCodec.decode(_compressed, _decompressed);
+		auto _t2 = w_clock::now();
+
+		size_t _resident_after, _peak_after;
+		_get_memory(_resident_after, _peak_after);
+
+		auto _passed = _hr == W_PASSED &&
+			_decompressed.size_out == pAsset.data.size() &&
+			std::memcmp(_decompressed.data, pAsset.data.data(), pAsset.data.size()) == 0;
+		_size_out = _compressed.size_out;
+		free(_compressed.data);
+		free(_decompressed.data);
+
+		if (!_passed)
+		{
+			logger.error("{} failed on {}", pCodec.name, pAsset.name);
+			return false;
+		}
+
+		auto _compress = std::chrono::duration<double>(_t1 - _t0).count();
+		auto _decompress = std::chrono::duration<double>(_t2 - _t1).count();
+		if (i == 0 || _compress < _compress_seconds) _compress_seconds = _compress;
+		if (i == 0 || _decompress < _decompress_seconds) _decompress_seconds = _decompress;
+		if (_peak_after > _resident) _peak_memory = std::max(_peak_memory, _peak_after - _resident);
+	}
+
+	pRow.files++;
+	pRow.size_in += pAsset.data.size();
+	pRow.size_out += _size_out;
+	pRow.compress_seconds += _compress_seconds;
+	pRow.decompress_seconds += _decompress_seconds;
+	pRow.peak_memory = std::max(pRow.peak_memory, _peak_memory);
+	return true;
+}
+
+WOLF_MAIN()
+{
+#ifdef __WIN32
+	auto pArgc = __argc;
+	auto pArgv = __argv;
+#endif
+
+	std::string _content_directory;
+	std::string _format = "table";
+	std::string _codecs;
+	int _iterations = 3;
+	size_t _pack_size = 64;
+	for (int i = 1; i + 1 < pArgc; i += 2)
+	{
+		std::string _arg = pArgv[i];
+		if (_arg == "--content") _content_directory = pArgv[i + 1];
+		else if (_arg == "--format") _format = pArgv[i + 1];
+		else if (_arg == "--codecs") _codecs = "," + std::string(pArgv[i + 1]) + ",";
+		else if (_arg == "--iterations") _iterations = std::max(1, atoi(pArgv[i + 1]));
+		else if (_arg == "--pack-size") _pack_size = static_cast<size_t>(std::max(0, atoi(pArgv[i + 1])));
+	}
+
+	w_logger_config _log_config;
+	_log_config.app_name = L"24_compress_benchmark";
+	_log_config.log_path = wolf::system::io::get_current_directoryW();
+	//keep std out clean for machine readable formats
+#ifdef __WIN32
+	_log_config.log_to_std_out = false;
+#else
+	_log_config.log_to_std_out = _format == "table";
+#endif
+	logger.initialize(_log_config);
+
+	if (_content_directory.empty()) _content_directory = _find_content_directory();
+	if (!_content_directory.empty() && _content_directory.back() != '/' && _content_directory.back() != '\\')
+	{
+		_content_directory += "/";
+	}
+
+	std::vector<w_asset> _assets;
+	if (!_content_directory.empty()) _collect_assets(_content_directory, "", _assets);
+	if (_assets.empty())
+	{
+		logger.error("could not find any file in content directory \"{}\", use --content", _content_directory);
+		logger.release();
+		return EXIT_FAILURE;
+	}
+	if (_pack_size && !_generate_scene_pack(_pack_size * 1024 * 1024, _assets))
+	{
+		logger.warning("there is no .wscene in content, scene pack was not generated");
+	}
+	logger.write("benchmarking {} files of {}", _assets.size(), _content_directory);
+
+	//rows of each codec are sorted by class, all is the sum of every class
+	std::vector<w_benchmark_row> _rows;
+	bool _passed = true;
+	for (auto& _codec : s_codecs)
+	{
+		if (!_codecs.empty() && _codecs.find("," + std::string(_codec.name) + ",") == std::string::npos) continue;
+
+		std::map<std::string, w_benchmark_row> _classes;
+		w_benchmark_row _all;
+		_all.codec = _codec.name;
+		_all.asset_class = "all";
+		for (auto& _asset : _assets)
+		{
+			auto& _row = _classes[_asset.asset_class];
+			_row.codec = _codec.name;
+			_row.asset_class = _asset.asset_class;
+			if (!_run(_codec, _asset, _iterations, _row))
+			{
+				_row.passed = false;
+				_all.passed = false;
+				_passed = false;
+			}
+		}
+
+		for (auto& _iter : _classes)
+		{
+			auto& _row = _iter.second;
+			_all.files += _row.files;
+			_all.size_in += _row.size_in;
+			_all.size_out += _row.size_out;
+			_all.compress_seconds += _row.compress_seconds;
+			_all.decompress_seconds += _row.decompress_seconds;
+			_all.peak_memory = std::max(_all.peak_memory, _row.peak_memory);
+			_rows.push_back(_row);
+		}
+		_rows.push_back(_all);
+	}
+
+	if (_format == "csv") _print_csv(_rows);
+	else if (_format == "json") _print_json(_rows, _content_directory, _iterations);
+	else _print_table(_rows);
+
+	//release logger
+	logger.release();
+
+	return _passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}